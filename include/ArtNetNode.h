@@ -4,53 +4,276 @@
 #include <WiFiUdp.h>
 #include <array>
 
+#include "PortAddressMap.h"
+
+// Listens on one socket per interface (Ethernet, Wi-Fi station, Wi-Fi access
+// point), each bound to that interface's address, so a packet's socket tells
+// where it came from.  Replies leave the same way with that interface's IP and
+// MAC; a console on each network sees its own node.  Source filters restrict
+// which interfaces may feed a run of universes.  Whenever an interface starts
+// taking Art-Net the node sends an ArtPollReply, by unicast, to each known
+// controller on that interface's network, so they find it again after a
+// failover without waiting for their next poll.  ArtPollReply is never
+// broadcast; a console the node has not heard from finds it on its next poll.
+//
+// ArtPoll is answered after a random delay within the reply window, so a
+// broadcast poll does not get every node's reply in the same instant, and a
+// controller that polls again meanwhile still gets one reply.  Up to
+// MAX_CONTROLLERS pollers are remembered with their flags: a targeted poll
+// gets a reply only if it covers one of our Port-Addresses, a controller that
+// asked for changes gets an unsolicited reply when the node's state changes,
+// and one that asked for diagnostics gets sendDiagnostic()'s ArtDiagData.
+//
+// With a universe filter, ArtDmx for a Port-Address the map does not hold is
+// dropped on its 18-byte header; the payload is never copied or handed on.
 class ArtNetNode {
 public:
+  // Which interfaces listen: the preferred one while it has an address (the
+  // other is the fallback), or every interface that has one.
   enum class InterfacePreference : uint8_t {
     Ethernet = 0,
     WiFi     = 1,
-    Auto     = 2,
+    Auto     = 2,   // all at once
   };
 
+  enum class Interface : uint8_t {
+    Ethernet = 0,
+    WiFiStation,
+    WiFiAccessPoint,
+  };
+  static constexpr uint8_t INTERFACE_COUNT = 3;
+  static constexpr uint8_t interfaceBit(Interface iface) { return static_cast<uint8_t>(1u << static_cast<uint8_t>(iface)); }
+  static constexpr uint8_t ETHERNET_ONLY = 0x01;
+  static constexpr uint8_t WIFI_ONLY = 0x06;
+  static constexpr uint8_t ANY_INTERFACE = 0x07;
+
+  // Universes [firstUniverse, firstUniverse + universeCount) accept ArtDmx
+  // only from the interfaces in the mask; universes no filter covers accept
+  // any.  ArtSync is taken from the interfaces some filter allows.
+  struct SourceFilter {
+    uint16_t firstUniverse = 0;
+    uint16_t universeCount = 0;
+    uint8_t interfaces = ANY_INTERFACE;
+  };
+  static constexpr uint8_t MAX_SOURCE_FILTERS = 8;
+
   using ArtDmxCallback = void (*)(uint16_t universe, uint16_t length, uint8_t sequence,
                                   uint8_t* data, IPAddress remoteIP);
+  using ArtSyncCallback = void (*)(IPAddress remoteIP);
+
+  struct TimeCode {
+    uint8_t hours;
+    uint8_t minutes;
+    uint8_t seconds;
+    uint8_t frames;
+    uint8_t type;     // 0 Film 24, 1 EBU 25, 2 DF 29.97, 3 SMPTE 30
+    uint8_t streamId;
+
+    // Milliseconds since 00:00:00:00 on the wall clock of the given rate.
+    uint32_t toMs() const;
+  };
+  using ArtTimeCodeCallback = void (*)(const TimeCode& timecode, IPAddress remoteIP);
+
+  enum class AddressCommand : uint8_t {
+    None = 0,
+    CancelMerge,  // the next ArtDmx's sender becomes the only source
+    MergeLtp,     // AcMergeLtp0..3; the merge mode is shared by all ports
+    MergeHtp,     // AcMergeHtp0..3
+  };
+
+  // ArtAddress, decoded.  A switch is UNCHANGED when the sender left it alone
+  // and RESET when it asked for the default; an empty name is unchanged.
+  struct AddressProgram {
+    static constexpr int16_t UNCHANGED = -1;
+    static constexpr int16_t RESET = -2;
+
+    String shortName;
+    String longName;
+    int16_t net = UNCHANGED;     // Port-Address bits 14..8
+    int16_t subNet = UNCHANGED;  // bits 7..4
+    int16_t swOut = UNCHANGED;   // bits 3..0 of output port 0
+    AddressCommand command = AddressCommand::None;
+  };
+  using ArtAddressCallback = void (*)(const AddressProgram& program, IPAddress remoteIP);
+
+  // ArtIpProg, decoded.  Without enable the sender only asks for the settings.
+  struct IpProgram {
+    bool enable = false;
+    bool dhcp = false;           // overrides the fields below
+    bool resetDefaults = false;
+    bool setIp = false;
+    bool setMask = false;
+    bool setGateway = false;
+    IPAddress ip;
+    IPAddress mask;
+    IPAddress gateway;
+  };
+  // What ArtIpProgReply reports; the callback fills it in.
+  struct IpSettings {
+    IPAddress ip;
+    IPAddress mask;
+    IPAddress gateway;
+    bool dhcp = false;
+  };
+  using ArtIpProgCallback = void (*)(const IpProgram& program, IPAddress remoteIP, IpSettings& settings);
+
+  // ArtDiagData priorities (DpLow .. DpVolatile).
+  enum class DiagPriority : uint8_t {
+    Low      = 0x10,
+    Medium   = 0x40,
+    High     = 0x80,
+    Critical = 0xE0,
+    Volatile = 0xF0,
+  };
+
+  static constexpr uint8_t MAX_CONTROLLERS = 8;
+  // A controller that has not polled for this long is forgotten (they poll
+  // every 2.5 to 3 s).
+  static constexpr uint32_t CONTROLLER_TIMEOUT_MS = 10000;
+  // Art-Net lets a node take up to a second to answer.
+  static constexpr uint16_t DEFAULT_POLL_REPLY_WINDOW_MS = 1000;
+
+  struct PollStats {
+    uint32_t polls = 0;
+    uint32_t replies = 0;          // ArtPollReply sent for a poll
+    uint32_t coalesced = 0;        // polls that found their reply already pending
+    uint32_t untargeted = 0;       // targeted polls that missed our Port-Addresses
+    uint32_t changeReplies = 0;    // unsolicited, to controllers that asked for changes
+    uint32_t diagnostics = 0;      // ArtDiagData sent
+  };
 
   void begin(uint16_t port = 6454);
-  void read();
+  // Takes at most one datagram per interface; true when it took any.
+  bool read();
 
   void setArtDmxCallback(ArtDmxCallback callback);
+  void setArtSyncCallback(ArtSyncCallback callback);
+  void setArtTimeCodeCallback(ArtTimeCodeCallback callback) { m_timeCodeCallback = callback; }
+  // The node answers ArtAddress with an ArtPollReply once the callback has
+  // applied it, and ArtIpProg with an ArtIpProgReply; without a callback both
+  // are ignored.
+  void setArtAddressCallback(ArtAddressCallback callback) { m_addressCallback = callback; }
+  void setArtIpProgCallback(ArtIpProgCallback callback) { m_ipProgCallback = callback; }
   void setUniverseInfo(uint16_t startUniverse, uint16_t universeCount);
   void setNodeNames(const String& shortName, const String& longName);
   void updateNetworkInfo();
   void setInterfacePreference(InterfacePreference preference);
+  // A link that is down counts as having no address even while its stack
+  // still reports one, so the fallback takes over on the link event rather
+  // than when the lease runs out.
+  void setLinkUp(Interface iface, bool up);
+  // Hot standby: with Ethernet preferred, the Wi-Fi sockets stay open while
+  // Ethernet is up and drop what they receive; failing over only flips them.
+  void setStandby(bool standby);
+  void setSourceFilters(const SourceFilter* filters, uint8_t count);
+  // ArtDmx reaches the callback only for Port-Addresses in owned (kept by
+  // the caller, read on every packet); nullptr passes every universe.  A
+  // targeted ArtPoll is answered when its range meets owned; without it, when
+  // it meets the single run set by setUniverseInfo().
+  void setUniverseFilter(const PortAddressMap* owned);
+  // Reported per output port in ArtPollReply GoodOutput.
+  void setPortMerging(uint8_t port, bool merging);
+  void setMergeLtp(bool ltp);
+  // 0 answers every ArtPoll at once.
+  void setPollReplyWindow(uint16_t ms) { m_pollReplyWindowMs = ms; }
+  // Sends text as ArtDiagData to the controllers that asked for diagnostics of
+  // this priority or lower, unicast or broadcast as each asked.
+  void sendDiagnostic(DiagPriority priority, const char* text);
+  const PollStats& pollStats() const { return m_pollStats; }
+  uint8_t controllerCount() const;
+  // Address of the first listening interface in preference order.
   IPAddress localIp() const { return m_localIp; }
+  bool listening(Interface iface) const { return binding(iface).active; }
+  bool standingBy(Interface iface) const { return binding(iface).bound && !binding(iface).active; }
+  IPAddress interfaceIp(Interface iface) const { return binding(iface).ip; }
+  uint32_t interfacePackets(Interface iface) const { return binding(iface).packets; }
+  // ArtDmx and ArtSync dropped by the source filters.
+  uint32_t filteredPackets() const { return m_filteredPackets; }
+  // ArtDmx for universes outside the universe filter.
+  uint32_t unownedPackets() const { return m_unownedPackets; }
+  uint32_t firstPollReplyMs() const { return m_firstPollReplyMs; }
+  // Unsolicited ArtPollReplies sent when an interface started taking Art-Net
+  // (one per known controller on its network).
+  uint32_t announcements() const { return m_announcements; }
+  // Where the packet being handled came in; valid inside the callbacks.
+  Interface packetInterface() const { return static_cast<Interface>(m_current); }
 
 private:
   static constexpr uint16_t ARTNET_PORT = 6454;
   static constexpr size_t ARTNET_MAX_BUFFER = 600;
 
+  struct Binding {
+    WiFiUDP udp;
+    IPAddress ip;          // 0 while bound to every address (nothing has one yet)
+    IPAddress mask;
+    std::array<uint8_t, 6> mac{};
+    bool bound = false;
+    bool active = false;   // bound and not standing by
+    uint32_t packets = 0;
+  };
+
+  // A controller that polled us: where it polls from, what it asked for and
+  // whether its reply is still waiting for the random delay.
+  struct Controller {
+    IPAddress ip;
+    uint16_t port = 0;
+    uint8_t binding = 0;
+    uint8_t flags = 0;
+    uint8_t diagPriority = 0;
+    uint32_t lastPollMs = 0;
+    uint32_t replyDueMs = 0;
+    bool used = false;
+    bool replyPending = false;
+  };
+
+  const Binding& binding(Interface iface) const { return m_bindings[static_cast<uint8_t>(iface)]; }
+  void handlePoll(int len, IPAddress remoteIP, uint16_t remotePort);
+  Controller* controllerFor(IPAddress remoteIP, uint8_t index, uint32_t now);
+  void servicePollReplies();
+  bool servesPortAddress(uint16_t bottom, uint16_t top) const;
+  // False when nothing was waiting on the socket.
+  bool readFrom(uint8_t index);
+  bool arrivedElsewhere(uint8_t index, IPAddress remoteIP) const;
+  bool acceptsUniverse(uint16_t universe, uint8_t index) const;
   void sendPollReply(IPAddress remoteIP, uint16_t remotePort);
+  void announce(uint8_t index);
+  void sendReplyTo(const Controller& controller);
+  void handleAddress(int len);
+  void handleIpProg(int len);
   void refreshLocalInfo();
   void copyStringToField(const String& source, char* destination, size_t maxLength);
 
-  enum class ActiveInterface : uint8_t {
-    None = 0,
-    Ethernet,
-    WiFiStation,
-    WiFiAccessPoint,
-  };
-
-  WiFiUDP m_udp;
+  std::array<Binding, INTERFACE_COUNT> m_bindings;
+  uint8_t m_current = 0;   // binding of the packet being handled
   ArtDmxCallback m_dmxCallback = nullptr;
+  ArtSyncCallback m_syncCallback = nullptr;
+  ArtTimeCodeCallback m_timeCodeCallback = nullptr;
+  ArtAddressCallback m_addressCallback = nullptr;
+  ArtIpProgCallback m_ipProgCallback = nullptr;
   IPAddress m_localIp;
   uint16_t m_listenPort = ARTNET_PORT;
   uint16_t m_startUniverse = 0;
+  uint16_t m_universeCount = 1;
   uint8_t m_portCount = 1;
   String m_shortName = F("PixelEtherLED");
   String m_longName = F("PixelEtherLED Controller");
   std::array<uint8_t, ARTNET_MAX_BUFFER> m_buffer{};
-  std::array<uint8_t, 6> m_mac{};
   InterfacePreference m_interfacePreference = InterfacePreference::Ethernet;
-  ActiveInterface m_activeInterface = ActiveInterface::None;
+  SourceFilter m_filters[MAX_SOURCE_FILTERS];
+  uint8_t m_filterCount = 0;
+  uint8_t m_syncInterfaces = ANY_INTERFACE;
+  uint32_t m_filteredPackets = 0;
+  const PortAddressMap* m_ownedUniverses = nullptr;
+  uint32_t m_unownedPackets = 0;
+  uint32_t m_firstPollReplyMs = 0;
+  uint32_t m_announcements = 0;
+  std::array<Controller, MAX_CONTROLLERS> m_controllers;
+  PollStats m_pollStats;
+  uint16_t m_pollReplyWindowMs = DEFAULT_POLL_REPLY_WINDOW_MS;
+  bool m_stateChanged = false;   // something an ArtPollReply reports
+  uint8_t m_linkDown = 0;   // interfaceBit() mask
+  bool m_standby = false;
+  uint8_t m_portMergingMask = 0;
+  bool m_mergeLtp = false;
 };
 
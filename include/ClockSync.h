@@ -0,0 +1,131 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFiUdp.h>
+
+// Lightweight PTP-style clock sync so several nodes show a frame at the same
+// instant.  A slave measures its offset to the master with two-way timestamp
+// exchanges (offset = ((t2 - t1) + (t3 - t4)) / 2) and keeps the exchange
+// with the shortest round trip out of the last few, which filters out most
+// Wi-Fi queueing.  When the master latches a frame it sends every slave a
+// target time `now + presentDelay`; each node holds its own copy of that
+// frame until the target on its local clock instead of showing it as soon as
+// it was received.
+//
+// Timestamps are wrapping 32-bit microseconds passed in by the caller, so
+// clocks with arbitrary offsets work and host simulations can drive virtual
+// clocks.
+class ClockSync {
+public:
+  enum class Role : uint8_t {
+    Off = 0,
+    Master,
+    Slave,
+    ROLE_COUNT
+  };
+
+  static constexpr uint16_t PORT = 6460;
+  static constexpr uint8_t MAX_PEERS = 16;
+  static constexpr uint8_t SAMPLE_WINDOW = 8;
+  static constexpr uint32_t REQUEST_INTERVAL_US = 125000;
+  static constexpr uint32_t PEER_TIMEOUT_US = 5000000;
+  // Offset estimates older than this no longer count as synced.
+  static constexpr uint32_t SYNC_TIMEOUT_US = 3000000;
+
+  struct Peer {
+    IPAddress ip;
+    uint16_t port = 0;
+    uint32_t lastSeenUs = 0;
+    uint32_t errorUs = 0;       // presentation error reported by the slave
+    uint32_t pathDelayUs = 0;
+  };
+
+  // masterIp 0 = find the master by broadcast.  bindAddress is for host
+  // simulations running several nodes on one machine.  Calling it again with
+  // the same role and master keeps the current sync.
+  void begin(Role role, IPAddress masterIp, uint16_t port = PORT, IPAddress bindAddress = IPAddress((uint32_t)0));
+  void setPresentDelay(uint32_t delayUs) { m_presentDelayUs = delayUs; }
+  bool active() const { return m_role != Role::Off; }
+  Role role() const { return m_role; }
+
+  // Reads sync traffic and sends requests.  Call often from loop().
+  void service(uint32_t nowUs);
+
+  // A complete frame was latched; it is shown once presentDue() says so.
+  void frameLatched(uint32_t nowUs);
+  bool presentDue(uint32_t nowUs) const { return !m_pending || static_cast<int32_t>(nowUs - m_targetUs) >= 0; }
+  // The held frame started going out at startUs.
+  void presented(uint32_t startUs);
+
+  bool synced(uint32_t nowUs) const;
+  uint32_t toLocal(uint32_t masterUs) const { return masterUs - m_offsetUs; }
+  uint32_t toMaster(uint32_t localUs) const { return localUs + m_offsetUs; }
+
+  uint32_t offsetUs() const { return m_offsetUs; }
+  uint32_t pathDelayUs() const { return m_pathDelayUs; }
+  IPAddress masterIp() const { return m_masterIp; }
+  int32_t lastErrorUs() const { return m_lastErrorUs; }
+  // Smoothed |presentation error| plus half the round trip: how far this
+  // node's frames may be from the shared target.
+  uint32_t skewUs() const { return m_avgErrorUs + m_pathDelayUs / 2; }
+  uint32_t presentedFrames() const { return m_presented; }
+  uint32_t targetedFrames() const { return m_targetedCount; }
+  uint32_t lateFrames() const { return m_late; }
+  uint32_t exchanges() const { return m_exchanges; }
+
+  // Master only.
+  uint8_t peerCount() const { return m_peerCount; }
+  const Peer& peer(uint8_t index) const { return m_peers[index]; }
+  uint32_t maxPeerSkewUs() const;
+
+private:
+  struct Sample {
+    uint32_t offsetUs;
+    uint32_t pathDelayUs;
+  };
+
+  void handlePacket(const uint8_t* data, size_t length, uint32_t nowUs);
+  void sendPacket(IPAddress ip, uint16_t port, uint8_t type, uint16_t seq, uint32_t t1, uint32_t t2, uint32_t t3, uint32_t value);
+  void addSample(uint32_t offsetUs, uint32_t pathDelayUs, uint32_t nowUs);
+  void notePeer(IPAddress ip, uint16_t port, uint32_t errorUs, uint32_t pathDelayUs, uint32_t nowUs);
+  void setTarget(uint32_t targetUs);
+
+  WiFiUDP m_udp;
+  Role m_role = Role::Off;
+  uint16_t m_port = PORT;
+  IPAddress m_masterIp;
+  IPAddress m_configuredMasterIp;
+  bool m_discover = false;
+  uint32_t m_presentDelayUs = 20000;
+
+  // Slave clock estimate: master time = local time + m_offsetUs.
+  Sample m_samples[SAMPLE_WINDOW] = {};
+  uint8_t m_sampleCount = 0;
+  uint8_t m_sampleNext = 0;
+  uint32_t m_offsetUs = 0;
+  uint32_t m_pathDelayUs = 0;
+  uint32_t m_lastSampleUs = 0;
+  bool m_hasOffset = false;
+  uint32_t m_nextRequestUs = 0;
+  bool m_requestScheduled = false;
+  uint16_t m_requestSeq = 0;
+  uint32_t m_exchanges = 0;
+
+  // Frame presentation.
+  bool m_pending = false;
+  bool m_targeted = false;      // target came from the master
+  uint32_t m_latchUs = 0;
+  uint32_t m_targetUs = 0;
+  bool m_announced = false;     // a master target not yet matched to a frame
+  uint32_t m_announceUs = 0;    // local arrival of that target
+  uint32_t m_announceTargetUs = 0;
+
+  int32_t m_lastErrorUs = 0;
+  uint32_t m_avgErrorUs = 0;
+  uint32_t m_presented = 0;
+  uint32_t m_targetedCount = 0;
+  uint32_t m_late = 0;
+
+  Peer m_peers[MAX_PEERS];
+  uint8_t m_peerCount = 0;
+};
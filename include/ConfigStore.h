@@ -0,0 +1,66 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <vector>
+
+// Persists the configuration as one versioned, CRC-protected blob under a
+// single NVS key.  Writes are staged in RAM, dropped when the payload matches
+// what is already in flash, and committed from loop() once the caller reports
+// a quiet moment (or MAX_DEFER_MS has passed since the first pending change).
+//
+// Layouts only ever grow: newer fields are appended, so a shorter blob written
+// by an older firmware loads its prefix over the caller's defaults.
+class ConfigStore {
+public:
+  enum class LoadResult : uint8_t {
+    Ok,
+    Missing,
+    Corrupt
+  };
+
+  static constexpr uint32_t WRITE_DELAY_MS = 1000;   // coalesces bursts of saves
+  static constexpr uint32_t MAX_DEFER_MS   = 10000;  // write even if output never idles
+
+  ConfigStore(const char* ns, const char* key) : m_namespace(ns), m_key(key) {}
+
+  // Single NVS read.  On Ok copies min(stored, capacity) bytes into payload and
+  // reports the stored layout version and length.
+  LoadResult load(void* payload, size_t capacity, uint16_t& version, size_t& length);
+
+  // Queues payload for writing; returns false (and does nothing) when it is
+  // identical to the persisted copy.
+  bool stage(const void* payload, size_t size, uint16_t version);
+  // Commits a staged payload when due.  Returns true if flash was written.
+  bool service(bool quiet);
+  // Commits a staged payload immediately (before a restart).
+  bool flush();
+  // Drops the cached copy after the namespace was erased externally.
+  void forget();
+
+  bool dirty() const { return m_dirty; }
+  uint32_t writeCount() const { return m_writes; }
+  uint32_t skippedCount() const { return m_skipped; }
+
+private:
+  struct Header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t length;
+    uint32_t crc;
+  };
+  static constexpr uint32_t MAGIC = 0x31435850;  // "PXC1"
+
+  bool write();
+
+  const char* m_namespace;
+  const char* m_key;
+  Preferences m_prefs;
+  std::vector<uint8_t> m_persisted;   // header + payload as stored in flash
+  std::vector<uint8_t> m_staged;
+  bool m_dirty = false;
+  uint32_t m_firstDirtyMs = 0;
+  uint32_t m_lastStageMs = 0;
+  uint32_t m_writes = 0;
+  uint32_t m_skipped = 0;
+};
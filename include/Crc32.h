@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Standard CRC-32 (IEEE 802.3, reflected).  Bitwise on purpose: it only runs
+// on configuration and scene records, never per packet.
+inline uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t length)
+{
+  crc = ~crc;
+  for (size_t i = 0; i < length; ++i) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+  }
+  return ~crc;
+}
+
+inline uint32_t crc32(const void* data, size_t length)
+{
+  return crc32Update(0, static_cast<const uint8_t*>(data), length);
+}
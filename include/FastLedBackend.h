@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+
+#include "LedOutputs.h"
+
+// Drives LedOutputs through FastLED.  Each output gets its own clockless
+// controller; on the ESP32 FastLED assigns each one an RMT channel and starts
+// all of them together in show(), so the outputs transmit in parallel.
+//
+// After begin() the backend is asynchronous: FastLED.show() runs in a task of
+// its own, which sleeps while the RMT hardware clocks the data out, and show()
+// only wakes that task up.
+class FastLedBackend : public LedOutputs::Backend {
+public:
+  static constexpr uint32_t TASK_STACK = 4096;
+  static constexpr UBaseType_t TASK_PRIORITY = 2;
+
+  // Starts the output task on the given core; without it show() blocks.
+  bool begin(BaseType_t core);
+
+  bool attach(uint8_t index, const LedOutputs::Output& output, CRGB* pixels) override;
+  void resize(uint8_t index, CRGB* pixels, uint16_t count) override;
+  void show(uint8_t brightness) override;
+  bool asynchronous() const override { return m_task != nullptr; }
+  bool busy() const override { return m_busy.load(std::memory_order_acquire); }
+  uint32_t doneUs() const override { return m_doneUs; }
+
+private:
+  static void taskMain(void* arg);
+
+  CLEDController* m_controllers[LedOutputs::MAX_OUTPUTS] = {};
+  TaskHandle_t m_task = nullptr;
+  std::atomic<bool> m_busy{false};
+  uint8_t m_brightness = 255;
+  uint32_t m_doneUs = 0;
+};
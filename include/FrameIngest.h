@@ -0,0 +1,222 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+#include "LatencyHistogram.h"
+#include "MemoryArena.h"
+#include "PortAddressMap.h"
+
+// Copies ArtDmx universes into the pixel buffer and latches a frame once every
+// configured universe has been received at least once.  After an ArtSync the
+// node switches to synchronous mode and latches on ArtSync instead, falling
+// back to completeness latching when no ArtSync arrives for 4 s.
+//
+// Up to two controllers may feed the same universe (Art-Net merge).  Their
+// data is combined HTP (per-channel highest) or LTP (latest packet); a third
+// source is ignored until one of the two has been silent for 10 s.  While only
+// one source is active nothing is buffered and the packet is copied straight
+// into the pixels.  Merge buffers come from a fixed pool sized by the memory
+// plan; when it runs dry a universe merges LTP until a slot frees up.
+// cancelMerge() (ArtAddress CancelMerge) hands every universe to whichever
+// controller sends the next packet; the others are ignored until it has been
+// silent for 10 s.
+//
+// Each LED output maps its own run of universes onto its slice of the pixel
+// buffer, so outputs need not use consecutive universes.  Ranges should not
+// overlap; a universe claimed twice feeds only the first range.  A
+// Port-Address map built at configure() finds a universe's index in one
+// lookup however the ranges are spread; the node filters on the same map.
+//
+// The copy loop also sums each universe's R, G and B channels, so the frame's
+// power draw can be estimated at latch without another pass over the pixels,
+// and notes whether any pixel actually changed value.
+class FrameIngest {
+public:
+  enum class MergeMode : uint8_t {
+    Htp = 0,
+    Ltp = 1,
+  };
+
+  struct Stats {
+    uint32_t packets = 0;
+    uint32_t framesLatched = 0;
+    uint32_t syncLatched = 0;
+    uint32_t syncPackets = 0;
+    uint32_t mergedPackets = 0;        // packets received while two sources were merged
+    uint32_t ignoredSourcePackets = 0; // packets from a third source, or after cancelMerge()
+    uint32_t unbufferedMerges = 0;     // merged LTP for lack of a pool slot
+    LatencyHistogram latchLatencyUs;   // first packet of a frame -> latch
+  };
+
+  struct ChannelSums {
+    uint32_t r = 0;
+    uint32_t g = 0;
+    uint32_t b = 0;
+  };
+
+  static constexpr uint8_t MAX_RANGES = 8;
+
+  struct Range {
+    uint16_t startUniverse = 0;
+    uint16_t firstPixel = 0;
+    uint16_t pixelCount = 0;
+  };
+
+  // The universe tables and mergeSlots merge buffers are taken from arena;
+  // false when it cannot hold the tables, and then no universe is ours.
+  // One range starting at pixel 0.
+  bool configure(uint16_t numLeds, uint16_t startUniverse, uint16_t pixelsPerUniverse, MemoryArena& arena,
+                 uint16_t mergeSlots);
+  bool configure(const Range* ranges, uint8_t count, uint16_t pixelsPerUniverse, MemoryArena& arena,
+                 uint16_t mergeSlots);
+  static uint16_t universesFor(const Range* ranges, uint8_t count, uint16_t pixelsPerUniverse);
+  // Arena bytes for the universe tables of universes spread over ranges
+  // runs, and for a pool of merge slots.
+  static size_t tableBytes(uint16_t universes, uint8_t ranges = 1)
+  {
+    return MemoryArena::footprint<uint8_t>(universes) + MemoryArena::footprint<UniverseState>(universes) +
+           PortAddressMap::bytesFor(PortAddressMap::maxPages(universes, ranges));
+  }
+  static size_t mergePoolBytes(uint16_t slots)
+  {
+    return MemoryArena::footprint<MergeBuffers>(slots) + MemoryArena::footprint<uint16_t>(slots);
+  }
+  void setTarget(CRGB* pixels) { m_pixels = pixels; }
+  // With a staging buffer, ArtDmx assembles frames there (a plain copy) and
+  // only loadFrame() writes the target; a jitter buffer releases them later.
+  void setStaging(CRGB* pixels) { m_staging = pixels; }
+
+  void setMergeMode(MergeMode mode) { m_mergeMode = mode; }
+  MergeMode mergeMode() const { return m_mergeMode; }
+  void cancelMerge() { m_cancelMergePending = true; }
+  // The controller that took over after cancelMerge(), or 0.
+  uint32_t exclusiveSource() const { return m_exclusiveIp; }
+
+  // Returns true when this packet completed a frame.  sourceIp identifies the
+  // sending controller for merging.
+  bool ingest(uint16_t universe, uint16_t length, const uint8_t* data, uint32_t sourceIp);
+  // Writes a whole frame from a local source (show playback) through the same
+  // copy as ArtDmx, bypassing merging and latching.
+  void loadFrame(const CRGB* pixels, uint16_t count);
+  // Returns true when the ArtSync latched a (possibly partial) frame.
+  bool sync();
+  void reset();
+
+  bool syncMode() const { return m_syncActive && (millis() - m_lastSyncMs) < SYNC_TIMEOUT_MS; }
+  const Stats& stats() const { return m_stats; }
+  void resetStats() { m_stats = Stats(); }
+
+  // Universe index (0-based, across all ranges) or -1 when not ours.
+  int32_t universeIndex(uint16_t universe) const
+  {
+    const uint16_t slot = m_map.slot(universe);
+    return slot == PortAddressMap::NONE ? -1 : slot;
+  }
+  bool ownsUniverse(uint16_t universe) const { return universeIndex(universe) >= 0; }
+
+  uint16_t universeCount() const { return m_universeCount; }
+  // Port-Address to universe index for every universe we own.
+  const PortAddressMap& portAddressMap() const { return m_map; }
+  uint16_t mergeSlots() const { return m_mergeSlots; }
+  uint16_t freeMergeSlots() const { return m_freeMergeCount; }
+  // First universe of the first range.
+  uint16_t startUniverse() const { return m_rangeCount ? m_ranges[0].startUniverse : 0; }
+  uint16_t pixelsPerUniverse() const { return m_pixelsPerUniverse; }
+  uint16_t numLeds() const { return m_numLeds; }
+  // First pixel written by universe index idxU.
+  uint16_t pixelOffset(uint16_t idxU) const { return m_universes[idxU].pixelOffset; }
+
+  bool merging(uint16_t universe) const
+  {
+    const int32_t idxU = universeIndex(universe);
+    return idxU >= 0 && m_universes[idxU].merging;
+  }
+  // Sums of the pixels last written for universe index idxU (0-based).
+  const ChannelSums& channelSums(uint16_t idxU) const { return m_universes[idxU].sums; }
+  // True once after any pixel changed value since the previous call; callers
+  // take it when a frame latches.
+  bool takeFrameChanged()
+  {
+    const bool changed = m_frameChanged;
+    m_frameChanged = false;
+    return changed;
+  }
+  // True while pixels written since the last latch differ from it, i.e. the
+  // target holds part of a new frame.  Does not consume the flag.
+  bool frameChangePending() const { return m_frameChanged; }
+  // True once after any universe started or stopped merging.
+  bool takeMergeStateChange()
+  {
+    const bool changed = m_mergeStateChanged;
+    m_mergeStateChanged = false;
+    return changed;
+  }
+
+private:
+  static constexpr uint32_t SYNC_TIMEOUT_MS = 4000;
+  static constexpr uint32_t MERGE_TIMEOUT_MS = 10000;
+  static constexpr size_t DMX_WORDS = 512 / sizeof(uint32_t);
+
+  struct MergeSource {
+    uint32_t ip = 0;
+    uint32_t lastMs = 0;
+  };
+
+  // Taken from the pool the first time a universe sees a second source.
+  struct MergeBuffers {
+    uint32_t dmx[2][DMX_WORDS];
+    uint32_t merged[DMX_WORDS];
+    uint16_t length[2];
+  };
+
+  struct RangeState {
+    uint16_t startUniverse = 0;
+    uint16_t universeCount = 0;
+    uint16_t firstIndex = 0;
+  };
+
+  struct UniverseState {
+    uint16_t pixelOffset = 0;
+    uint16_t pixelCount = 0;
+    MergeSource sources[2];
+    bool merging = false;
+    ChannelSums sums;
+    MergeBuffers* buffers = nullptr;
+  };
+
+  void latch();
+  void copyUniverse(uint16_t idxU, const uint8_t* data, uint16_t pixels);
+  void stageUniverse(uint16_t idxU, const uint8_t* data, uint16_t pixels);
+  bool admitSource(uint32_t sourceIp, uint32_t now);
+  int8_t selectSource(UniverseState& state, uint32_t sourceIp, uint32_t now);
+  const uint8_t* merge(UniverseState& state, uint8_t slot, uint16_t& length, const uint8_t* data);
+  MergeBuffers* takeMergeBuffers();
+  void releaseMergeBuffers(UniverseState& state);
+
+  CRGB* m_pixels = nullptr;
+  CRGB* m_staging = nullptr;
+  uint16_t m_numLeds = 0;
+  RangeState m_ranges[MAX_RANGES];
+  uint8_t m_rangeCount = 0;
+  PortAddressMap m_map;
+  uint16_t m_pixelsPerUniverse = 1;
+  uint16_t m_universeCount = 0;
+  uint16_t m_receivedCount = 0;
+  uint8_t* m_received = nullptr;
+  UniverseState* m_universes = nullptr;
+  MergeBuffers* m_mergePool = nullptr;
+  uint16_t* m_freeMerge = nullptr;     // stack of free pool slots
+  uint16_t m_mergeSlots = 0;
+  uint16_t m_freeMergeCount = 0;
+  MergeMode m_mergeMode = MergeMode::Htp;
+  bool m_cancelMergePending = false;
+  uint32_t m_exclusiveIp = 0;
+  uint32_t m_exclusiveLastMs = 0;
+  bool m_mergeStateChanged = false;
+  bool m_frameChanged = true;
+  uint32_t m_frameStartUs = 0;
+  uint32_t m_lastSyncMs = 0;
+  bool m_syncActive = false;
+  Stats m_stats;
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+#include "MemoryArena.h"
+
+// Evens out bunched frame arrival (typical of Wi-Fi) by holding a few
+// complete frames and releasing them at a steady cadence.  The cadence
+// follows the smoothed input interval and is nudged faster or slower to keep
+// the buffer at its target depth, which is derived from the maximum added
+// latency; a frame never waits longer than that.
+//
+// Frames are kept in Art-Net sequence order (arrival order when the sender
+// does not number packets); a frame older than one already released is
+// dropped.
+//
+// How many frames it can queue is set by the memory plan: whatever the arena
+// has left once the other buffers are carved, between MIN_ and MAX_CAPACITY.
+class FrameJitterBuffer {
+public:
+  static constexpr uint8_t MIN_CAPACITY = 2;
+  static constexpr uint8_t MAX_CAPACITY = 16;
+  static constexpr uint16_t MAX_LATENCY_MS = 200;
+
+  // Takes room for capacity queued frames from arena.  maxLatencyMs 0
+  // disables the buffer and takes nothing; so does an arena too small for
+  // MIN_CAPACITY frames.
+  void configure(uint16_t numLeds, uint16_t maxLatencyMs, MemoryArena& arena, uint8_t capacity);
+  bool enabled() const { return m_maxLatencyUs != 0; }
+  // Arena bytes for capacity queued frames plus the staging and release slots.
+  static size_t bytesFor(uint16_t numLeds, uint8_t capacity)
+  {
+    return MemoryArena::footprint<CRGB>(numLeds) + MemoryArena::footprint<CRGB>(static_cast<size_t>(capacity + 1) * numLeds);
+  }
+
+  // Where FrameIngest assembles incoming frames while the buffer is enabled.
+  CRGB* staging() { return enabled() ? m_staging : nullptr; }
+  // The staged frame is complete.  sequence 0 = unnumbered.
+  void push(uint8_t sequence, uint32_t nowUs);
+  // Next frame due for presentation, or nullptr.  Valid until the next call.
+  const CRGB* release(uint32_t nowUs);
+
+  uint8_t depth() const { return m_count; }
+  uint8_t capacity() const { return m_capacity; }
+  uint8_t targetDepth() const { return m_targetDepth; }
+  uint32_t intervalUs() const { return m_intervalUs; }
+  uint32_t latencyUs() const { return m_latencyUs; }
+  uint32_t released() const { return m_released; }
+  uint32_t underruns() const { return m_underruns; }
+  uint32_t overruns() const { return m_overruns; }
+  uint32_t lateFrames() const { return m_late; }
+
+private:
+  struct Slot {
+    uint8_t sequence;
+    uint32_t arrivalUs;
+  };
+
+  CRGB* slotPixels(uint8_t slot) { return m_frames + static_cast<size_t>(slot) * m_numLeds; }
+  void updateTargetDepth();
+
+  uint16_t m_numLeds = 0;
+  uint32_t m_maxLatencyUs = 0;
+  uint8_t m_capacity = 0;
+  CRGB* m_staging = nullptr;
+  CRGB* m_frames = nullptr;        // m_capacity frames plus the one being released
+  Slot m_slots[MAX_CAPACITY + 1] = {};
+  uint8_t m_order[MAX_CAPACITY] = {};  // queued slots, oldest first
+  uint8_t m_count = 0;
+  uint8_t m_releasedSlot = 0;
+
+  uint32_t m_intervalUs = 0;       // smoothed input interval
+  uint32_t m_lastPushUs = 0;
+  bool m_hasPushed = false;
+  uint8_t m_targetDepth = 1;
+  bool m_playing = false;
+  uint32_t m_nextReleaseUs = 0;
+  bool m_hasReleased = false;
+  uint8_t m_lastSequence = 0;
+
+  uint32_t m_latencyUs = 0;        // smoothed wait from arrival to release
+  uint32_t m_released = 0;
+  uint32_t m_underruns = 0;
+  uint32_t m_overruns = 0;
+  uint32_t m_late = 0;
+};
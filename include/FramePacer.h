@@ -0,0 +1,54 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Decides when the next FastLED.show() may start.  It measures how long a
+// show really takes (the strip's transfer time, during which the CPU is
+// blocked) and spaces shows so they never run back to back, leaving the loop
+// time to ingest packets; an optional max fps caps output further.  Frames
+// that latch while the strip is busy are coalesced by the render stage, so
+// only the newest one is shown.
+//
+// When the transfer runs in the background (an asynchronous output) the loop
+// is not blocked, so no headroom is added and shows may follow back to back.
+class FramePacer {
+public:
+  // 0 = limited only by the measured strip transfer time.
+  void setMaxFps(uint16_t fps);
+  void setBackgroundShow(bool background);
+
+  bool due(uint32_t nowUs) const { return nowUs - m_lastShowStartUs >= m_intervalUs; }
+
+  void frameReceived();
+  void frameCoalesced() { m_coalesced++; }
+  void frameShown(uint32_t startUs, uint32_t endUs);
+
+  // Rates over the last complete one-second window.
+  uint16_t inputFps() const { return m_inputFps; }
+  uint16_t outputFps() const { return m_outputFps; }
+  uint32_t showUs() const { return m_showUs; }
+  uint32_t intervalUs() const { return m_intervalUs; }
+  uint32_t coalesced() const { return m_coalesced; }
+
+private:
+  // Shows are spaced by the transfer time plus 1/HEADROOM_DIVISOR of it, so
+  // ingest always gets at least ~20% of the loop.
+  static constexpr uint32_t HEADROOM_DIVISOR = 4;
+  static constexpr uint32_t WINDOW_MS = 1000;
+
+  void updateInterval();
+  void roll(uint32_t nowMs);
+
+  bool m_background = false;
+  uint32_t m_minIntervalUs = 0;
+  uint32_t m_intervalUs = 0;
+  uint32_t m_showUs = 0;           // smoothed show duration
+  uint32_t m_lastShowStartUs = 0;
+  uint32_t m_coalesced = 0;
+
+  uint32_t m_windowStartMs = 0;
+  uint16_t m_inputCount = 0;
+  uint16_t m_outputCount = 0;
+  uint16_t m_inputFps = 0;
+  uint16_t m_outputFps = 0;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+// Fixed-size log-linear histogram (four buckets per power of two) for
+// microsecond latencies.  Recording is a couple of shifts and an increment, so
+// it can sit on the receive path; percentiles are accurate to ~19%.
+class LatencyHistogram {
+public:
+  void record(uint32_t value)
+  {
+    ++m_buckets[bucketFor(value)];
+    ++m_count;
+    if (value > m_max) m_max = value;
+  }
+
+  void reset()
+  {
+    memset(m_buckets, 0, sizeof(m_buckets));
+    m_count = 0;
+    m_max = 0;
+  }
+
+  uint32_t count() const { return m_count; }
+  uint32_t max() const { return m_max; }
+
+  // Upper bound of the bucket holding the requested percentile (0..100).
+  uint32_t percentile(uint8_t pct) const
+  {
+    if (m_count == 0) return 0;
+    uint32_t target = static_cast<uint32_t>((static_cast<uint64_t>(m_count) * pct + 99) / 100);
+    if (target == 0) target = 1;
+    uint32_t seen = 0;
+    for (uint16_t i = 0; i < kBucketCount; ++i) {
+      seen += m_buckets[i];
+      if (seen >= target) {
+        const uint32_t upper = bucketUpperBound(i);
+        return upper < m_max ? upper : m_max;
+      }
+    }
+    return m_max;
+  }
+
+private:
+  static constexpr uint8_t kSubBits = 2;
+  static constexpr uint16_t kBucketCount = (32 - kSubBits + 1) << kSubBits;
+
+  static uint16_t bucketFor(uint32_t value)
+  {
+    if (value < (1u << kSubBits)) return static_cast<uint16_t>(value);
+    const uint8_t msb = static_cast<uint8_t>(31 - __builtin_clz(value));
+    const uint8_t shift = msb - kSubBits;
+    const uint32_t sub = (value >> shift) & ((1u << kSubBits) - 1);
+    return static_cast<uint16_t>(((shift + 1) << kSubBits) + sub);
+  }
+
+  static uint32_t bucketUpperBound(uint16_t bucket)
+  {
+    if (bucket < (1u << kSubBits)) return bucket;
+    const uint8_t shift = static_cast<uint8_t>((bucket >> kSubBits) - 1);
+    const uint32_t sub = bucket & ((1u << kSubBits) - 1);
+    const uint64_t upper = ((static_cast<uint64_t>((1u << kSubBits) | sub) + 1) << shift) - 1;
+    return upper > 0xFFFFFFFFull ? 0xFFFFFFFFu : static_cast<uint32_t>(upper);
+  }
+
+  uint32_t m_buckets[kBucketCount] = {};
+  uint32_t m_count = 0;
+  uint32_t m_max = 0;
+};
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+#include "MemoryArena.h"
+
+enum class LedChipType : uint8_t {
+  WS2811 = 0,
+  WS2812B,
+  SK6812,
+  CHIP_TYPE_COUNT
+};
+
+enum class LedColorOrder : uint8_t {
+  RGB = 0,
+  RBG,
+  GRB,
+  GBR,
+  BRG,
+  BGR,
+  COLOR_ORDER_COUNT
+};
+
+// Parallel LED outputs.  Each output is a slice of the shared pixel buffer
+// sent on its own data pin with its own chipset and color order.  A backend
+// sends every slice at once (on the ESP32, one RMT channel per output), so a
+// refresh takes as long as the longest output instead of the sum of all.
+//
+// An asynchronous backend returns from show() as soon as the transfer is
+// started.  The frame is first copied into a transmit buffer the backend
+// reads from, so the pixel buffer is free again right away and the next
+// frame's ingest overlaps the transfer; the copy is the only output work on
+// the caller's side.  service() reports the end of a transfer through the
+// done callback, from the caller's task.
+//
+// The backend is the only part that touches hardware; host tools plug in a
+// recording backend to check what each output sent and when.
+class LedOutputs {
+public:
+  static constexpr uint8_t MAX_OUTPUTS = 4;
+  // Free data pins on the WT32-ETH01 header, in the order outputs use them.
+  static constexpr uint8_t PIN_COUNT = 4;
+  static constexpr uint8_t PINS[PIN_COUNT] = {2, 4, 14, 15};
+
+  struct Output {
+    uint8_t pin = 2;
+    LedChipType chip = LedChipType::WS2811;
+    LedColorOrder colorOrder = LedColorOrder::GRB;
+    uint16_t firstLed = 0;
+    uint16_t ledCount = 0;
+  };
+
+  class Backend {
+  public:
+    virtual ~Backend() = default;
+    // Registers an output on its pin; false when the backend cannot drive it.
+    virtual bool attach(uint8_t index, const Output& output, CRGB* pixels) = 0;
+    // Points an attached output at a new slice (LED count changed).
+    virtual void resize(uint8_t index, CRGB* pixels, uint16_t count) = 0;
+    // Sends every attached output.  A blocking backend returns once all of
+    // them are done, an asynchronous one once the transfer started.
+    virtual void show(uint8_t brightness) = 0;
+    virtual bool asynchronous() const { return false; }
+    // Asynchronous backends: true while a transfer runs, and the micros()
+    // at which the last one finished.
+    virtual bool busy() const { return false; }
+    virtual uint32_t doneUs() const { return 0; }
+  };
+
+  // Called when a show finished sending, with its start and end in micros().
+  using DoneCallback = void (*)(uint32_t startUs, uint32_t endUs);
+
+  void begin(Backend& backend);
+  void setDoneCallback(DoneCallback callback) { m_doneCallback = callback; }
+  // pixels holds capacity LEDs; outputs are slices of it.  An asynchronous
+  // backend also gets a transmit buffer from arena (false when it does not
+  // fit).  Call configure() next so the backend reads the new buffers.
+  bool setBuffers(CRGB* pixels, uint16_t capacity, MemoryArena& arena);
+  // Arena bytes setBuffers() takes.
+  static size_t bytesFor(uint16_t capacity, bool asynchronous)
+  {
+    return asynchronous ? MemoryArena::footprint<CRGB>(capacity) : 0;
+  }
+
+  // Attaches new outputs and resizes the ones already attached.  Returns false
+  // when an attached output changed pin, chip or color order: controllers
+  // cannot be removed, so that takes a restart.
+  bool configure(const Output* outputs, uint8_t count);
+  // Starts sending the pixel buffer; false while the previous show is still
+  // on the wire.
+  bool show(uint8_t brightness);
+  // Blacks out every output and waits until that is sent.
+  void clear();
+  // Reports a finished asynchronous show; call from loop().
+  void service();
+  // Blocks until the show in flight is sent, e.g. before its buffers go away.
+  void waitIdle();
+  bool busy() const { return m_pending; }
+  bool asynchronous() const { return m_transmit != nullptr; }
+
+  uint8_t count() const { return m_count; }
+  const Output& output(uint8_t index) const { return m_outputs[index]; }
+  uint16_t totalLeds() const;
+
+  // Time on the wire for one output (24 bits at 800 kHz plus the latch gap)
+  // and for a refresh, which is the longest output.
+  static uint32_t wireTimeUs(const Output& output);
+  uint32_t frameTimeUs() const;
+  uint32_t showCount() const { return m_showCount; }
+  // Caller time spent per show: the copy for an asynchronous backend, the
+  // whole transfer for a blocking one.
+  uint32_t lastShowCallUs() const { return m_showCallUs; }
+
+private:
+  static constexpr uint32_t BIT_NS = 1250;
+  static constexpr uint32_t LATCH_US = 80;
+
+  // Slice an output's controller reads from.
+  CRGB* sendBuffer(uint16_t firstLed) { return (m_transmit ? m_transmit : m_pixels) + firstLed; }
+  void finish(uint32_t endUs);
+
+  Backend* m_backend = nullptr;
+  CRGB* m_pixels = nullptr;
+  uint16_t m_capacity = 0;
+  CRGB* m_transmit = nullptr;     // asynchronous backends only
+  DoneCallback m_doneCallback = nullptr;
+  bool m_pending = false;
+  uint32_t m_startUs = 0;
+  uint32_t m_showCallUs = 0;
+  Output m_outputs[MAX_OUTPUTS];
+  uint8_t m_count = 0;
+  uint8_t m_attached = 0;
+  uint32_t m_showCount = 0;
+};
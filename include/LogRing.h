@@ -0,0 +1,109 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+// Fixed-size log for code that must not wait on the UART.  A record keeps the
+// address of its format string and up to MAX_ARGS 32-bit arguments (or one
+// short string) and is only formatted when the reader takes it, so writing
+// one is a few stores.  Any task may write: a slot is claimed with one
+// compare-and-swap and published by its sequence number.  When the ring is
+// full the new record is dropped and counted; writers never wait.  One task
+// reads, and keeps the last HISTORY records it took for /api/logs.
+class LogRing {
+public:
+  enum class Level : uint8_t {
+    Error = 0,
+    Warn,
+    Info,
+    Debug,
+    LEVEL_COUNT
+  };
+
+  enum class Tag : uint8_t {
+    Cfg = 0,
+    Eth,
+    Wifi,
+    ArtNet,
+    Dmx,
+    Mem,
+    Scene,
+    Fw,
+    Led,
+    Show,
+    TAG_COUNT
+  };
+
+  static constexpr size_t CAPACITY = 64;   // power of two
+  static constexpr size_t HISTORY = 32;
+  static constexpr uint8_t MAX_ARGS = 12;
+  static constexpr size_t TEXT_SIZE = 80;    // one diagnostic line, an SSID or a file name
+  static constexpr size_t LINE_SIZE = 160;
+
+  struct Record {
+    uint32_t seq = 0;   // order of writing
+    uint32_t ms = 0;
+    const char* format = "";
+    Level level = Level::Info;
+    Tag tag = Tag::Cfg;
+    bool hasText = false;
+    union {
+      uint32_t args[MAX_ARGS] = {};
+      char text[TEXT_SIZE];
+    };
+  };
+
+  LogRing();
+
+  void setLevel(Level level) { m_level.store(level, std::memory_order_relaxed); }
+  Level level() const { return m_level.load(std::memory_order_relaxed); }
+  bool enabled(Level level) const { return level <= this->level(); }
+
+  // format may only hold 32-bit conversions (%u, %d, %x, %c); each argument
+  // is stored as 32 bits.  The string must outlive the record (a literal).
+  template <typename... Args>
+  bool log(Level level, Tag tag, const char* format, Args... args)
+  {
+    static_assert(sizeof...(Args) <= MAX_ARGS, "too many log arguments");
+    if (!enabled(level)) return false;
+    const uint32_t values[] = {static_cast<uint32_t>(args)..., 0};
+    return push(level, tag, format, values, sizeof...(Args), nullptr);
+  }
+  // format holds one %s, filled with a copy of text (cut to TEXT_SIZE - 1).
+  bool logText(Level level, Tag tag, const char* format, const char* text);
+
+  // Reader side, one task only.  The oldest record not yet taken, or nullptr.
+  const Record* peek() const;
+  // Takes the record peek() returned into the history.
+  void pop();
+
+  // Oldest first.
+  size_t historyCount() const { return m_taken < HISTORY ? m_taken : HISTORY; }
+  const Record& history(size_t index) const { return m_history[(m_taken - historyCount() + index) % HISTORY]; }
+
+  uint32_t written() const { return m_head.load(std::memory_order_relaxed); }
+  uint32_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+  // "[TAG] message", without a newline; returns its length.
+  static size_t format(const Record& record, char* line, size_t size);
+  static const char* tagName(Tag tag);
+  static const char* levelName(Level level);
+
+private:
+  struct Cell {
+    std::atomic<uint32_t> sequence{0};
+    Record record;
+  };
+
+  bool push(Level level, Tag tag, const char* format, const uint32_t* args, uint8_t count, const char* text);
+
+  Cell m_cells[CAPACITY];
+  std::atomic<uint32_t> m_head{0};
+  std::atomic<uint32_t> m_dropped{0};
+  uint32_t m_tail = 0;
+  Record m_history[HISTORY];
+  uint32_t m_taken = 0;
+  std::atomic<Level> m_level{Level::Info};
+};
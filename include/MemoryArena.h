@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+#include <type_traits>
+
+// One heap block reserved at boot.  Buffers whose size depends on the
+// configuration are carved out of it by a bump allocator when the
+// configuration is applied, and all dropped together on the next apply, so
+// reconfiguring never fragments the heap and nothing on the data path
+// allocates.  Each block is named so /metrics can report the plan.
+class MemoryArena {
+public:
+  // What the heap guarantees for the base on every target.
+  static constexpr size_t ALIGN = alignof(void*);
+  static constexpr uint8_t MAX_BLOCKS = 16;
+
+  struct Block {
+    const char* name;
+    uint32_t bytes;
+  };
+
+  // Reserves the arena; false when the heap cannot provide it.
+  bool begin(size_t bytes);
+  // Drops every block.  Pointers handed out before are no longer valid.
+  void reset();
+
+  // count value-initialized T's, or nullptr when the arena is full.
+  template <typename T>
+  T* take(const char* name, size_t count)
+  {
+    static_assert(std::is_trivially_destructible<T>::value, "arena blocks are never destroyed");
+    static_assert(alignof(T) <= ALIGN, "arena blocks are ALIGN-aligned");
+    T* items = static_cast<T*>(takeBytes(name, count * sizeof(T)));
+    if (items) {
+      for (size_t i = 0; i < count; ++i) new (items + i) T();
+    }
+    return items;
+  }
+
+  // Arena bytes a block of count T's uses, padding included.
+  template <typename T>
+  static constexpr size_t footprint(size_t count)
+  {
+    return (count * sizeof(T) + ALIGN - 1) / ALIGN * ALIGN;
+  }
+
+  size_t capacity() const { return m_capacity; }
+  size_t used() const { return m_used; }
+  size_t available() const { return m_capacity - m_used; }
+  uint8_t blockCount() const { return m_blockCount; }
+  const Block& block(uint8_t index) const { return m_blocks[index]; }
+
+private:
+  void* takeBytes(const char* name, size_t bytes);
+
+  uint8_t* m_base = nullptr;
+  size_t m_capacity = 0;
+  size_t m_used = 0;
+  Block m_blocks[MAX_BLOCKS] = {};
+  uint8_t m_blockCount = 0;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// How one configuration's buffers fit in the memory arena.  The frame buffers
+// (pixels, the transmit copy, the render stage's and those of the features
+// that are on) and the ingest tables are required, as is room for the jitter
+// buffer's minimum queue when it is enabled.  What is left goes first to merge
+// buffers, up to one per universe, then to a deeper jitter queue.  So a small
+// install gets its spare RAM back as queue depth, and a large one can use it
+// for pixels instead.
+struct MemoryPlan {
+  struct Needs {
+    uint16_t leds = 0;
+    uint16_t universes = 0;
+    uint8_t ranges = 1;          // runs the universes are spread over
+    bool transmit = false;       // asynchronous output keeps a copy in flight
+    bool interpolation = false;
+    bool fallbackScene = false;
+    bool jitter = false;
+  };
+
+  Needs needs;
+  size_t capacity = 0;
+  size_t pixelBytes = 0;    // pixels and transmit copy
+  size_t renderBytes = 0;
+  size_t tableBytes = 0;
+  size_t mergeBytes = 0;
+  size_t jitterBytes = 0;
+  uint16_t mergeSlots = 0;
+  uint8_t jitterFrames = 0;  // queue depth; 0 = jitter buffer off
+  bool fits = false;
+
+  size_t totalBytes() const { return pixelBytes + renderBytes + tableBytes + mergeBytes + jitterBytes; }
+
+  static MemoryPlan compute(const Needs& needs, size_t capacity);
+  // Most LEDs (up to ceiling) whose required buffers fit in capacity, with
+  // the universes of ranges outputs of pixelsPerUniverse each; 0 when none do.
+  static uint16_t maxLeds(Needs needs, uint16_t pixelsPerUniverse, uint8_t ranges, size_t capacity,
+                          uint16_t ceiling);
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <FastLED.h>
+#include <stddef.h>
+
+// Run-length coding for pixel buffers (PackBits on whole pixels).  A control
+// byte below 0x80 is followed by c+1 literal pixels; 0x80 and above repeats the
+// next pixel (c-0x80)+2 times.  Solid looks and gradients with flat segments
+// shrink to a few bytes; noise costs one extra byte per 128 pixels.
+namespace PixelCodec {
+
+// Worst-case encoded size for count pixels.
+constexpr size_t maxRleSize(size_t count) { return count * 3 + (count + 127) / 128; }
+
+// Returns the encoded length, or 0 when it would not fit in capacity.
+size_t encodeRle(const CRGB* pixels, size_t count, uint8_t* out, size_t capacity);
+
+// Decodes exactly count pixels; false if the stream is short or overruns.
+bool decodeRle(const uint8_t* in, size_t length, CRGB* pixels, size_t count);
+
+}  // namespace PixelCodec
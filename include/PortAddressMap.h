@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "MemoryArena.h"
+
+// Port-Address (net, sub-net and universe: 15 bits) to slot, in one lookup
+// for any set of universes, contiguous or not.  A directory of the 128 nets
+// points at a page of 256 slots for each net in use; the pages come from the
+// memory arena, so a node that owns a few universes pays for one or two.
+class PortAddressMap {
+public:
+  static constexpr uint16_t NONE = 0xFFFF;
+  static constexpr uint16_t PAGE_SIZE = 256;   // Port-Addresses in one net
+  static constexpr uint8_t NETS = 128;
+
+  // Most pages runs of universes in total can touch: a run of n spans at
+  // most n / PAGE_SIZE + 2 nets.
+  static uint8_t maxPages(uint16_t universes, uint8_t runs);
+  static size_t bytesFor(uint8_t pages) { return MemoryArena::footprint<uint16_t>(static_cast<size_t>(pages) * PAGE_SIZE); }
+
+  PortAddressMap();
+
+  // Empties the map and takes pages from arena; false when it cannot.
+  bool begin(uint8_t pages, MemoryArena& arena);
+  // Maps [first, first + count) to firstSlot, firstSlot + 1, ...  Addresses
+  // already mapped keep their slot.  False when the run needs more pages
+  // than begin() took; what fits is mapped.
+  bool add(uint16_t first, uint16_t count, uint16_t firstSlot);
+  void clear();
+
+  uint16_t slot(uint16_t portAddress) const
+  {
+    if (portAddress >= NETS * PAGE_SIZE) return NONE;
+    const uint8_t page = m_directory[portAddress / PAGE_SIZE];
+    return page == NO_PAGE ? NONE : m_pages[page * PAGE_SIZE + portAddress % PAGE_SIZE];
+  }
+  bool contains(uint16_t portAddress) const { return slot(portAddress) != NONE; }
+  // True when any Port-Address in [first, last] is mapped.  Nets without a
+  // page are skipped whole.
+  bool containsAny(uint16_t first, uint16_t last) const;
+  uint8_t pagesUsed() const { return m_pagesUsed; }
+
+private:
+  static constexpr uint8_t NO_PAGE = 0xFF;
+
+  uint8_t m_directory[NETS];
+  uint16_t* m_pages = nullptr;
+  uint8_t m_pageCount = 0;
+  uint8_t m_pagesUsed = 0;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+#include "FrameIngest.h"
+
+// Caps the strip's current draw by lowering the global brightness.  Each
+// output is a range of pixels with its own supply limit; the estimate uses the
+// channel sums FrameIngest keeps per universe, so the cost at latch grows with
+// the universe count, not the LED count.  The most loaded output sets the one
+// scale factor for the frame.
+class PowerLimiter {
+public:
+  static constexpr uint8_t MAX_OUTPUTS = 4;
+
+  // Per LED at full value (WS2812-class at 5 V, FastLED's power model).
+  static constexpr uint32_t RED_MA   = 16;
+  static constexpr uint32_t GREEN_MA = 11;
+  static constexpr uint32_t BLUE_MA  = 15;
+  static constexpr uint32_t IDLE_MA  = 1;
+
+  struct Output {
+    uint16_t firstLed = 0;
+    uint16_t ledCount = 0;
+    uint32_t limitMa = 0;       // 0 = no limit
+    uint32_t estimatedMa = 0;   // at the configured brightness
+    uint32_t limitedMa = 0;     // at the applied brightness
+  };
+
+  void setOutputCount(uint8_t count);
+  void setOutput(uint8_t index, uint16_t firstLed, uint16_t ledCount, uint32_t limitMa);
+
+  // Estimate from the universe sums of a just-latched frame.
+  void update(const FrameIngest& ingest, uint8_t brightness);
+  // Estimate from pixels not fed by ingest (e.g. a stored scene).
+  void measure(const CRGB* pixels, uint16_t count, uint8_t brightness);
+
+  // Brightness to hand to FastLED for the last estimated frame.
+  uint8_t brightness() const { return m_brightness; }
+  bool limiting() const { return m_limiting; }
+  uint32_t estimatedMa() const;
+  uint32_t limitedMa() const;
+  uint32_t limitedFrames() const { return m_limitedFrames; }
+  uint8_t outputCount() const { return m_outputCount; }
+  const Output& output(uint8_t index) const { return m_outputs[index]; }
+
+private:
+  int8_t outputFor(uint16_t led) const;
+  void apply(const uint32_t* weighted, uint8_t brightness);
+
+  Output m_outputs[MAX_OUTPUTS];
+  uint8_t m_outputCount = 0;
+  uint8_t m_brightness = 255;
+  bool m_limiting = false;
+  uint32_t m_limitedFrames = 0;
+};
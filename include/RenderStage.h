@@ -0,0 +1,155 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+#include "FrameIngest.h"
+#include "MemoryArena.h"
+
+// Sits between FrameIngest and the LED output buffer.  While live data flows
+// unmodified, FrameIngest writes straight into the output buffer and the stage
+// costs one timestamp compare per loop().  During a transition ingest is
+// redirected into a private live buffer and the stage composes the output
+// itself, time-driven from loop() at up to 1000 / FRAME_INTERVAL_MS fps.
+//
+// When a frame latches while the strip is still busy, ingest is parked in the
+// live buffer so the latched frame stays intact until it is shown; further
+// frames latching meanwhile replace it (coalescing, newest wins).
+//
+// With interpolation enabled ingest always lands in the live buffer; each
+// latched frame becomes the target of a linear ramp from the current output,
+// spread over the measured inter-frame interval, so the strip can refresh
+// faster than the source sends.  This adds one source frame of latency.
+//
+// Latched frames whose pixels did not change are not shown again; the strip
+// is refreshed with the held output every keep-alive interval instead, in
+// every mode.  In pass-through the refresh waits while ingest has written part
+// of a different frame into the output buffer, so it never shows a torn frame.
+class RenderStage {
+public:
+  enum class SourceLossPolicy : uint8_t {
+    Hold = 0,     // keep the last look forever
+    FadeOut,      // fade to black over fadeMs
+    Fallback,     // crossfade to the stored scene over fadeMs
+    POLICY_COUNT
+  };
+
+  // Fills up to capacity pixels with the fallback look; returns how many.
+  using FallbackLoader = uint16_t (*)(CRGB* pixels, uint16_t capacity);
+
+  static constexpr uint32_t FRAME_INTERVAL_MS = 20;
+  static constexpr uint32_t RESUME_FADE_MS    = 300;
+  // Slower sources (under ~5 fps) are shown as-is instead of interpolated.
+  static constexpr uint32_t MAX_INTERPOLATE_US = 200000;
+
+  void begin(FrameIngest& ingest);
+  // Takes the stage's buffers for numLeds pixels from arena (the fallback
+  // scene and the interpolation endpoints only when enabled), drops any
+  // transition and returns to pass-through.  False when the arena is short;
+  // the stage then drives no pixels.
+  bool configure(CRGB* output, uint16_t numLeds, MemoryArena& arena);
+  // Arena bytes configure() takes.
+  static size_t bytesFor(uint16_t numLeds, bool interpolation, bool fallbackScene);
+  // The policy's scene buffer is taken by the next configure().
+  void setSourceLoss(SourceLossPolicy policy, uint32_t timeoutMs, uint32_t fadeMs);
+  void setFallbackLoader(FallbackLoader loader) { m_fallbackLoader = loader; }
+  // Takes effect at the next configure().
+  void setInterpolation(bool enabled) { m_interpolate = enabled; }
+  // 0 shows every latched frame, changed or not.
+  void setKeepAlive(uint32_t intervalMs) { m_keepAliveMs = intervalMs; }
+
+  // Freezes whatever the output buffer holds (e.g. the boot scene) until the
+  // first live frame, which then crossfades in over crossfadeMs.
+  void holdOutput(uint32_t crossfadeMs);
+
+  // Call after FrameIngest latched a frame.  showNow tells whether the strip
+  // is free to show it immediately; otherwise the frame is kept until then.
+  // changed is false when no pixel differs from the previous frame.
+  // Returns true when an unshown frame was replaced (coalesced).
+  bool onFrameLatched(bool showNow, bool changed);
+  // Call from a periodic timer: starts the source-loss policy once no frame
+  // has latched for the timeout, whether or not the strip is free.  True when
+  // it did; the fade is then composed by prepareOutput().
+  bool serviceSourceLoss();
+  // Composes the output when there is something new to show (a latched frame,
+  // a transition step or a keep-alive refresh).
+  // False: nothing to show.
+  bool prepareOutput();
+  // Call after the output buffer has been shown.
+  void outputShown();
+
+  // Most recent received pixels (not the composed output).
+  const CRGB* liveFrame() const { return m_ingestTarget; }
+  bool passthrough() const { return m_mode == Mode::Passthrough || m_mode == Mode::Interpolate; }
+  bool interpolation() const { return m_interpolate; }
+  // Smoothed interval between latched frames, the interpolation span.
+  uint32_t frameIntervalUs() const { return m_frameIntervalUs; }
+  bool sourceLost() const { return m_sourceLost; }
+  uint32_t lossCount() const { return m_losses; }
+  // Shows that carried new content (not keep-alive refreshes).
+  uint32_t outputFrame() const { return m_outputFrames; }
+  uint32_t unchangedFrames() const { return m_unchangedFrames; }
+  uint32_t keepAliveCount() const { return m_keepAlives; }
+  uint32_t inputAgeMs() const { return millis() - m_lastLatchMs; }
+
+private:
+  enum class Mode : uint8_t {
+    Passthrough,
+    Frozen,      // output fixed until the next live frame
+    Fade,        // output = blend(m_from, target) over m_fadeMs
+    Interpolate  // output = lerp(m_prev, m_next) over m_frameIntervalUs
+  };
+
+  static size_t interpolationWords(uint16_t numLeds) { return (static_cast<size_t>(numLeds) * sizeof(CRGB) + 3) / 4; }
+  void redirectIngest(CRGB* target);
+  CRGB* passthroughTarget() { return m_interpolate ? m_live : m_output; }
+  void startInterpolation();
+  bool interpolate();
+  void startFade(const CRGB* target, uint32_t durationMs);
+  void beginSourceLoss();
+  void compose(uint8_t amount);
+  bool render(bool force);
+  bool keepAliveDue();
+
+  FrameIngest* m_ingest = nullptr;
+  CRGB* m_output = nullptr;
+  CRGB* m_ingestTarget = nullptr;
+  uint16_t m_numLeds = 0;
+  CRGB* m_from = nullptr;      // look being faded out
+  CRGB* m_live = nullptr;      // ingest target while a transition runs
+  CRGB* m_scene = nullptr;     // fallback look, taken for Fallback only
+  // Interpolation endpoints as words for the lerp kernel; taken only while
+  // interpolation is enabled.
+  uint32_t* m_prev = nullptr;
+  uint32_t* m_next = nullptr;
+  const CRGB* m_fadeTarget = nullptr;   // m_live, m_scene or nullptr (black)
+  Mode m_mode = Mode::Passthrough;
+  uint32_t m_fadeStartMs = 0;
+  uint32_t m_fadeMs = 0;
+  uint32_t m_resumeMs = RESUME_FADE_MS;
+  uint32_t m_lastRenderMs = 0;
+  uint32_t m_lastLatchMs = 0;
+  bool m_outputDirty = false;   // latched frame not shown yet
+  bool m_ingestParked = false;  // pass-through ingest diverted to m_live
+  bool m_refreshing = false;    // pending show is a keep-alive refresh
+
+  uint32_t m_keepAliveMs = 0;
+  uint32_t m_lastShowMs = 0;
+  uint32_t m_outputFrames = 0;
+  uint32_t m_unchangedFrames = 0;
+  uint32_t m_keepAlives = 0;
+
+  bool m_interpolate = false;
+  uint32_t m_lastLatchUs = 0;
+  uint32_t m_frameIntervalUs = 0;
+  uint32_t m_interpStartUs = 0;
+  uint32_t m_interpSpanUs = 0;
+  uint32_t m_interpWeight = 0;  // step last composed
+
+  SourceLossPolicy m_policy = SourceLossPolicy::Hold;
+  uint32_t m_lossTimeoutMs = 0;
+  uint32_t m_lossFadeMs = 0;
+  FallbackLoader m_fallbackLoader = nullptr;
+  bool m_sourceLost = false;
+  uint32_t m_losses = 0;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <esp_partition.h>
+
+// Keeps the boot scene in the dedicated "scene" data partition (see
+// partitions.csv).  The partition is used as a ring of 4 KB slots: every save
+// goes to the next slot with a higher sequence number, so wear is spread over
+// all sectors and a write torn by a power cut leaves the previous scene valid.
+// Frames are stored run-length encoded when that is smaller (PixelCodec).
+class SceneStore {
+public:
+  enum class SaveResult : uint8_t {
+    Saved,
+    Unchanged,
+    Unavailable,
+    TooLarge,
+    Failed
+  };
+
+  static constexpr size_t SLOT_SIZE = 4096;
+
+  // Locates the partition and the newest valid slot.  False when the flash
+  // layout has no "scene" partition (e.g. units updated over OTA only).
+  bool begin();
+  bool available() const { return m_partition != nullptr; }
+
+  // Decodes the newest scene into pixels.  Returns the pixels restored (the
+  // rest of the buffer is left untouched), 0 when nothing valid is stored.
+  uint16_t load(CRGB* pixels, uint16_t capacity);
+  // Writes count pixels to the next slot unless they match the stored scene.
+  SaveResult save(const CRGB* pixels, uint16_t count);
+
+  bool hasScene() const { return m_hasScene; }
+  uint16_t storedPixels() const { return m_storedPixels; }
+  uint32_t storedBytes() const { return m_storedBytes; }
+  uint32_t saveCount() const { return m_saves; }
+
+private:
+  enum Encoding : uint8_t {
+    ENCODING_RAW = 0,
+    ENCODING_RLE = 1
+  };
+
+  struct SlotHeader {
+    uint32_t magic;
+    uint32_t sequence;
+    uint16_t pixelCount;
+    uint8_t  encoding;
+    uint8_t  reserved;
+    uint32_t payloadLength;
+    uint32_t payloadCrc;
+    uint32_t frameCrc;     // CRC of the decoded pixels, to skip identical saves
+    uint32_t headerCrc;    // covers every field above; written last
+  };
+  static constexpr uint32_t MAGIC = 0x31535850;  // "PXS1"
+
+  bool readHeader(size_t slot, SlotHeader& header) const;
+
+  const esp_partition_t* m_partition = nullptr;
+  size_t m_slotCount = 0;
+  bool m_hasScene = false;
+  size_t m_currentSlot = 0;
+  uint32_t m_sequence = 0;
+  uint32_t m_storedFrameCrc = 0;
+  uint16_t m_storedPixels = 0;
+  uint32_t m_storedBytes = 0;
+  uint32_t m_saves = 0;
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <FastLED.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "PixelCodec.h"
+
+// Compact, streamable format for a recorded frame stream (".pxr").  A file is
+// a FileHeader followed by records, each a RecordHeader and its payload:
+//
+//   Key    PixelCodec RLE of the whole frame.
+//   Delta  previous frame XOR this frame as byte runs: a control byte below
+//          0x80 skips c+1 unchanged bytes, 0x80 and above is followed by
+//          (c-0x80)+1 XOR bytes.  Bytes past the end of the payload are
+//          unchanged, so a repeated frame costs just the record header.
+//
+// Deltas are applied in place to the previous frame, so a player needs one
+// frame and one record of RAM regardless of the show's length.  The encoder
+// writes a key every keyInterval frames and whenever a delta would exceed the
+// worst-case key size.
+namespace ShowCodec {
+
+constexpr uint32_t MAGIC = 0x31525850;   // "PXR1"
+constexpr uint8_t VERSION = 1;
+
+enum class RecordType : uint8_t {
+  Key = 1,
+  Delta = 2,
+};
+
+struct __attribute__((packed)) FileHeader {
+  uint32_t magic;
+  uint8_t  version;
+  uint8_t  reserved;
+  uint16_t pixelCount;
+  uint16_t keyInterval;
+  uint16_t reserved2;
+  uint32_t frameCount;    // 0 if the recording was not closed cleanly
+  uint32_t durationMs;
+};
+
+struct __attribute__((packed)) RecordHeader {
+  uint8_t  type;
+  uint8_t  reserved;
+  uint16_t dtMs;          // time since the previous record
+  uint16_t length;        // payload bytes
+};
+
+// Largest pixel count whose worst-case record length fits RecordHeader::length.
+constexpr uint16_t MAX_PIXELS = 21000;
+
+constexpr size_t maxPayload(size_t pixels) { return PixelCodec::maxRleSize(pixels); }
+constexpr size_t maxRecordSize(size_t pixels) { return sizeof(RecordHeader) + maxPayload(pixels); }
+
+bool validHeader(const FileHeader& header);
+
+class Encoder {
+public:
+  bool begin(uint16_t pixelCount, uint16_t keyInterval);
+  FileHeader header(uint32_t frameCount, uint32_t durationMs) const;
+
+  // Writes one record (header and payload) for frame into out, which must hold
+  // maxRecordSize(pixelCount) bytes.  Returns the record length, 0 on error.
+  size_t encode(const CRGB* frame, uint16_t dtMs, uint8_t* out, size_t capacity);
+
+  uint32_t keyFrames() const { return m_keyFrames; }
+  uint32_t deltaFrames() const { return m_deltaFrames; }
+
+private:
+  std::vector<CRGB> m_prev;
+  uint16_t m_pixelCount = 0;
+  uint16_t m_keyInterval = 0;
+  uint16_t m_sinceKey = 0;
+  bool m_havePrev = false;
+  uint32_t m_keyFrames = 0;
+  uint32_t m_deltaFrames = 0;
+};
+
+class Decoder {
+public:
+  bool begin(const FileHeader& header);
+  // Turns frame (the previously decoded frame) into the record's frame.
+  // Deltas before the first key fail.
+  bool apply(const RecordHeader& record, const uint8_t* payload, CRGB* frame);
+  void rewind() { m_haveKey = false; }
+
+  uint16_t pixelCount() const { return m_pixelCount; }
+
+private:
+  uint16_t m_pixelCount = 0;
+  bool m_haveKey = false;
+};
+
+}  // namespace ShowCodec
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <FS.h>
+#include <vector>
+
+#include "LogRing.h"
+#include "ShowCodec.h"
+
+// Records the latched frame stream to a single show file on LittleFS (the
+// "spiffs" data partition) and plays it back at the recorded timing.  Playback
+// reads one record ahead into a fixed buffer and patches one frame in place, so
+// RAM use depends on the pixel count only, never on the show's length.
+//
+// Playback follows a show clock that can run slightly fast or slow (setRate)
+// and can be repositioned (seek) so an external timecode can drive it.  Seeks
+// start from the nearest earlier key frame, found in a small index of key
+// records.  The index is collected while recording and stored next to the
+// show; for a show without one (recorded by older firmware, or not closed
+// cleanly) playback scans a few record headers per call until it is complete,
+// and seeks past the scanned part fail until then.
+class ShowRecorder {
+public:
+  enum class State : uint8_t {
+    Idle,
+    Recording,
+    Playing
+  };
+
+  static constexpr uint16_t KEY_INTERVAL = 100;
+  // Recording stops when less than this is left on the filesystem.
+  static constexpr uint32_t FREE_MARGIN = 16384;
+  // Seek points kept per show; the spacing doubles as the show grows.
+  static constexpr uint8_t MAX_SEEK_POINTS = 64;
+
+  // Mounts LittleFS without formatting; reads the stored show's header.
+  bool begin();
+  bool available() const { return m_mounted; }
+  // Where recording messages go; none are written without one.
+  void setLog(LogRing* log) { m_log = log; }
+
+  // Formats the filesystem first if it never mounted.
+  bool startRecording(uint16_t pixelCount);
+  // Call for every latched frame.  Unchanged frames are not stored; their
+  // time is carried by the next record.
+  void recordFrame(const CRGB* frame, bool changed);
+
+  bool startPlayback(bool loop);
+  // Call from loop(); true when frame() holds the next frame to show.
+  bool servicePlayback();
+  // Decodes the frame due at showMs and continues from there.  Playing only;
+  // false while the index does not reach showMs yet.
+  bool seek(uint32_t showMs);
+  // Show clock speed in 1/1000 (1000 = recorded speed).
+  void setRate(uint16_t permille);
+  uint16_t rate() const { return m_rate; }
+  uint32_t positionMs() const;
+
+  void stop();
+  bool remove();
+
+  State state() const { return m_state; }
+  const CRGB* frame() const { return m_frame.data(); }
+  uint16_t pixelCount() const { return m_pixelCount; }
+
+  // Stored show (or the one being recorded).
+  bool hasShow() const { return m_hasShow; }
+  uint32_t showFrames() const { return m_frames; }
+  uint32_t showDurationMs() const { return m_durationMs; }
+  uint32_t showBytes() const { return m_bytes; }
+  uint32_t playedFrames() const { return m_played; }
+  uint32_t loops() const { return m_loops; }
+  const char* lastError() const { return m_error; }
+
+private:
+  struct SeekPoint {
+    uint32_t offset;   // file offset of a key record
+    uint32_t baseMs;   // show time of the record before it
+  };
+
+  bool readHeader(File& file, ShowCodec::FileHeader& header);
+  void clearSeekIndex();
+  void addSeekPoint(uint32_t offset, uint32_t baseMs);
+  void saveSeekIndex();
+  bool loadSeekIndex();
+  void scanSeekIndex();
+  bool readRecord();
+  void finishRecording();
+  void fail(const char* error);
+
+  File m_file;
+  State m_state = State::Idle;
+  bool m_mounted = false;
+  bool m_hasShow = false;
+  bool m_loop = false;
+  const char* m_error = "";
+  LogRing* m_log = nullptr;
+
+  ShowCodec::Encoder m_encoder;
+  ShowCodec::Decoder m_decoder;
+  std::vector<uint8_t> m_record;   // one record: header + payload
+  std::vector<CRGB> m_frame;       // playback frame, patched in place
+  uint16_t m_pixelCount = 0;
+
+  uint32_t m_frames = 0;
+  uint32_t m_durationMs = 0;
+  uint32_t m_bytes = 0;
+  uint32_t m_budget = 0;
+  uint32_t m_lastRecordMs = 0;
+
+  // Show clock: position = m_baseShowMs + (millis() - m_baseLocalMs) * rate.
+  uint32_t m_baseShowMs = 0;
+  uint32_t m_baseLocalMs = 0;
+  uint16_t m_rate = 1000;
+  uint32_t m_recordMs = 0;      // show time of the record read ahead
+  uint16_t m_lastDtMs = 0;
+  uint32_t m_played = 0;
+  uint32_t m_loops = 0;
+
+  SeekPoint m_seekPoints[MAX_SEEK_POINTS];
+  uint8_t m_seekPointCount = 0;
+  uint16_t m_seekStride = 1;    // key records per seek point
+  uint32_t m_seekKeys = 0;      // key records seen
+  bool m_seekIndexBuilt = false;
+  // Scan of a show without a stored index: next record header and its time.
+  uint32_t m_scanOffset = 0;
+  uint32_t m_scanMs = 0;
+};
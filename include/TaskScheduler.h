@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Cooperative scheduler for loop().  Each task is declared once with a
+// priority (0 is the most urgent), a period (0 = every pass) and a time
+// budget.  A pass runs the priority-0 tasks, then every other task that is
+// due, in priority order, and runs the priority-0 tasks again before each of
+// them: a packet never waits for more than one task's run, however many are
+// due.  Nothing is pre-empted; a task that takes longer than its budget is
+// counted as an overrun.
+//
+// Times come from micros(), so a host tool that drives the clock by hand
+// (HostNet::useManualClock) sees the same schedule as the ESP32.
+class TaskScheduler {
+public:
+  using TaskFn = void (*)();
+
+  static constexpr uint8_t MAX_TASKS = 8;
+  // CPU shares are measured over windows of this length.
+  static constexpr uint32_t WINDOW_US = 1000000;
+
+  struct Stats {
+    uint32_t runs = 0;
+    uint32_t overruns = 0;       // runs longer than the budget
+    uint32_t lastRunUs = 0;
+    uint32_t maxRunUs = 0;
+    // Time from due to start.  A task with no period is due again when its
+    // last run ends, so this is the longest it went without running.
+    uint32_t maxLatencyUs = 0;
+    uint16_t cpuPermille = 0;    // of the last complete window
+  };
+
+  // False when the table is full.  Tasks of the same priority keep the order
+  // they were added in; the table is sorted, so indexes change as tasks are
+  // added.
+  bool add(const char* name, TaskFn fn, uint8_t priority, uint32_t periodUs, uint32_t budgetUs);
+
+  // One pass; call from loop().
+  void runPass();
+
+  uint8_t taskCount() const { return m_count; }
+  const char* name(uint8_t index) const { return m_tasks[index].name; }
+  uint8_t priority(uint8_t index) const { return m_tasks[index].priority; }
+  uint32_t periodUs(uint8_t index) const { return m_tasks[index].periodUs; }
+  uint32_t budgetUs(uint8_t index) const { return m_tasks[index].budgetUs; }
+  const Stats& stats(uint8_t index) const { return m_tasks[index].stats; }
+
+  uint32_t passes() const { return m_passes; }
+  // Share of the last window spent outside every task (scheduling, idle).
+  uint16_t idlePermille() const { return m_idlePermille; }
+  // Clears the counters and maxima, not the schedule.
+  void resetStats();
+
+private:
+  struct Task {
+    const char* name = "";
+    TaskFn fn = nullptr;
+    uint8_t priority = 0;
+    uint32_t periodUs = 0;
+    uint32_t budgetUs = 0;
+    uint32_t dueUs = 0;
+    bool started = false;
+    uint32_t windowUs = 0;       // run time in the current window
+    Stats stats;
+  };
+
+  bool due(const Task& task, uint32_t nowUs) const;
+  void run(Task& task);
+  void runUrgent();
+  void closeWindow(uint32_t nowUs);
+
+  Task m_tasks[MAX_TASKS];
+  uint8_t m_count = 0;
+  uint8_t m_urgentCount = 0;     // tasks of priority 0, first in the table
+  uint32_t m_passes = 0;
+  uint32_t m_windowStartUs = 0;
+  bool m_windowStarted = false;
+  uint16_t m_idlePermille = 1000;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "ShowRecorder.h"
+
+// Slaves show playback to incoming ArtTimeCode.  The stored show is one cue
+// that starts at a configured timecode: while the clock is inside the show it
+// plays, seeking on large jumps and nudging the playback rate to absorb
+// drift.  Short timecode dropouts are bridged by free-wheeling on the local
+// clock; a longer silence stops playback and holds the last frame.
+class TimecodeSync {
+public:
+  static constexpr uint32_t FREEWHEEL_MS = 2000;
+  // Larger errors seek, smaller ones are chased by the rate.
+  static constexpr uint32_t SEEK_THRESHOLD_MS = 200;
+  // Largest rate correction in 1/1000 (5%).
+  static constexpr int32_t MAX_RATE_ADJUST = 50;
+
+  void setEnabled(bool enabled);
+  void setStartMs(uint32_t startMs) { m_startMs = startMs; }
+  bool enabled() const { return m_enabled; }
+
+  void onTimeCode(uint32_t timecodeMs, uint32_t nowMs);
+  // Call from loop(); true when it moved playback, so recorder.frame() has
+  // to be shown right away.
+  bool service(ShowRecorder& recorder, uint32_t nowMs);
+
+  bool locked() const { return m_locked; }
+  bool freewheeling() const { return m_freewheel; }
+  uint32_t timecodeMs() const { return m_timecodeMs; }
+  int32_t errorMs() const { return m_errorMs; }
+  uint16_t rate() const { return m_rate; }
+  uint32_t received() const { return m_received; }
+  uint32_t seeks() const { return m_seeks; }
+  uint32_t dropouts() const { return m_dropouts; }
+
+private:
+  bool m_enabled = false;
+  uint32_t m_startMs = 0;
+
+  bool m_hasTimecode = false;
+  uint32_t m_rxTimecodeMs = 0;  // last received value
+  uint32_t m_rxLocalMs = 0;     // millis() when it arrived
+
+  bool m_locked = false;        // playback is following the clock
+  bool m_freewheel = false;
+  uint32_t m_timecodeMs = 0;
+  int32_t m_errorMs = 0;
+  uint16_t m_rate = 1000;
+  uint32_t m_received = 0;
+  uint32_t m_seeks = 0;
+  uint32_t m_dropouts = 0;
+};
@@ -10,7 +10,26 @@ namespace {
 constexpr char kArtNetId[] = "Art-Net";
 constexpr uint16_t kOpPoll = 0x2000;
 constexpr uint16_t kOpDmx = 0x5000;
+constexpr uint16_t kOpSync = 0x5200;
 constexpr uint16_t kOpPollReply = 0x2100;
+constexpr uint16_t kOpTimeCode = 0x9700;
+constexpr uint16_t kOpAddress = 0x6000;
+constexpr uint16_t kOpIpProg = 0xF800;
+constexpr uint16_t kOpIpProgReply = 0xF900;
+constexpr uint16_t kOpDiagData = 0x2300;
+constexpr uint8_t kProtocolVersion = 14;
+// ArtPoll Flags.
+constexpr uint8_t kPollReplyOnChange = 0x02;
+constexpr uint8_t kPollDiagnostics = 0x04;
+constexpr uint8_t kPollDiagUnicast = 0x08;
+constexpr uint8_t kPollTargeted = 0x20;
+constexpr int kPollTargetedLength = 18;   // through TargetPortAddressBottom
+constexpr int kDmxHeaderLength = 18;      // through Length; also read first for any packet
+constexpr size_t kDiagHeaderLength = 18;
+constexpr size_t kDiagMaxText = 512;      // terminator included
+constexpr int kAddressLength = 107;   // through Command
+constexpr int kIpProgLength = 24;     // through ProgSm; older senders stop before ProgDg
+constexpr int kIpProgGatewayLength = 30;
 
 struct __attribute__((packed)) ArtPollReplyPacket {
   char id[8];
@@ -47,6 +66,65 @@ struct __attribute__((packed)) ArtPollReplyPacket {
   uint8_t filler[26];
 };
 
+struct __attribute__((packed)) ArtIpProgReplyPacket {
+  char id[8];
+  uint16_t opCode;
+  uint8_t protVerHi;
+  uint8_t protVerLo;
+  uint8_t filler[4];
+  uint8_t ip[4];
+  uint8_t mask[4];
+  uint8_t portHi;
+  uint8_t portLo;
+  uint8_t status;
+  uint8_t spare1;
+  uint8_t gateway[4];
+  uint8_t spare2[2];
+};
+static_assert(sizeof(ArtIpProgReplyPacket) == 34, "ArtIpProgReply is 34 bytes");
+
+// ArtAddress switch: bit 7 programs the low bits, 0x00 resets, the rest
+// (0x7F by convention) leaves it alone.
+int16_t decodeSwitch(uint8_t value, uint8_t mask)
+{
+  if (value & 0x80) return value & mask;
+  if (value == 0) return ArtNetNode::AddressProgram::RESET;
+  return ArtNetNode::AddressProgram::UNCHANGED;
+}
+
+String decodeName(const uint8_t* field, size_t size)
+{
+  char name[65];
+  const size_t length = strnlen(reinterpret_cast<const char*>(field), std::min(size, sizeof(name) - 1));
+  memcpy(name, field, length);
+  name[length] = '\0';
+  return String(name);
+}
+
+IPAddress decodeIp(const uint8_t* field)
+{
+  return IPAddress(field[0], field[1], field[2], field[3]);
+}
+
+void encodeIp(const IPAddress& ip, uint8_t* field)
+{
+  for (uint8_t i = 0; i < 4; ++i) field[i] = ip[i];
+}
+
+// The soft AP keeps the Arduino default network, 192.168.4.1/24.
+const IPAddress kSoftApMask(255, 255, 255, 0);
+
+bool sameSubnet(IPAddress a, IPAddress b, IPAddress mask)
+{
+  return ((static_cast<uint32_t>(a) ^ static_cast<uint32_t>(b)) & static_cast<uint32_t>(mask)) == 0;
+}
+
+// Directed broadcast of ip's network; 255.255.255.255 when the mask is unknown.
+IPAddress broadcastOf(IPAddress ip, IPAddress mask)
+{
+  return IPAddress(static_cast<uint32_t>(ip) | ~static_cast<uint32_t>(mask));
+}
+
 uint8_t clampPortCount(uint16_t value) {
   if (value == 0) return 1;
   if (value > 4) return 4;
@@ -55,11 +133,30 @@ uint8_t clampPortCount(uint16_t value) {
 
 }  // namespace
 
+uint32_t ArtNetNode::TimeCode::toMs() const
+{
+  const uint32_t wholeSeconds = (static_cast<uint32_t>(hours) * 60 + minutes) * 60 + seconds;
+  switch (type) {
+    case 0: return wholeSeconds * 1000 + frames * 1000UL / 24;
+    case 1: return wholeSeconds * 1000 + frames * 1000UL / 25;
+    case 2: {
+      // Drop-frame: labels ;00 and ;01 are skipped every minute but each tenth.
+      const uint32_t totalMinutes = static_cast<uint32_t>(hours) * 60 + minutes;
+      const uint32_t frameNumber = wholeSeconds * 30 + frames - 2 * (totalMinutes - totalMinutes / 10);
+      return static_cast<uint32_t>((static_cast<uint64_t>(frameNumber) * 1001) / 30);
+    }
+    default: return wholeSeconds * 1000 + frames * 1000UL / 30;
+  }
+}
+
 void ArtNetNode::begin(uint16_t port)
 {
   m_listenPort = port;
-  m_udp.stop();
-  m_udp.begin(m_listenPort);
+  for (Binding& binding : m_bindings) {
+    binding.udp.stop();
+    binding.bound = false;
+    binding.active = false;
+  }
   updateNetworkInfo();
 }
 
@@ -68,9 +165,17 @@ void ArtNetNode::setArtDmxCallback(ArtDmxCallback callback)
   m_dmxCallback = callback;
 }
 
+void ArtNetNode::setArtSyncCallback(ArtSyncCallback callback)
+{
+  m_syncCallback = callback;
+}
+
 void ArtNetNode::setUniverseInfo(uint16_t startUniverse, uint16_t universeCount)
 {
+  const uint16_t previousStart = m_startUniverse;
+  const uint8_t previousPorts = m_portCount;
   m_startUniverse = startUniverse;
+  m_universeCount = universeCount ? universeCount : 1;
   uint8_t desired = clampPortCount(universeCount);
   if (desired == 0) desired = 1;
 
@@ -89,12 +194,37 @@ void ArtNetNode::setUniverseInfo(uint16_t startUniverse, uint16_t universeCount)
   }
 
   m_portCount = desired;
+  if (m_startUniverse != previousStart || m_portCount != previousPorts) m_stateChanged = true;
+}
+
+void ArtNetNode::setPortMerging(uint8_t port, bool merging)
+{
+  if (port >= 4) return;
+  const uint8_t previous = m_portMergingMask;
+  if (merging) {
+    m_portMergingMask |= static_cast<uint8_t>(1u << port);
+  } else {
+    m_portMergingMask &= static_cast<uint8_t>(~(1u << port));
+  }
+  if (m_portMergingMask != previous) m_stateChanged = true;
+}
+
+void ArtNetNode::setMergeLtp(bool ltp)
+{
+  if (ltp != m_mergeLtp) m_stateChanged = true;
+  m_mergeLtp = ltp;
 }
 
 void ArtNetNode::setNodeNames(const String& shortName, const String& longName)
 {
-  if (shortName.length()) m_shortName = shortName;
-  if (longName.length()) m_longName = longName;
+  if (shortName.length() && shortName != m_shortName) {
+    m_shortName = shortName;
+    m_stateChanged = true;
+  }
+  if (longName.length() && longName != m_longName) {
+    m_longName = longName;
+    m_stateChanged = true;
+  }
 }
 
 void ArtNetNode::updateNetworkInfo()
@@ -108,77 +238,119 @@ void ArtNetNode::setInterfacePreference(InterfacePreference preference)
   refreshLocalInfo();
 }
 
-void ArtNetNode::refreshLocalInfo()
+void ArtNetNode::setLinkUp(Interface iface, bool up)
 {
-  m_activeInterface = ActiveInterface::None;
-
-  auto setWifiActive = [&](const IPAddress& ip) {
-    if (ip == IPAddress((uint32_t)0)) {
-      return ip;
-    }
-
-    if ((WiFi.getMode() & WIFI_AP) != 0 && WiFi.softAPIP() == ip) {
-      m_activeInterface = ActiveInterface::WiFiAccessPoint;
-    } else {
-      m_activeInterface = ActiveInterface::WiFiStation;
-    }
-    return ip;
-  };
+  const uint8_t bit = interfaceBit(iface);
+  const uint8_t linkDown = up ? (m_linkDown & ~bit) : (m_linkDown | bit);
+  if (linkDown == m_linkDown) return;
+  m_linkDown = linkDown;
+  refreshLocalInfo();
+}
 
-  auto pickEthernet = [&]() {
-    IPAddress ip = ETH.localIP();
-    if (ip != IPAddress((uint32_t)0)) {
-      m_activeInterface = ActiveInterface::Ethernet;
-    }
-    return ip;
-  };
+void ArtNetNode::setStandby(bool standby)
+{
+  m_standby = standby;
+  refreshLocalInfo();
+}
 
-  auto pickWifi = [&]() {
-    IPAddress ip = WiFi.localIP();
-    if (ip != IPAddress((uint32_t)0)) {
-      return setWifiActive(ip);
-    }
+void ArtNetNode::setSourceFilters(const SourceFilter* filters, uint8_t count)
+{
+  m_filterCount = std::min<uint8_t>(count, MAX_SOURCE_FILTERS);
+  m_syncInterfaces = m_filterCount ? 0 : ANY_INTERFACE;
+  for (uint8_t i = 0; i < m_filterCount; ++i) {
+    m_filters[i] = filters[i];
+    m_syncInterfaces |= filters[i].interfaces;
+  }
+}
 
-    ip = WiFi.softAPIP();
-    return setWifiActive(ip);
-  };
+void ArtNetNode::setUniverseFilter(const PortAddressMap* owned)
+{
+  m_ownedUniverses = owned;
+}
 
-  IPAddress current((uint32_t)0);
+void ArtNetNode::refreshLocalInfo()
+{
+  const IPAddress none((uint32_t)0);
+  const bool apUp = (WiFi.getMode() & WIFI_AP) != 0;
+  IPAddress ips[INTERFACE_COUNT] = {ETH.localIP(), WiFi.localIP(), apUp ? WiFi.softAPIP() : none};
+  for (uint8_t i = 0; i < INTERFACE_COUNT; ++i) {
+    if (m_linkDown & (1u << i)) ips[i] = none;
+  }
+  const bool ethernetUp = ips[0] != none;
+  const bool wifiUp = ips[1] != none || ips[2] != none;
 
-  switch (m_interfacePreference) {
-    case InterfacePreference::WiFi:
-      current = pickWifi();
-      if (current == IPAddress((uint32_t)0)) {
-        current = pickEthernet();
-      }
-      break;
-    case InterfacePreference::Auto:
-      current = pickEthernet();
-      if (current == IPAddress((uint32_t)0)) {
-        current = pickWifi();
-      }
-      break;
-    case InterfacePreference::Ethernet:
-    default:
-      current = pickEthernet();
-      if (current == IPAddress((uint32_t)0)) {
-        current = pickWifi();
+  bool wanted[INTERFACE_COUNT];
+  bool standby[INTERFACE_COUNT] = {};
+  for (uint8_t i = 0; i < INTERFACE_COUNT; ++i) {
+    wanted[i] = ips[i] != none;
+  }
+  if (m_interfacePreference == InterfacePreference::Ethernet && ethernetUp) {
+    standby[1] = m_standby && wanted[1];
+    standby[2] = m_standby && wanted[2];
+    wanted[1] = wanted[2] = false;
+  } else if (m_interfacePreference == InterfacePreference::WiFi && wifiUp) {
+    wanted[0] = false;
+  }
+  // Until some interface has an address, one socket listens on all of them.
+  const bool anyAddress = !ethernetUp && !wifiUp;
+
+  static constexpr esp_mac_type_t kMacTypes[INTERFACE_COUNT] = {ESP_MAC_ETH, ESP_MAC_WIFI_STA, ESP_MAC_WIFI_SOFTAP};
+  uint8_t started = 0;
+  m_localIp = none;
+  for (uint8_t i = 0; i < INTERFACE_COUNT; ++i) {
+    Binding& binding = m_bindings[i];
+    const bool bind = wanted[i] || standby[i] || (anyAddress && i == 0);
+    const IPAddress ip = (wanted[i] || standby[i]) ? ips[i] : none;
+    if (bind != binding.bound || ip != binding.ip) {
+      binding.udp.stop();
+      binding.bound = bind && binding.udp.begin(ip, m_listenPort);
+      binding.ip = ip;
+      binding.mask = i == 0 ? ETH.subnetMask() : i == 1 ? WiFi.subnetMask() : kSoftApMask;
+      if (esp_read_mac(binding.mac.data(), kMacTypes[i]) != ESP_OK) {
+        std::fill(binding.mac.begin(), binding.mac.end(), 0);
       }
-      break;
+    }
+    const bool active = binding.bound && !standby[i];
+    if (active && !binding.active && binding.ip != none) started |= static_cast<uint8_t>(1u << i);
+    binding.active = active;
   }
 
-  m_localIp = current;
+  // Preference order: the one asked for, then the other.
+  static constexpr uint8_t kEthernetFirst[INTERFACE_COUNT] = {0, 1, 2};
+  static constexpr uint8_t kWifiFirst[INTERFACE_COUNT] = {1, 2, 0};
+  const uint8_t* order = m_interfacePreference == InterfacePreference::WiFi ? kWifiFirst : kEthernetFirst;
+  for (uint8_t i = 0; i < INTERFACE_COUNT && m_localIp == none; ++i) {
+    if (m_bindings[order[i]].active) m_localIp = m_bindings[order[i]].ip;
+  }
 
-  esp_mac_type_t macType = ESP_MAC_ETH;
-  if (m_activeInterface == ActiveInterface::WiFiAccessPoint) {
-    macType = ESP_MAC_WIFI_SOFTAP;
-  } else if (m_activeInterface == ActiveInterface::WiFiStation) {
-    macType = ESP_MAC_WIFI_STA;
+  for (uint8_t i = 0; i < INTERFACE_COUNT; ++i) {
+    if (started & (1u << i)) announce(i);
   }
+}
 
-  if (esp_read_mac(m_mac.data(), macType) != ESP_OK) {
-    std::fill(m_mac.begin(), m_mac.end(), 0);
+void ArtNetNode::announce(uint8_t index)
+{
+  // ArtPollReply is never broadcast: the announcement goes by unicast to the
+  // controllers that polled through this interface or sit on its network.
+  const Binding& binding = m_bindings[index];
+  const uint8_t current = m_current;
+  m_current = index;
+  for (size_t i = 0; i < m_controllers.size(); ++i) {
+    const Controller& controller = m_controllers[i];
+    if (!controller.used ||
+        (controller.binding != index && !sameSubnet(controller.ip, binding.ip, binding.mask))) {
+      continue;
+    }
+    // A controller polling through two interfaces gets one reply.
+    bool repeated = false;
+    for (size_t j = 0; j < i && !repeated; ++j) {
+      repeated = m_controllers[j].used && m_controllers[j].ip == controller.ip;
+    }
+    if (repeated) continue;
+    sendPollReply(controller.ip, controller.port ? controller.port : ARTNET_PORT);
+    m_announcements++;
   }
+  m_current = current;
 }
 
 void ArtNetNode::copyStringToField(const String& source, char* destination, size_t maxLength)
@@ -192,21 +364,19 @@ void ArtNetNode::copyStringToField(const String& source, char* destination, size
 
 void ArtNetNode::sendPollReply(IPAddress remoteIP, uint16_t remotePort)
 {
-  if (m_localIp == IPAddress((uint32_t)0)) {
-    refreshLocalInfo();
-  }
-
   if (remoteIP == IPAddress((uint32_t)0)) {
     return;
   }
 
+  // Sent from the interface the request came in on, as that interface.
+  Binding& binding = m_bindings[m_current];
   ArtPollReplyPacket reply{};
   memcpy(reply.id, kArtNetId, sizeof(reply.id));
   reply.id[7] = '\0';
   reply.opCode = kOpPollReply;
   for (uint8_t i = 0; i < 4; ++i) {
-    reply.ip[i] = m_localIp[i];
-    reply.bindIp[i] = m_localIp[i];
+    reply.ip[i] = binding.ip[i];
+    reply.bindIp[i] = binding.ip[i];
   }
   reply.port = ARTNET_PORT;
   reply.versInfoH = 1;
@@ -226,7 +396,14 @@ void ArtNetNode::sendPollReply(IPAddress remoteIP, uint16_t remotePort)
   for (uint8_t i = 0; i < 4; ++i) {
     reply.portTypes[i] = (i < m_portCount) ? 0x80 : 0x00;
     reply.goodInput[i] = 0x00;
-    reply.goodOutput[i] = (i < m_portCount) ? 0x80 : 0x00;
+    if (i < m_portCount) {
+      // 0x80 data transmitted, 0x08 merging Art-Net sources, 0x02 merge mode LTP.
+      reply.goodOutput[i] = 0x80;
+      if (m_portMergingMask & (1u << i)) reply.goodOutput[i] |= 0x08;
+      if (m_mergeLtp) reply.goodOutput[i] |= 0x02;
+    } else {
+      reply.goodOutput[i] = 0x00;
+    }
     reply.swIn[i] = 0x00;
     reply.swOut[i] = (i < m_portCount) ? static_cast<uint8_t>((m_startUniverse + i) & 0x0F) : 0x00;
   }
@@ -236,96 +413,390 @@ void ArtNetNode::sendPollReply(IPAddress remoteIP, uint16_t remotePort)
   reply.swRemote = 0;
   memset(reply.spare, 0, sizeof(reply.spare));
   reply.style = 0x00;
-  std::copy(m_mac.begin(), m_mac.end(), reply.mac);
+  std::copy(binding.mac.begin(), binding.mac.end(), reply.mac);
+  // Every address is a root device of its own: its ports are all on it.
   reply.bindIndex = 1;
   reply.status2 = 0x00;
   memset(reply.filler, 0, sizeof(reply.filler));
 
-  m_udp.beginPacket(remoteIP, remotePort ? remotePort : ARTNET_PORT);
-  m_udp.write(reinterpret_cast<uint8_t*>(&reply), sizeof(reply));
-  m_udp.endPacket();
+  binding.udp.beginPacket(remoteIP, remotePort ? remotePort : ARTNET_PORT);
+  binding.udp.write(reinterpret_cast<uint8_t*>(&reply), sizeof(reply));
+  binding.udp.endPacket();
+
+  if (m_firstPollReplyMs == 0) {
+    m_firstPollReplyMs = std::max<uint32_t>(1, millis());
+  }
 }
 
-void ArtNetNode::read()
+bool ArtNetNode::servesPortAddress(uint16_t bottom, uint16_t top) const
 {
-  refreshLocalInfo();
+  // Outputs patched apart own separate runs; the map knows them all.
+  if (m_ownedUniverses) {
+    return m_ownedUniverses->containsAny(bottom, top);
+  }
+  const uint32_t last = static_cast<uint32_t>(m_startUniverse) + m_universeCount - 1;
+  return m_startUniverse <= top && last >= bottom;
+}
 
-  int packetSize = m_udp.parsePacket();
-  if (packetSize <= 0) {
+ArtNetNode::Controller* ArtNetNode::controllerFor(IPAddress remoteIP, uint8_t index, uint32_t now)
+{
+  Controller* spare = nullptr;
+  for (Controller& controller : m_controllers) {
+    if (controller.used && controller.ip == remoteIP && controller.binding == index) {
+      return &controller;
+    }
+    const bool expired = controller.used && !controller.replyPending &&
+                         now - controller.lastPollMs > CONTROLLER_TIMEOUT_MS;
+    if (!spare && (!controller.used || expired)) spare = &controller;
+  }
+  if (spare) {
+    *spare = Controller();
+    spare->ip = remoteIP;
+    spare->binding = index;
+    spare->used = true;
+  }
+  return spare;
+}
+
+void ArtNetNode::handlePoll(int len, IPAddress remoteIP, uint16_t remotePort)
+{
+  m_pollStats.polls++;
+  // Polls older than Art-Net 4 stop after Flags and DiagPriority.
+  const uint8_t flags = len > 12 ? m_buffer[12] : 0;
+  if ((flags & kPollTargeted) && len >= kPollTargetedLength) {
+    const uint16_t top = static_cast<uint16_t>((m_buffer[14] << 8) | m_buffer[15]);
+    const uint16_t bottom = static_cast<uint16_t>((m_buffer[16] << 8) | m_buffer[17]);
+    if (!servesPortAddress(bottom, top)) {
+      m_pollStats.untargeted++;
+      return;
+    }
+  }
+
+  const uint32_t now = millis();
+  Controller* controller = controllerFor(remoteIP, m_current, now);
+  if (!controller) {
+    // Too many controllers to remember: answer now, keep nothing.
+    sendPollReply(remoteIP, remotePort);
+    m_pollStats.replies++;
+    return;
+  }
+  controller->port = remotePort;
+  controller->flags = flags;
+  controller->diagPriority = len > 13 ? m_buffer[13] : 0;
+  controller->lastPollMs = now;
+  if (controller->replyPending) {
+    m_pollStats.coalesced++;
     return;
   }
+  controller->replyPending = true;
+  controller->replyDueMs = now + (m_pollReplyWindowMs ? esp_random() % (m_pollReplyWindowMs + 1u) : 0);
+}
 
-  IPAddress packetLocal = m_localIp;
-  bool dropPacket = false;
+void ArtNetNode::sendReplyTo(const Controller& controller)
+{
+  if (!m_bindings[controller.binding].active) return;
+  const uint8_t current = m_current;
+  m_current = controller.binding;
+  sendPollReply(controller.ip, controller.port);
+  m_current = current;
+}
 
-  if (packetLocal != IPAddress((uint32_t)0)) {
-    switch (m_activeInterface) {
-      case ActiveInterface::Ethernet: {
-        IPAddress ethernetIp = ETH.localIP();
-        dropPacket = ethernetIp != IPAddress((uint32_t)0) && packetLocal != ethernetIp;
-        break;
-      }
-      case ActiveInterface::WiFiStation: {
-        IPAddress wifiIp = WiFi.localIP();
-        dropPacket = wifiIp != IPAddress((uint32_t)0) && packetLocal != wifiIp;
-        break;
-      }
-      case ActiveInterface::WiFiAccessPoint: {
-        IPAddress apIp = WiFi.softAPIP();
-        dropPacket = apIp != IPAddress((uint32_t)0) && packetLocal != apIp;
-        break;
-      }
-      case ActiveInterface::None:
-      default:
-        break;
+void ArtNetNode::servicePollReplies()
+{
+  const uint32_t now = millis();
+  const bool changed = m_stateChanged;
+  m_stateChanged = false;
+  for (Controller& controller : m_controllers) {
+    if (!controller.used) continue;
+    // A pending reply already carries the change.
+    if (changed && (controller.flags & kPollReplyOnChange) && !controller.replyPending) {
+      sendReplyTo(controller);
+      m_pollStats.changeReplies++;
+    }
+    if (controller.replyPending && static_cast<int32_t>(now - controller.replyDueMs) >= 0) {
+      controller.replyPending = false;
+      sendReplyTo(controller);
+      m_pollStats.replies++;
+    } else if (!controller.replyPending && now - controller.lastPollMs > CONTROLLER_TIMEOUT_MS) {
+      controller.used = false;
     }
   }
+}
+
+uint8_t ArtNetNode::controllerCount() const
+{
+  uint8_t count = 0;
+  for (const Controller& controller : m_controllers) {
+    if (controller.used) ++count;
+  }
+  return count;
+}
 
-  if (dropPacket) {
-    while (m_udp.available()) {
-      m_udp.read();
+void ArtNetNode::sendDiagnostic(DiagPriority priority, const char* text)
+{
+  uint8_t packet[kDiagHeaderLength + kDiagMaxText];
+  const size_t length = strnlen(text, kDiagMaxText - 1) + 1;
+  memcpy(packet, kArtNetId, 8);
+  packet[8] = kOpDiagData & 0xFF;
+  packet[9] = kOpDiagData >> 8;
+  packet[10] = 0;
+  packet[11] = kProtocolVersion;
+  packet[12] = 0;
+  packet[13] = static_cast<uint8_t>(priority);
+  packet[14] = 0;   // LogicalPort: the node as a whole
+  packet[15] = 0;
+  packet[16] = static_cast<uint8_t>(length >> 8);
+  packet[17] = static_cast<uint8_t>(length & 0xFF);
+  memcpy(packet + kDiagHeaderLength, text, length - 1);
+  packet[kDiagHeaderLength + length - 1] = '\0';
+
+  // One broadcast per interface covers every controller that asked for it.
+  uint8_t broadcastSent = 0;
+  for (const Controller& controller : m_controllers) {
+    if (!controller.used || !(controller.flags & kPollDiagnostics) ||
+        static_cast<uint8_t>(priority) < controller.diagPriority) {
+      continue;
     }
+    Binding& binding = m_bindings[controller.binding];
+    if (!binding.active) continue;
+    IPAddress destination = controller.ip;
+    uint16_t port = controller.port ? controller.port : ARTNET_PORT;
+    if (!(controller.flags & kPollDiagUnicast)) {
+      if (broadcastSent & (1u << controller.binding)) continue;
+      broadcastSent |= static_cast<uint8_t>(1u << controller.binding);
+      destination = broadcastOf(binding.ip, binding.mask);
+      port = ARTNET_PORT;
+    }
+    binding.udp.beginPacket(destination, port);
+    binding.udp.write(packet, kDiagHeaderLength + length);
+    binding.udp.endPacket();
+    m_pollStats.diagnostics++;
+  }
+}
+
+void ArtNetNode::handleAddress(int len)
+{
+  if (len < kAddressLength || !m_addressCallback) {
     return;
   }
 
-  if (packetSize > static_cast<int>(m_buffer.size())) {
-    packetSize = static_cast<int>(m_buffer.size());
+  AddressProgram program;
+  program.net = decodeSwitch(m_buffer[12], 0x7F);
+  program.shortName = decodeName(&m_buffer[14], 18);
+  program.longName = decodeName(&m_buffer[32], 64);
+  program.swOut = decodeSwitch(m_buffer[100], 0x0F);
+  program.subNet = decodeSwitch(m_buffer[104], 0x0F);
+  const uint8_t command = m_buffer[106];
+  if (command == 0x01) {
+    program.command = AddressCommand::CancelMerge;
+  } else if (command >= 0x10 && command <= 0x13) {
+    program.command = AddressCommand::MergeLtp;
+  } else if (command >= 0x50 && command <= 0x53) {
+    program.command = AddressCommand::MergeHtp;
   }
 
-  int len = m_udp.read(m_buffer.data(), packetSize);
-  if (len < 10) {
+  const IPAddress remoteIP = m_bindings[m_current].udp.remoteIP();
+  const uint16_t remotePort = m_bindings[m_current].udp.remotePort();
+  m_addressCallback(program, remoteIP);
+  sendPollReply(remoteIP, remotePort);
+}
+
+void ArtNetNode::handleIpProg(int len)
+{
+  if (len < kIpProgLength || !m_ipProgCallback) {
     return;
   }
 
-  if (memcmp(m_buffer.data(), kArtNetId, 8) != 0) {
-    return;
+  IpProgram program;
+  const uint8_t command = m_buffer[14];
+  program.enable = (command & 0x80) != 0;
+  program.dhcp = program.enable && (command & 0x40);
+  program.setGateway = program.enable && (command & 0x10) && len >= kIpProgGatewayLength;
+  program.resetDefaults = program.enable && (command & 0x08);
+  program.setIp = program.enable && (command & 0x04);
+  program.setMask = program.enable && (command & 0x02);
+  program.ip = decodeIp(&m_buffer[16]);
+  program.mask = decodeIp(&m_buffer[20]);
+  if (len >= kIpProgGatewayLength) {
+    program.gateway = decodeIp(&m_buffer[26]);
   }
 
+  const IPAddress remoteIP = m_bindings[m_current].udp.remoteIP();
+  const uint16_t remotePort = m_bindings[m_current].udp.remotePort();
+  IpSettings settings;
+  m_ipProgCallback(program, remoteIP, settings);
+
+  Binding& binding = m_bindings[m_current];
+  ArtIpProgReplyPacket reply{};
+  memcpy(reply.id, kArtNetId, sizeof(reply.id));
+  reply.opCode = kOpIpProgReply;
+  reply.protVerLo = kProtocolVersion;
+  encodeIp(settings.ip, reply.ip);
+  encodeIp(settings.mask, reply.mask);
+  encodeIp(settings.gateway, reply.gateway);
+  reply.portHi = ARTNET_PORT >> 8;
+  reply.portLo = ARTNET_PORT & 0xFF;
+  reply.status = settings.dhcp ? 0x40 : 0x00;
+
+  binding.udp.beginPacket(remoteIP, remotePort ? remotePort : ARTNET_PORT);
+  binding.udp.write(reinterpret_cast<uint8_t*>(&reply), sizeof(reply));
+  binding.udp.endPacket();
+}
+
+bool ArtNetNode::arrivedElsewhere(uint8_t index, IPAddress remoteIP) const
+{
+  // A limited broadcast (255.255.255.255) reaches every socket; it belongs to
+  // the interface whose network the sender is on.
+  const Binding& own = m_bindings[index];
+  if (sameSubnet(own.ip, remoteIP, own.mask)) return false;
+  for (uint8_t i = 0; i < INTERFACE_COUNT; ++i) {
+    const Binding& other = m_bindings[i];
+    if (i != index && other.active && other.ip != IPAddress((uint32_t)0) &&
+        sameSubnet(other.ip, remoteIP, other.mask)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ArtNetNode::acceptsUniverse(uint16_t universe, uint8_t index) const
+{
+  for (uint8_t i = 0; i < m_filterCount; ++i) {
+    const SourceFilter& filter = m_filters[i];
+    if (universe >= filter.firstUniverse && universe - filter.firstUniverse < filter.universeCount) {
+      return (filter.interfaces & (1u << index)) != 0;
+    }
+  }
+  return true;
+}
+
+bool ArtNetNode::read()
+{
+  refreshLocalInfo();
+  bool took = false;
+  for (uint8_t i = 0; i < INTERFACE_COUNT; ++i) {
+    if (m_bindings[i].bound && readFrom(i)) {
+      took = true;
+    }
+  }
+  servicePollReplies();
+  return took;
+}
+
+bool ArtNetNode::readFrom(uint8_t index)
+{
+  Binding& binding = m_bindings[index];
+  WiFiUDP& udp = binding.udp;
+  const int packetSize = udp.parsePacket();
+  if (packetSize <= 0) {
+    return false;
+  }
+
+  // Only the header is read first: a packet dropped on it (not Art-Net, a
+  // standby socket, ArtDmx for a universe that is not ours) never has its
+  // payload copied.  flush() discards what is left of the datagram.
+  int len = udp.read(m_buffer.data(), std::min(packetSize, kDmxHeaderLength));
+  if (len < 10 || memcmp(m_buffer.data(), kArtNetId, 8) != 0) {
+    udp.flush();
+    return true;
+  }
+
+  // A standby socket is drained so nothing stale is waiting at failover.
+  if (!binding.active) {
+    udp.flush();
+    return true;
+  }
+
+  const IPAddress remoteIP = udp.remoteIP();
+  if (arrivedElsewhere(index, remoteIP)) {
+    udp.flush();
+    return true;
+  }
+  m_current = index;
+  binding.packets++;
+
   uint16_t opCode = static_cast<uint16_t>(m_buffer[8]) | (static_cast<uint16_t>(m_buffer[9]) << 8);
 
+  if (opCode == kOpDmx && m_ownedUniverses && len == kDmxHeaderLength) {
+    const uint16_t universe = static_cast<uint16_t>(m_buffer[14]) | (static_cast<uint16_t>(m_buffer[15]) << 8);
+    if (!m_ownedUniverses->contains(universe)) {
+      m_unownedPackets++;
+      udp.flush();
+      return true;
+    }
+  }
+
+  if (packetSize > len) {
+    const int rest = udp.read(m_buffer.data() + len, std::min<int>(packetSize, m_buffer.size()) - len);
+    if (rest > 0) {
+      len += rest;
+    }
+    udp.flush();
+  }
+
   if (opCode == kOpPoll) {
-    sendPollReply(m_udp.remoteIP(), m_udp.remotePort());
-    return;
+    handlePoll(len, remoteIP, udp.remotePort());
+    return true;
+  }
+
+  if (opCode == kOpSync) {
+    if (!(m_syncInterfaces & (1u << index))) {
+      m_filteredPackets++;
+      return true;
+    }
+    if (m_syncCallback) {
+      m_syncCallback(remoteIP);
+    }
+    return true;
+  }
+
+  if (opCode == kOpTimeCode) {
+    if (len >= 19 && m_timeCodeCallback) {
+      TimeCode timecode;
+      timecode.streamId = m_buffer[13];
+      timecode.frames = m_buffer[14];
+      timecode.seconds = m_buffer[15];
+      timecode.minutes = m_buffer[16];
+      timecode.hours = m_buffer[17];
+      timecode.type = m_buffer[18] & 0x03;
+      m_timeCodeCallback(timecode, remoteIP);
+    }
+    return true;
+  }
+
+  if (opCode == kOpAddress) {
+    handleAddress(len);
+    return true;
+  }
+
+  if (opCode == kOpIpProg) {
+    handleIpProg(len);
+    return true;
   }
 
   if (opCode != kOpDmx) {
-    return;
+    return true;
   }
 
   if (len < 18) {
-    return;
+    return true;
   }
 
   uint8_t sequence = m_buffer[12];
   uint16_t universe = static_cast<uint16_t>(m_buffer[14]) | (static_cast<uint16_t>(m_buffer[15]) << 8);
   uint16_t dataLength = static_cast<uint16_t>(m_buffer[16]) << 8 | static_cast<uint16_t>(m_buffer[17]);
 
+  if (!acceptsUniverse(universe, index)) {
+    m_filteredPackets++;
+    return true;
+  }
+
   if (dataLength > static_cast<uint16_t>(len - 18)) {
     dataLength = static_cast<uint16_t>(len - 18);
   }
 
   if (m_dmxCallback) {
-    m_dmxCallback(universe, dataLength, sequence, m_buffer.data() + 18, m_udp.remoteIP());
+    m_dmxCallback(universe, dataLength, sequence, m_buffer.data() + 18, remoteIP);
   }
+  return true;
 }
-
@@ -0,0 +1,250 @@
+#include "ClockSync.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace {
+
+constexpr char kClockId[4] = {'P', 'X', 'C', 'K'};
+constexpr uint8_t kVersion = 1;
+
+enum PacketType : uint8_t {
+  kRequest = 1,   // slave → master: t1 = send time, t2 = path delay, value = error
+  kResponse = 2,  // master → slave: t1 echoed, t2 = receive time, t3 = send time
+  kPresent = 3,   // master → slave: t1 = target in master time, value = delay
+};
+
+struct __attribute__((packed)) ClockPacket {
+  char id[4];
+  uint8_t version;
+  uint8_t type;
+  uint16_t seq;
+  uint32_t t1;
+  uint32_t t2;
+  uint32_t t3;
+  uint32_t value;
+};
+
+// Exchanges slower than this were queued somewhere; their offset is useless.
+constexpr uint32_t kMaxRoundTripUs = 500000;
+// A frame shown later than this after its target counts as late.
+constexpr int32_t kLateUs = 1000;
+
+}  // namespace
+
+void ClockSync::begin(Role role, IPAddress masterIp, uint16_t port, IPAddress bindAddress)
+{
+  if (role == m_role && masterIp == m_configuredMasterIp && port == m_port) {
+    return;
+  }
+  m_udp.stop();
+  m_role = role;
+  m_configuredMasterIp = masterIp;
+  m_port = port;
+  m_masterIp = masterIp;
+  m_discover = masterIp == IPAddress((uint32_t)0);
+  m_sampleCount = 0;
+  m_sampleNext = 0;
+  m_hasOffset = false;
+  m_requestScheduled = false;
+  m_pending = false;
+  m_announced = false;
+  m_peerCount = 0;
+  if (role == Role::Off) {
+    return;
+  }
+  if (bindAddress == IPAddress((uint32_t)0)) {
+    m_udp.begin(port);
+  } else {
+    m_udp.begin(bindAddress, port);
+  }
+}
+
+bool ClockSync::synced(uint32_t nowUs) const
+{
+  if (m_role == Role::Master) return true;
+  return m_hasOffset && nowUs - m_lastSampleUs < SYNC_TIMEOUT_US;
+}
+
+void ClockSync::service(uint32_t nowUs)
+{
+  if (m_role == Role::Off) {
+    return;
+  }
+
+  uint8_t buffer[sizeof(ClockPacket)];
+  int packetSize;
+  while ((packetSize = m_udp.parsePacket()) > 0) {
+    const int length = m_udp.read(buffer, sizeof(buffer));
+    handlePacket(buffer, length > 0 ? static_cast<size_t>(length) : 0, nowUs);
+  }
+
+  if (m_role == Role::Slave) {
+    if (!m_requestScheduled || static_cast<int32_t>(nowUs - m_nextRequestUs) >= 0) {
+      const IPAddress target = m_discover && !m_hasOffset ? IPAddress(255, 255, 255, 255) : m_masterIp;
+      sendPacket(target, m_port, kRequest, ++m_requestSeq, nowUs, m_pathDelayUs, 0, m_avgErrorUs);
+      // Fill the sample window quickly after start-up.
+      m_nextRequestUs = nowUs + (m_sampleCount < SAMPLE_WINDOW ? REQUEST_INTERVAL_US / 4 : REQUEST_INTERVAL_US);
+      m_requestScheduled = true;
+    }
+    return;
+  }
+
+  uint8_t kept = 0;
+  for (uint8_t i = 0; i < m_peerCount; ++i) {
+    if (nowUs - m_peers[i].lastSeenUs < PEER_TIMEOUT_US) {
+      m_peers[kept++] = m_peers[i];
+    }
+  }
+  m_peerCount = kept;
+}
+
+void ClockSync::handlePacket(const uint8_t* data, size_t length, uint32_t nowUs)
+{
+  ClockPacket packet;
+  if (length < sizeof(packet)) return;
+  memcpy(&packet, data, sizeof(packet));
+  if (memcmp(packet.id, kClockId, sizeof(kClockId)) != 0 || packet.version != kVersion) return;
+
+  const IPAddress remoteIp = m_udp.remoteIP();
+  switch (packet.type) {
+    case kRequest:
+      if (m_role != Role::Master) return;
+      notePeer(remoteIp, m_udp.remotePort(), packet.value, packet.t2, nowUs);
+      // t3 = t2: the reply leaves within the same service() call.
+      sendPacket(remoteIp, m_udp.remotePort(), kResponse, packet.seq, packet.t1, nowUs, nowUs, 0);
+      return;
+
+    case kResponse: {
+      if (m_role != Role::Slave || packet.seq != m_requestSeq) return;
+      const uint32_t roundTrip = nowUs - packet.t1;
+      const uint32_t masterHold = packet.t3 - packet.t2;
+      if (roundTrip > kMaxRoundTripUs || masterHold > roundTrip) return;
+      const uint32_t pathDelay = roundTrip - masterHold;
+      if (m_discover) m_masterIp = remoteIp;
+      // Symmetric paths assumed: the request took half the round trip.
+      addSample(packet.t2 - packet.t1 - pathDelay / 2, pathDelay, nowUs);
+      return;
+    }
+
+    case kPresent: {
+      if (m_role != Role::Slave || !synced(nowUs)) return;
+      if (!m_discover && remoteIp != m_masterIp) return;
+      if (m_pending && !m_targeted && nowUs - m_latchUs < m_presentDelayUs) {
+        setTarget(toLocal(packet.t1));
+      } else {
+        // Arrived ahead of the frame itself.
+        m_announced = true;
+        m_announceUs = nowUs;
+        m_announceTargetUs = packet.t1;
+      }
+      return;
+    }
+  }
+}
+
+void ClockSync::sendPacket(IPAddress ip, uint16_t port, uint8_t type, uint16_t seq, uint32_t t1, uint32_t t2, uint32_t t3, uint32_t value)
+{
+  ClockPacket packet;
+  memcpy(packet.id, kClockId, sizeof(kClockId));
+  packet.version = kVersion;
+  packet.type = type;
+  packet.seq = seq;
+  packet.t1 = t1;
+  packet.t2 = t2;
+  packet.t3 = t3;
+  packet.value = value;
+  m_udp.beginPacket(ip, port);
+  m_udp.write(reinterpret_cast<const uint8_t*>(&packet), sizeof(packet));
+  m_udp.endPacket();
+}
+
+void ClockSync::addSample(uint32_t offsetUs, uint32_t pathDelayUs, uint32_t nowUs)
+{
+  m_samples[m_sampleNext] = {offsetUs, pathDelayUs};
+  m_sampleNext = (m_sampleNext + 1) % SAMPLE_WINDOW;
+  if (m_sampleCount < SAMPLE_WINDOW) m_sampleCount++;
+
+  // The fastest exchange had the least queueing and the most symmetric path.
+  const Sample* best = &m_samples[0];
+  for (uint8_t i = 1; i < m_sampleCount; ++i) {
+    if (m_samples[i].pathDelayUs < best->pathDelayUs) best = &m_samples[i];
+  }
+  m_offsetUs = best->offsetUs;
+  m_pathDelayUs = best->pathDelayUs;
+  m_lastSampleUs = nowUs;
+  m_hasOffset = true;
+  m_exchanges++;
+}
+
+void ClockSync::notePeer(IPAddress ip, uint16_t port, uint32_t errorUs, uint32_t pathDelayUs, uint32_t nowUs)
+{
+  uint8_t index = 0;
+  while (index < m_peerCount && (m_peers[index].ip != ip || m_peers[index].port != port)) ++index;
+  if (index == m_peerCount) {
+    if (m_peerCount == MAX_PEERS) return;
+    m_peerCount++;
+    m_peers[index].ip = ip;
+    m_peers[index].port = port;
+  }
+  m_peers[index].lastSeenUs = nowUs;
+  m_peers[index].errorUs = errorUs;
+  m_peers[index].pathDelayUs = pathDelayUs;
+}
+
+uint32_t ClockSync::maxPeerSkewUs() const
+{
+  uint32_t skew = 0;
+  for (uint8_t i = 0; i < m_peerCount; ++i) {
+    skew = std::max(skew, m_peers[i].errorUs + m_peers[i].pathDelayUs / 2);
+  }
+  return skew;
+}
+
+void ClockSync::setTarget(uint32_t targetUs)
+{
+  // A target far from this frame's arrival belongs to some other frame.
+  const int32_t lead = static_cast<int32_t>(targetUs - m_latchUs);
+  if (lead > static_cast<int32_t>(2 * m_presentDelayUs) || lead < -static_cast<int32_t>(m_presentDelayUs)) {
+    return;
+  }
+  m_targetUs = targetUs;
+  m_targeted = true;
+  m_targetedCount++;
+}
+
+void ClockSync::frameLatched(uint32_t nowUs)
+{
+  m_pending = true;
+  m_latchUs = nowUs;
+  m_targeted = false;
+  // Without a target from the master the frame still waits the fixed delay,
+  // so latency does not change when sync drops out.
+  m_targetUs = nowUs + m_presentDelayUs;
+
+  if (m_role == Role::Master) {
+    setTarget(m_targetUs);
+    for (uint8_t i = 0; i < m_peerCount; ++i) {
+      sendPacket(m_peers[i].ip, m_peers[i].port, kPresent, 0, m_targetUs, 0, 0, m_presentDelayUs);
+    }
+  } else if (m_announced && synced(nowUs) && nowUs - m_announceUs < m_presentDelayUs) {
+    m_announced = false;
+    setTarget(toLocal(m_announceTargetUs));
+  }
+}
+
+void ClockSync::presented(uint32_t startUs)
+{
+  if (!m_pending) {
+    return;
+  }
+  m_pending = false;
+  m_presented++;
+  if (!m_targeted) {
+    return;
+  }
+  m_lastErrorUs = static_cast<int32_t>(startUs - m_targetUs);
+  if (m_lastErrorUs > kLateUs) m_late++;
+  const uint32_t error = static_cast<uint32_t>(abs(m_lastErrorUs));
+  m_avgErrorUs = (m_avgErrorUs * 7 + error) / 8;
+}
@@ -0,0 +1,118 @@
+#include "ConfigStore.h"
+#include "Crc32.h"
+
+#include <algorithm>
+#include <cstring>
+
+ConfigStore::LoadResult ConfigStore::load(void* payload, size_t capacity, uint16_t& version, size_t& length)
+{
+  version = 0;
+  length = 0;
+  m_persisted.clear();
+
+  // Room for a newer (longer) layout than this firmware knows about.
+  std::vector<uint8_t> raw(sizeof(Header) + capacity + 256);
+  size_t read = 0;
+  if (m_prefs.begin(m_namespace, true)) {
+    read = m_prefs.getBytes(m_key, raw.data(), raw.size());
+    m_prefs.end();
+  }
+  if (read == 0) {
+    return LoadResult::Missing;
+  }
+
+  Header header;
+  if (read < sizeof(header)) {
+    return LoadResult::Corrupt;
+  }
+  memcpy(&header, raw.data(), sizeof(header));
+  const uint8_t* body = raw.data() + sizeof(header);
+  if (header.magic != MAGIC || sizeof(header) + header.length != read ||
+      crc32(body, header.length) != header.crc) {
+    return LoadResult::Corrupt;
+  }
+
+  version = header.version;
+  length = header.length;
+  memcpy(payload, body, std::min<size_t>(header.length, capacity));
+  m_persisted.assign(raw.begin(), raw.begin() + read);
+  return LoadResult::Ok;
+}
+
+bool ConfigStore::stage(const void* payload, size_t size, uint16_t version)
+{
+  Header header;
+  header.magic = MAGIC;
+  header.version = version;
+  header.length = static_cast<uint16_t>(size);
+  header.crc = crc32(static_cast<const uint8_t*>(payload), size);
+
+  std::vector<uint8_t> blob(sizeof(header) + size);
+  memcpy(blob.data(), &header, sizeof(header));
+  memcpy(blob.data() + sizeof(header), payload, size);
+
+  if (blob == m_persisted) {
+    // Reverting a pending change back to the stored contents cancels the write.
+    if (m_dirty) {
+      m_dirty = false;
+      m_staged.clear();
+    }
+    m_skipped++;
+    return false;
+  }
+
+  const uint32_t now = millis();
+  if (!m_dirty) {
+    m_firstDirtyMs = now;
+  }
+  m_staged.swap(blob);
+  m_lastStageMs = now;
+  m_dirty = true;
+  return true;
+}
+
+bool ConfigStore::service(bool quiet)
+{
+  if (!m_dirty) {
+    return false;
+  }
+  const uint32_t now = millis();
+  if (now - m_lastStageMs < WRITE_DELAY_MS) {
+    return false;
+  }
+  if (!quiet && now - m_firstDirtyMs < MAX_DEFER_MS) {
+    return false;
+  }
+  return write();
+}
+
+bool ConfigStore::flush()
+{
+  return m_dirty ? write() : false;
+}
+
+void ConfigStore::forget()
+{
+  m_persisted.clear();
+  m_staged.clear();
+  m_dirty = false;
+}
+
+bool ConfigStore::write()
+{
+  bool ok = false;
+  if (m_prefs.begin(m_namespace, false)) {
+    ok = m_prefs.putBytes(m_key, m_staged.data(), m_staged.size()) == m_staged.size();
+    m_prefs.end();
+  }
+  if (!ok) {
+    // Keep the change staged; the next service() call retries.
+    m_lastStageMs = millis();
+    return false;
+  }
+  m_persisted.swap(m_staged);
+  m_staged.clear();
+  m_dirty = false;
+  m_writes++;
+  return true;
+}
@@ -0,0 +1,83 @@
+#include "FastLedBackend.h"
+
+namespace {
+
+template <template<uint8_t DATA_PIN, fl::EOrder RGB_ORDER> class CHIPSET, uint8_t PIN>
+CLEDController* addForOrder(LedColorOrder order, CRGB* pixels, uint16_t count)
+{
+  switch (order) {
+    case LedColorOrder::RGB: return &FastLED.addLeds<CHIPSET, PIN, RGB>(pixels, count);
+    case LedColorOrder::RBG: return &FastLED.addLeds<CHIPSET, PIN, RBG>(pixels, count);
+    case LedColorOrder::GRB: return &FastLED.addLeds<CHIPSET, PIN, GRB>(pixels, count);
+    case LedColorOrder::GBR: return &FastLED.addLeds<CHIPSET, PIN, GBR>(pixels, count);
+    case LedColorOrder::BRG: return &FastLED.addLeds<CHIPSET, PIN, BRG>(pixels, count);
+    case LedColorOrder::BGR: return &FastLED.addLeds<CHIPSET, PIN, BGR>(pixels, count);
+    default: return &FastLED.addLeds<CHIPSET, PIN, BRG>(pixels, count);
+  }
+}
+
+template <uint8_t PIN>
+CLEDController* addForPin(const LedOutputs::Output& output, CRGB* pixels)
+{
+  switch (output.chip) {
+    case LedChipType::WS2812B: return addForOrder<WS2812B, PIN>(output.colorOrder, pixels, output.ledCount);
+    case LedChipType::SK6812:  return addForOrder<SK6812, PIN>(output.colorOrder, pixels, output.ledCount);
+    case LedChipType::WS2811:
+    default:                   return addForOrder<WS2811, PIN>(output.colorOrder, pixels, output.ledCount);
+  }
+}
+
+}  // namespace
+
+bool FastLedBackend::begin(BaseType_t core)
+{
+  if (m_task) return true;
+  return xTaskCreatePinnedToCore(taskMain, "ledout", TASK_STACK, this, TASK_PRIORITY, &m_task, core) == pdPASS;
+}
+
+void FastLedBackend::taskMain(void* arg)
+{
+  FastLedBackend& self = *static_cast<FastLedBackend*>(arg);
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    FastLED.show(self.m_brightness);
+    self.m_doneUs = micros();
+    // Publishes m_doneUs along with the end of the transfer.
+    self.m_busy.store(false, std::memory_order_release);
+  }
+}
+
+void FastLedBackend::show(uint8_t brightness)
+{
+  if (!m_task) {
+    FastLED.show(brightness);
+    return;
+  }
+  m_brightness = brightness;
+  m_busy.store(true, std::memory_order_release);
+  xTaskNotifyGive(m_task);
+}
+
+bool FastLedBackend::attach(uint8_t index, const LedOutputs::Output& output, CRGB* pixels)
+{
+  if (index >= LedOutputs::MAX_OUTPUTS || m_controllers[index]) return false;
+
+  // The pin is a template argument, so only the pins in LedOutputs::PINS exist.
+  CLEDController* controller = nullptr;
+  switch (output.pin) {
+    case 2:  controller = addForPin<2>(output, pixels); break;
+    case 4:  controller = addForPin<4>(output, pixels); break;
+    case 14: controller = addForPin<14>(output, pixels); break;
+    case 15: controller = addForPin<15>(output, pixels); break;
+    default: return false;
+  }
+  m_controllers[index] = controller;
+  return controller != nullptr;
+}
+
+void FastLedBackend::resize(uint8_t index, CRGB* pixels, uint16_t count)
+{
+  if (index < LedOutputs::MAX_OUTPUTS && m_controllers[index]) {
+    m_controllers[index]->setLeds(pixels, count);
+  }
+}
@@ -0,0 +1,330 @@
+#include "FrameIngest.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace {
+
+// Per-byte max of two words (SWAR): the borrow-free subtract yields a >= b in
+// each byte's top bit, which is widened to a byte mask.
+inline uint32_t maxBytes(uint32_t a, uint32_t b)
+{
+  constexpr uint32_t kHigh = 0x80808080u;
+  constexpr uint32_t kLow  = 0x7F7F7F7Fu;
+  const uint32_t diff = (a | kHigh) - (b & kLow);
+  const uint32_t ge = ((a & ~b) | (~(a ^ b) & diff)) & kHigh;
+  const uint32_t mask = (ge >> 7) * 0xFFu;
+  return (a & mask) | (b & ~mask);
+}
+
+void mergeHtp(const uint32_t* a, const uint32_t* b, uint32_t* out, size_t words)
+{
+  for (size_t i = 0; i < words; ++i) {
+    out[i] = maxBytes(a[i], b[i]);
+  }
+}
+
+}  // namespace
+
+bool FrameIngest::configure(uint16_t numLeds, uint16_t startUniverse, uint16_t pixelsPerUniverse,
+                            MemoryArena& arena, uint16_t mergeSlots)
+{
+  Range range;
+  range.startUniverse = startUniverse;
+  range.pixelCount = numLeds;
+  return configure(&range, 1, pixelsPerUniverse, arena, mergeSlots);
+}
+
+uint16_t FrameIngest::universesFor(const Range* ranges, uint8_t count, uint16_t pixelsPerUniverse)
+{
+  const uint16_t perUniverse = std::max<uint16_t>(1, pixelsPerUniverse);
+  uint16_t universes = 0;
+  for (uint8_t r = 0; r < std::min<uint8_t>(count, MAX_RANGES); ++r) {
+    universes += std::max<uint16_t>(1, (ranges[r].pixelCount + perUniverse - 1) / perUniverse);
+  }
+  return universes;
+}
+
+bool FrameIngest::configure(const Range* ranges, uint8_t count, uint16_t pixelsPerUniverse, MemoryArena& arena,
+                            uint16_t mergeSlots)
+{
+  m_pixelsPerUniverse = std::max<uint16_t>(1, pixelsPerUniverse);
+  m_rangeCount = std::min<uint8_t>(count, MAX_RANGES);
+  m_numLeds = 0;
+  m_universeCount = 0;
+  for (uint8_t r = 0; r < m_rangeCount; ++r) {
+    RangeState& range = m_ranges[r];
+    range.startUniverse = ranges[r].startUniverse;
+    range.firstIndex = m_universeCount;
+    range.universeCount = std::max<uint16_t>(1, (ranges[r].pixelCount + m_pixelsPerUniverse - 1) / m_pixelsPerUniverse);
+    m_universeCount += range.universeCount;
+    m_numLeds = std::max<uint16_t>(m_numLeds, ranges[r].firstPixel + ranges[r].pixelCount);
+  }
+
+  m_receivedCount = 0;
+  m_mergeStateChanged = true;
+  m_frameChanged = true;
+  m_received = arena.take<uint8_t>("ingest", m_universeCount);
+  m_universes = arena.take<UniverseState>("universes", m_universeCount);
+  m_mergePool = arena.take<MergeBuffers>("merge", mergeSlots);
+  m_freeMerge = arena.take<uint16_t>("mergeFree", mergeSlots);
+  m_mergeSlots = (m_mergePool && m_freeMerge) ? mergeSlots : 0;
+  m_freeMergeCount = m_mergeSlots;
+  for (uint16_t i = 0; i < m_mergeSlots; ++i) {
+    m_freeMerge[i] = i;
+  }
+  if (!m_received || !m_universes ||
+      !m_map.begin(PortAddressMap::maxPages(m_universeCount, m_rangeCount), arena)) {
+    m_map.clear();
+    m_rangeCount = 0;
+    m_universeCount = 0;
+    return false;
+  }
+
+  for (uint8_t r = 0; r < m_rangeCount; ++r) {
+    for (uint16_t u = 0; u < m_ranges[r].universeCount; ++u) {
+      UniverseState& state = m_universes[m_ranges[r].firstIndex + u];
+      const uint16_t skipped = u * m_pixelsPerUniverse;
+      state.pixelOffset = ranges[r].firstPixel + skipped;
+      state.pixelCount = skipped < ranges[r].pixelCount
+                           ? std::min<uint16_t>(m_pixelsPerUniverse, ranges[r].pixelCount - skipped)
+                           : 0;
+    }
+    // Ranges go in order, so the first to claim a universe keeps it.
+    m_map.add(m_ranges[r].startUniverse, m_ranges[r].universeCount, m_ranges[r].firstIndex);
+  }
+  return true;
+}
+
+void FrameIngest::reset()
+{
+  std::fill(m_received, m_received + m_universeCount, 0);
+  m_receivedCount = 0;
+}
+
+void FrameIngest::latch()
+{
+  m_stats.framesLatched++;
+  m_stats.latchLatencyUs.record(micros() - m_frameStartUs);
+  reset();
+}
+
+bool FrameIngest::sync()
+{
+  m_stats.syncPackets++;
+  m_lastSyncMs = millis();
+  m_syncActive = true;
+  if (m_receivedCount == 0) return false;
+
+  m_stats.syncLatched++;
+  latch();
+  return true;
+}
+
+bool FrameIngest::admitSource(uint32_t sourceIp, uint32_t now)
+{
+  if (m_cancelMergePending) {
+    // This controller takes every universe; the others' slots are freed.
+    m_cancelMergePending = false;
+    m_exclusiveIp = sourceIp;
+    for (uint16_t u = 0; u < m_universeCount; ++u) {
+      UniverseState& state = m_universes[u];
+      for (MergeSource& source : state.sources) {
+        if (source.ip != sourceIp) source = MergeSource();
+      }
+      if (state.merging) {
+        state.merging = false;
+        m_mergeStateChanged = true;
+      }
+      if (state.buffers) releaseMergeBuffers(state);
+    }
+  } else if (m_exclusiveIp == 0) {
+    return true;
+  } else if (sourceIp != m_exclusiveIp) {
+    if (now - m_exclusiveLastMs <= MERGE_TIMEOUT_MS) return false;
+    m_exclusiveIp = 0;   // it went quiet: merge as usual again
+    return true;
+  }
+  m_exclusiveLastMs = now;
+  return true;
+}
+
+int8_t FrameIngest::selectSource(UniverseState& state, uint32_t sourceIp, uint32_t now)
+{
+  int8_t slot = -1;
+  if (state.sources[0].ip == sourceIp) {
+    slot = 0;
+  } else if (state.sources[1].ip == sourceIp) {
+    slot = 1;
+  } else {
+    // A new controller takes a free or timed-out slot; a third live one is ignored.
+    for (uint8_t i = 0; i < 2; ++i) {
+      if (state.sources[i].ip == 0 || now - state.sources[i].lastMs > MERGE_TIMEOUT_MS) {
+        slot = static_cast<int8_t>(i);
+        state.sources[i].ip = sourceIp;
+        break;
+      }
+    }
+    if (slot < 0) return -1;
+  }
+  state.sources[slot].lastMs = now;
+
+  MergeSource& other = state.sources[1 - slot];
+  if (other.ip != 0 && now - other.lastMs > MERGE_TIMEOUT_MS) {
+    other.ip = 0;
+  }
+  const bool merging = other.ip != 0;
+  if (merging != state.merging) {
+    state.merging = merging;
+    m_mergeStateChanged = true;
+  }
+  return slot;
+}
+
+FrameIngest::MergeBuffers* FrameIngest::takeMergeBuffers()
+{
+  if (m_freeMergeCount == 0) return nullptr;
+  MergeBuffers* buffers = m_mergePool + m_freeMerge[--m_freeMergeCount];
+  *buffers = MergeBuffers();
+  return buffers;
+}
+
+void FrameIngest::releaseMergeBuffers(UniverseState& state)
+{
+  m_freeMerge[m_freeMergeCount++] = static_cast<uint16_t>(state.buffers - m_mergePool);
+  state.buffers = nullptr;
+}
+
+const uint8_t* FrameIngest::merge(UniverseState& state, uint8_t slot, uint16_t& length, const uint8_t* data)
+{
+  const bool seedOther = !state.buffers;
+  if (!state.buffers) {
+    state.buffers = takeMergeBuffers();
+    if (!state.buffers) {
+      // Pool exhausted: the latest packet wins until a slot frees up.
+      m_stats.unbufferedMerges++;
+      return data;
+    }
+  }
+  MergeBuffers& buffers = *state.buffers;
+  uint8_t* own = reinterpret_cast<uint8_t*>(buffers.dmx[slot]);
+  uint8_t* other = reinterpret_cast<uint8_t*>(buffers.dmx[1 - slot]);
+
+  if (seedOther) {
+    // The other controller's last data is what the pixels currently hold.
+    memset(other, 0, sizeof(buffers.dmx[0]));
+    buffers.length[1 - slot] = 0;
+    if (m_pixels && state.pixelCount) {
+      const uint16_t bytes = std::min<uint16_t>(state.pixelCount * 3, sizeof(buffers.dmx[0]));
+      memcpy(other, m_pixels + state.pixelOffset, bytes);
+      buffers.length[1 - slot] = bytes;
+    }
+  }
+
+  const uint16_t ownLength = std::min<uint16_t>(length, sizeof(buffers.dmx[0]));
+  memcpy(own, data, ownLength);
+  if (ownLength < buffers.length[slot]) {
+    memset(own + ownLength, 0, buffers.length[slot] - ownLength);
+  }
+  buffers.length[slot] = ownLength;
+  m_stats.mergedPackets++;
+
+  if (m_mergeMode == MergeMode::Ltp) {
+    return data;
+  }
+  mergeHtp(buffers.dmx[0], buffers.dmx[1], buffers.merged, DMX_WORDS);
+  length = std::max(buffers.length[0], buffers.length[1]);
+  return reinterpret_cast<const uint8_t*>(buffers.merged);
+}
+
+void FrameIngest::copyUniverse(uint16_t idxU, const uint8_t* data, uint16_t pixels)
+{
+  UniverseState& state = m_universes[idxU];
+  if (!m_pixels || !state.pixelCount) return;
+
+  const uint16_t pixelsInPacket = std::min<uint16_t>(pixels, state.pixelCount);
+
+  CRGB* out = m_pixels + state.pixelOffset;
+  uint32_t sumR = 0, sumG = 0, sumB = 0;
+  uint8_t diff = 0;
+  for (uint16_t i = 0; i < pixelsInPacket; i++) {
+    const uint8_t r = data[i * 3 + 0];
+    const uint8_t g = data[i * 3 + 1];
+    const uint8_t b = data[i * 3 + 2];
+    diff |= (out[i].r ^ r) | (out[i].g ^ g) | (out[i].b ^ b);
+    out[i].setRGB(r, g, b);
+    sumR += r;
+    sumG += g;
+    sumB += b;
+  }
+  // A short packet leaves the rest of the universe as it was; those pixels
+  // are still lit and still count towards the power estimate.
+  for (uint16_t i = pixelsInPacket; i < state.pixelCount; i++) {
+    sumR += out[i].r;
+    sumG += out[i].g;
+    sumB += out[i].b;
+  }
+  ChannelSums& sums = state.sums;
+  sums.r = sumR;
+  sums.g = sumG;
+  sums.b = sumB;
+  if (diff) m_frameChanged = true;
+}
+
+void FrameIngest::stageUniverse(uint16_t idxU, const uint8_t* data, uint16_t pixels)
+{
+  const UniverseState& state = m_universes[idxU];
+  const uint16_t count = std::min<uint16_t>(pixels, state.pixelCount);
+  memcpy(m_staging + state.pixelOffset, data, count * sizeof(CRGB));
+}
+
+void FrameIngest::loadFrame(const CRGB* pixels, uint16_t count)
+{
+  for (uint16_t u = 0; u < m_universeCount; ++u) {
+    const uint16_t offset = m_universes[u].pixelOffset;
+    if (offset >= count) continue;
+    const uint16_t pixelsHere = std::min<uint16_t>(m_universes[u].pixelCount, count - offset);
+    copyUniverse(u, reinterpret_cast<const uint8_t*>(pixels + offset), pixelsHere);
+  }
+}
+
+bool FrameIngest::ingest(uint16_t universe, uint16_t length, const uint8_t* data, uint32_t sourceIp)
+{
+  const int32_t index = universeIndex(universe);
+  if (index < 0) return false;
+
+  const uint16_t idxU = static_cast<uint16_t>(index);
+  UniverseState& state = m_universes[idxU];
+  const uint32_t now = millis();
+  const int8_t slot = admitSource(sourceIp, now) ? selectSource(state, sourceIp, now) : -1;
+  if (slot < 0) {
+    m_stats.ignoredSourcePackets++;
+    return false;
+  }
+  m_stats.packets++;
+
+  if (state.merging) {
+    data = merge(state, static_cast<uint8_t>(slot), length, data);
+  } else if (state.buffers) {
+    // Back to a single source: drop the buffers so the next merge re-seeds.
+    releaseMergeBuffers(state);
+  }
+
+  if (m_staging) {
+    stageUniverse(idxU, data, length / 3);
+  } else {
+    copyUniverse(idxU, data, length / 3);
+  }
+
+  if (!m_received[idxU]) {
+    if (m_receivedCount == 0) m_frameStartUs = micros();
+    m_received[idxU] = 1;
+    ++m_receivedCount;
+  }
+
+  // Actualizar cuando recibimos al menos un paquete de cada universo
+  if (m_receivedCount < m_universeCount || syncMode()) return false;
+
+  latch();
+  return true;
+}
@@ -0,0 +1,136 @@
+#include "FrameJitterBuffer.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace {
+
+// Art-Net sequence numbers wrap through 1..255.
+inline bool sequenceBefore(uint8_t a, uint8_t b)
+{
+  return static_cast<int8_t>(a - b) < 0;
+}
+
+}  // namespace
+
+void FrameJitterBuffer::configure(uint16_t numLeds, uint16_t maxLatencyMs, MemoryArena& arena, uint8_t capacity)
+{
+  uint32_t maxLatencyUs = static_cast<uint32_t>(std::min(maxLatencyMs, MAX_LATENCY_MS)) * 1000;
+  m_capacity = std::min(capacity, MAX_CAPACITY);
+  m_staging = nullptr;
+  m_frames = nullptr;
+  if (maxLatencyUs && m_capacity >= MIN_CAPACITY) {
+    m_staging = arena.take<CRGB>("jitterStaging", numLeds);
+    m_frames = arena.take<CRGB>("jitterFrames", static_cast<size_t>(m_capacity + 1) * numLeds);
+  }
+  if (!m_staging || !m_frames) {
+    maxLatencyUs = 0;
+    m_capacity = 0;
+  }
+  m_numLeds = numLeds;
+  m_maxLatencyUs = maxLatencyUs;
+  m_count = 0;
+  m_releasedSlot = m_capacity;
+  m_playing = false;
+  m_hasReleased = false;
+  m_hasPushed = false;
+  m_intervalUs = 0;
+  updateTargetDepth();
+}
+
+void FrameJitterBuffer::updateTargetDepth()
+{
+  // The oldest of N queued frames waits about N intervals, so one interval of
+  // the budget stays free for late arrivals; one slot stays free for bursts.
+  // Signed: input slower than the whole budget leaves no room at all.
+  const int32_t depth = m_intervalUs ? static_cast<int32_t>(m_maxLatencyUs / m_intervalUs) - 1 : 2;
+  const int32_t deepest = m_capacity > 1 ? m_capacity - 1 : 1;
+  m_targetDepth = static_cast<uint8_t>(std::max<int32_t>(1, std::min<int32_t>(depth, deepest)));
+}
+
+void FrameJitterBuffer::push(uint8_t sequence, uint32_t nowUs)
+{
+  if (!enabled()) return;
+
+  const uint32_t dt = nowUs - m_lastPushUs;
+  m_lastPushUs = nowUs;
+  if (m_hasPushed && dt < 1000000) {
+    m_intervalUs = m_intervalUs ? (m_intervalUs * 15 + dt) / 16 : dt;
+    updateTargetDepth();
+  }
+  m_hasPushed = true;
+
+  if (sequence && m_hasReleased && m_lastSequence && sequenceBefore(sequence, m_lastSequence)) {
+    m_late++;
+    return;
+  }
+  if (m_count == m_capacity) {
+    // Input ran ahead of the cadence: the oldest frame gives way.
+    memmove(m_order, m_order + 1, m_capacity - 1);
+    m_count--;
+    m_overruns++;
+  }
+
+  uint8_t slot = 0;
+  for (; slot <= m_capacity; ++slot) {
+    if (slot == m_releasedSlot) continue;
+    if (std::find(m_order, m_order + m_count, slot) == m_order + m_count) break;
+  }
+  memcpy(slotPixels(slot), m_staging, m_numLeds * sizeof(CRGB));
+  m_slots[slot] = {sequence, nowUs};
+
+  uint8_t pos = m_count;
+  while (pos > 0 && sequence) {
+    const uint8_t before = m_slots[m_order[pos - 1]].sequence;
+    if (!before || !sequenceBefore(sequence, before)) break;
+    m_order[pos] = m_order[pos - 1];
+    --pos;
+  }
+  m_order[pos] = slot;
+  m_count++;
+}
+
+const CRGB* FrameJitterBuffer::release(uint32_t nowUs)
+{
+  if (!enabled()) return nullptr;
+
+  if (m_count == 0) {
+    if (m_playing && static_cast<int32_t>(nowUs - m_nextReleaseUs) >= 0) {
+      // Due with nothing to show: refill to the target depth before resuming.
+      m_playing = false;
+      m_underruns++;
+    }
+    return nullptr;
+  }
+
+  const Slot& oldest = m_slots[m_order[0]];
+  const uint32_t age = nowUs - oldest.arrivalUs;
+  if (!m_playing) {
+    if (m_count < m_targetDepth && age < m_maxLatencyUs) return nullptr;
+    m_playing = true;
+    m_nextReleaseUs = nowUs;
+  }
+  const bool early = static_cast<int32_t>(nowUs - m_nextReleaseUs) < 0;
+  if (early && age < m_maxLatencyUs) return nullptr;
+
+  m_releasedSlot = m_order[0];
+  memmove(m_order, m_order + 1, m_capacity - 1);
+  m_count--;
+
+  // Steady cadence at the input rate, nudged to hold the target depth.
+  // 1/16 of an interval faster per frame above the target depth, slower
+  // per frame below it.
+  const int32_t error = std::max(-2, std::min(2, static_cast<int32_t>(m_count) + 1 - m_targetDepth));
+  const uint32_t step = static_cast<uint32_t>(static_cast<int32_t>(m_intervalUs) - static_cast<int32_t>(m_intervalUs) * error / 16);
+  if (static_cast<int32_t>(nowUs - m_nextReleaseUs) > static_cast<int32_t>(step)) {
+    m_nextReleaseUs = nowUs + step;   // the loop stalled; do not burst
+  } else {
+    m_nextReleaseUs = (early ? nowUs : m_nextReleaseUs) + step;
+  }
+
+  m_latencyUs = m_released ? (m_latencyUs * 7 + age) / 8 : age;
+  m_released++;
+  m_hasReleased = true;
+  m_lastSequence = m_slots[m_releasedSlot].sequence;
+  return slotPixels(m_releasedSlot);
+}
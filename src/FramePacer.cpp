@@ -0,0 +1,49 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+
+void FramePacer::setMaxFps(uint16_t fps)
+{
+  m_minIntervalUs = fps ? 1000000UL / fps : 0;
+  updateInterval();
+}
+
+void FramePacer::setBackgroundShow(bool background)
+{
+  m_background = background;
+  updateInterval();
+}
+
+void FramePacer::updateInterval()
+{
+  const uint32_t headroom = m_background ? 0 : m_showUs / HEADROOM_DIVISOR;
+  m_intervalUs = std::max(m_minIntervalUs, m_showUs + headroom);
+}
+
+void FramePacer::roll(uint32_t nowMs)
+{
+  const uint32_t elapsed = nowMs - m_windowStartMs;
+  if (elapsed < WINDOW_MS) return;
+  m_inputFps = static_cast<uint16_t>((m_inputCount * 1000UL + elapsed / 2) / elapsed);
+  m_outputFps = static_cast<uint16_t>((m_outputCount * 1000UL + elapsed / 2) / elapsed);
+  m_inputCount = 0;
+  m_outputCount = 0;
+  m_windowStartMs = nowMs;
+}
+
+void FramePacer::frameReceived()
+{
+  roll(millis());
+  m_inputCount++;
+}
+
+void FramePacer::frameShown(uint32_t startUs, uint32_t endUs)
+{
+  const uint32_t duration = endUs - startUs;
+  // Track increases immediately (a longer strip), decreases slowly (jitter).
+  m_showUs = duration > m_showUs ? duration : m_showUs - (m_showUs - duration) / 8;
+  m_lastShowStartUs = startUs;
+  updateInterval();
+  roll(millis());
+  m_outputCount++;
+}
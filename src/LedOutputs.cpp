@@ -0,0 +1,135 @@
+#include "LedOutputs.h"
+
+#include <algorithm>
+#include <string.h>
+
+constexpr uint8_t LedOutputs::PINS[];
+
+void LedOutputs::begin(Backend& backend)
+{
+  m_backend = &backend;
+}
+
+bool LedOutputs::setBuffers(CRGB* pixels, uint16_t capacity, MemoryArena& arena)
+{
+  waitIdle();
+  m_pixels = pixels;
+  m_capacity = capacity;
+  m_transmit = m_backend->asynchronous() ? arena.take<CRGB>("transmit", capacity) : nullptr;
+  return m_transmit || !m_backend->asynchronous();
+}
+
+bool LedOutputs::configure(const Output* outputs, uint8_t count)
+{
+  if (count > MAX_OUTPUTS) count = MAX_OUTPUTS;
+  waitIdle();
+  bool applied = true;
+  uint8_t i = 0;
+  for (; i < count; ++i) {
+    const Output& wanted = outputs[i];
+    CRGB* slice = sendBuffer(wanted.firstLed);
+    if (i >= m_attached) {
+      if (!m_backend->attach(i, wanted, slice)) {
+        applied = false;
+        break;
+      }
+      m_attached = i + 1;
+      m_outputs[i] = wanted;
+      continue;
+    }
+    Output& current = m_outputs[i];
+    if (current.pin != wanted.pin || current.chip != wanted.chip || current.colorOrder != wanted.colorOrder) {
+      // Keeps its old wiring until the restart but already sends the new slice.
+      applied = false;
+    }
+    m_backend->resize(i, slice, wanted.ledCount);
+    current.firstLed = wanted.firstLed;
+    current.ledCount = wanted.ledCount;
+  }
+  m_count = i;
+  // Outputs no longer configured stay attached but send nothing.
+  for (uint8_t j = m_count; j < m_attached; ++j) {
+    m_backend->resize(j, sendBuffer(0), 0);
+    m_outputs[j].ledCount = 0;
+  }
+  return applied;
+}
+
+bool LedOutputs::show(uint8_t brightness)
+{
+  service();
+  if (!m_backend || !m_pixels || m_pending) return false;
+
+  m_startUs = micros();
+  if (m_transmit) {
+    for (uint8_t i = 0; i < m_count; ++i) {
+      const Output& out = m_outputs[i];
+      memcpy(m_transmit + out.firstLed, m_pixels + out.firstLed, out.ledCount * sizeof(CRGB));
+    }
+  }
+  m_pending = true;
+  m_backend->show(brightness);
+  const uint32_t returnedUs = micros();
+  m_showCallUs = returnedUs - m_startUs;
+  m_showCount++;
+  if (!m_backend->asynchronous()) {
+    finish(returnedUs);
+  }
+  return true;
+}
+
+void LedOutputs::service()
+{
+  if (m_pending && !m_backend->busy()) {
+    finish(m_backend->doneUs());
+  }
+}
+
+void LedOutputs::finish(uint32_t endUs)
+{
+  m_pending = false;
+  if (m_doneCallback) {
+    m_doneCallback(m_startUs, endUs);
+  }
+}
+
+void LedOutputs::waitIdle()
+{
+  while (m_pending) {
+    service();
+    if (m_pending) delay(1);
+  }
+}
+
+void LedOutputs::clear()
+{
+  if (!m_backend || !m_pixels) return;
+  waitIdle();
+  std::fill(m_pixels, m_pixels + m_capacity, CRGB(0, 0, 0));
+  show(0);
+  waitIdle();
+}
+
+uint16_t LedOutputs::totalLeds() const
+{
+  uint16_t total = 0;
+  for (uint8_t i = 0; i < m_count; ++i) {
+    total = std::max<uint16_t>(total, m_outputs[i].firstLed + m_outputs[i].ledCount);
+  }
+  return total;
+}
+
+uint32_t LedOutputs::wireTimeUs(const Output& output)
+{
+  if (output.ledCount == 0) return 0;
+  return static_cast<uint32_t>(output.ledCount) * 24u * BIT_NS / 1000u + LATCH_US;
+}
+
+uint32_t LedOutputs::frameTimeUs() const
+{
+  uint32_t longest = 0;
+  for (uint8_t i = 0; i < m_count; ++i) {
+    longest = std::max(longest, wireTimeUs(m_outputs[i]));
+  }
+  return longest;
+}
@@ -0,0 +1,114 @@
+#include "LogRing.h"
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+const char* const kTagNames[] = {"CFG", "ETH", "WIFI", "ARTNET", "DMX", "MEM", "SCENE", "FW", "LED", "SHOW"};
+const char* const kLevelNames[] = {"error", "warn", "info", "debug"};
+static_assert(sizeof(kTagNames) / sizeof(kTagNames[0]) == static_cast<size_t>(LogRing::Tag::TAG_COUNT),
+              "one name per tag");
+static_assert(sizeof(kLevelNames) / sizeof(kLevelNames[0]) == static_cast<size_t>(LogRing::Level::LEVEL_COUNT),
+              "one name per level");
+static_assert((LogRing::CAPACITY & (LogRing::CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+}  // namespace
+
+LogRing::LogRing()
+{
+  for (size_t i = 0; i < CAPACITY; ++i) {
+    m_cells[i].sequence.store(static_cast<uint32_t>(i), std::memory_order_relaxed);
+  }
+}
+
+bool LogRing::logText(Level level, Tag tag, const char* format, const char* text)
+{
+  if (!enabled(level)) return false;
+  return push(level, tag, format, nullptr, 0, text ? text : "");
+}
+
+bool LogRing::push(Level level, Tag tag, const char* format, const uint32_t* args, uint8_t count, const char* text)
+{
+  // A cell is free for position pos when its sequence equals pos; the reader
+  // moves it on by CAPACITY once it has taken the record.
+  uint32_t pos = m_head.load(std::memory_order_relaxed);
+  Cell* cell;
+  for (;;) {
+    cell = &m_cells[pos & (CAPACITY - 1)];
+    const int32_t diff = static_cast<int32_t>(cell->sequence.load(std::memory_order_acquire) - pos);
+    if (diff == 0) {
+      if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+    } else if (diff < 0) {
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    } else {
+      pos = m_head.load(std::memory_order_relaxed);
+    }
+  }
+
+  Record& record = cell->record;
+  record.seq = pos;
+  record.ms = millis();
+  record.format = format;
+  record.level = level;
+  record.tag = tag;
+  record.hasText = text != nullptr;
+  if (text) {
+    strncpy(record.text, text, TEXT_SIZE - 1);
+    record.text[TEXT_SIZE - 1] = '\0';
+  } else {
+    memcpy(record.args, args, count * sizeof(uint32_t));
+  }
+  cell->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+const LogRing::Record* LogRing::peek() const
+{
+  const Cell& cell = m_cells[m_tail & (CAPACITY - 1)];
+  if (cell.sequence.load(std::memory_order_acquire) != m_tail + 1) return nullptr;
+  return &cell.record;
+}
+
+void LogRing::pop()
+{
+  Cell& cell = m_cells[m_tail & (CAPACITY - 1)];
+  if (cell.sequence.load(std::memory_order_acquire) != m_tail + 1) return;
+  m_history[m_taken++ % HISTORY] = cell.record;
+  cell.sequence.store(static_cast<uint32_t>(m_tail + CAPACITY), std::memory_order_release);
+  ++m_tail;
+}
+
+size_t LogRing::format(const Record& record, char* line, size_t size)
+{
+  if (size == 0) return 0;
+  int length = snprintf(line, size, "[%s] ", tagName(record.tag));
+  if (length < 0) length = 0;
+  const size_t prefix = static_cast<size_t>(length) < size ? static_cast<size_t>(length) : size - 1;
+  char* out = line + prefix;
+  const size_t room = size - prefix;
+  if (record.hasText) {
+    length = snprintf(out, room, record.format, record.text);
+  } else {
+    const uint32_t* a = record.args;
+    length = snprintf(out, room, record.format, static_cast<unsigned>(a[0]), static_cast<unsigned>(a[1]),
+                      static_cast<unsigned>(a[2]), static_cast<unsigned>(a[3]), static_cast<unsigned>(a[4]),
+                      static_cast<unsigned>(a[5]), static_cast<unsigned>(a[6]), static_cast<unsigned>(a[7]),
+                      static_cast<unsigned>(a[8]), static_cast<unsigned>(a[9]), static_cast<unsigned>(a[10]),
+                      static_cast<unsigned>(a[11]));
+  }
+  if (length < 0) length = 0;
+  return prefix + (static_cast<size_t>(length) < room ? static_cast<size_t>(length) : room - 1);
+}
+
+const char* LogRing::tagName(Tag tag)
+{
+  const size_t index = static_cast<size_t>(tag);
+  return index < static_cast<size_t>(Tag::TAG_COUNT) ? kTagNames[index] : "?";
+}
+
+const char* LogRing::levelName(Level level)
+{
+  const size_t index = static_cast<size_t>(level);
+  return index < static_cast<size_t>(Level::LEVEL_COUNT) ? kLevelNames[index] : "?";
+}
@@ -0,0 +1,32 @@
+#include "MemoryArena.h"
+
+#include <stdlib.h>
+
+bool MemoryArena::begin(size_t bytes)
+{
+  free(m_base);
+  m_base = static_cast<uint8_t*>(malloc(bytes));
+  m_capacity = m_base ? bytes : 0;
+  reset();
+  return m_base != nullptr;
+}
+
+void MemoryArena::reset()
+{
+  m_used = 0;
+  m_blockCount = 0;
+}
+
+void* MemoryArena::takeBytes(const char* name, size_t bytes)
+{
+  const size_t padded = (bytes + ALIGN - 1) / ALIGN * ALIGN;
+  if (padded > available()) {
+    return nullptr;
+  }
+  void* block = m_base + m_used;
+  m_used += padded;
+  if (padded && m_blockCount < MAX_BLOCKS) {
+    m_blocks[m_blockCount++] = {name, static_cast<uint32_t>(padded)};
+  }
+  return block;
+}
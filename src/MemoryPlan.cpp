@@ -0,0 +1,69 @@
+#include "MemoryPlan.h"
+
+#include "FrameIngest.h"
+#include "FrameJitterBuffer.h"
+#include "LedOutputs.h"
+#include "MemoryArena.h"
+#include "RenderStage.h"
+
+MemoryPlan MemoryPlan::compute(const Needs& needs, size_t capacity)
+{
+  MemoryPlan plan;
+  plan.needs = needs;
+  plan.capacity = capacity;
+  plan.pixelBytes = MemoryArena::footprint<CRGB>(needs.leds) + LedOutputs::bytesFor(needs.leds, needs.transmit);
+  plan.renderBytes = RenderStage::bytesFor(needs.leds, needs.interpolation, needs.fallbackScene);
+  plan.tableBytes = FrameIngest::tableBytes(needs.universes, needs.ranges);
+  if (needs.jitter) {
+    plan.jitterFrames = FrameJitterBuffer::MIN_CAPACITY;
+    plan.jitterBytes = FrameJitterBuffer::bytesFor(needs.leds, plan.jitterFrames);
+  }
+  plan.fits = plan.totalBytes() <= capacity;
+  if (!plan.fits) {
+    return plan;
+  }
+
+  size_t left = capacity - plan.totalBytes();
+  uint16_t slots = needs.universes;
+  while (slots > 0 && FrameIngest::mergePoolBytes(slots) > left) {
+    --slots;
+  }
+  plan.mergeSlots = slots;
+  plan.mergeBytes = FrameIngest::mergePoolBytes(slots);
+  left -= plan.mergeBytes;
+
+  if (needs.jitter) {
+    const size_t base = plan.jitterBytes;
+    while (plan.jitterFrames < FrameJitterBuffer::MAX_CAPACITY &&
+           FrameJitterBuffer::bytesFor(needs.leds, plan.jitterFrames + 1) - base <= left) {
+      ++plan.jitterFrames;
+    }
+    plan.jitterBytes = FrameJitterBuffer::bytesFor(needs.leds, plan.jitterFrames);
+  }
+  return plan;
+}
+
+uint16_t MemoryPlan::maxLeds(Needs needs, uint16_t pixelsPerUniverse, uint8_t ranges, size_t capacity,
+                             uint16_t ceiling)
+{
+  const uint16_t perUniverse = pixelsPerUniverse ? pixelsPerUniverse : 1;
+  auto fits = [&](uint16_t leds) {
+    needs.leds = leds;
+    needs.ranges = ranges;
+    // Every range rounds its last universe up.
+    needs.universes = static_cast<uint16_t>((leds + perUniverse - 1) / perUniverse + (ranges ? ranges - 1 : 0));
+    return compute(needs, capacity).fits;
+  };
+
+  uint16_t low = 0;
+  uint16_t high = ceiling;
+  while (low < high) {
+    const uint16_t mid = static_cast<uint16_t>(low + (high - low + 1) / 2);
+    if (fits(mid)) {
+      low = mid;
+    } else {
+      high = mid - 1;
+    }
+  }
+  return low;
+}
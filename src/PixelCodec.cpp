@@ -0,0 +1,83 @@
+#include "PixelCodec.h"
+
+#include <string.h>
+
+namespace {
+
+constexpr size_t kMaxLiteral = 128;
+constexpr size_t kMaxRepeat  = 129;
+
+inline bool samePixel(const CRGB& a, const CRGB& b)
+{
+  return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+}  // namespace
+
+namespace PixelCodec {
+
+size_t encodeRle(const CRGB* pixels, size_t count, uint8_t* out, size_t capacity)
+{
+  size_t used = 0;
+  size_t i = 0;
+  while (i < count) {
+    size_t run = 1;
+    while (i + run < count && run < kMaxRepeat && samePixel(pixels[i + run], pixels[i])) {
+      ++run;
+    }
+
+    if (run >= 2) {
+      if (used + 4 > capacity) return 0;
+      out[used++] = static_cast<uint8_t>(0x80 + run - 2);
+      out[used++] = pixels[i].r;
+      out[used++] = pixels[i].g;
+      out[used++] = pixels[i].b;
+      i += run;
+      continue;
+    }
+
+    // Literal stretch: stop where the next repeat of two or more begins.
+    size_t literal = 1;
+    while (i + literal < count && literal < kMaxLiteral &&
+           !(i + literal + 1 < count && samePixel(pixels[i + literal], pixels[i + literal + 1]))) {
+      ++literal;
+    }
+    if (used + 1 + literal * 3 > capacity) return 0;
+    out[used++] = static_cast<uint8_t>(literal - 1);
+    for (size_t k = 0; k < literal; ++k) {
+      out[used++] = pixels[i + k].r;
+      out[used++] = pixels[i + k].g;
+      out[used++] = pixels[i + k].b;
+    }
+    i += literal;
+  }
+  return used;
+}
+
+bool decodeRle(const uint8_t* in, size_t length, CRGB* pixels, size_t count)
+{
+  size_t pos = 0;
+  size_t written = 0;
+  while (written < count) {
+    if (pos >= length) return false;
+    const uint8_t control = in[pos++];
+    if (control < 0x80) {
+      const size_t literal = static_cast<size_t>(control) + 1;
+      if (written + literal > count || pos + literal * 3 > length) return false;
+      for (size_t k = 0; k < literal; ++k, pos += 3) {
+        pixels[written++].setRGB(in[pos], in[pos + 1], in[pos + 2]);
+      }
+    } else {
+      const size_t repeat = static_cast<size_t>(control - 0x80) + 2;
+      if (written + repeat > count || pos + 3 > length) return false;
+      const CRGB value(in[pos], in[pos + 1], in[pos + 2]);
+      pos += 3;
+      for (size_t k = 0; k < repeat; ++k) {
+        pixels[written++] = value;
+      }
+    }
+  }
+  return pos == length;
+}
+
+}  // namespace PixelCodec
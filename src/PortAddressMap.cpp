@@ -0,0 +1,61 @@
+#include "PortAddressMap.h"
+
+#include <algorithm>
+
+uint8_t PortAddressMap::maxPages(uint16_t universes, uint8_t runs)
+{
+  const uint32_t pages = static_cast<uint32_t>(universes) / PAGE_SIZE + 2u * runs;
+  return static_cast<uint8_t>(std::min<uint32_t>(pages, NETS));
+}
+
+PortAddressMap::PortAddressMap()
+{
+  clear();
+}
+
+bool PortAddressMap::begin(uint8_t pages, MemoryArena& arena)
+{
+  clear();
+  m_pages = pages ? arena.take<uint16_t>("portMap", static_cast<size_t>(pages) * PAGE_SIZE) : nullptr;
+  m_pageCount = m_pages ? pages : 0;
+  return m_pages != nullptr || pages == 0;
+}
+
+void PortAddressMap::clear()
+{
+  std::fill(m_directory, m_directory + NETS, NO_PAGE);
+  m_pagesUsed = 0;
+}
+
+bool PortAddressMap::containsAny(uint16_t first, uint16_t last) const
+{
+  const uint32_t end = std::min<uint32_t>(last, NETS * PAGE_SIZE - 1);
+  for (uint32_t portAddress = first; portAddress <= end;) {
+    const uint8_t page = m_directory[portAddress / PAGE_SIZE];
+    const uint32_t netEnd = std::min<uint32_t>(end, (portAddress / PAGE_SIZE + 1) * PAGE_SIZE - 1);
+    if (page != NO_PAGE) {
+      for (uint32_t p = portAddress; p <= netEnd; ++p) {
+        if (m_pages[page * PAGE_SIZE + p % PAGE_SIZE] != NONE) return true;
+      }
+    }
+    portAddress = netEnd + 1;
+  }
+  return false;
+}
+
+bool PortAddressMap::add(uint16_t first, uint16_t count, uint16_t firstSlot)
+{
+  for (uint16_t i = 0; i < count; ++i) {
+    const uint32_t portAddress = static_cast<uint32_t>(first) + i;
+    if (portAddress >= NETS * PAGE_SIZE) return false;
+    uint8_t& page = m_directory[portAddress / PAGE_SIZE];
+    if (page == NO_PAGE) {
+      if (m_pagesUsed == m_pageCount) return false;
+      page = m_pagesUsed++;
+      std::fill(m_pages + page * PAGE_SIZE, m_pages + (page + 1) * PAGE_SIZE, NONE);
+    }
+    uint16_t& slot = m_pages[page * PAGE_SIZE + portAddress % PAGE_SIZE];
+    if (slot == NONE) slot = static_cast<uint16_t>(firstSlot + i);
+  }
+  return true;
+}
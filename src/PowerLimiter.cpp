@@ -0,0 +1,112 @@
+#include "PowerLimiter.h"
+
+#include <algorithm>
+
+namespace {
+
+constexpr uint32_t kFullScale = 255UL * 255UL;   // channel value x brightness
+
+inline uint32_t weigh(uint32_t r, uint32_t g, uint32_t b)
+{
+  return r * PowerLimiter::RED_MA + g * PowerLimiter::GREEN_MA + b * PowerLimiter::BLUE_MA;
+}
+
+// weighted is sum(channel * mA at full), i.e. mA x 255 at full brightness.
+inline uint32_t drawMa(uint32_t idleMa, uint32_t weighted, uint8_t brightness)
+{
+  return idleMa + static_cast<uint32_t>((static_cast<uint64_t>(weighted) * brightness) / kFullScale);
+}
+
+}  // namespace
+
+void PowerLimiter::setOutputCount(uint8_t count)
+{
+  m_outputCount = std::min(count, MAX_OUTPUTS);
+}
+
+void PowerLimiter::setOutput(uint8_t index, uint16_t firstLed, uint16_t ledCount, uint32_t limitMa)
+{
+  if (index >= MAX_OUTPUTS) return;
+  Output& out = m_outputs[index];
+  out.firstLed = firstLed;
+  out.ledCount = ledCount;
+  out.limitMa = limitMa;
+}
+
+int8_t PowerLimiter::outputFor(uint16_t led) const
+{
+  for (uint8_t i = 0; i < m_outputCount; ++i) {
+    if (led >= m_outputs[i].firstLed && led - m_outputs[i].firstLed < m_outputs[i].ledCount) {
+      return static_cast<int8_t>(i);
+    }
+  }
+  return -1;
+}
+
+void PowerLimiter::update(const FrameIngest& ingest, uint8_t brightness)
+{
+  uint32_t weighted[MAX_OUTPUTS] = {};
+  for (uint16_t u = 0; u < ingest.universeCount(); ++u) {
+    // A universe is billed to the output holding its first pixel.
+    const int8_t out = outputFor(ingest.pixelOffset(u));
+    if (out < 0) continue;
+    const FrameIngest::ChannelSums& sums = ingest.channelSums(u);
+    weighted[out] += weigh(sums.r, sums.g, sums.b);
+  }
+  apply(weighted, brightness);
+}
+
+void PowerLimiter::measure(const CRGB* pixels, uint16_t count, uint8_t brightness)
+{
+  uint32_t weighted[MAX_OUTPUTS] = {};
+  for (uint8_t o = 0; o < m_outputCount; ++o) {
+    const Output& out = m_outputs[o];
+    const uint16_t end = std::min<uint32_t>(count, out.firstLed + out.ledCount);
+    uint32_t r = 0, g = 0, b = 0;
+    for (uint16_t i = out.firstLed; i < end; ++i) {
+      r += pixels[i].r;
+      g += pixels[i].g;
+      b += pixels[i].b;
+    }
+    weighted[o] = weigh(r, g, b);
+  }
+  apply(weighted, brightness);
+}
+
+void PowerLimiter::apply(const uint32_t* weighted, uint8_t brightness)
+{
+  uint8_t allowed = brightness;
+  for (uint8_t o = 0; o < m_outputCount; ++o) {
+    const Output& out = m_outputs[o];
+    const uint32_t idleMa = out.ledCount * IDLE_MA;
+    if (out.limitMa == 0 || drawMa(idleMa, weighted[o], brightness) <= out.limitMa) continue;
+    // Largest brightness that keeps this output under its supply limit.
+    const uint64_t budget = out.limitMa > idleMa ? out.limitMa - idleMa : 0;
+    const uint64_t fit = (budget * kFullScale) / weighted[o];
+    allowed = std::min<uint64_t>(allowed, fit);
+  }
+
+  m_limiting = allowed < brightness;
+  if (m_limiting) m_limitedFrames++;
+  m_brightness = allowed;
+  for (uint8_t o = 0; o < m_outputCount; ++o) {
+    Output& out = m_outputs[o];
+    const uint32_t idleMa = out.ledCount * IDLE_MA;
+    out.estimatedMa = drawMa(idleMa, weighted[o], brightness);
+    out.limitedMa = drawMa(idleMa, weighted[o], allowed);
+  }
+}
+
+uint32_t PowerLimiter::estimatedMa() const
+{
+  uint32_t total = 0;
+  for (uint8_t o = 0; o < m_outputCount; ++o) total += m_outputs[o].estimatedMa;
+  return total;
+}
+
+uint32_t PowerLimiter::limitedMa() const
+{
+  uint32_t total = 0;
+  for (uint8_t o = 0; o < m_outputCount; ++o) total += m_outputs[o].limitedMa;
+  return total;
+}
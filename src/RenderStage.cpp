@@ -0,0 +1,317 @@
+#include "RenderStage.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace {
+
+// Per-byte lerp of two words (SWAR): even and odd bytes are spread into
+// 16-bit lanes so one multiply weighs two channels.  wa + wb must be 256,
+// which keeps every lane below 0x10000.
+inline uint32_t lerpBytes(uint32_t a, uint32_t b, uint32_t wa, uint32_t wb)
+{
+  constexpr uint32_t kEven = 0x00FF00FFu;
+  const uint32_t even = ((a & kEven) * wa + (b & kEven) * wb) >> 8;
+  const uint32_t odd  = ((a >> 8) & kEven) * wa + ((b >> 8) & kEven) * wb;
+  return (even & kEven) | (odd & ~kEven);
+}
+
+// out = a + (b - a) * weight / 256 over bytes; a and b are padded to whole
+// words.  out may be unaligned.
+void lerpFrame(const uint32_t* a, const uint32_t* b, uint8_t* out, size_t bytes, uint32_t weight)
+{
+  const uint32_t wa = 256 - weight;
+  const size_t words = bytes / 4;
+  for (size_t i = 0; i < words; ++i) {
+    const uint32_t value = lerpBytes(a[i], b[i], wa, weight);
+    memcpy(out + i * 4, &value, 4);
+  }
+  if (bytes % 4) {
+    const uint32_t value = lerpBytes(a[words], b[words], wa, weight);
+    memcpy(out + words * 4, &value, bytes % 4);
+  }
+}
+
+}  // namespace
+
+void RenderStage::begin(FrameIngest& ingest)
+{
+  m_ingest = &ingest;
+  m_lastLatchMs = millis();
+  m_lastLatchUs = micros();
+}
+
+size_t RenderStage::bytesFor(uint16_t numLeds, bool interpolation, bool fallbackScene)
+{
+  size_t bytes = 2 * MemoryArena::footprint<CRGB>(numLeds);
+  if (fallbackScene) bytes += MemoryArena::footprint<CRGB>(numLeds);
+  if (interpolation) bytes += 2 * MemoryArena::footprint<uint32_t>(interpolationWords(numLeds));
+  return bytes;
+}
+
+bool RenderStage::configure(CRGB* output, uint16_t numLeds, MemoryArena& arena)
+{
+  m_output = output;
+  m_from = arena.take<CRGB>("renderFrom", numLeds);
+  m_live = arena.take<CRGB>("renderLive", numLeds);
+  m_scene = m_policy == SourceLossPolicy::Fallback ? arena.take<CRGB>("scene", numLeds) : nullptr;
+  m_prev = m_interpolate ? arena.take<uint32_t>("interpPrev", interpolationWords(numLeds)) : nullptr;
+  m_next = m_interpolate ? arena.take<uint32_t>("interpNext", interpolationWords(numLeds)) : nullptr;
+  const bool complete = m_output && m_from && m_live && (!m_interpolate || (m_prev && m_next));
+  if (!complete) {
+    m_interpolate = false;
+  }
+  m_numLeds = complete ? numLeds : 0;
+
+  m_mode = Mode::Passthrough;
+  m_sourceLost = false;
+  m_outputDirty = false;
+  m_ingestParked = false;
+  // The previous buffers are gone; nothing to carry over.
+  m_ingestTarget = nullptr;
+  redirectIngest(passthroughTarget());
+  return complete;
+}
+
+void RenderStage::setSourceLoss(SourceLossPolicy policy, uint32_t timeoutMs, uint32_t fadeMs)
+{
+  m_policy = policy;
+  m_lossTimeoutMs = timeoutMs;
+  m_lossFadeMs = fadeMs;
+}
+
+void RenderStage::redirectIngest(CRGB* target)
+{
+  // Carry over universes already received for the frame in progress.
+  if (m_ingestTarget && m_ingestTarget != target) {
+    memcpy(target, m_ingestTarget, m_numLeds * sizeof(CRGB));
+  }
+  m_ingestTarget = target;
+  m_ingest->setTarget(target);
+}
+
+void RenderStage::holdOutput(uint32_t crossfadeMs)
+{
+  m_ingestParked = false;
+  redirectIngest(m_live);
+  m_resumeMs = crossfadeMs;
+  m_mode = Mode::Frozen;
+}
+
+void RenderStage::startFade(const CRGB* target, uint32_t durationMs)
+{
+  // Start from what is on the strip right now, even mid-transition.
+  memcpy(m_from, m_output, m_numLeds * sizeof(CRGB));
+  m_fadeTarget = target;
+  m_fadeMs = durationMs;
+  m_fadeStartMs = millis();
+  m_mode = Mode::Fade;
+}
+
+void RenderStage::beginSourceLoss()
+{
+  m_sourceLost = true;
+  m_losses++;
+  m_ingestParked = false;
+  redirectIngest(m_live);
+
+  const CRGB* target = nullptr;
+  if (m_policy == SourceLossPolicy::Fallback && m_fallbackLoader && m_scene) {
+    std::fill(m_scene, m_scene + m_numLeds, CRGB());
+    if (m_fallbackLoader(m_scene, m_numLeds) > 0) {
+      target = m_scene;
+    }
+  }
+  // Without a stored scene Fallback degrades to a fade to black.
+  startFade(target, m_lossFadeMs);
+}
+
+void RenderStage::compose(uint8_t amount)
+{
+  if (m_fadeTarget) {
+    for (uint16_t i = 0; i < m_numLeds; ++i) {
+      m_output[i] = blend(m_from[i], m_fadeTarget[i], amount);
+    }
+  } else {
+    const uint8_t keep = 255 - amount;
+    for (uint16_t i = 0; i < m_numLeds; ++i) {
+      m_output[i] = m_from[i];
+      m_output[i].nscale8(keep);
+    }
+  }
+  m_lastRenderMs = millis();
+}
+
+bool RenderStage::render(bool force)
+{
+  const uint32_t now = millis();
+  const uint32_t elapsed = now - m_fadeStartMs;
+  if (elapsed >= m_fadeMs) {
+    if (m_fadeTarget == m_live) {
+      m_mode = Mode::Passthrough;
+      if (m_interpolate) {
+        memcpy(m_output, m_live, m_numLeds * sizeof(CRGB));
+      }
+      redirectIngest(passthroughTarget());
+    } else {
+      if (m_fadeTarget) {
+        memcpy(m_output, m_fadeTarget, m_numLeds * sizeof(CRGB));
+      } else {
+        std::fill(m_output, m_output + m_numLeds, CRGB());
+      }
+      m_resumeMs = RESUME_FADE_MS;
+      m_mode = Mode::Frozen;
+    }
+    return true;
+  }
+  if (!force && now - m_lastRenderMs < FRAME_INTERVAL_MS) {
+    return false;
+  }
+  compose(static_cast<uint8_t>((elapsed * 255) / m_fadeMs));
+  return true;
+}
+
+void RenderStage::startInterpolation()
+{
+  const size_t bytes = m_numLeds * sizeof(CRGB);
+  // Ramp from what is on the strip right now, even mid-ramp.
+  memcpy(m_prev, m_output, bytes);
+  memcpy(m_next, m_live, bytes);
+  m_interpStartUs = micros();
+  m_interpSpanUs = m_frameIntervalUs;
+  m_interpWeight = 0;
+  m_mode = Mode::Interpolate;
+}
+
+bool RenderStage::interpolate()
+{
+  const uint32_t elapsed = micros() - m_interpStartUs;
+  if (elapsed >= m_interpSpanUs) {
+    memcpy(reinterpret_cast<uint8_t*>(m_output), m_next, m_numLeds * sizeof(CRGB));
+    m_mode = Mode::Passthrough;
+    return true;
+  }
+  const uint32_t weight = (elapsed * 256) / m_interpSpanUs;
+  if (weight == m_interpWeight && !m_outputDirty) {
+    // Same step as the one on the strip.
+    return false;
+  }
+  m_interpWeight = weight;
+  lerpFrame(m_prev, m_next, reinterpret_cast<uint8_t*>(m_output),
+            m_numLeds * sizeof(CRGB), weight);
+  return true;
+}
+
+bool RenderStage::onFrameLatched(bool showNow, bool changed)
+{
+  m_lastLatchMs = millis();
+  m_sourceLost = false;
+
+  const uint32_t nowUs = micros();
+  const uint32_t intervalUs = nowUs - m_lastLatchUs;
+  m_lastLatchUs = nowUs;
+  if (intervalUs > MAX_INTERPOLATE_US) {
+    // First frame after a pause: show it as-is and measure again.
+    m_frameIntervalUs = 0;
+  } else if (m_frameIntervalUs == 0) {
+    m_frameIntervalUs = intervalUs;
+  } else {
+    m_frameIntervalUs = (m_frameIntervalUs * 3 + intervalUs) / 4;
+  }
+
+  const bool live = m_mode == Mode::Passthrough || m_mode == Mode::Interpolate;
+  if (live && !changed && m_keepAliveMs) {
+    // Same pixels as the frame already shown (or still pending): nothing to do.
+    m_unchangedFrames++;
+    return false;
+  }
+  const bool coalesced = m_outputDirty;
+  m_outputDirty = true;
+
+  switch (m_mode) {
+    case Mode::Passthrough:
+    case Mode::Interpolate:
+      if (m_interpolate) {
+        startInterpolation();
+      } else if (m_ingestParked) {
+        // The newest complete frame replaces the one still waiting for the strip.
+        memcpy(m_output, m_live, m_numLeds * sizeof(CRGB));
+      } else if (!showNow) {
+        m_ingestParked = true;
+        redirectIngest(m_live);
+      }
+      break;
+    case Mode::Frozen:
+      startFade(m_live, m_resumeMs);
+      break;
+    case Mode::Fade:
+      if (m_fadeTarget != m_live) {
+        // Input came back while fading out: turn around towards live.
+        startFade(m_live, RESUME_FADE_MS);
+      }
+      break;
+  }
+  return coalesced;
+}
+
+bool RenderStage::serviceSourceLoss()
+{
+  if (m_mode != Mode::Passthrough || m_outputDirty || m_policy == SourceLossPolicy::Hold) {
+    return false;
+  }
+  if (millis() - m_lastLatchMs < m_lossTimeoutMs) {
+    return false;
+  }
+  beginSourceLoss();
+  // The first step of the fade goes out on the next prepareOutput().
+  m_lastRenderMs = millis() - FRAME_INTERVAL_MS;
+  return true;
+}
+
+bool RenderStage::prepareOutput()
+{
+  switch (m_mode) {
+    case Mode::Passthrough:
+      if (m_outputDirty) {
+        return true;
+      }
+      return keepAliveDue();
+    case Mode::Interpolate:
+      return interpolate() || keepAliveDue();
+    case Mode::Fade:
+      return render(m_outputDirty);
+    case Mode::Frozen:
+      return keepAliveDue();
+  }
+  return false;
+}
+
+bool RenderStage::keepAliveDue()
+{
+  if (m_keepAliveMs == 0 || millis() - m_lastShowMs < m_keepAliveMs) {
+    return false;
+  }
+  if (m_ingestTarget == m_output && m_ingest->frameChangePending()) {
+    // Part of a new frame is already in the output buffer; the refresh waits
+    // for it to latch instead of showing it half-written.
+    return false;
+  }
+  m_refreshing = true;
+  return true;
+}
+
+void RenderStage::outputShown()
+{
+  m_lastShowMs = millis();
+  if (m_refreshing) {
+    m_refreshing = false;
+    m_keepAlives++;
+  } else {
+    m_outputFrames++;
+  }
+  m_outputDirty = false;
+  if (m_ingestParked) {
+    m_ingestParked = false;
+    redirectIngest(m_output);
+  }
+}
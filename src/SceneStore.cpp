@@ -0,0 +1,131 @@
+#include "SceneStore.h"
+
+#include "Crc32.h"
+#include "PixelCodec.h"
+
+#include <stddef.h>
+#include <vector>
+
+bool SceneStore::begin()
+{
+  m_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "scene");
+  if (!m_partition) {
+    return false;
+  }
+  m_slotCount = m_partition->size / SLOT_SIZE;
+  if (m_slotCount == 0) {
+    m_partition = nullptr;
+    return false;
+  }
+
+  m_hasScene = false;
+  for (size_t slot = 0; slot < m_slotCount; ++slot) {
+    SlotHeader header;
+    if (!readHeader(slot, header)) continue;
+    if (!m_hasScene || static_cast<int32_t>(header.sequence - m_sequence) > 0) {
+      m_hasScene = true;
+      m_currentSlot = slot;
+      m_sequence = header.sequence;
+      m_storedFrameCrc = header.frameCrc;
+      m_storedPixels = header.pixelCount;
+      m_storedBytes = header.payloadLength;
+    }
+  }
+  return true;
+}
+
+bool SceneStore::readHeader(size_t slot, SlotHeader& header) const
+{
+  if (esp_partition_read(m_partition, slot * SLOT_SIZE, &header, sizeof(header)) != ESP_OK) {
+    return false;
+  }
+  return header.magic == MAGIC &&
+         header.headerCrc == crc32(&header, offsetof(SlotHeader, headerCrc)) &&
+         header.payloadLength <= SLOT_SIZE - sizeof(SlotHeader);
+}
+
+uint16_t SceneStore::load(CRGB* pixels, uint16_t capacity)
+{
+  if (!m_partition || !m_hasScene) {
+    return 0;
+  }
+
+  SlotHeader header;
+  if (!readHeader(m_currentSlot, header)) {
+    return 0;
+  }
+  std::vector<uint8_t> payload(header.payloadLength);
+  if (esp_partition_read(m_partition, m_currentSlot * SLOT_SIZE + sizeof(SlotHeader), payload.data(), payload.size()) != ESP_OK ||
+      crc32(payload.data(), payload.size()) != header.payloadCrc) {
+    return 0;
+  }
+
+  // Decode into scratch so a scene larger than the current strip still parses.
+  std::vector<CRGB> frame(header.pixelCount);
+  if (header.encoding == ENCODING_RLE) {
+    if (!PixelCodec::decodeRle(payload.data(), payload.size(), frame.data(), frame.size())) {
+      return 0;
+    }
+  } else if (payload.size() == frame.size() * sizeof(CRGB)) {
+    memcpy(frame.data(), payload.data(), payload.size());
+  } else {
+    return 0;
+  }
+
+  const uint16_t count = std::min<uint16_t>(capacity, header.pixelCount);
+  memcpy(pixels, frame.data(), count * sizeof(CRGB));
+  return count;
+}
+
+SceneStore::SaveResult SceneStore::save(const CRGB* pixels, uint16_t count)
+{
+  if (!m_partition) {
+    return SaveResult::Unavailable;
+  }
+
+  const uint32_t frameCrc = crc32(pixels, count * sizeof(CRGB));
+  if (m_hasScene && frameCrc == m_storedFrameCrc && count == m_storedPixels) {
+    return SaveResult::Unchanged;
+  }
+
+  constexpr size_t kCapacity = SLOT_SIZE - sizeof(SlotHeader);
+  std::vector<uint8_t> payload(kCapacity);
+  SlotHeader header{};
+  header.magic = MAGIC;
+  header.sequence = m_hasScene ? m_sequence + 1 : 1;
+  header.pixelCount = count;
+  header.frameCrc = frameCrc;
+
+  const size_t rawSize = count * sizeof(CRGB);
+  const size_t rleSize = PixelCodec::encodeRle(pixels, count, payload.data(), std::min(kCapacity, rawSize));
+  if (rleSize != 0 && rleSize < rawSize) {
+    header.encoding = ENCODING_RLE;
+    payload.resize(rleSize);
+  } else if (rawSize <= kCapacity) {
+    header.encoding = ENCODING_RAW;
+    payload.assign(reinterpret_cast<const uint8_t*>(pixels), reinterpret_cast<const uint8_t*>(pixels) + rawSize);
+  } else {
+    return SaveResult::TooLarge;
+  }
+  header.payloadLength = payload.size();
+  header.payloadCrc = crc32(payload.data(), payload.size());
+  header.headerCrc = crc32(&header, offsetof(SlotHeader, headerCrc));
+
+  // Payload first, header last: a torn write never yields a valid header.
+  const size_t slot = m_hasScene ? (m_currentSlot + 1) % m_slotCount : 0;
+  const size_t base = slot * SLOT_SIZE;
+  if (esp_partition_erase_range(m_partition, base, SLOT_SIZE) != ESP_OK ||
+      esp_partition_write(m_partition, base + sizeof(SlotHeader), payload.data(), payload.size()) != ESP_OK ||
+      esp_partition_write(m_partition, base, &header, sizeof(header)) != ESP_OK) {
+    return SaveResult::Failed;
+  }
+
+  m_hasScene = true;
+  m_currentSlot = slot;
+  m_sequence = header.sequence;
+  m_storedFrameCrc = frameCrc;
+  m_storedPixels = count;
+  m_storedBytes = header.payloadLength;
+  m_saves++;
+  return SaveResult::Saved;
+}
@@ -0,0 +1,169 @@
+#include "ShowCodec.h"
+
+#include <string.h>
+
+namespace {
+
+constexpr size_t kMaxRun = 128;
+
+// Returns the payload length, or 0 when it would not fit in capacity (which
+// is also what an unchanged frame yields; callers check for that first).
+size_t encodeDelta(const uint8_t* prev, const uint8_t* cur, size_t bytes, uint8_t* out, size_t capacity)
+{
+  size_t used = 0;
+  size_t i = 0;
+  while (i < bytes) {
+    size_t skip = 0;
+    while (i + skip < bytes && skip < kMaxRun && prev[i + skip] == cur[i + skip]) {
+      ++skip;
+    }
+    if (skip) {
+      i += skip;
+      if (i == bytes) break;   // trailing unchanged bytes are implicit
+      if (used + 1 > capacity) return 0;
+      out[used++] = static_cast<uint8_t>(skip - 1);
+      continue;
+    }
+
+    // Literal stretch: stop where two unchanged bytes in a row begin, since a
+    // skip control is cheaper from there on.
+    size_t literal = 1;
+    while (i + literal < bytes && literal < kMaxRun &&
+           !(prev[i + literal] == cur[i + literal] &&
+             (i + literal + 1 == bytes || prev[i + literal + 1] == cur[i + literal + 1]))) {
+      ++literal;
+    }
+    if (used + 1 + literal > capacity) return 0;
+    out[used++] = static_cast<uint8_t>(0x80 + literal - 1);
+    for (size_t k = 0; k < literal; ++k) {
+      out[used++] = prev[i + k] ^ cur[i + k];
+    }
+    i += literal;
+  }
+  return used;
+}
+
+bool applyDelta(const uint8_t* in, size_t length, uint8_t* frame, size_t bytes)
+{
+  size_t pos = 0;
+  size_t at = 0;
+  while (pos < length) {
+    const uint8_t control = in[pos++];
+    if (control < 0x80) {
+      at += static_cast<size_t>(control) + 1;
+      if (at > bytes) return false;
+    } else {
+      const size_t literal = static_cast<size_t>(control - 0x80) + 1;
+      if (at + literal > bytes || pos + literal > length) return false;
+      for (size_t k = 0; k < literal; ++k) {
+        frame[at++] ^= in[pos++];
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+namespace ShowCodec {
+
+bool validHeader(const FileHeader& header)
+{
+  return header.magic == MAGIC && header.version == VERSION && header.pixelCount > 0 &&
+         header.pixelCount <= MAX_PIXELS;
+}
+
+bool Encoder::begin(uint16_t pixelCount, uint16_t keyInterval)
+{
+  if (pixelCount == 0 || pixelCount > MAX_PIXELS) return false;
+  m_pixelCount = pixelCount;
+  m_keyInterval = keyInterval ? keyInterval : 1;
+  m_prev.assign(pixelCount, CRGB());
+  m_havePrev = false;
+  m_sinceKey = 0;
+  m_keyFrames = 0;
+  m_deltaFrames = 0;
+  return true;
+}
+
+FileHeader Encoder::header(uint32_t frameCount, uint32_t durationMs) const
+{
+  FileHeader header{};
+  header.magic = MAGIC;
+  header.version = VERSION;
+  header.pixelCount = m_pixelCount;
+  header.keyInterval = m_keyInterval;
+  header.frameCount = frameCount;
+  header.durationMs = durationMs;
+  return header;
+}
+
+size_t Encoder::encode(const CRGB* frame, uint16_t dtMs, uint8_t* out, size_t capacity)
+{
+  if (m_pixelCount == 0 || capacity < maxRecordSize(m_pixelCount)) return 0;
+
+  const size_t bytes = static_cast<size_t>(m_pixelCount) * sizeof(CRGB);
+  const uint8_t* prev = reinterpret_cast<const uint8_t*>(m_prev.data());
+  const uint8_t* cur = reinterpret_cast<const uint8_t*>(frame);
+  uint8_t* payload = out + sizeof(RecordHeader);
+  const size_t payloadCapacity = capacity - sizeof(RecordHeader);
+
+  RecordHeader record{};
+  record.dtMs = dtMs;
+  size_t length = 0;
+  bool delta = false;
+
+  if (m_havePrev && m_sinceKey < m_keyInterval) {
+    if (memcmp(prev, cur, bytes) == 0) {
+      delta = true;
+    } else {
+      // A delta is only worth it while it beats the worst-case key.
+      length = encodeDelta(prev, cur, bytes, payload, payloadCapacity);
+      delta = length != 0;
+    }
+  }
+  if (!delta) {
+    length = PixelCodec::encodeRle(frame, m_pixelCount, payload, payloadCapacity);
+    if (length == 0) return 0;
+  }
+
+  record.type = static_cast<uint8_t>(delta ? RecordType::Delta : RecordType::Key);
+  record.length = static_cast<uint16_t>(length);
+  memcpy(out, &record, sizeof(record));
+
+  memcpy(m_prev.data(), frame, bytes);
+  m_havePrev = true;
+  if (delta) {
+    m_sinceKey++;
+    m_deltaFrames++;
+  } else {
+    m_sinceKey = 1;
+    m_keyFrames++;
+  }
+  return sizeof(RecordHeader) + length;
+}
+
+bool Decoder::begin(const FileHeader& header)
+{
+  if (!validHeader(header)) return false;
+  m_pixelCount = header.pixelCount;
+  m_haveKey = false;
+  return true;
+}
+
+bool Decoder::apply(const RecordHeader& record, const uint8_t* payload, CRGB* frame)
+{
+  switch (static_cast<RecordType>(record.type)) {
+    case RecordType::Key:
+      if (!PixelCodec::decodeRle(payload, record.length, frame, m_pixelCount)) return false;
+      m_haveKey = true;
+      return true;
+    case RecordType::Delta:
+      if (!m_haveKey) return false;
+      return applyDelta(payload, record.length, reinterpret_cast<uint8_t*>(frame),
+                        static_cast<size_t>(m_pixelCount) * sizeof(CRGB));
+  }
+  return false;
+}
+
+}  // namespace ShowCodec
@@ -0,0 +1,379 @@
+#include "ShowRecorder.h"
+
+#include <LittleFS.h>
+#include <algorithm>
+
+namespace {
+constexpr char kShowPath[] = "/show.pxr";
+// Seek index written by finishRecording().
+constexpr char kIndexPath[] = "/show.idx";
+constexpr uint32_t kIndexMagic = 0x58444950;   // "PIDX"
+// Records decoded per servicePlayback() call when catching up after a stall.
+constexpr uint16_t kMaxCatchUp = 64;
+// Record headers read per servicePlayback() call while scanning for the index.
+constexpr uint16_t kScanPerCall = 16;
+
+// Ties the stored index to the show it was written for.
+struct __attribute__((packed)) IndexHeader {
+  uint32_t magic;
+  uint32_t showBytes;
+  uint32_t frameCount;
+  uint8_t  count;
+  uint8_t  reserved[3];
+};
+}  // namespace
+
+bool ShowRecorder::begin()
+{
+  m_mounted = LittleFS.begin(false);
+  if (!m_mounted || !LittleFS.exists(kShowPath)) return m_mounted;
+
+  File file = LittleFS.open(kShowPath, "r");
+  ShowCodec::FileHeader header;
+  if (file && readHeader(file, header)) {
+    m_hasShow = true;
+    m_pixelCount = header.pixelCount;
+    m_frames = header.frameCount;
+    m_durationMs = header.durationMs;
+    m_bytes = file.size();
+  }
+  file.close();
+  return true;
+}
+
+bool ShowRecorder::readHeader(File& file, ShowCodec::FileHeader& header)
+{
+  return file.read(reinterpret_cast<uint8_t*>(&header), sizeof(header)) == sizeof(header) &&
+         ShowCodec::validHeader(header);
+}
+
+void ShowRecorder::fail(const char* error)
+{
+  m_error = error;
+  if (m_log) m_log->logText(LogRing::Level::Error, LogRing::Tag::Show, "%s", error);
+}
+
+bool ShowRecorder::startRecording(uint16_t pixelCount)
+{
+  stop();
+  if (!m_mounted) {
+    // First use: format the partition once instead of at every boot.
+    m_mounted = LittleFS.begin(true);
+    if (!m_mounted) {
+      fail("No se pudo montar LittleFS");
+      return false;
+    }
+  }
+  if (!m_encoder.begin(pixelCount, KEY_INTERVAL)) {
+    fail("Cantidad de LEDs no soportada");
+    return false;
+  }
+
+  LittleFS.remove(kShowPath);
+  LittleFS.remove(kIndexPath);
+  m_file = LittleFS.open(kShowPath, "w");
+  if (!m_file) {
+    fail("No se pudo crear el archivo del show");
+    return false;
+  }
+  const ShowCodec::FileHeader header = m_encoder.header(0, 0);
+  m_file.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+
+  const size_t total = LittleFS.totalBytes();
+  const size_t used = LittleFS.usedBytes();
+  m_budget = total > used + FREE_MARGIN ? total - used - FREE_MARGIN : 0;
+
+  std::vector<CRGB>().swap(m_frame);
+  m_record.assign(ShowCodec::maxRecordSize(pixelCount), 0);
+  m_pixelCount = pixelCount;
+  m_frames = 0;
+  m_durationMs = 0;
+  m_bytes = sizeof(header);
+  m_hasShow = false;
+  m_error = "";
+  clearSeekIndex();
+  m_state = State::Recording;
+  if (m_log) {
+    m_log->log(LogRing::Level::Info, LogRing::Tag::Show, "Grabando %u LEDs (%u KB libres)", pixelCount,
+               m_budget / 1024);
+  }
+  return true;
+}
+
+void ShowRecorder::recordFrame(const CRGB* frame, bool changed)
+{
+  if (m_state != State::Recording) return;
+  if (m_frames > 0 && !changed) return;
+
+  const uint32_t now = millis();
+  const uint32_t dt = m_frames ? std::min<uint32_t>(now - m_lastRecordMs, 0xFFFF) : 0;
+  const size_t length = m_encoder.encode(frame, static_cast<uint16_t>(dt), m_record.data(), m_record.size());
+  if (length == 0 || m_bytes + length > m_budget) {
+    finishRecording();
+    fail(length == 0 ? "Error al codificar el frame" : "Sin espacio: grabación detenida");
+    return;
+  }
+  if (m_file.write(m_record.data(), length) != length) {
+    finishRecording();
+    fail("Error de escritura en flash");
+    return;
+  }
+  ShowCodec::RecordHeader record;
+  memcpy(&record, m_record.data(), sizeof(record));
+  if (record.type == static_cast<uint8_t>(ShowCodec::RecordType::Key)) {
+    addSeekPoint(m_bytes, m_durationMs);
+  }
+  m_lastRecordMs = now;
+  m_frames++;
+  m_durationMs += dt;
+  m_bytes += length;
+}
+
+void ShowRecorder::finishRecording()
+{
+  const ShowCodec::FileHeader header = m_encoder.header(m_frames, m_durationMs);
+  m_file.seek(0);
+  m_file.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+  m_file.close();
+  std::vector<uint8_t>().swap(m_record);
+  m_hasShow = m_frames > 0;
+  m_state = State::Idle;
+  if (m_hasShow) saveSeekIndex();
+  if (m_log) {
+    m_log->log(LogRing::Level::Info, LogRing::Tag::Show, "Grabación terminada: %u frames, %u ms, %u bytes (%u claves)",
+               m_frames, m_durationMs, m_bytes, m_encoder.keyFrames());
+  }
+}
+
+bool ShowRecorder::startPlayback(bool loop)
+{
+  stop();
+  if (!m_mounted || !m_hasShow) {
+    fail("No hay show grabado");
+    return false;
+  }
+  m_file = LittleFS.open(kShowPath, "r");
+  ShowCodec::FileHeader header;
+  if (!m_file || !readHeader(m_file, header) || !m_decoder.begin(header)) {
+    m_file.close();
+    fail("Archivo de show inválido");
+    return false;
+  }
+
+  m_pixelCount = header.pixelCount;
+  m_frame.assign(m_pixelCount, CRGB());
+  m_record.assign(ShowCodec::maxRecordSize(m_pixelCount), 0);
+  m_loop = loop;
+  m_played = 0;
+  m_loops = 0;
+  m_error = "";
+  if (!loadSeekIndex()) {
+    clearSeekIndex();
+    m_scanOffset = sizeof(ShowCodec::FileHeader);
+    m_scanMs = 0;
+  }
+  m_recordMs = 0;
+  m_baseShowMs = 0;
+  m_baseLocalMs = millis();
+  m_rate = 1000;
+  m_state = State::Playing;
+  if (!readRecord()) {
+    stop();
+    fail("El show está vacío");
+    return false;
+  }
+  return true;
+}
+
+uint32_t ShowRecorder::positionMs() const
+{
+  const uint64_t elapsed = static_cast<uint64_t>(millis() - m_baseLocalMs) * m_rate / 1000;
+  return m_baseShowMs + static_cast<uint32_t>(elapsed);
+}
+
+void ShowRecorder::setRate(uint16_t permille)
+{
+  if (permille == m_rate) return;
+  m_baseShowMs = positionMs();
+  m_baseLocalMs = millis();
+  m_rate = permille;
+}
+
+// Reads the next record into m_record, wrapping to the first one when looping.
+bool ShowRecorder::readRecord()
+{
+  ShowCodec::RecordHeader record;
+  if (m_file.read(reinterpret_cast<uint8_t*>(&record), sizeof(record)) != sizeof(record)) {
+    if (!m_loop || m_played == 0) return false;
+    m_file.seek(sizeof(ShowCodec::FileHeader));
+    m_decoder.rewind();
+    m_loops++;
+    if (m_file.read(reinterpret_cast<uint8_t*>(&record), sizeof(record)) != sizeof(record)) return false;
+    // The first record has no delay of its own: hold the last frame as long
+    // as the one before it.
+    record.dtMs = m_lastDtMs;
+  }
+  if (sizeof(record) + record.length > m_record.size()) return false;
+  m_recordMs += record.dtMs;
+  m_lastDtMs = record.dtMs;
+  memcpy(m_record.data(), &record, sizeof(record));
+  return m_file.read(m_record.data() + sizeof(record), record.length) == record.length;
+}
+
+bool ShowRecorder::servicePlayback()
+{
+  if (m_state != State::Playing) return false;
+  if (!m_seekIndexBuilt) scanSeekIndex();
+
+  // Every due record is decoded (deltas build on each other); only the last
+  // one needs to reach the strip.
+  const uint32_t position = positionMs();
+  bool decoded = false;
+  for (uint16_t i = 0; i < kMaxCatchUp && m_state == State::Playing; ++i) {
+    if (static_cast<int32_t>(position - m_recordMs) < 0) break;
+
+    ShowCodec::RecordHeader record;
+    memcpy(&record, m_record.data(), sizeof(record));
+    if (!m_decoder.apply(record, m_record.data() + sizeof(record), m_frame.data())) {
+      stop();
+      fail("Show dañado: reproducción detenida");
+      return false;
+    }
+    decoded = true;
+    m_played++;
+    if (!readRecord()) {
+      // Keep the last frame on the strip and go idle.
+      m_file.close();
+      m_state = State::Idle;
+    }
+  }
+  return decoded;
+}
+
+void ShowRecorder::clearSeekIndex()
+{
+  m_seekPointCount = 0;
+  m_seekStride = 1;
+  m_seekKeys = 0;
+  m_seekIndexBuilt = false;
+}
+
+void ShowRecorder::addSeekPoint(uint32_t offset, uint32_t baseMs)
+{
+  if (m_seekKeys++ % m_seekStride != 0) return;
+  if (m_seekPointCount == MAX_SEEK_POINTS) {
+    // Full: keep every other point and halve the density from now on.
+    for (uint8_t i = 0; i < MAX_SEEK_POINTS / 2; ++i) m_seekPoints[i] = m_seekPoints[i * 2];
+    m_seekPointCount = MAX_SEEK_POINTS / 2;
+    m_seekStride *= 2;
+  }
+  m_seekPoints[m_seekPointCount++] = {offset, baseMs};
+}
+
+void ShowRecorder::saveSeekIndex()
+{
+  File file = LittleFS.open(kIndexPath, "w");
+  if (!file) return;
+  const IndexHeader header = {kIndexMagic, m_bytes, m_frames, m_seekPointCount, {}};
+  const size_t points = m_seekPointCount * sizeof(SeekPoint);
+  const bool ok = file.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header)) == sizeof(header) &&
+                  file.write(reinterpret_cast<const uint8_t*>(m_seekPoints), points) == points;
+  file.close();
+  // Without a complete index playback scans for one.
+  if (!ok) LittleFS.remove(kIndexPath);
+}
+
+bool ShowRecorder::loadSeekIndex()
+{
+  clearSeekIndex();
+  File file = LittleFS.open(kIndexPath, "r");
+  if (!file) return false;
+  IndexHeader header;
+  bool ok = file.read(reinterpret_cast<uint8_t*>(&header), sizeof(header)) == sizeof(header) &&
+            header.magic == kIndexMagic && header.showBytes == m_file.size() && header.frameCount == m_frames &&
+            header.count > 0 && header.count <= MAX_SEEK_POINTS;
+  if (ok) {
+    const size_t points = header.count * sizeof(SeekPoint);
+    ok = file.read(reinterpret_cast<uint8_t*>(m_seekPoints), points) == points;
+  }
+  file.close();
+  m_seekPointCount = ok ? header.count : 0;
+  m_seekIndexBuilt = ok;
+  return ok;
+}
+
+// Reads a few record headers past the last one scanned, then puts the file
+// back where playback left it.
+void ShowRecorder::scanSeekIndex()
+{
+  const uint32_t resume = m_file.position();
+  ShowCodec::RecordHeader record;
+  uint16_t scanned = 0;
+  m_file.seek(m_scanOffset);
+  while (scanned++ < kScanPerCall) {
+    if (m_file.read(reinterpret_cast<uint8_t*>(&record), sizeof(record)) != sizeof(record)) {
+      m_seekIndexBuilt = true;
+      break;
+    }
+    if (record.type == static_cast<uint8_t>(ShowCodec::RecordType::Key)) {
+      addSeekPoint(m_scanOffset, m_scanMs);
+    }
+    m_scanMs += record.dtMs;
+    m_scanOffset += sizeof(record) + record.length;
+    if (!m_file.seek(m_scanOffset)) {
+      m_seekIndexBuilt = true;
+      break;
+    }
+  }
+  m_file.seek(resume);
+}
+
+bool ShowRecorder::seek(uint32_t showMs)
+{
+  if (m_state != State::Playing) return false;
+  // The part of the show not scanned yet may hold a closer key frame.
+  if (!m_seekIndexBuilt && showMs >= m_scanMs) return false;
+  if (m_seekPointCount == 0) return false;
+
+  uint8_t point = 0;
+  while (point + 1 < m_seekPointCount && m_seekPoints[point + 1].baseMs < showMs) ++point;
+
+  m_file.seek(m_seekPoints[point].offset);
+  m_decoder.rewind();
+  m_recordMs = m_seekPoints[point].baseMs;
+  if (!readRecord()) {
+    stop();
+    fail("Show dañado: reproducción detenida");
+    return false;
+  }
+  m_baseShowMs = showMs;
+  m_baseLocalMs = millis();
+  // Decode from the key frame up to the frame due at showMs.
+  while (m_state == State::Playing && static_cast<int32_t>(showMs - m_recordMs) >= 0) {
+    servicePlayback();
+  }
+  return true;
+}
+
+void ShowRecorder::stop()
+{
+  if (m_state == State::Recording) {
+    finishRecording();
+  } else if (m_state == State::Playing) {
+    m_file.close();
+    m_state = State::Idle;
+  }
+  std::vector<uint8_t>().swap(m_record);
+}
+
+bool ShowRecorder::remove()
+{
+  stop();
+  std::vector<CRGB>().swap(m_frame);
+  m_hasShow = false;
+  m_frames = 0;
+  m_durationMs = 0;
+  m_bytes = 0;
+  if (m_mounted) LittleFS.remove(kIndexPath);
+  return m_mounted && LittleFS.remove(kShowPath);
+}
@@ -0,0 +1,124 @@
+#include "TaskScheduler.h"
+
+#include <Arduino.h>
+
+bool TaskScheduler::add(const char* name, TaskFn fn, uint8_t priority, uint32_t periodUs, uint32_t budgetUs)
+{
+  if (m_count >= MAX_TASKS || !fn) {
+    return false;
+  }
+  // Kept sorted by priority, so a pass walks the table once.
+  uint8_t index = m_count;
+  while (index > 0 && m_tasks[index - 1].priority > priority) {
+    m_tasks[index] = m_tasks[index - 1];
+    --index;
+  }
+  Task& task = m_tasks[index];
+  task = Task();
+  task.name = name;
+  task.fn = fn;
+  task.priority = priority;
+  task.periodUs = periodUs;
+  task.budgetUs = budgetUs;
+  m_count++;
+  if (priority == 0) {
+    m_urgentCount++;
+  }
+  return true;
+}
+
+bool TaskScheduler::due(const Task& task, uint32_t nowUs) const
+{
+  return !task.started || task.periodUs == 0 || static_cast<int32_t>(nowUs - task.dueUs) >= 0;
+}
+
+void TaskScheduler::run(Task& task)
+{
+  const uint32_t startUs = micros();
+  if (task.started) {
+    const int32_t late = static_cast<int32_t>(startUs - task.dueUs);
+    if (late > 0 && static_cast<uint32_t>(late) > task.stats.maxLatencyUs) {
+      task.stats.maxLatencyUs = static_cast<uint32_t>(late);
+    }
+  }
+
+  task.fn();
+
+  const uint32_t endUs = micros();
+  const uint32_t elapsed = endUs - startUs;
+  task.stats.runs++;
+  task.stats.lastRunUs = elapsed;
+  if (elapsed > task.stats.maxRunUs) task.stats.maxRunUs = elapsed;
+  if (task.budgetUs && elapsed > task.budgetUs) task.stats.overruns++;
+  task.windowUs += elapsed;
+
+  if (task.periodUs == 0) {
+    task.dueUs = endUs;
+  } else if (!task.started || static_cast<int32_t>(endUs - (task.dueUs + task.periodUs)) >= 0) {
+    // A whole period behind: start over from now instead of running a burst.
+    task.dueUs = startUs + task.periodUs;
+  } else {
+    task.dueUs += task.periodUs;
+  }
+  task.started = true;
+}
+
+void TaskScheduler::runUrgent()
+{
+  for (uint8_t i = 0; i < m_urgentCount; ++i) {
+    if (due(m_tasks[i], micros())) {
+      run(m_tasks[i]);
+    }
+  }
+}
+
+void TaskScheduler::runPass()
+{
+  m_passes++;
+  runUrgent();
+  bool ranOne = false;
+  for (uint8_t i = m_urgentCount; i < m_count; ++i) {
+    if (!due(m_tasks[i], micros())) {
+      continue;
+    }
+    if (ranOne) {
+      runUrgent();
+    }
+    run(m_tasks[i]);
+    ranOne = true;
+  }
+  closeWindow(micros());
+}
+
+void TaskScheduler::closeWindow(uint32_t nowUs)
+{
+  if (!m_windowStarted) {
+    m_windowStartUs = nowUs;
+    m_windowStarted = true;
+    return;
+  }
+  const uint32_t length = nowUs - m_windowStartUs;
+  if (length < WINDOW_US) {
+    return;
+  }
+  uint32_t busy = 0;
+  for (uint8_t i = 0; i < m_count; ++i) {
+    Task& task = m_tasks[i];
+    busy += task.windowUs;
+    task.stats.cpuPermille = static_cast<uint16_t>((static_cast<uint64_t>(task.windowUs) * 1000) / length);
+    task.windowUs = 0;
+  }
+  m_idlePermille = busy < length ? static_cast<uint16_t>((static_cast<uint64_t>(length - busy) * 1000) / length) : 0;
+  m_windowStartUs = nowUs;
+}
+
+void TaskScheduler::resetStats()
+{
+  for (uint8_t i = 0; i < m_count; ++i) {
+    m_tasks[i].stats = Stats();
+    m_tasks[i].windowUs = 0;
+  }
+  m_passes = 0;
+  m_idlePermille = 1000;
+  m_windowStarted = false;
+}
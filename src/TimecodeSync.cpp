@@ -0,0 +1,92 @@
+#include "TimecodeSync.h"
+
+#include <algorithm>
+
+namespace {
+
+// Timecode arrives once per frame (24-30 fps); a longer gap is a dropout
+// being bridged.
+constexpr uint32_t kFrameGapMs = 100;
+
+}  // namespace
+
+void TimecodeSync::setEnabled(bool enabled)
+{
+  m_enabled = enabled;
+  if (!enabled) {
+    m_hasTimecode = false;
+    m_locked = false;
+    m_freewheel = false;
+  }
+}
+
+void TimecodeSync::onTimeCode(uint32_t timecodeMs, uint32_t nowMs)
+{
+  if (!m_enabled) return;
+  m_rxTimecodeMs = timecodeMs;
+  m_rxLocalMs = nowMs;
+  m_hasTimecode = true;
+  m_received++;
+}
+
+bool TimecodeSync::service(ShowRecorder& recorder, uint32_t nowMs)
+{
+  if (!m_enabled || !m_hasTimecode) return false;
+
+  const uint32_t sinceRx = nowMs - m_rxLocalMs;
+  const bool playing = recorder.state() == ShowRecorder::State::Playing;
+  if (sinceRx > FREEWHEEL_MS) {
+    // The clock is gone: stop on the current frame until it comes back.
+    m_hasTimecode = false;
+    m_freewheel = false;
+    if (m_locked) {
+      m_locked = false;
+      m_dropouts++;
+      if (playing) recorder.stop();
+    }
+    return false;
+  }
+  // Between packets (one per frame) and through short dropouts the clock runs
+  // on locally.
+  m_freewheel = sinceRx > kFrameGapMs;
+  m_timecodeMs = m_rxTimecodeMs + sinceRx;
+
+  if (!recorder.hasShow() || m_timecodeMs < m_startMs) {
+    if (m_locked && playing) recorder.stop();
+    m_locked = false;
+    return false;
+  }
+  const uint32_t target = m_timecodeMs - m_startMs;
+  if (target >= recorder.showDurationMs()) {
+    // Past the end: the recorder finishes the last frames on its own.
+    m_locked = false;
+    return false;
+  }
+
+  if (m_locked && !playing) {
+    // Stopped from the UI or ran out a little early: stay put until the
+    // clock leaves the show or drops out.
+    return false;
+  }
+  if (!m_locked) {
+    if (!playing && !recorder.startPlayback(false)) return false;
+    m_locked = true;
+    m_rate = 1000;
+    recorder.setRate(m_rate);
+    m_seeks++;
+    return recorder.seek(target);
+  }
+
+  m_errorMs = static_cast<int32_t>(target - recorder.positionMs());
+  if (static_cast<uint32_t>(abs(m_errorMs)) > SEEK_THRESHOLD_MS) {
+    m_rate = 1000;
+    recorder.setRate(m_rate);
+    m_seeks++;
+    return recorder.seek(target);
+  }
+  // Proportional: N ms behind runs N/1000 faster, closing the gap in about a
+  // second.
+  m_rate = static_cast<uint16_t>(1000 + std::max(-MAX_RATE_ADJUST, std::min(MAX_RATE_ADJUST, m_errorMs)));
+  recorder.setRate(m_rate);
+  return false;
+}
@@ -3,11 +3,28 @@
 #include <ETH.h>
 #include <WiFiUdp.h>
 #include "ArtNetNode.h"
+#include "ClockSync.h"
+#include "ConfigStore.h"
+#include "FrameIngest.h"
+#include "FastLedBackend.h"
+#include "FrameJitterBuffer.h"
+#include "FramePacer.h"
+#include "LedOutputs.h"
+#include "LogRing.h"
+#include "MemoryArena.h"
+#include "MemoryPlan.h"
+#include "PowerLimiter.h"
+#include "RenderStage.h"
+#include "SceneStore.h"
+#include "ShowRecorder.h"
+#include "TaskScheduler.h"
+#include "TimecodeSync.h"
 #include <FastLED.h>
 #include <Preferences.h>
 #include <WebServer.h>
 #include <Update.h>
 #include <algorithm>
+#include <stdarg.h>
 #include <vector>
 
 // ===================== CONFIG RED (IP FIJA - FALLBACK) =====================
@@ -33,7 +50,10 @@ const char* const  DEFAULT_WIFI_STA_PASSWORD  = "";
 const char* const  DEFAULT_WIFI_AP_SSID       = "PixelEtherLED";
 const char* const  DEFAULT_WIFI_AP_PASSWORD   = "";
 constexpr uint8_t  DEFAULT_ARTNET_INPUT       = static_cast<uint8_t>(ArtNetNode::InterfacePreference::Ethernet);
+constexpr bool     DEFAULT_WIFI_STANDBY       = false;   // Wi-Fi en espera activa detrás de Ethernet
 constexpr const char* DEVICE_HOSTNAME         = "esp32-artnet";
+const char* const  DEFAULT_SHORT_NAME         = "PixelEtherLED";             // ArtPollReply, 17 caracteres
+const char* const  DEFAULT_LONG_NAME          = "PixelEtherLED Controller";  // 63 caracteres
 const uint32_t DEFAULT_STATIC_IP         = static_cast<uint32_t>(STATIC_IP);
 const uint32_t DEFAULT_STATIC_GW         = static_cast<uint32_t>(STATIC_GW);
 const uint32_t DEFAULT_STATIC_MASK       = static_cast<uint32_t>(STATIC_MASK);
@@ -41,29 +61,23 @@ const uint32_t DEFAULT_STATIC_DNS1       = static_cast<uint32_t>(STATIC_DNS1);
 const uint32_t DEFAULT_STATIC_DNS2       = static_cast<uint32_t>(STATIC_DNS2);
 
 // ===================== LEDS =====================
-constexpr uint8_t LED_DATA_PIN        = 2;
-constexpr uint16_t MAX_LEDS             = 1024;
+constexpr uint16_t MAX_LEDS             = 4096;             // tope; el real lo fija el plan de memoria
+constexpr size_t   MEMORY_ARENA_BYTES   = 48 * 1024;        // buffers por configuración (ver MemoryPlan)
+constexpr uint16_t VISUALIZER_MAX_LEDS  = 1024;             // el JSON del visualizador crece 30 B por LED
+constexpr BaseType_t OUTPUT_TASK_CORE    = 0;                // loop() corre en el núcleo 1
 constexpr uint16_t DEFAULT_NUM_LEDS     = 60;
 constexpr uint16_t DEFAULT_START_UNIVERSE = 0;
 constexpr uint16_t DEFAULT_PIXELS_PER_UNIVERSE = 170;      // 512/3
 constexpr uint8_t  DEFAULT_BRIGHTNESS   = 255;
 constexpr uint32_t DEFAULT_DHCP_TIMEOUT = 3000;             // ms
-
-enum class LedChipType : uint8_t {
-  WS2811 = 0,
-  WS2812B,
-  SK6812,
-  CHIP_TYPE_COUNT
-};
-
-enum class LedColorOrder : uint8_t {
-  RGB = 0,
-  RBG,
-  GRB,
-  GBR,
-  BRG,
-  BGR,
-  COLOR_ORDER_COUNT
+constexpr uint8_t  DEFAULT_OUTPUT_COUNT = 1;                // salidas paralelas en uso
+
+// Escena de arranque: qué se muestra desde flash antes de que llegue Art-Net.
+enum class BootSceneMode : uint8_t {
+  Off = 0,
+  LastFrame,      // último frame recibido, guardado automáticamente
+  Pinned,         // escena fija, sólo se guarda con el botón de la web
+  BOOT_SCENE_MODE_COUNT
 };
 
 constexpr uint8_t DEFAULT_CHIP_TYPE   = static_cast<uint8_t>(LedChipType::WS2811);
@@ -75,6 +89,101 @@ const char* const CHIP_TYPE_NAMES[] = {
   "SK6812"
 };
 
+constexpr uint8_t  DEFAULT_BOOT_SCENE          = static_cast<uint8_t>(BootSceneMode::LastFrame);
+constexpr uint32_t BOOT_SCENE_CROSSFADE_MS     = 1000;
+constexpr uint32_t SCENE_MIN_SAVE_INTERVAL_MS  = 60000;    // límite de escrituras en flash
+constexpr uint32_t SCENE_LIVE_SAVE_INTERVAL_MS = 300000;   // con show continuo
+constexpr uint32_t SCENE_IDLE_MS               = 2000;     // sin frames → guardar ya
+
+constexpr uint8_t  DEFAULT_SOURCE_LOSS_POLICY  = static_cast<uint8_t>(RenderStage::SourceLossPolicy::Hold);
+constexpr uint32_t DEFAULT_SOURCE_LOSS_TIMEOUT = 3000;     // ms sin frames
+constexpr uint32_t DEFAULT_SOURCE_LOSS_FADE    = 2000;     // ms
+
+constexpr uint8_t  DEFAULT_MERGE_MODE          = static_cast<uint8_t>(FrameIngest::MergeMode::Htp);
+constexpr uint16_t DEFAULT_MAX_FPS             = 0;        // 0 = lo que permita la tira
+constexpr bool     DEFAULT_INTERPOLATE         = false;
+constexpr uint32_t DEFAULT_POWER_LIMIT_MA      = 0;        // 0 = sin límite
+constexpr uint32_t MAX_POWER_LIMIT_MA          = 200000;
+constexpr uint16_t DEFAULT_KEEP_ALIVE_MS       = 1000;     // 0 = enviar todos los frames
+constexpr bool     DEFAULT_TIMECODE_SYNC       = false;
+constexpr uint32_t DEFAULT_TIMECODE_START_MS   = 0;        // 00:00:00.000
+constexpr uint32_t MAX_TIMECODE_MS             = 24UL * 3600UL * 1000UL - 1;
+constexpr uint8_t  DEFAULT_CLOCK_ROLE          = static_cast<uint8_t>(ClockSync::Role::Off);
+constexpr uint32_t DEFAULT_CLOCK_MASTER_IP     = 0;        // 0 = buscar por broadcast
+constexpr uint16_t DEFAULT_PRESENT_DELAY_MS    = 20;
+constexpr uint16_t MAX_PRESENT_DELAY_MS        = 500;
+constexpr uint16_t DEFAULT_JITTER_LATENCY_MS   = 0;        // 0 = sin buffer de jitter
+constexpr uint8_t  DEFAULT_LOG_LEVEL           = static_cast<uint8_t>(LogRing::Level::Info);
+constexpr uint32_t DEFAULT_SYSLOG_IP           = 0;        // 0 = sin syslog
+constexpr uint16_t DEFAULT_SYSLOG_PORT         = 514;
+constexpr uint8_t  LOG_DRAIN_PER_PASS          = 8;        // registros por pasada de mantenimiento
+constexpr size_t   SERIAL_TX_BUFFER            = 1024;     // la UART nunca hace esperar a loop()
+// Tareas de loop(): período (0 = cada pasada) y presupuesto, en us.
+constexpr uint32_t TASK_INGEST_BUDGET_US       = 500;
+constexpr uint32_t TASK_RENDER_BUDGET_US       = 2000;
+constexpr uint32_t TASK_TIMERS_PERIOD_US       = 10000;
+constexpr uint32_t TASK_TIMERS_BUDGET_US       = 500;
+constexpr uint32_t TASK_WEB_PERIOD_US          = 2000;
+constexpr uint32_t TASK_WEB_BUDGET_US          = 20000;
+constexpr uint32_t TASK_HOUSEKEEPING_PERIOD_US = 10000;
+constexpr uint32_t TASK_HOUSEKEEPING_BUDGET_US = 5000;
+
+const char* const LOG_LEVEL_NAMES[] = {
+  "Errores",
+  "Advertencias",
+  "Información",
+  "Depuración (cada paquete DMX)"
+};
+
+const char* const CLOCK_ROLE_NAMES[] = {
+  "Desactivada",
+  "Maestro (marca el tiempo)",
+  "Esclavo (sigue al maestro)"
+};
+
+// De qué interfaz acepta ArtDmx cada salida (ver ArtNetNode::SourceFilter).
+enum class OutputSource : uint8_t {
+  Any = 0,
+  Ethernet,
+  WiFi,
+  SOURCE_COUNT
+};
+
+const char* const OUTPUT_SOURCE_NAMES[] = {
+  "Cualquier interfaz",
+  "Sólo Ethernet",
+  "Sólo Wi-Fi"
+};
+
+const uint8_t OUTPUT_SOURCE_INTERFACES[] = {
+  ArtNetNode::ANY_INTERFACE,
+  ArtNetNode::ETHERNET_ONLY,
+  ArtNetNode::WIFI_ONLY
+};
+
+const char* const ARTNET_INTERFACE_NAMES[] = {
+  "Ethernet",
+  "Wi-Fi",
+  "Wi-Fi (AP)"
+};
+
+const char* const MERGE_MODE_NAMES[] = {
+  "HTP (el valor más alto)",
+  "LTP (el último paquete)"
+};
+
+const char* const SOURCE_LOSS_POLICY_NAMES[] = {
+  "Mantener último frame",
+  "Fundido a negro",
+  "Escena guardada"
+};
+
+const char* const BOOT_SCENE_NAMES[] = {
+  "Apagada",
+  "Último frame recibido",
+  "Escena fija"
+};
+
 const char* const COLOR_ORDER_NAMES[] = {
   "RGB",
   "RBG",
@@ -84,7 +193,16 @@ const char* const COLOR_ORDER_NAMES[] = {
   "BGR"
 };
 
-CRGB leds[MAX_LEDS];
+CRGB* leds = nullptr;   // en el arena; applyConfig() lo reubica
+
+// Salidas 2..N; la salida 1 usa los campos de siempre (numLeds, chipType...).
+struct ExtraOutputConfig {
+  uint16_t ledCount;
+  uint16_t startUniverse;
+  uint8_t  chipType;
+  uint8_t  colorOrder;
+  uint32_t powerLimitMa;   // fuente propia de la salida; 0 = sin límite
+};
 
 struct AppConfig {
   uint32_t dhcpTimeoutMs;
@@ -104,25 +222,148 @@ struct AppConfig {
   bool     wifiEnabled;
   bool     wifiApMode;
   uint8_t  artnetInput;
+  bool     wifiStandby;
+  uint8_t  bootScene;
+  uint8_t  sourceLossPolicy;
+  uint32_t sourceLossTimeoutMs;
+  uint32_t sourceLossFadeMs;
+  uint8_t  mergeMode;
+  uint16_t maxFps;
+  bool     interpolate;
+  uint32_t powerLimitMa;
+  uint16_t keepAliveMs;
+  bool     timecodeSync;
+  uint32_t timecodeStartMs;
+  uint8_t  clockRole;
+  uint32_t clockMasterIp;
+  uint16_t presentDelayMs;
+  uint16_t jitterLatencyMs;
+  uint8_t  logLevel;
+  uint32_t syslogIp;
+  uint16_t syslogPort;
+  uint8_t  outputCount;
+  uint8_t  outputPins[LedOutputs::MAX_OUTPUTS];
+  uint8_t  outputSources[LedOutputs::MAX_OUTPUTS];
+  ExtraOutputConfig extraOutputs[LedOutputs::MAX_OUTPUTS - 1];
   String   wifiStaSsid;
   String   wifiStaPassword;
   String   wifiApSsid;
   String   wifiApPassword;
+  String   shortName;
+  String   longName;
+};
+
+struct PersistedOutput {
+  uint16_t ledCount;
+  uint16_t startUniverse;
+  uint8_t  chipType;
+  uint8_t  colorOrder;
+  uint8_t  reserved[2];
 };
 
+// Disposición binaria de AppConfig en NVS (una sola clave, ver ConfigStore).
+// Sólo se agregan campos al final; subir CONFIG_BLOB_VERSION al hacerlo.
+struct PersistedConfig {
+  uint32_t dhcpTimeoutMs;
+  uint32_t staticIp;
+  uint32_t staticGateway;
+  uint32_t staticSubnet;
+  uint32_t staticDns1;
+  uint32_t staticDns2;
+  uint16_t numLeds;
+  uint16_t startUniverse;
+  uint16_t pixelsPerUniverse;
+  uint8_t  brightness;
+  uint8_t  chipType;
+  uint8_t  colorOrder;
+  uint8_t  useDhcp;
+  uint8_t  fallbackToStatic;
+  uint8_t  wifiEnabled;
+  uint8_t  wifiApMode;
+  uint8_t  artnetInput;
+  char     wifiStaSsid[33];
+  char     wifiStaPassword[65];
+  char     wifiApSsid[33];
+  char     wifiApPassword[65];
+  uint8_t  reserved[2];
+  // v2
+  uint8_t  bootScene;
+  uint8_t  reservedV2[3];
+  // v3
+  uint32_t sourceLossTimeoutMs;
+  uint32_t sourceLossFadeMs;
+  uint8_t  sourceLossPolicy;
+  uint8_t  reservedV3[3];
+  // v4
+  uint8_t  mergeMode;
+  uint8_t  reservedV4[3];
+  // v5
+  uint16_t maxFps;
+  uint8_t  reservedV5[2];
+  // v6
+  uint8_t  interpolate;
+  uint8_t  reservedV6[3];
+  // v7
+  uint32_t powerLimitMa;
+  // v8
+  uint16_t keepAliveMs;
+  uint8_t  reservedV8[2];
+  // v9
+  uint8_t  timecodeSync;
+  uint8_t  reservedV9[3];
+  uint32_t timecodeStartMs;
+  // v10
+  uint8_t  clockRole;
+  uint8_t  reservedV10;
+  uint16_t presentDelayMs;
+  uint32_t clockMasterIp;
+  // v11
+  uint16_t jitterLatencyMs;
+  uint8_t  reservedV11[2];
+  // v12
+  uint8_t  outputCount;
+  uint8_t  outputPins[4];
+  uint8_t  reservedV12[3];
+  PersistedOutput extraOutputs[3];
+  // v13
+  char     shortName[18];
+  char     longName[64];
+  uint8_t  reservedV13[2];
+  // v14
+  uint8_t  outputSources[4];
+  // v15
+  uint8_t  wifiStandby;
+  uint8_t  reservedV15[3];
+  // v16
+  uint8_t  logLevel;
+  uint8_t  reservedV16;
+  uint16_t syslogPort;
+  uint32_t syslogIp;
+  // v17
+  uint32_t outputPowerLimitMa[3];
+};
+static_assert(sizeof(PersistedConfig) == 436, "PersistedConfig layout changed; append fields and bump the version");
+static_assert(LedOutputs::MAX_OUTPUTS == 4, "PersistedConfig stores four outputs");
+
+constexpr uint16_t CONFIG_BLOB_VERSION = 17;
+
 AppConfig makeDefaultConfig();
 String ipToString(uint32_t ipValue);
 uint32_t parseIp(const String& text, uint32_t fallback);
+String timecodeToString(uint32_t ms);
+uint32_t parseTimecode(const String& text, uint32_t fallback);
 void restoreFactoryDefaults();
 bool checkFactoryResetOnBoot();
 void bringUpEthernet(const AppConfig& config);
 void bringUpWiFi(const AppConfig& config);
+void serviceNetworkBringUp();
 void handleWifiScan();
 String htmlEscape(const String& text);
 String jsonEscape(const String& text);
 String wifiAuthModeToText(wifi_auth_mode_t mode);
 const char* getChipName(uint8_t value);
 const char* getColorOrderName(uint8_t value);
+uint16_t totalLeds(const AppConfig& config);
 
 AppConfig g_config = makeDefaultConfig();
 
@@ -150,10 +391,46 @@ AppConfig makeDefaultConfig()
   cfg.wifiEnabled     = DEFAULT_WIFI_ENABLED;
   cfg.wifiApMode      = DEFAULT_WIFI_AP_MODE;
   cfg.artnetInput     = DEFAULT_ARTNET_INPUT;
+  cfg.wifiStandby     = DEFAULT_WIFI_STANDBY;
+  cfg.bootScene       = DEFAULT_BOOT_SCENE;
+  cfg.sourceLossPolicy = DEFAULT_SOURCE_LOSS_POLICY;
+  cfg.sourceLossTimeoutMs = DEFAULT_SOURCE_LOSS_TIMEOUT;
+  cfg.sourceLossFadeMs = DEFAULT_SOURCE_LOSS_FADE;
+  cfg.mergeMode       = DEFAULT_MERGE_MODE;
+  cfg.maxFps          = DEFAULT_MAX_FPS;
+  cfg.interpolate     = DEFAULT_INTERPOLATE;
+  cfg.powerLimitMa    = DEFAULT_POWER_LIMIT_MA;
+  cfg.keepAliveMs     = DEFAULT_KEEP_ALIVE_MS;
+  cfg.timecodeSync    = DEFAULT_TIMECODE_SYNC;
+  cfg.timecodeStartMs = DEFAULT_TIMECODE_START_MS;
+  cfg.clockRole       = DEFAULT_CLOCK_ROLE;
+  cfg.clockMasterIp   = DEFAULT_CLOCK_MASTER_IP;
+  cfg.presentDelayMs  = DEFAULT_PRESENT_DELAY_MS;
+  cfg.jitterLatencyMs = DEFAULT_JITTER_LATENCY_MS;
+  cfg.logLevel        = DEFAULT_LOG_LEVEL;
+  cfg.syslogIp        = DEFAULT_SYSLOG_IP;
+  cfg.syslogPort      = DEFAULT_SYSLOG_PORT;
+  cfg.outputCount     = DEFAULT_OUTPUT_COUNT;
+  for (uint8_t i = 0; i < LedOutputs::MAX_OUTPUTS; ++i) {
+    cfg.outputPins[i] = LedOutputs::PINS[i];
+    cfg.outputSources[i] = static_cast<uint8_t>(OutputSource::Any);
+  }
+  // Cada salida extra arranca en el universo que sigue a la anterior.
+  const uint16_t defaultUniverses = (DEFAULT_NUM_LEDS + DEFAULT_PIXELS_PER_UNIVERSE - 1) / DEFAULT_PIXELS_PER_UNIVERSE;
+  for (uint8_t i = 0; i + 1 < LedOutputs::MAX_OUTPUTS; ++i) {
+    ExtraOutputConfig& out = cfg.extraOutputs[i];
+    out.ledCount      = DEFAULT_NUM_LEDS;
+    out.startUniverse = DEFAULT_START_UNIVERSE + (i + 1) * defaultUniverses;
+    out.chipType      = DEFAULT_CHIP_TYPE;
+    out.colorOrder    = DEFAULT_COLOR_ORDER;
+    out.powerLimitMa  = DEFAULT_POWER_LIMIT_MA;
+  }
   cfg.wifiStaSsid     = DEFAULT_WIFI_STA_SSID;
   cfg.wifiStaPassword = DEFAULT_WIFI_STA_PASSWORD;
   cfg.wifiApSsid      = DEFAULT_WIFI_AP_SSID;
   cfg.wifiApPassword  = DEFAULT_WIFI_AP_PASSWORD;
+  cfg.shortName       = DEFAULT_SHORT_NAME;
+  cfg.longName        = DEFAULT_LONG_NAME;
   return cfg;
 }
 
@@ -172,6 +449,50 @@ uint32_t parseIp(const String& text, uint32_t fallback)
   return fallback;
 }
 
+// Hora de timecode como "HH:MM:SS.mmm".
+String timecodeToString(uint32_t ms)
+{
+  char text[16];
+  snprintf(text, sizeof(text), "%02lu:%02lu:%02lu.%03lu",
+           (unsigned long)(ms / 3600000UL), (unsigned long)(ms / 60000UL % 60),
+           (unsigned long)(ms / 1000UL % 60), (unsigned long)(ms % 1000));
+  return String(text);
+}
+
+// Acepta "HH:MM:SS", "HH:MM:SS.mmm" o "MM:SS"; cualquier otra cosa deja fallback.
+uint32_t parseTimecode(const String& text, uint32_t fallback)
+{
+  unsigned long parts[3] = {0, 0, 0};
+  unsigned long millisPart = 0;
+  uint8_t count = 0;
+  const char* p = text.c_str();
+  while (*p && count < 3) {
+    if (*p < '0' || *p > '9') return fallback;
+    parts[count++] = strtoul(p, const_cast<char**>(&p), 10);
+    if (*p == ':') {
+      ++p;
+    } else {
+      break;
+    }
+  }
+  if (*p == '.') {
+    unsigned long scale = 100;
+    for (++p; *p >= '0' && *p <= '9'; ++p) {
+      millisPart += (*p - '0') * scale;
+      scale /= 10;
+    }
+  }
+  if (*p || count < 2) return fallback;
+  if (count == 2) {
+    parts[2] = parts[1];
+    parts[1] = parts[0];
+    parts[0] = 0;
+  }
+  if (parts[1] > 59 || parts[2] > 59) return fallback;
+  const unsigned long ms = ((parts[0] * 60 + parts[1]) * 60 + parts[2]) * 1000 + millisPart;
+  return ms > MAX_TIMECODE_MS ? fallback : static_cast<uint32_t>(ms);
+}
+
 String htmlEscape(const String& text)
 {
   String out;
@@ -233,6 +554,7 @@ String wifiAuthModeToText(wifi_auth_mode_t mode)
 }
 
 Preferences g_prefs;
+ConfigStore g_configStore("pixelcfg", "cfg");
 WebServer g_server(80);
 
 bool g_firmwareUploadHandled = false;
@@ -290,20 +612,49 @@ void restoreFactoryDefaults()
     g_prefs.clear();
     g_prefs.end();
   }
+  g_configStore.forget();
   g_config = makeDefaultConfig();
 }
 
 // ===================== ART-NET =====================
 ArtNetNode artnet;
-std::vector<uint8_t> g_universeReceived;
-uint16_t g_universeCount = 0;
-
-// ===================== DEBUG DMX =====================
-//#define DMX_DEBUG                      1
-#define DMX_DEBUG_LED_INDEX            0     // LED que mostramos por serie
-#define DMX_DEBUG_CHANNELS_TO_PRINT    12    // Primeros N canales del paquete
-#define DMX_DEBUG_MIN_INTERVAL_MS      200   // Evitar spam serie
+ClockSync g_clock;
+bool g_clockReady = false;   // la red ya se inicializó: se puede abrir el socket
+FrameIngest g_ingest;
+RenderStage g_render;
+FramePacer g_pacer;
+FrameJitterBuffer g_jitter;
+uint8_t g_lastDmxSequence = 0;
+PowerLimiter g_power;
+FastLedBackend g_ledBackend;
+LedOutputs g_outputs;
+MemoryArena g_arena;
+MemoryPlan g_memoryPlan;
+bool g_outputsNeedRestart = false;   // cambió el cableado de una salida ya creada
+SceneStore g_sceneStore;
+ShowRecorder g_show;
+TimecodeSync g_tcSync;
+uint32_t g_lastFrameMs = 0;
+uint32_t g_lastSceneSaveMs = 0;
+bool g_sceneDirty = false;
+// loop() es una pasada del planificador; las tareas se declaran en setup().
+TaskScheduler g_scheduler;
+
+// ===================== REGISTRO =====================
+// Todo mensaje de ejecución pasa por g_log: escribir un registro no espera a la
+// UART.  serviceLogs() los saca en loop() hacia Serial, syslog y /api/logs.
+LogRing g_log;
+WiFiUDP g_syslogUdp;
+using LogLevel = LogRing::Level;
+using LogTag = LogRing::Tag;
+
+void logIp(LogTag tag, const char* format, IPAddress ip)
+{
+  g_log.log(LogLevel::Info, tag, format, ip[0], ip[1], ip[2], ip[3]);
+}
+
 uint32_t g_dmxFrames = 0;
+uint32_t g_lastDmxMs = 0;
 
 // ===================== ETHERNET (WT32-ETH01 / LAN8720) =====================
 #define ETH_PHY_ADDR   1
@@ -316,59 +667,88 @@ uint32_t g_dmxFrames = 0;
 static bool eth_link_up = false;
 static bool eth_has_ip  = false;
 
+// Arranque de red no bloqueante: bringUpWiFi()/bringUpEthernet() sólo inician
+// las interfaces y serviceNetworkBringUp() (desde loop) resuelve los plazos de
+// DHCP y el fallback a IP fija, así Art-Net y el servidor web arrancan enseguida.
+struct NetworkBringUp {
+  bool     ethDhcpPending   = false;
+  uint32_t ethDeadlineMs    = 0;
+  bool     wifiStaPending   = false;
+  uint32_t wifiDeadlineMs   = 0;
+  uint32_t ethIpMs          = 0;   // millis() al obtener IP por primera vez
+  uint32_t wifiIpMs         = 0;
+  bool     firstReplyLogged = false;
+};
+static NetworkBringUp g_netBringUp;
+static bool g_ipProgramPending = false;   // ArtIpProg cambió la IP; se aplica tras responder
+
+// Failover Ethernet → Wi-Fi: onWiFiEvent() anota la caída del enlace y loop()
+// pasa Art-Net a Wi-Fi en la vuelta siguiente (ver serviceFailover()).
+struct Failover {
+  volatile uint32_t linkDownUs = 0;   // micros() del evento ETH_DISCONNECTED
+  bool     linkSeen       = false;    // último eth_link_up aplicado a ArtNetNode
+  bool     awaitingData   = false;    // esperando el primer ArtDmx por Wi-Fi
+  uint32_t count          = 0;
+  uint32_t lastSwitchUs   = 0;        // evento → Art-Net escuchando por Wi-Fi
+  uint32_t lastGapMs      = 0;        // último ArtDmx por Ethernet → primero por Wi-Fi
+  uint32_t lastEthernetDmxMs = 0;
+};
+static Failover g_failover;
+
 void onWiFiEvent(WiFiEvent_t event)
 {
   switch (event) {
     case ARDUINO_EVENT_ETH_START:
-      Serial.println("[ETH] START");
+      g_log.log(LogLevel::Info, LogTag::Eth, "START");
       ETH.setHostname(DEVICE_HOSTNAME);
       break;
     case ARDUINO_EVENT_ETH_CONNECTED:
-      Serial.println("[ETH] LINK UP");
+      g_log.log(LogLevel::Info, LogTag::Eth, "LINK UP");
       eth_link_up = true;
       break;
     case ARDUINO_EVENT_ETH_GOT_IP:
-      Serial.print("[ETH] DHCP IP: ");
-      Serial.println(ETH.localIP());
+      logIp(LogTag::Eth, "DHCP IP: %u.%u.%u.%u", ETH.localIP());
       eth_has_ip = true;
+      if (!g_netBringUp.ethIpMs) g_netBringUp.ethIpMs = millis();
       break;
     case ARDUINO_EVENT_ETH_DISCONNECTED:
-      Serial.println("[ETH] LINK DOWN");
+      g_failover.linkDownUs = micros();
+      g_log.log(LogLevel::Warn, LogTag::Eth, "LINK DOWN");
       eth_link_up = false;
       eth_has_ip  = false;
       break;
     case ARDUINO_EVENT_ETH_STOP:
-      Serial.println("[ETH] STOP");
+      g_log.log(LogLevel::Info, LogTag::Eth, "STOP");
       eth_link_up = false;
       eth_has_ip  = false;
       break;
     case ARDUINO_EVENT_WIFI_STA_START:
-      Serial.println("[WIFI] STA start");
+      g_log.log(LogLevel::Info, LogTag::Wifi, "STA start");
       wifi_sta_running = true;
       wifi_sta_connected = false;
       wifi_sta_has_ip = false;
       wifi_sta_ip = IPAddress((uint32_t)0);
       break;
     case ARDUINO_EVENT_WIFI_STA_CONNECTED:
-      Serial.println("[WIFI] STA connected");
+      g_log.log(LogLevel::Info, LogTag::Wifi, "STA connected");
       wifi_sta_connected = true;
       wifi_sta_ssid_current = WiFi.SSID();
       break;
     case ARDUINO_EVENT_WIFI_STA_GOT_IP:
-      Serial.print("[WIFI] STA IP: ");
-      Serial.println(WiFi.localIP());
+      logIp(LogTag::Wifi, "STA IP: %u.%u.%u.%u", WiFi.localIP());
       wifi_sta_has_ip = true;
       wifi_sta_ip = WiFi.localIP();
+      if (!g_netBringUp.wifiIpMs) g_netBringUp.wifiIpMs = millis();
       break;
     case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
-      Serial.println("[WIFI] STA disconnected");
+      g_log.log(LogLevel::Warn, LogTag::Wifi, "STA disconnected");
       wifi_sta_connected = false;
       wifi_sta_has_ip = false;
       wifi_sta_ip = IPAddress((uint32_t)0);
       wifi_sta_ssid_current.clear();
       break;
     case ARDUINO_EVENT_WIFI_STA_STOP:
-      Serial.println("[WIFI] STA stop");
+      g_log.log(LogLevel::Info, LogTag::Wifi, "STA stop");
       wifi_sta_running = false;
       wifi_sta_connected = false;
       wifi_sta_has_ip = false;
@@ -376,12 +756,12 @@ void onWiFiEvent(WiFiEvent_t event)
       wifi_sta_ssid_current.clear();
       break;
     case ARDUINO_EVENT_WIFI_AP_START:
-      Serial.println("[WIFI] AP start");
+      g_log.log(LogLevel::Info, LogTag::Wifi, "AP start");
       wifi_ap_running = true;
       wifi_ap_ip = WiFi.softAPIP();
       break;
     case ARDUINO_EVENT_WIFI_AP_STOP:
-      Serial.println("[WIFI] AP stop");
+      g_log.log(LogLevel::Info, LogTag::Wifi, "AP stop");
       wifi_ap_running = false;
       wifi_ap_ip = IPAddress((uint32_t)0);
       break;
@@ -396,11 +776,17 @@ void onWiFiEvent(WiFiEvent_t event)
 // ======== CALLBACK Art-Net (firma con IP de origen) ========
 void applyConfig();
 void saveConfig();
+void serviceConfigPersistence();
+void serviceLogs();
+void handleLogsJson();
 void handleConfigGet();
 void handleConfigPost();
 void handleWifiConfigGet();
 void handleWifiConfigPost();
 void handleRoot();
+void handleShowPost();
+String buildShowStatus();
+uint16_t ledBudget(const AppConfig& config);
 String buildConfigPage(const String& message = String())
 {
   String html;
@@ -426,7 +812,7 @@ String buildConfigPage(const String& message = String())
       artnetInputLabel = F("Wi-Fi");
       break;
     case static_cast<uint8_t>(ArtNetNode::InterfacePreference::Auto):
-      artnetInputLabel = F("Automático");
+      artnetInputLabel = F("Todas a la vez");
       break;
     case static_cast<uint8_t>(ArtNetNode::InterfacePreference::Ethernet):
     default:
@@ -457,19 +843,24 @@ String buildConfigPage(const String& message = String())
   String wifiSsidStatus = htmlEscape(wifiSsidLabel);
   String wifiClientsStr = (wifiEnabled && wifiApMode) ? String(WiFi.softAPgetStationNum()) : String("-");
 
-  String artnetActiveLabel = F("Sin enlace");
-  if (artnetIp != IPAddress((uint32_t)0)) {
-    if (artnetIp == ETH.localIP()) {
-      artnetActiveLabel = F("Ethernet");
-    } else {
-      IPAddress staIp = WiFi.localIP();
-      IPAddress apIp = WiFi.softAPIP();
-      if (artnetIp == staIp || artnetIp == apIp || artnetIp == wifi_sta_ip || artnetIp == wifi_ap_ip) {
-        artnetActiveLabel = F("Wi-Fi");
-      } else {
-        artnetActiveLabel = F("Desconocido");
-      }
+  // Cada interfaz escucha con su propia IP; se listan las que reciben.
+  String artnetActiveLabel;
+  String artnetIpList;
+  for (uint8_t i = 0; i < ArtNetNode::INTERFACE_COUNT; ++i) {
+    const ArtNetNode::Interface iface = static_cast<ArtNetNode::Interface>(i);
+    const IPAddress ip = artnet.interfaceIp(iface);
+    if (!artnet.listening(iface) || ip == IPAddress((uint32_t)0)) continue;
+    if (artnetActiveLabel.length()) {
+      artnetActiveLabel += " + ";
+      artnetIpList += ", ";
     }
+    artnetActiveLabel += ARTNET_INTERFACE_NAMES[i];
+    artnetIpList += ip.toString();
+  }
+  if (artnetActiveLabel.length() == 0) {
+    artnetActiveLabel = F("Sin enlace");
+  } else {
+    artnetIpStr = artnetIpList;
   }
 
   html += F("<!DOCTYPE html><html lang='es'><head><meta charset='utf-8'>");
@@ -522,11 +913,26 @@ String buildConfigPage(const String& message = String())
   html += F("<label for='staticDns2'>DNS secundario</label>");
   html += "<input type='text' id='staticDns2' name='staticDns2' value='" + staticDns2Str + "'>";
   html += F("<h2 class='section-title'>Art-Net</h2>");
+  html += F("<label for='shortName'>Nombre corto</label>");
+  html += "<input type='text' id='shortName' name='shortName' maxlength='17' value='" + htmlEscape(g_config.shortName) + "'>";
+  html += F("<label for='longName'>Nombre largo</label>");
+  html += "<input type='text' id='longName' name='longName' maxlength='63' value='" + htmlEscape(g_config.longName) + "'>";
   html += F("<label for='artnetInput'>Preferencia de interfaz</label>");
   html += F("<select id='artnetInput' name='artnetInput'>");
   html += String("<option value='") + String(static_cast<uint8_t>(ArtNetNode::InterfacePreference::Ethernet)) + "'" + (artnetInputValue == static_cast<uint8_t>(ArtNetNode::InterfacePreference::Ethernet) ? " selected" : "") + ">Ethernet</option>";
   html += String("<option value='") + String(static_cast<uint8_t>(ArtNetNode::InterfacePreference::WiFi)) + "'" + (artnetInputValue == static_cast<uint8_t>(ArtNetNode::InterfacePreference::WiFi) ? " selected" : "") + ">Wi-Fi</option>";
-  html += String("<option value='") + String(static_cast<uint8_t>(ArtNetNode::InterfacePreference::Auto)) + "'" + (artnetInputValue == static_cast<uint8_t>(ArtNetNode::InterfacePreference::Auto) ? " selected" : "") + ">Automático</option>";
+  html += String("<option value='") + String(static_cast<uint8_t>(ArtNetNode::InterfacePreference::Auto)) + "'" + (artnetInputValue == static_cast<uint8_t>(ArtNetNode::InterfacePreference::Auto) ? " selected" : "") + ">Todas a la vez (Ethernet y Wi-Fi)</option>";
+  html += F("</select>");
+  html += F("<label for='wifiStandby'>Wi-Fi en espera activa</label>");
+  html += F("<select id='wifiStandby' name='wifiStandby'>");
+  html += String("<option value='0'") + (!g_config.wifiStandby ? " selected" : "") + ">Desactivada</option>";
+  html += String("<option value='1'") + (g_config.wifiStandby ? " selected" : "") + ">Activada (si cae Ethernet, sigue por Wi-Fi al instante)</option>";
+  html += F("</select>");
+  html += F("<label for='mergeMode'>Fusión de dos controladores</label>");
+  html += F("<select id='mergeMode' name='mergeMode'>");
+  for (uint8_t i = 0; i < 2; ++i) {
+    html += String("<option value='") + String(i) + "'" + (g_config.mergeMode == i ? " selected" : "") + ">" + String(MERGE_MODE_NAMES[i]) + "</option>";
+  }
   html += F("</select>");
   html += F("<h2 class='section-title'>LEDs</h2>");
   html += F("<label for='numLeds'>Cantidad de LEDs activos</label>");
@@ -549,6 +955,110 @@ String buildConfigPage(const String& message = String())
     html += String("<option value='") + String(i) + "'" + (g_config.colorOrder == i ? " selected" : "") + ">" + String(getColorOrderName(i)) + "</option>";
   }
   html += F("</select>");
+  html += F("<label for='outputCount'>Salidas en paralelo</label>");
+  html += F("<select id='outputCount' name='outputCount'>");
+  for (uint8_t i = 1; i <= LedOutputs::MAX_OUTPUTS; ++i) {
+    html += String("<option value='") + String(i) + "'" + (g_config.outputCount == i ? " selected" : "") + ">" + String(i) + "</option>";
+  }
+  html += F("</select>");
+  html += F("<p style='margin-top:0;font-size:0.9rem;color:#96a2c5;'>La salida 1 usa los campos de arriba. Las salidas se envían a la vez, así que el refresco dura lo que la más larga. Cambiar pin, chip u orden de una salida en uso reinicia el equipo.</p>");
+  html += "<p style='margin-top:0;font-size:0.9rem;color:#96a2c5;'>Con las opciones actuales entran hasta " + String(ledBudget(g_config)) +
+          " LEDs entre todas las salidas. Interpolación, escena de respaldo y buffer de jitter usan memoria por LED.</p>";
+  for (uint8_t o = 0; o < LedOutputs::MAX_OUTPUTS; ++o) {
+    const String suffix = String(o);
+    const String title = "Salida " + String(o + 1) + ": ";
+    html += "<label for='outputPin" + suffix + "'>" + title + "pin de datos</label>";
+    html += "<select id='outputPin" + suffix + "' name='outputPin" + suffix + "'>";
+    for (uint8_t p = 0; p < LedOutputs::PIN_COUNT; ++p) {
+      const uint8_t pin = LedOutputs::PINS[p];
+      html += String("<option value='") + String(pin) + "'" + (g_config.outputPins[o] == pin ? " selected" : "") + ">GPIO" + String(pin) + "</option>";
+    }
+    html += F("</select>");
+    html += "<label for='outputSource" + suffix + "'>" + title + "recibir Art-Net de</label>";
+    html += "<select id='outputSource" + suffix + "' name='outputSource" + suffix + "'>";
+    for (uint8_t i = 0; i < static_cast<uint8_t>(OutputSource::SOURCE_COUNT); ++i) {
+      html += String("<option value='") + String(i) + "'" + (g_config.outputSources[o] == i ? " selected" : "") + ">" + String(OUTPUT_SOURCE_NAMES[i]) + "</option>";
+    }
+    html += F("</select>");
+    if (o == 0) continue;
+    const ExtraOutputConfig& out = g_config.extraOutputs[o - 1];
+    html += "<label for='outputLeds" + suffix + "'>" + title + "cantidad de LEDs</label>";
+    html += "<input type='number' id='outputLeds" + suffix + "' name='outputLeds" + suffix + "' min='1' max='" + String(MAX_LEDS) + "' value='" + String(out.ledCount) + "'>";
+    html += "<label for='outputUniverse" + suffix + "'>" + title + "universo inicial</label>";
+    html += "<input type='number' id='outputUniverse" + suffix + "' name='outputUniverse" + suffix + "' min='0' max='32767' value='" + String(out.startUniverse) + "'>";
+    html += "<label for='outputChip" + suffix + "'>" + title + "tipo de chip</label>";
+    html += "<select id='outputChip" + suffix + "' name='outputChip" + suffix + "'>";
+    for (uint8_t i = 0; i < static_cast<uint8_t>(LedChipType::CHIP_TYPE_COUNT); ++i) {
+      html += String("<option value='") + String(i) + "'" + (out.chipType == i ? " selected" : "") + ">" + String(getChipName(i)) + "</option>";
+    }
+    html += F("</select>");
+    html += "<label for='outputOrder" + suffix + "'>" + title + "orden de color</label>";
+    html += "<select id='outputOrder" + suffix + "' name='outputOrder" + suffix + "'>";
+    for (uint8_t i = 0; i < static_cast<uint8_t>(LedColorOrder::COLOR_ORDER_COUNT); ++i) {
+      html += String("<option value='") + String(i) + "'" + (out.colorOrder == i ? " selected" : "") + ">" + String(getColorOrderName(i)) + "</option>";
+    }
+    html += F("</select>");
+    html += "<label for='outputPower" + suffix + "'>" + title + "límite de corriente de su fuente (mA, 0 = sin límite)</label>";
+    html += "<input type='number' id='outputPower" + suffix + "' name='outputPower" + suffix + "' min='0' max='" + String((unsigned long)MAX_POWER_LIMIT_MA) + "' value='" + String((unsigned long)out.powerLimitMa) + "'>";
+  }
+  html += F("<label for='maxFps'>FPS máximo de salida (0 = automático)</label>");
+  html += "<input type='number' id='maxFps' name='maxFps' min='0' max='1000' value='" + String(g_config.maxFps) + "'>";
+  html += F("<label for='powerLimit'>Límite de corriente de la fuente de la salida 1 (mA, 0 = sin límite)</label>");
+  html += "<input type='number' id='powerLimit' name='powerLimit' min='0' max='" + String((unsigned long)MAX_POWER_LIMIT_MA) + "' value='" + String((unsigned long)g_config.powerLimitMa) + "'>";
+  html += F("<label for='keepAlive'>Reenvío de frames sin cambios (ms, 0 = enviar siempre)</label>");
+  html += "<input type='number' id='keepAlive' name='keepAlive' min='0' max='60000' value='" + String(g_config.keepAliveMs) + "'>";
+  html += F("<label for='jitterLatency'>Buffer de jitter para Wi-Fi (ms de latencia máxima, 0 = desactivado)</label>");
+  html += "<input type='number' id='jitterLatency' name='jitterLatency' min='0' max='" + String(FrameJitterBuffer::MAX_LATENCY_MS) + "' value='" + String(g_config.jitterLatencyMs) + "'>";
+  html += F("<label for='interpolate'>Interpolación de frames</label>");
+  html += F("<select id='interpolate' name='interpolate'>");
+  html += String("<option value='0'") + (!g_config.interpolate ? " selected" : "") + ">Desactivada</option>";
+  html += String("<option value='1'") + (g_config.interpolate ? " selected" : "") + ">Activada (suaviza fuentes lentas)</option>";
+  html += F("</select>");
+  html += F("<label for='timecodeSync'>Sincronizar show grabado con ArtTimeCode</label>");
+  html += F("<select id='timecodeSync' name='timecodeSync'>");
+  html += String("<option value='0'") + (!g_config.timecodeSync ? " selected" : "") + ">Desactivado</option>";
+  html += String("<option value='1'") + (g_config.timecodeSync ? " selected" : "") + ">Activado (sigue al reloj de la consola)</option>";
+  html += F("</select>");
+  html += F("<label for='timecodeStart'>Timecode de inicio del show (HH:MM:SS.mmm)</label>");
+  html += "<input type='text' id='timecodeStart' name='timecodeStart' value='" + timecodeToString(g_config.timecodeStartMs) + "'>";
+  html += F("<label for='clockRole'>Sincronía de presentación entre nodos</label>");
+  html += F("<select id='clockRole' name='clockRole'>");
+  for (uint8_t i = 0; i < static_cast<uint8_t>(ClockSync::Role::ROLE_COUNT); ++i) {
+    html += String("<option value='") + String(i) + "'" + (g_config.clockRole == i ? " selected" : "") + ">" + CLOCK_ROLE_NAMES[i] + "</option>";
+  }
+  html += F("</select>");
+  html += F("<label for='clockMaster'>IP del nodo maestro (vacío = buscar en la red)</label>");
+  html += "<input type='text' id='clockMaster' name='clockMaster' value='" +
+          (g_config.clockMasterIp ? ipToString(g_config.clockMasterIp) : String()) + "'>";
+  html += F("<label for='presentDelay'>Retardo de presentación (ms)</label>");
+  html += "<input type='number' id='presentDelay' name='presentDelay' min='1' max='" + String(MAX_PRESENT_DELAY_MS) + "' value='" + String(g_config.presentDelayMs) + "'>";
+  html += F("<label for='sourceLossPolicy'>Si se pierde la señal Art-Net</label>");
+  html += F("<select id='sourceLossPolicy' name='sourceLossPolicy'>");
+  for (uint8_t i = 0; i < static_cast<uint8_t>(RenderStage::SourceLossPolicy::POLICY_COUNT); ++i) {
+    html += String("<option value='") + String(i) + "'" + (g_config.sourceLossPolicy == i ? " selected" : "") + ">" + String(SOURCE_LOSS_POLICY_NAMES[i]) + "</option>";
+  }
+  html += F("</select>");
+  html += F("<label for='sourceLossTimeout'>Tiempo sin señal (ms)</label>");
+  html += "<input type='number' id='sourceLossTimeout' name='sourceLossTimeout' min='100' max='600000' value='" + String((unsigned long)g_config.sourceLossTimeoutMs) + "'>";
+  html += F("<label for='sourceLossFade'>Duración del fundido (ms)</label>");
+  html += "<input type='number' id='sourceLossFade' name='sourceLossFade' min='0' max='60000' value='" + String((unsigned long)g_config.sourceLossFadeMs) + "'>";
+  html += F("<label for='bootScene'>Escena de arranque</label>");
+  html += F("<select id='bootScene' name='bootScene'>");
+  for (uint8_t i = 0; i < static_cast<uint8_t>(BootSceneMode::BOOT_SCENE_MODE_COUNT); ++i) {
+    html += String("<option value='") + String(i) + "'" + (g_config.bootScene == i ? " selected" : "") + ">" + String(BOOT_SCENE_NAMES[i]) + "</option>";
+  }
+  html += F("</select>");
+  html += F("<label for='logLevel'>Nivel de registro</label>");
+  html += F("<select id='logLevel' name='logLevel'>");
+  for (uint8_t i = 0; i < static_cast<uint8_t>(LogRing::Level::LEVEL_COUNT); ++i) {
+    html += String("<option value='") + String(i) + "'" + (g_config.logLevel == i ? " selected" : "") + ">" + LOG_LEVEL_NAMES[i] + "</option>";
+  }
+  html += F("</select>");
+  html += F("<label for='syslogIp'>Servidor syslog (vacío = desactivado)</label>");
+  html += "<input type='text' id='syslogIp' name='syslogIp' value='" +
+          (g_config.syslogIp ? ipToString(g_config.syslogIp) : String()) + "'>";
+  html += F("<label for='syslogPort'>Puerto syslog (UDP)</label>");
+  html += "<input type='number' id='syslogPort' name='syslogPort' min='1' max='65535' value='" + String(g_config.syslogPort) + "'>";
   html += F("<button type='submit'>Guardar configuración</button>");
   html += F("</form>");
 
@@ -571,14 +1081,61 @@ String buildConfigPage(const String& message = String())
   html += "<div><strong>IP Wi-Fi:</strong><br>" + wifiIpStr + "</div>";
   html += "<div><strong>Clientes Wi-Fi:</strong><br>" + wifiClientsStr + "</div>";
   html += "<div><strong>Configurar Wi-Fi:</strong><br><a class='link' href='/wifi'>Abrir página Wi-Fi</a></div>";
-  html += "<div><strong>Universos:</strong><br>" + String(g_universeCount) + " (desde " + String(g_config.startUniverse) + ")";
+  html += "<div><strong>Universos:</strong><br>" + String(g_ingest.universeCount()) + " (desde " + String(g_config.startUniverse) + ")";
   html += "</div><div><strong>Frames DMX:</strong><br>" + String((unsigned long)g_dmxFrames) + "</div>";
   html += "<div><strong>Brillo:</strong><br>" + String(g_config.brightness) + "/255";
   html += "</div><div><strong>DHCP timeout:</strong><br>" + String(g_config.dhcpTimeoutMs) + " ms";
   html += "</div><div><strong>Chip LED:</strong><br>" + String(getChipName(g_config.chipType)) + "</div>";
   html += "<div><strong>Orden:</strong><br>" + String(getColorOrderName(g_config.colorOrder)) + "</div>";
+  html += "<div><strong>Fusión Art-Net:</strong><br>" + String(g_config.mergeMode ? "LTP" : "HTP") +
+          (g_ingest.merging(g_config.startUniverse) ? " (fusionando)" : "") + "</div>";
+  html += "<div><strong>FPS entrada / salida:</strong><br>" + String(g_pacer.inputFps()) + " / " + String(g_pacer.outputFps()) + "</div>";
+  html += "<div><strong>Tiempo de envío a la tira:</strong><br>" + String((unsigned long)g_pacer.showUs() / 1000) + " ms</div>";
+  html += "<div><strong>Salidas:</strong><br>" + String(g_outputs.count()) + " (" + String(totalLeds(g_config)) + " LEDs, " +
+          String((unsigned long)g_outputs.frameTimeUs() / 1000) + " ms por refresco)</div>";
+  html += "<div><strong>Consumo estimado:</strong><br>" + String((unsigned long)g_power.estimatedMa()) + " mA" +
+          (g_power.limiting() ? " (limitado a " + String((unsigned long)g_power.limitedMa()) + " mA)" : String("")) + "</div>";
+  html += "<div><strong>Interpolación:</strong><br>" + String(g_config.interpolate ? "Activada" : "Desactivada") + "</div>";
+  html += "<div><strong>Pérdida de señal:</strong><br>" + String(SOURCE_LOSS_POLICY_NAMES[g_config.sourceLossPolicy]) +
+          (g_render.sourceLost() ? " (sin señal)" : "") + "</div>";
+  html += "<div><strong>Escena de arranque:</strong><br>" + String(BOOT_SCENE_NAMES[g_config.bootScene]) + "</div>";
+  String sceneStatus;
+  if (!g_sceneStore.available()) {
+    sceneStatus = F("sin partición");
+  } else if (g_sceneStore.hasScene()) {
+    sceneStatus = String(g_sceneStore.storedPixels()) + " LEDs (" + String((unsigned long)g_sceneStore.storedBytes()) + " bytes)";
+  } else {
+    sceneStatus = F("vacía");
+  }
+  html += "<div><strong>Escena guardada:</strong><br>" + sceneStatus + "</div>";
   html += F("</div></div>");
 
+  html += F("<div class='card'>");
+  html += F("<h2>Escena de arranque</h2>");
+  html += F("<form method='post' action='/scene'>");
+  html += F("<p style='margin-top:0;font-size:0.9rem;color:#96a2c5;'>Guarda en flash el último frame recibido para mostrarlo al encender, antes de que haya red. En modo <em>Escena fija</em> sólo se guarda con este botón.</p>");
+  html += F("<button type='submit'>Guardar escena actual</button>");
+  html += F("</form>");
+  html += F("</div>");
+
+  html += F("<div class='card'>");
+  html += F("<h2>Show grabado</h2>");
+  html += F("<p style='margin-top:0;font-size:0.9rem;color:#96a2c5;'>Graba los frames Art-Net recibidos en la flash y los reproduce con la misma temporización, sin controlador. Durante la reproducción se ignora Art-Net.</p>");
+  html += "<p style='font-size:0.9rem;'>" + buildShowStatus() + "</p>";
+  html += F("<form method='post' action='/show'>");
+  if (g_show.state() == ShowRecorder::State::Idle) {
+    html += F("<button type='submit' name='action' value='record'>Grabar</button> ");
+    if (g_show.hasShow()) {
+      html += F("<button type='submit' name='action' value='play'>Reproducir</button> ");
+      html += F("<button type='submit' name='action' value='loop'>Reproducir en bucle</button> ");
+      html += F("<button type='submit' name='action' value='delete'>Borrar</button>");
+    }
+  } else {
+    html += F("<button type='submit' name='action' value='stop'>Detener</button>");
+  }
+  html += F("</form>");
+  html += F("</div>");
+
   html += F("<div class='card'>");
   html += F("<h2>Consejos</h2><ul><li>Si ampliás la tira LED, incrementá el parámetro <em>Cantidad de LEDs activos</em>.</li><li>Reducí el brillo máximo para ahorrar consumo o evitar saturación.</li><li>Ajustá el tiempo de espera de DHCP si tu red tarda más en asignar IP.</li><li>El valor de pixeles por universo determina cuántos LEDs se controlan por paquete Art-Net.</li><li>Mantené presionado el botón de reinicio durante 10 segundos al encender para restaurar la configuración de fábrica.</li></ul>");
   html += F("</div>");
@@ -720,70 +1277,159 @@ String buildWifiConfigPage(const String& message = String())
 String buildVisualizerPage();
 void handleVisualizerGet();
 void handleLedStateJson();
+void handleMetricsJson();
 
-void onDmxFrame(uint16_t universe, uint16_t length, uint8_t sequence,
-                uint8_t* data, IPAddress remoteIP)
+// Refleja en ArtPollReply qué puertos están fusionando dos fuentes.
+void syncMergeStatus()
 {
-  g_dmxFrames++;
+  for (uint8_t port = 0; port < 4; ++port) {
+    artnet.setPortMerging(port, g_ingest.merging(g_ingest.startUniverse() + port));
+  }
+}
+
+// Mensaje [ARTNET] del registro que también llega, como ArtDiagData, a las
+// consolas que pidieron diagnóstico con esta prioridad.
+void reportDiagnostic(ArtNetNode::DiagPriority priority, const char* format, ...)
+{
+  char text[128];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(text, sizeof(text), format, args);
+  va_end(args);
+  g_log.logText(LogLevel::Info, LogTag::ArtNet, "%s", text);
+  artnet.sendDiagnostic(priority, text);
+}
 
-  const uint16_t universeStart = g_config.startUniverse;
-  if (universe < universeStart || universe >= (universeStart + g_universeCount)) return;
+// Único lugar que envía a las salidas durante el show: el pacer decide
+// cuándo las tiras están libres y RenderStage entrega siempre el frame más nuevo.
+void presentOutput()
+{
+  if (g_outputs.busy() || !g_render.prepareOutput()) {
+    return;
+  }
+  const uint32_t startUs = micros();
+  g_outputs.show(FastLED.getBrightness());
+  // El frame ya se copió al buffer de envío: el ingest puede volver a
+  // escribir en leds mientras la tira recibe éste.
+  g_render.outputShown();
+  g_clock.presented(startUs);
+}
+
+// Llega desde g_outputs.service() cuando la tira terminó de recibir el frame.
+void onOutputDone(uint32_t startUs, uint32_t endUs)
+{
+  g_pacer.frameShown(startUs, endUs);
+}
+
+bool outputFree(uint32_t nowUs)
+{
+  return g_pacer.due(nowUs) && !g_outputs.busy();
+}
+
+void serviceOutput()
+{
+  g_outputs.service();
+  const uint32_t nowUs = micros();
+  // Con sincronía entre nodos el frame espera a su hora de presentación.
+  if (outputFree(nowUs) && g_clock.presentDue(nowUs)) {
+    presentOutput();
+  }
+}
 
-  const uint16_t idxU = universe - universeStart;
-  const uint16_t pixelOffset = idxU * g_config.pixelsPerUniverse;
+void presentLatchedFrame()
+{
+  g_lastFrameMs = millis();
+  g_pacer.frameReceived();
+  // Un frame idéntico al anterior no se vuelve a enviar a la tira.
+  const bool changed = g_ingest.takeFrameChanged();
+  g_show.recordFrame(g_render.liveFrame(), changed);
+  if (changed) {
+    g_sceneDirty = true;
+    g_power.update(g_ingest, g_config.brightness);
+    FastLED.setBrightness(g_power.brightness());
+  }
+  bool showNow = outputFree(micros());
+  if (g_clock.active() && changed) {
+    g_clock.frameLatched(micros());
+    showNow = false;
+  }
+  if (g_render.onFrameLatched(showNow, changed)) {
+    g_pacer.frameCoalesced();
+  }
+  if (showNow) {
+    presentOutput();
+  }
+}
 
-  const uint16_t maxPixThisU    = min<uint16_t>(g_config.pixelsPerUniverse, g_config.numLeds - pixelOffset);
-  const uint16_t pixelsInPacket = min<uint16_t>(length / 3, maxPixThisU);
+// Con buffer de jitter el frame espera su turno; serviceJitterBuffer() lo
+// presenta con cadencia pareja.
+void latchNetworkFrame()
+{
+  if (g_jitter.enabled()) {
+    g_jitter.push(g_lastDmxSequence, micros());
+  } else {
+    presentLatchedFrame();
+  }
+}
 
-  for (uint16_t i = 0; i < pixelsInPacket; i++) {
-    const uint16_t ledIndex = pixelOffset + i;
-    const uint8_t r = data[i * 3 + 0];
-    const uint8_t g = data[i * 3 + 1];
-    const uint8_t b = data[i * 3 + 2];
-    leds[ledIndex].setRGB(r, g, b);
+void serviceJitterBuffer()
+{
+  const CRGB* frame = g_jitter.release(micros());
+  if (!frame) {
+    return;
   }
+  g_ingest.loadFrame(frame, totalLeds(g_config));
+  presentLatchedFrame();
+}
 
-  if (idxU < g_universeReceived.size()) {
-    g_universeReceived[idxU] = 1;
+void onDmxFrame(uint16_t universe, uint16_t length, uint8_t sequence,
+                uint8_t* data, IPAddress remoteIP)
+{
+  g_dmxFrames++;
+  g_lastDmxMs = millis();
+  if (artnet.packetInterface() == ArtNetNode::Interface::Ethernet) {
+    g_failover.lastEthernetDmxMs = g_lastDmxMs;
+  } else if (g_failover.awaitingData) {
+    g_failover.awaitingData = false;
+    g_failover.lastGapMs = g_lastDmxMs - g_failover.lastEthernetDmxMs;
+    reportDiagnostic(ArtNetNode::DiagPriority::Medium, "Failover: %lu ms sin datos",
+                     (unsigned long)g_failover.lastGapMs);
+  }
+  if (g_show.state() == ShowRecorder::State::Playing) {
+    return;   // el show grabado tiene la salida
   }
 
-  // ======== PRINT DEBUG (rate-limited) ========
-#if DMX_DEBUG
-  static uint32_t lastPrintMs = 0;
-  if (millis() - lastPrintMs >= DMX_DEBUG_MIN_INTERVAL_MS) {
-    lastPrintMs = millis();
-    String rip = remoteIP.toString();
-    Serial.printf("[DMX] U=%u len=%u seq=%u src=%s frames=%lu\n",
-                  universe, length, sequence, rip.c_str(), (unsigned long)g_dmxFrames);
+  const bool frameComplete = g_ingest.ingest(universe, length, data, static_cast<uint32_t>(remoteIP));
+  if (g_ingest.takeMergeStateChange()) {
+    syncMergeStatus();
+  }
 
-    // Primeros N canales del paquete recibido (ojo: son del universo actual)
-    uint16_t toShow = min<uint16_t>(DMX_DEBUG_CHANNELS_TO_PRINT, length);
-    Serial.print("  ch[0..]:");
-    for (uint16_t i = 0; i < toShow; i++) {
-      Serial.printf(" %u", data[i]);
-    }
+  // Traza de cada paquete, en el nivel Depuración.  Sólo copia enteros al
+  // registro: el formato se arma cuando serviceLogs() lo saca.
+  if (g_log.enabled(LogLevel::Debug)) {
+    g_log.log(LogLevel::Debug, LogTag::Dmx, "U=%u len=%u seq=%u src=%u.%u.%u.%u ch=%u,%u,%u", universe, length,
+              sequence, remoteIP[0], remoteIP[1], remoteIP[2], remoteIP[3], length > 0 ? data[0] : 0,
+              length > 1 ? data[1] : 0, length > 2 ? data[2] : 0);
+  }
 
-    // Mostrar color del LED de referencia (por defecto, 0 o el primero del universo)
-    uint16_t ledIndexToShow = DMX_DEBUG_LED_INDEX;
-    // Si ese LED NO pertenece a este universo, mostramos el primero de este universo
-    if (ledIndexToShow < pixelOffset || ledIndexToShow >= (pixelOffset + maxPixThisU)) {
-      ledIndexToShow = pixelOffset; // primer LED de este universo
-    }
-    if (ledIndexToShow < g_config.numLeds) {
-      CRGB c = leds[ledIndexToShow];
-      Serial.printf("\n  LED[%u]=(%u,%u,%u)\n", ledIndexToShow, c.r, c.g, c.b);
-    } else {
-      Serial.println();
-    }
+  g_lastDmxSequence = sequence;
+  if (frameComplete) {
+    latchNetworkFrame();
   }
-#endif
+}
 
-  // Actualizar cuando recibimos al menos un paquete de cada universo
-  bool all = true;
-  for (uint16_t i = 0; i < g_universeCount; i++) { if (!g_universeReceived[i]) { all = false; break; } }
-  if (all) {
-    FastLED.show();
-    std::fill(g_universeReceived.begin(), g_universeReceived.end(), 0);
+void onArtTimeCode(const ArtNetNode::TimeCode& timecode, IPAddress remoteIP)
+{
+  g_tcSync.onTimeCode(timecode.toMs(), millis());
+}
+
+void onArtSync(IPAddress remoteIP)
+{
+  if (g_show.state() == ShowRecorder::State::Playing) {
+    return;
+  }
+  if (g_ingest.sync()) {
+    latchNetworkFrame();
   }
 }
 
@@ -799,6 +1445,124 @@ uint8_t clampIndex(uint8_t value, uint8_t maxValue, uint8_t fallback)
   return value;
 }
 
+int8_t outputPinSlot(uint8_t pin)
+{
+  for (uint8_t i = 0; i < LedOutputs::PIN_COUNT; ++i) {
+    if (LedOutputs::PINS[i] == pin) return static_cast<int8_t>(i);
+  }
+  return -1;
+}
+
+// Lo que la configuración necesita del arena, además de los LEDs y universos.
+MemoryPlan::Needs memoryNeeds(const AppConfig& config)
+{
+  MemoryPlan::Needs needs;
+  needs.transmit = g_ledBackend.asynchronous();
+  needs.interpolation = config.interpolate;
+  needs.fallbackScene = config.sourceLossPolicy == static_cast<uint8_t>(RenderStage::SourceLossPolicy::Fallback);
+  needs.jitter = config.jitterLatencyMs > 0;
+  return needs;
+}
+
+// Cuántos LEDs entran en el arena con las opciones activas (interpolación,
+// escena de respaldo, buffer de jitter...).
+uint16_t ledBudget(const AppConfig& config)
+{
+  if (g_arena.capacity() == 0) {
+    return MAX_LEDS;   // sin arena todavía: no recortar la configuración guardada
+  }
+  return std::max<uint16_t>(1, MemoryPlan::maxLeds(memoryNeeds(config), config.pixelsPerUniverse, config.outputCount,
+                                                   g_arena.capacity(), MAX_LEDS));
+}
+
+// Cada salida usa un pin distinto de la lista y entre todas caben en el arena.
+void normalizeOutputs(AppConfig& config)
+{
+  config.outputCount = clampValue<uint8_t>(config.outputCount, 1, LedOutputs::MAX_OUTPUTS);
+  uint8_t usedPins = 0;
+  for (uint8_t i = 0; i < LedOutputs::MAX_OUTPUTS; ++i) {
+    int8_t slot = outputPinSlot(config.outputPins[i]);
+    if (slot < 0 || (usedPins & (1u << slot))) {
+      slot = 0;
+      while (usedPins & (1u << slot)) ++slot;
+      config.outputPins[i] = LedOutputs::PINS[slot];
+    }
+    usedPins |= 1u << slot;
+  }
+
+  for (uint8_t i = 0; i < LedOutputs::MAX_OUTPUTS; ++i) {
+    config.outputSources[i] = clampIndex(config.outputSources[i], static_cast<uint8_t>(OutputSource::SOURCE_COUNT),
+                                         static_cast<uint8_t>(OutputSource::Any));
+  }
+  for (uint8_t i = 0; i + 1 < LedOutputs::MAX_OUTPUTS; ++i) {
+    ExtraOutputConfig& out = config.extraOutputs[i];
+    out.chipType = clampIndex(out.chipType, static_cast<uint8_t>(LedChipType::CHIP_TYPE_COUNT), DEFAULT_CHIP_TYPE);
+    out.colorOrder = clampIndex(out.colorOrder, static_cast<uint8_t>(LedColorOrder::COLOR_ORDER_COUNT), DEFAULT_COLOR_ORDER);
+    out.startUniverse = clampValue<uint16_t>(out.startUniverse, 0, 32767);
+    out.powerLimitMa = clampValue<uint32_t>(out.powerLimitMa, 0, MAX_POWER_LIMIT_MA);
+  }
+
+  const uint16_t budget = ledBudget(config);
+  config.numLeds = std::min(config.numLeds, budget);
+  uint16_t used = config.numLeds;
+  for (uint8_t i = 1; i < config.outputCount; ++i) {
+    if (used >= budget) {
+      config.outputCount = i;
+      break;
+    }
+    ExtraOutputConfig& out = config.extraOutputs[i - 1];
+    out.ledCount = clampValue<uint16_t>(out.ledCount, 1, budget - used);
+    used += out.ledCount;
+  }
+}
+
+uint16_t totalLeds(const AppConfig& config)
+{
+  uint16_t total = config.numLeds;
+  for (uint8_t i = 1; i < config.outputCount; ++i) {
+    total += config.extraOutputs[i - 1].ledCount;
+  }
+  return total;
+}
+
+// Hasta la v16 había un solo límite para todas las salidas.  Al migrar se
+// reparte entre ellas según sus LEDs, así la suma no pasa del límite anterior.
+void splitSharedPowerLimit(AppConfig& config)
+{
+  const uint32_t shared = config.powerLimitMa;
+  const uint16_t total = totalLeds(config);
+  if (shared == 0 || config.outputCount < 2 || total == 0) {
+    return;
+  }
+  config.powerLimitMa = static_cast<uint32_t>((static_cast<uint64_t>(shared) * config.numLeds) / total);
+  for (uint8_t i = 1; i < config.outputCount; ++i) {
+    ExtraOutputConfig& out = config.extraOutputs[i - 1];
+    out.powerLimitMa = static_cast<uint32_t>((static_cast<uint64_t>(shared) * out.ledCount) / total);
+  }
+}
+
+// Las salidas ocupan tramos consecutivos del buffer, en orden.
+uint8_t describeOutputs(const AppConfig& config, LedOutputs::Output* outputs, FrameIngest::Range* ranges)
+{
+  uint16_t firstLed = 0;
+  for (uint8_t i = 0; i < config.outputCount; ++i) {
+    const bool first = i == 0;
+    const uint8_t chip = first ? config.chipType : config.extraOutputs[i - 1].chipType;
+    const uint8_t order = first ? config.colorOrder : config.extraOutputs[i - 1].colorOrder;
+    LedOutputs::Output& out = outputs[i];
+    out.pin = config.outputPins[i];
+    out.chip = static_cast<LedChipType>(chip);
+    out.colorOrder = static_cast<LedColorOrder>(order);
+    out.firstLed = firstLed;
+    out.ledCount = first ? config.numLeds : config.extraOutputs[i - 1].ledCount;
+    ranges[i].startUniverse = first ? config.startUniverse : config.extraOutputs[i - 1].startUniverse;
+    ranges[i].firstPixel = firstLed;
+    ranges[i].pixelCount = out.ledCount;
+    firstLed += out.ledCount;
+  }
+  return config.outputCount;
+}
+
 void normalizeConfig(AppConfig& config)
 {
   config.numLeds = clampValue<uint16_t>(config.numLeds, 1, MAX_LEDS);
@@ -809,12 +1573,29 @@ void normalizeConfig(AppConfig& config)
   }
   config.chipType   = clampIndex(config.chipType, static_cast<uint8_t>(LedChipType::CHIP_TYPE_COUNT), DEFAULT_CHIP_TYPE);
   config.colorOrder = clampIndex(config.colorOrder, static_cast<uint8_t>(LedColorOrder::COLOR_ORDER_COUNT), DEFAULT_COLOR_ORDER);
+  config.bootScene  = clampIndex(config.bootScene, static_cast<uint8_t>(BootSceneMode::BOOT_SCENE_MODE_COUNT), DEFAULT_BOOT_SCENE);
+  config.sourceLossPolicy = clampIndex(config.sourceLossPolicy, static_cast<uint8_t>(RenderStage::SourceLossPolicy::POLICY_COUNT),
+                                       DEFAULT_SOURCE_LOSS_POLICY);
+  config.sourceLossTimeoutMs = clampValue<uint32_t>(config.sourceLossTimeoutMs, 100, 600000);
+  config.sourceLossFadeMs = clampValue<uint32_t>(config.sourceLossFadeMs, 0, 60000);
+  config.mergeMode = clampIndex(config.mergeMode, 2, DEFAULT_MERGE_MODE);
+  config.maxFps = clampValue<uint16_t>(config.maxFps, 0, 1000);
+  config.powerLimitMa = clampValue<uint32_t>(config.powerLimitMa, 0, MAX_POWER_LIMIT_MA);
+  config.keepAliveMs = clampValue<uint16_t>(config.keepAliveMs, 0, 60000);
+  config.timecodeStartMs = clampValue<uint32_t>(config.timecodeStartMs, 0, MAX_TIMECODE_MS);
+  config.clockRole = clampIndex(config.clockRole, static_cast<uint8_t>(ClockSync::Role::ROLE_COUNT), DEFAULT_CLOCK_ROLE);
+  config.presentDelayMs = clampValue<uint16_t>(config.presentDelayMs, 1, MAX_PRESENT_DELAY_MS);
+  config.jitterLatencyMs = clampValue<uint16_t>(config.jitterLatencyMs, 0, FrameJitterBuffer::MAX_LATENCY_MS);
+  config.logLevel = clampIndex(config.logLevel, static_cast<uint8_t>(LogRing::Level::LEVEL_COUNT), DEFAULT_LOG_LEVEL);
+  if (config.syslogPort == 0) config.syslogPort = DEFAULT_SYSLOG_PORT;
+  normalizeOutputs(config);
   config.useDhcp = config.useDhcp ? true : false;
   config.fallbackToStatic = config.fallbackToStatic ? true : false;
   config.wifiEnabled = config.wifiEnabled ? true : false;
   config.wifiApMode  = config.wifiApMode ? true : false;
   config.artnetInput = clampValue<uint8_t>(config.artnetInput, 0,
                                            static_cast<uint8_t>(ArtNetNode::InterfacePreference::Auto));
+  config.wifiStandby = config.wifiStandby ? true : false;
 
   config.wifiStaSsid.trim();
   config.wifiStaPassword.trim();
@@ -839,6 +1620,19 @@ void normalizeConfig(AppConfig& config)
     config.wifiApPassword = config.wifiApPassword.substring(0, 64);
   }
 
+  config.shortName.trim();
+  config.longName.trim();
+  if (config.shortName.length() == 0) {
+    config.shortName = DEFAULT_SHORT_NAME;
+  } else if (config.shortName.length() > 17) {
+    config.shortName = config.shortName.substring(0, 17);
+  }
+  if (config.longName.length() == 0) {
+    config.longName = DEFAULT_LONG_NAME;
+  } else if (config.longName.length() > 63) {
+    config.longName = config.longName.substring(0, 63);
+  }
+
   if (config.staticSubnet == 0) {
     config.staticSubnet = DEFAULT_STATIC_MASK;
   }
@@ -856,126 +1650,370 @@ void normalizeConfig(AppConfig& config)
   }
 }
 
-template <template<uint8_t DATA_PIN, fl::EOrder RGB_ORDER> class CHIPSET>
-void addFastLedControllerForOrder(LedColorOrder order)
+const char* getChipName(uint8_t value)
 {
-  switch (order) {
-    case LedColorOrder::RGB: FastLED.addLeds<CHIPSET, LED_DATA_PIN, RGB>(leds, MAX_LEDS); break;
-    case LedColorOrder::RBG: FastLED.addLeds<CHIPSET, LED_DATA_PIN, RBG>(leds, MAX_LEDS); break;
-    case LedColorOrder::GRB: FastLED.addLeds<CHIPSET, LED_DATA_PIN, GRB>(leds, MAX_LEDS); break;
-    case LedColorOrder::GBR: FastLED.addLeds<CHIPSET, LED_DATA_PIN, GBR>(leds, MAX_LEDS); break;
-    case LedColorOrder::BRG: FastLED.addLeds<CHIPSET, LED_DATA_PIN, BRG>(leds, MAX_LEDS); break;
-    case LedColorOrder::BGR: FastLED.addLeds<CHIPSET, LED_DATA_PIN, BGR>(leds, MAX_LEDS); break;
-    default: FastLED.addLeds<CHIPSET, LED_DATA_PIN, BRG>(leds, MAX_LEDS); break;
-  }
+  uint8_t idx = clampIndex(value, static_cast<uint8_t>(LedChipType::CHIP_TYPE_COUNT), DEFAULT_CHIP_TYPE);
+  return CHIP_TYPE_NAMES[idx];
 }
 
-void initializeFastLEDController()
+const char* getColorOrderName(uint8_t value)
 {
-  static bool initialized = false;
-  if (initialized) return;
+  uint8_t idx = clampIndex(value, static_cast<uint8_t>(LedColorOrder::COLOR_ORDER_COUNT), DEFAULT_COLOR_ORDER);
+  return COLOR_ORDER_NAMES[idx];
+}
 
-  LedChipType chip = static_cast<LedChipType>(clampIndex(g_config.chipType, static_cast<uint8_t>(LedChipType::CHIP_TYPE_COUNT), DEFAULT_CHIP_TYPE));
-  LedColorOrder order = static_cast<LedColorOrder>(clampIndex(g_config.colorOrder, static_cast<uint8_t>(LedColorOrder::COLOR_ORDER_COUNT), DEFAULT_COLOR_ORDER));
+void copyConfigString(char* dest, size_t size, const String& value)
+{
+  memset(dest, 0, size);
+  memcpy(dest, value.c_str(), std::min<size_t>(value.length(), size - 1));
+}
 
-  switch (chip) {
-    case LedChipType::WS2811:
-      addFastLedControllerForOrder<WS2811>(order);
-      break;
-    case LedChipType::WS2812B:
-      addFastLedControllerForOrder<WS2812B>(order);
-      break;
-    case LedChipType::SK6812:
-      addFastLedControllerForOrder<SK6812>(order);
-      break;
-    default:
-      addFastLedControllerForOrder<WS2811>(order);
-      break;
-  }
+String readConfigString(const char* src, size_t size)
+{
+  char buffer[80];
+  const size_t length = std::min<size_t>(strnlen(src, size), sizeof(buffer) - 1);
+  memcpy(buffer, src, length);
+  buffer[length] = '\0';
+  return String(buffer);
+}
 
-  initialized = true;
+void toPersistedConfig(const AppConfig& config, PersistedConfig& blob)
+{
+  memset(&blob, 0, sizeof(blob));
+  blob.dhcpTimeoutMs     = config.dhcpTimeoutMs;
+  blob.staticIp          = config.staticIp;
+  blob.staticGateway     = config.staticGateway;
+  blob.staticSubnet      = config.staticSubnet;
+  blob.staticDns1        = config.staticDns1;
+  blob.staticDns2        = config.staticDns2;
+  blob.numLeds           = config.numLeds;
+  blob.startUniverse     = config.startUniverse;
+  blob.pixelsPerUniverse = config.pixelsPerUniverse;
+  blob.brightness        = config.brightness;
+  blob.chipType          = config.chipType;
+  blob.colorOrder        = config.colorOrder;
+  blob.useDhcp           = config.useDhcp ? 1 : 0;
+  blob.fallbackToStatic  = config.fallbackToStatic ? 1 : 0;
+  blob.wifiEnabled       = config.wifiEnabled ? 1 : 0;
+  blob.wifiApMode        = config.wifiApMode ? 1 : 0;
+  blob.artnetInput       = config.artnetInput;
+  blob.wifiStandby       = config.wifiStandby ? 1 : 0;
+  blob.bootScene         = config.bootScene;
+  blob.sourceLossTimeoutMs = config.sourceLossTimeoutMs;
+  blob.sourceLossFadeMs  = config.sourceLossFadeMs;
+  blob.sourceLossPolicy  = config.sourceLossPolicy;
+  blob.mergeMode         = config.mergeMode;
+  blob.maxFps            = config.maxFps;
+  blob.interpolate       = config.interpolate ? 1 : 0;
+  blob.powerLimitMa      = config.powerLimitMa;
+  blob.keepAliveMs       = config.keepAliveMs;
+  blob.timecodeSync      = config.timecodeSync ? 1 : 0;
+  blob.timecodeStartMs   = config.timecodeStartMs;
+  blob.clockRole         = config.clockRole;
+  blob.presentDelayMs    = config.presentDelayMs;
+  blob.clockMasterIp     = config.clockMasterIp;
+  blob.jitterLatencyMs   = config.jitterLatencyMs;
+  blob.logLevel          = config.logLevel;
+  blob.syslogPort        = config.syslogPort;
+  blob.syslogIp          = config.syslogIp;
+  blob.outputCount       = config.outputCount;
+  for (uint8_t i = 0; i < LedOutputs::MAX_OUTPUTS; ++i) {
+    blob.outputPins[i]   = config.outputPins[i];
+    blob.outputSources[i] = config.outputSources[i];
+  }
+  for (uint8_t i = 0; i + 1 < LedOutputs::MAX_OUTPUTS; ++i) {
+    blob.extraOutputs[i].ledCount      = config.extraOutputs[i].ledCount;
+    blob.extraOutputs[i].startUniverse = config.extraOutputs[i].startUniverse;
+    blob.extraOutputs[i].chipType      = config.extraOutputs[i].chipType;
+    blob.extraOutputs[i].colorOrder    = config.extraOutputs[i].colorOrder;
+    blob.outputPowerLimitMa[i]         = config.extraOutputs[i].powerLimitMa;
+  }
+  copyConfigString(blob.wifiStaSsid, sizeof(blob.wifiStaSsid), config.wifiStaSsid);
+  copyConfigString(blob.wifiStaPassword, sizeof(blob.wifiStaPassword), config.wifiStaPassword);
+  copyConfigString(blob.wifiApSsid, sizeof(blob.wifiApSsid), config.wifiApSsid);
+  copyConfigString(blob.wifiApPassword, sizeof(blob.wifiApPassword), config.wifiApPassword);
+  copyConfigString(blob.shortName, sizeof(blob.shortName), config.shortName);
+  copyConfigString(blob.longName, sizeof(blob.longName), config.longName);
 }
 
-const char* getChipName(uint8_t value)
+void fromPersistedConfig(const PersistedConfig& blob, AppConfig& config)
 {
-  uint8_t idx = clampIndex(value, static_cast<uint8_t>(LedChipType::CHIP_TYPE_COUNT), DEFAULT_CHIP_TYPE);
-  return CHIP_TYPE_NAMES[idx];
+  config.dhcpTimeoutMs     = blob.dhcpTimeoutMs;
+  config.staticIp          = blob.staticIp;
+  config.staticGateway     = blob.staticGateway;
+  config.staticSubnet      = blob.staticSubnet;
+  config.staticDns1        = blob.staticDns1;
+  config.staticDns2        = blob.staticDns2;
+  config.numLeds           = blob.numLeds;
+  config.startUniverse     = blob.startUniverse;
+  config.pixelsPerUniverse = blob.pixelsPerUniverse;
+  config.brightness        = blob.brightness;
+  config.chipType          = blob.chipType;
+  config.colorOrder        = blob.colorOrder;
+  config.useDhcp           = blob.useDhcp != 0;
+  config.fallbackToStatic  = blob.fallbackToStatic != 0;
+  config.wifiEnabled       = blob.wifiEnabled != 0;
+  config.wifiApMode        = blob.wifiApMode != 0;
+  config.artnetInput       = blob.artnetInput;
+  config.wifiStandby       = blob.wifiStandby != 0;
+  config.bootScene         = blob.bootScene;
+  config.sourceLossTimeoutMs = blob.sourceLossTimeoutMs;
+  config.sourceLossFadeMs  = blob.sourceLossFadeMs;
+  config.sourceLossPolicy  = blob.sourceLossPolicy;
+  config.mergeMode         = blob.mergeMode;
+  config.maxFps            = blob.maxFps;
+  config.interpolate       = blob.interpolate != 0;
+  config.powerLimitMa      = blob.powerLimitMa;
+  config.keepAliveMs       = blob.keepAliveMs;
+  config.timecodeSync      = blob.timecodeSync != 0;
+  config.timecodeStartMs   = blob.timecodeStartMs;
+  config.clockRole         = blob.clockRole;
+  config.presentDelayMs    = blob.presentDelayMs;
+  config.clockMasterIp     = blob.clockMasterIp;
+  config.jitterLatencyMs   = blob.jitterLatencyMs;
+  config.logLevel          = blob.logLevel;
+  config.syslogPort        = blob.syslogPort;
+  config.syslogIp          = blob.syslogIp;
+  config.outputCount       = blob.outputCount;
+  for (uint8_t i = 0; i < LedOutputs::MAX_OUTPUTS; ++i) {
+    config.outputPins[i]   = blob.outputPins[i];
+    config.outputSources[i] = blob.outputSources[i];
+  }
+  for (uint8_t i = 0; i + 1 < LedOutputs::MAX_OUTPUTS; ++i) {
+    config.extraOutputs[i].ledCount      = blob.extraOutputs[i].ledCount;
+    config.extraOutputs[i].startUniverse = blob.extraOutputs[i].startUniverse;
+    config.extraOutputs[i].chipType      = blob.extraOutputs[i].chipType;
+    config.extraOutputs[i].colorOrder    = blob.extraOutputs[i].colorOrder;
+    config.extraOutputs[i].powerLimitMa  = blob.outputPowerLimitMa[i];
+  }
+  config.wifiStaSsid       = readConfigString(blob.wifiStaSsid, sizeof(blob.wifiStaSsid));
+  config.wifiStaPassword   = readConfigString(blob.wifiStaPassword, sizeof(blob.wifiStaPassword));
+  config.wifiApSsid        = readConfigString(blob.wifiApSsid, sizeof(blob.wifiApSsid));
+  config.wifiApPassword    = readConfigString(blob.wifiApPassword, sizeof(blob.wifiApPassword));
+  config.shortName         = readConfigString(blob.shortName, sizeof(blob.shortName));
+  config.longName          = readConfigString(blob.longName, sizeof(blob.longName));
 }
 
-const char* getColorOrderName(uint8_t value)
+// Claves sueltas usadas por firmwares anteriores al blob "cfg".
+const char* const LEGACY_CONFIG_KEYS[] = {
+  "dhcpTimeout", "numLeds", "startUni", "pixPerUni", "brightness", "chipType", "colorOrder",
+  "useDhcp", "dhcpFallback", "staticIp", "staticGw", "staticMask", "staticDns1", "staticDns2",
+  "wifiEnabled", "wifiApMode", "artnetInput", "wifiStaSsid", "wifiStaPass", "wifiApSsid", "wifiApPass"
+};
+
+bool loadLegacyConfig(AppConfig& config)
 {
-  uint8_t idx = clampIndex(value, static_cast<uint8_t>(LedColorOrder::COLOR_ORDER_COUNT), DEFAULT_COLOR_ORDER);
-  return COLOR_ORDER_NAMES[idx];
+  bool found = false;
+  if (g_prefs.begin("pixelcfg", true)) {
+    found = g_prefs.isKey("numLeds");
+    if (found) {
+      config.dhcpTimeoutMs   = g_prefs.getUInt("dhcpTimeout", config.dhcpTimeoutMs);
+      config.numLeds         = g_prefs.getUShort("numLeds", config.numLeds);
+      config.startUniverse   = g_prefs.getUShort("startUni", config.startUniverse);
+      config.pixelsPerUniverse = g_prefs.getUShort("pixPerUni", config.pixelsPerUniverse);
+      config.brightness      = g_prefs.getUChar("brightness", config.brightness);
+      config.chipType        = g_prefs.getUChar("chipType", config.chipType);
+      config.colorOrder      = g_prefs.getUChar("colorOrder", config.colorOrder);
+      config.useDhcp         = g_prefs.getBool("useDhcp", config.useDhcp);
+      config.fallbackToStatic = g_prefs.getBool("dhcpFallback", config.fallbackToStatic);
+      config.staticIp        = g_prefs.getUInt("staticIp", config.staticIp);
+      config.staticGateway   = g_prefs.getUInt("staticGw", config.staticGateway);
+      config.staticSubnet    = g_prefs.getUInt("staticMask", config.staticSubnet);
+      config.staticDns1      = g_prefs.getUInt("staticDns1", config.staticDns1);
+      config.staticDns2      = g_prefs.getUInt("staticDns2", config.staticDns2);
+      config.wifiEnabled     = g_prefs.getBool("wifiEnabled", config.wifiEnabled);
+      config.wifiApMode      = g_prefs.getBool("wifiApMode", config.wifiApMode);
+      config.artnetInput     = g_prefs.getUChar("artnetInput", config.artnetInput);
+      config.wifiStaSsid     = g_prefs.getString("wifiStaSsid", config.wifiStaSsid);
+      config.wifiStaPassword = g_prefs.getString("wifiStaPass", config.wifiStaPassword);
+      config.wifiApSsid      = g_prefs.getString("wifiApSsid", config.wifiApSsid);
+      config.wifiApPassword  = g_prefs.getString("wifiApPass", config.wifiApPassword);
+    }
+    g_prefs.end();
+  }
+  return found;
+}
+
+void removeLegacyConfigKeys()
+{
+  if (g_prefs.begin("pixelcfg", false)) {
+    for (const char* key : LEGACY_CONFIG_KEYS) {
+      g_prefs.remove(key);
+    }
+    g_prefs.end();
+  }
 }
 
 void loadConfig()
 {
   g_config = makeDefaultConfig();
 
-  if (g_prefs.begin("pixelcfg", true)) {
-    g_config.dhcpTimeoutMs   = g_prefs.getUInt("dhcpTimeout", g_config.dhcpTimeoutMs);
-    g_config.numLeds         = g_prefs.getUShort("numLeds", g_config.numLeds);
-    g_config.startUniverse   = g_prefs.getUShort("startUni", g_config.startUniverse);
-    g_config.pixelsPerUniverse = g_prefs.getUShort("pixPerUni", g_config.pixelsPerUniverse);
-    g_config.brightness      = g_prefs.getUChar("brightness", g_config.brightness);
-    g_config.chipType        = g_prefs.getUChar("chipType", g_config.chipType);
-    g_config.colorOrder      = g_prefs.getUChar("colorOrder", g_config.colorOrder);
-    g_config.useDhcp         = g_prefs.getBool("useDhcp", g_config.useDhcp);
-    g_config.fallbackToStatic = g_prefs.getBool("dhcpFallback", g_config.fallbackToStatic);
-    g_config.staticIp        = g_prefs.getUInt("staticIp", g_config.staticIp);
-    g_config.staticGateway   = g_prefs.getUInt("staticGw", g_config.staticGateway);
-    g_config.staticSubnet    = g_prefs.getUInt("staticMask", g_config.staticSubnet);
-    g_config.staticDns1      = g_prefs.getUInt("staticDns1", g_config.staticDns1);
-    g_config.staticDns2      = g_prefs.getUInt("staticDns2", g_config.staticDns2);
-    g_config.wifiEnabled     = g_prefs.getBool("wifiEnabled", g_config.wifiEnabled);
-    g_config.wifiApMode      = g_prefs.getBool("wifiApMode", g_config.wifiApMode);
-    g_config.artnetInput     = g_prefs.getUChar("artnetInput", g_config.artnetInput);
-    g_config.wifiStaSsid     = g_prefs.getString("wifiStaSsid", g_config.wifiStaSsid);
-    g_config.wifiStaPassword = g_prefs.getString("wifiStaPass", g_config.wifiStaPassword);
-    g_config.wifiApSsid      = g_prefs.getString("wifiApSsid", g_config.wifiApSsid);
-    g_config.wifiApPassword  = g_prefs.getString("wifiApPass", g_config.wifiApPassword);
-    g_prefs.end();
+  PersistedConfig blob;
+  toPersistedConfig(g_config, blob);
+  uint16_t version = 0;
+  size_t length = 0;
+  bool migrate = false;
+  bool splitPower = false;
+
+  switch (g_configStore.load(&blob, sizeof(blob), version, length)) {
+    case ConfigStore::LoadResult::Ok:
+      fromPersistedConfig(blob, g_config);
+      // Un blob de otra versión se reescribe con la disposición actual.
+      migrate = (version != CONFIG_BLOB_VERSION || length != sizeof(blob));
+      splitPower = version < 17;
+      break;
+    case ConfigStore::LoadResult::Missing:
+      migrate = loadLegacyConfig(g_config);
+      if (migrate) {
+        g_log.log(LogLevel::Info, LogTag::Cfg, "Migrando configuración desde claves NVS sueltas.");
+      }
+      break;
+    case ConfigStore::LoadResult::Corrupt:
+      g_log.log(LogLevel::Warn, LogTag::Cfg, "Configuración guardada inválida (CRC); se usan valores por defecto.");
+      break;
   }
 
   normalizeConfig(g_config);
+  if (splitPower) {
+    splitSharedPowerLimit(g_config);
+  }
+
+  if (migrate) {
+    saveConfig();
+    if (g_configStore.flush()) {
+      removeLegacyConfigKeys();
+    }
+  }
 }
 
+// Sólo deja el cambio pendiente: serviceConfigPersistence() lo escribe desde
+// loop() cuando no hay tráfico DMX (o vence ConfigStore::MAX_DEFER_MS).
 void saveConfig()
 {
-  if (g_prefs.begin("pixelcfg", false)) {
-    g_prefs.putUInt("dhcpTimeout", g_config.dhcpTimeoutMs);
-    g_prefs.putUShort("numLeds", g_config.numLeds);
-    g_prefs.putUShort("startUni", g_config.startUniverse);
-    g_prefs.putUShort("pixPerUni", g_config.pixelsPerUniverse);
-    g_prefs.putUChar("brightness", g_config.brightness);
-    g_prefs.putUChar("chipType", g_config.chipType);
-    g_prefs.putUChar("colorOrder", g_config.colorOrder);
-    g_prefs.putBool("useDhcp", g_config.useDhcp);
-    g_prefs.putBool("dhcpFallback", g_config.fallbackToStatic);
-    g_prefs.putUInt("staticIp", g_config.staticIp);
-    g_prefs.putUInt("staticGw", g_config.staticGateway);
-    g_prefs.putUInt("staticMask", g_config.staticSubnet);
-    g_prefs.putUInt("staticDns1", g_config.staticDns1);
-    g_prefs.putUInt("staticDns2", g_config.staticDns2);
-    g_prefs.putBool("wifiEnabled", g_config.wifiEnabled);
-    g_prefs.putBool("wifiApMode", g_config.wifiApMode);
-    g_prefs.putUChar("artnetInput", g_config.artnetInput);
-    g_prefs.putString("wifiStaSsid", g_config.wifiStaSsid);
-    g_prefs.putString("wifiStaPass", g_config.wifiStaPassword);
-    g_prefs.putString("wifiApSsid", g_config.wifiApSsid);
-    g_prefs.putString("wifiApPass", g_config.wifiApPassword);
-    g_prefs.end();
+  PersistedConfig blob;
+  toPersistedConfig(g_config, blob);
+  g_configStore.stage(&blob, sizeof(blob), CONFIG_BLOB_VERSION);
+}
+
+void serviceConfigPersistence()
+{
+  constexpr uint32_t DMX_QUIET_MS = 250;
+  const bool quiet = (millis() - g_lastDmxMs) >= DMX_QUIET_MS;
+  if (g_configStore.service(quiet)) {
+    g_log.log(LogLevel::Info, LogTag::Cfg, "Configuración guardada (%u escrituras, %u sin cambios)",
+              g_configStore.writeCount(), g_configStore.skippedCount());
+  }
+}
+
+// RFC 3164 sin marca de tiempo (la pone el servidor), facility local0.
+void sendSyslog(const LogRing::Record& record, const char* line)
+{
+  if (!g_config.syslogIp || !(eth_has_ip || wifi_sta_has_ip || wifi_ap_running)) {
+    return;
+  }
+  static const uint8_t SEVERITY[] = {3, 4, 6, 7};   // err, warning, info, debug
+  char header[48];
+  const int length = snprintf(header, sizeof(header), "<%u>%s PixelEtherLED: ",
+                              16u * 8u + SEVERITY[static_cast<uint8_t>(record.level)], DEVICE_HOSTNAME);
+  if (!g_syslogUdp.beginPacket(IPAddress(g_config.syslogIp), g_config.syslogPort)) {
+    return;
+  }
+  g_syslogUdp.write(reinterpret_cast<const uint8_t*>(header), static_cast<size_t>(length));
+  g_syslogUdp.write(reinterpret_cast<const uint8_t*>(line), strlen(line));
+  g_syslogUdp.endPacket();
+}
+
+// Saca del registro lo que entra en el buffer de la UART, como mucho
+// LOG_DRAIN_PER_PASS por pasada: loop() nunca espera al puerto serie.  Lo que
+// no entra queda para la próxima pasada; si el anillo se llena, los mensajes
+// nuevos se descartan y se cuentan en logs.dropped.
+void serviceLogs()
+{
+  char line[LogRing::LINE_SIZE];
+  for (uint8_t i = 0; i < LOG_DRAIN_PER_PASS; ++i) {
+    const LogRing::Record* record = g_log.peek();
+    if (!record) {
+      return;
+    }
+    const size_t length = LogRing::format(*record, line, sizeof(line));
+    if (static_cast<size_t>(Serial.availableForWrite()) < length + 1) {
+      return;
+    }
+    Serial.write(reinterpret_cast<const uint8_t*>(line), length);
+    Serial.write('\n');
+    sendSyslog(*record, line);
+    g_log.pop();
   }
 }
 
+// Lo que se aplica sin repartir buffers: también lo usa ArtAddress cuando sólo
+// cambian los nombres o el modo de fusión, para no apagar la salida.
+void applyArtNetSettings()
+{
+  g_ingest.setMergeMode(static_cast<FrameIngest::MergeMode>(g_config.mergeMode));
+  artnet.setMergeLtp(g_config.mergeMode == static_cast<uint8_t>(FrameIngest::MergeMode::Ltp));
+  artnet.setNodeNames(g_config.shortName, g_config.longName);
+}
+
 void applyConfig()
 {
   normalizeConfig(g_config);
-  g_universeCount = (g_config.numLeds + g_config.pixelsPerUniverse - 1) / g_config.pixelsPerUniverse;
-  g_universeCount = std::max<uint16_t>(1, g_universeCount);
-  g_universeReceived.assign(g_universeCount, 0);
-
-  artnet.setUniverseInfo(g_config.startUniverse, g_universeCount);
+  LedOutputs::Output outputs[LedOutputs::MAX_OUTPUTS];
+  FrameIngest::Range ranges[LedOutputs::MAX_OUTPUTS];
+  const uint8_t outputCount = describeOutputs(g_config, outputs, ranges);
+  const uint16_t ledCount = totalLeds(g_config);
+
+  // Todos los buffers que dependen de la configuración salen del arena, en un
+  // solo reparto: nada se reserva después en el camino de los datos.
+  MemoryPlan::Needs needs = memoryNeeds(g_config);
+  needs.leds = ledCount;
+  needs.universes = FrameIngest::universesFor(ranges, outputCount, g_config.pixelsPerUniverse);
+  needs.ranges = outputCount;
+  g_memoryPlan = MemoryPlan::compute(needs, g_arena.capacity());
+  if (!g_memoryPlan.fits) {
+    g_log.log(LogLevel::Warn, LogTag::Mem, "La configuración necesita %u bytes y el arena tiene %u.",
+              g_memoryPlan.totalBytes(), g_arena.capacity());
+  }
+  // La tarea de salida no puede seguir leyendo un buffer que se reparte de nuevo.
+  g_outputs.waitIdle();
+  g_arena.reset();
+  leds = g_arena.take<CRGB>("pixels", ledCount);
+  g_outputs.setBuffers(leds, ledCount, g_arena);
+  g_pacer.setBackgroundShow(g_outputs.asynchronous());
+  g_render.setInterpolation(g_config.interpolate);
+  g_render.setSourceLoss(static_cast<RenderStage::SourceLossPolicy>(g_config.sourceLossPolicy),
+                         g_config.sourceLossTimeoutMs, g_config.sourceLossFadeMs);
+  g_ingest.configure(ranges, outputCount, g_config.pixelsPerUniverse, g_arena, g_memoryPlan.mergeSlots);
+  g_render.configure(leds, ledCount, g_arena);
+  g_jitter.configure(ledCount, g_config.jitterLatencyMs, g_arena, g_memoryPlan.jitterFrames);
+  g_ingest.setStaging(g_jitter.staging());
+  applyArtNetSettings();
+  g_render.setKeepAlive(g_config.keepAliveMs);
+  g_pacer.setMaxFps(g_config.maxFps);
+  g_tcSync.setEnabled(g_config.timecodeSync);
+  g_log.setLevel(static_cast<LogRing::Level>(g_config.logLevel));
+  g_clock.setPresentDelay(static_cast<uint32_t>(g_config.presentDelayMs) * 1000);
+  if (g_clockReady) {
+    g_clock.begin(static_cast<ClockSync::Role>(g_config.clockRole), IPAddress(g_config.clockMasterIp));
+  }
+  g_tcSync.setStartMs(g_config.timecodeStartMs);
+  // Cada salida con su fuente; el brillo baja por la que más se pase.
+  g_power.setOutputCount(outputCount);
+  for (uint8_t i = 0; i < outputCount; ++i) {
+    const uint32_t limitMa = i == 0 ? g_config.powerLimitMa : g_config.extraOutputs[i - 1].powerLimitMa;
+    g_power.setOutput(i, outputs[i].firstLed, outputs[i].ledCount, limitMa);
+  }
+
+  artnet.setUniverseInfo(g_config.startUniverse, g_ingest.universeCount());
+  ArtNetNode::SourceFilter filters[LedOutputs::MAX_OUTPUTS];
+  for (uint8_t i = 0; i < outputCount; ++i) {
+    filters[i].firstUniverse = ranges[i].startUniverse;
+    filters[i].universeCount = FrameIngest::universesFor(&ranges[i], 1, g_config.pixelsPerUniverse);
+    filters[i].interfaces = OUTPUT_SOURCE_INTERFACES[g_config.outputSources[i]];
+  }
+  artnet.setSourceFilters(filters, outputCount);
+  // Los universos que no son nuestros se descartan al leer la cabecera.
+  artnet.setUniverseFilter(&g_ingest.portAddressMap());
 
   ArtNetNode::InterfacePreference pref = ArtNetNode::InterfacePreference::Ethernet;
   if (g_config.artnetInput == static_cast<uint8_t>(ArtNetNode::InterfacePreference::WiFi)) {
@@ -984,14 +2022,125 @@ void applyConfig()
     pref = ArtNetNode::InterfacePreference::Auto;
   }
   artnet.setInterfacePreference(pref);
+  artnet.setStandby(g_config.wifiStandby);
 
+  // FastLED no puede quitar controladores: cambiar pin, chip u orden de color
+  // de una salida ya creada se aplica al reiniciar.
+  g_outputsNeedRestart = !g_outputs.configure(outputs, outputCount);
   FastLED.setBrightness(g_config.brightness);
-  FastLED.clear(true);
+  g_outputs.clear();
+}
+
+// ArtAddress: una consola renombra o re-parchea el nodo por la red.  Queda
+// guardado como un POST de /config, sin reiniciar; ArtNetNode responde después
+// con un ArtPollReply que ya muestra lo nuevo.
+void onArtAddress(const ArtNetNode::AddressProgram& program, IPAddress remoteIP)
+{
+  using Program = ArtNetNode::AddressProgram;
+  AppConfig newConfig = g_config;
+  if (program.shortName.length()) newConfig.shortName = program.shortName;
+  if (program.longName.length()) newConfig.longName = program.longName;
+
+  // Net, SubNet y SwOut arman el universo inicial de la salida 1; las demás
+  // salidas se corren lo mismo y conservan la distancia entre ellas.
+  auto field = [](int16_t value, uint16_t current, uint16_t reset) {
+    if (value == Program::UNCHANGED) return current;
+    if (value == Program::RESET) return reset;
+    return static_cast<uint16_t>(value);
+  };
+  const uint16_t start = g_config.startUniverse;
+  const uint16_t net = field(program.net, (start >> 8) & 0x7F, (DEFAULT_START_UNIVERSE >> 8) & 0x7F);
+  const uint16_t sub = field(program.subNet, (start >> 4) & 0x0F, (DEFAULT_START_UNIVERSE >> 4) & 0x0F);
+  const uint16_t sw  = field(program.swOut, start & 0x0F, DEFAULT_START_UNIVERSE & 0x0F);
+  newConfig.startUniverse = static_cast<uint16_t>((net << 8) | (sub << 4) | sw);
+  const int32_t shift = static_cast<int32_t>(newConfig.startUniverse) - start;
+  for (ExtraOutputConfig& out : newConfig.extraOutputs) {
+    out.startUniverse = static_cast<uint16_t>(clampValue<int32_t>(out.startUniverse + shift, 0, 32767));
+  }
+
+  if (program.command == ArtNetNode::AddressCommand::MergeLtp) {
+    newConfig.mergeMode = static_cast<uint8_t>(FrameIngest::MergeMode::Ltp);
+  } else if (program.command == ArtNetNode::AddressCommand::MergeHtp) {
+    newConfig.mergeMode = static_cast<uint8_t>(FrameIngest::MergeMode::Htp);
+  }
+  normalizeConfig(newConfig);
+
+  const bool repatch = newConfig.startUniverse != g_config.startUniverse;
+  const bool changed = repatch || newConfig.shortName != g_config.shortName ||
+                       newConfig.longName != g_config.longName || newConfig.mergeMode != g_config.mergeMode;
+  if (changed) {
+    g_config = newConfig;
+    if (repatch) {
+      applyConfig();
+    } else {
+      applyArtNetSettings();
+    }
+    saveConfig();
+    reportDiagnostic(ArtNetNode::DiagPriority::Low, "ArtAddress de %s: universo %u, fusión %s, nombre \"%s\"",
+                     remoteIP.toString().c_str(), g_config.startUniverse, g_config.mergeMode ? "LTP" : "HTP",
+                     g_config.shortName.c_str());
+  }
+  if (program.command == ArtNetNode::AddressCommand::CancelMerge) {
+    g_ingest.cancelMerge();
+  }
+}
+
+// ArtIpProg: IP, máscara, puerta de enlace o DHCP de Ethernet.  Se guarda ya,
+// pero la interfaz cambia en serviceIpProgram(), después de que ArtNetNode
+// responda desde la IP actual.
+void onArtIpProg(const ArtNetNode::IpProgram& program, IPAddress remoteIP, ArtNetNode::IpSettings& settings)
+{
+  if (program.enable) {
+    AppConfig newConfig = g_config;
+    if (program.resetDefaults) {
+      const AppConfig defaults = makeDefaultConfig();
+      newConfig.useDhcp = defaults.useDhcp;
+      newConfig.staticIp = defaults.staticIp;
+      newConfig.staticSubnet = defaults.staticSubnet;
+      newConfig.staticGateway = defaults.staticGateway;
+    }
+    if (program.dhcp) {
+      newConfig.useDhcp = true;
+    } else {
+      if (program.setIp && program.ip != IPAddress((uint32_t)0)) {
+        newConfig.staticIp = program.ip;
+        newConfig.useDhcp = false;
+      }
+      if (program.setMask && program.mask != IPAddress((uint32_t)0)) {
+        newConfig.staticSubnet = program.mask;
+      }
+      if (program.setGateway && program.gateway != IPAddress((uint32_t)0)) {
+        newConfig.staticGateway = program.gateway;
+      }
+    }
+    normalizeConfig(newConfig);
+
+    if (newConfig.useDhcp != g_config.useDhcp || newConfig.staticIp != g_config.staticIp ||
+        newConfig.staticSubnet != g_config.staticSubnet || newConfig.staticGateway != g_config.staticGateway) {
+      g_config = newConfig;
+      saveConfig();
+      g_ipProgramPending = true;
+      reportDiagnostic(ArtNetNode::DiagPriority::Medium, "ArtIpProg de %s: %s", remoteIP.toString().c_str(),
+                       g_config.useDhcp ? "DHCP" : ipToString(g_config.staticIp).c_str());
+    }
+  }
+
+  settings.dhcp = g_config.useDhcp;
+  if (g_config.useDhcp) {
+    // Hasta que DHCP asigne otra, sigue valiendo la actual.
+    settings.ip = ETH.localIP();
+    settings.mask = ETH.subnetMask();
+    settings.gateway = ETH.gatewayIP();
+  } else {
+    settings.ip = IPAddress(g_config.staticIp);
+    settings.mask = IPAddress(g_config.staticSubnet);
+    settings.gateway = IPAddress(g_config.staticGateway);
+  }
 }
 
 String buildVisualizerPage()
 {
-  const uint16_t ledCount = std::min<uint16_t>(g_config.numLeds, MAX_LEDS);
+  const uint16_t ledCount = std::min<uint16_t>(totalLeds(g_config), VISUALIZER_MAX_LEDS);
   const uint16_t fallbackWidth = ledCount > 0 ? std::min<uint16_t>(ledCount, static_cast<uint16_t>(16)) : static_cast<uint16_t>(1);
   const uint16_t safeWidth = fallbackWidth == 0 ? static_cast<uint16_t>(1) : fallbackWidth;
   const uint16_t safeHeight = std::max<uint16_t>(static_cast<uint16_t>(1), static_cast<uint16_t>((ledCount + safeWidth - 1) / safeWidth));
@@ -1049,19 +2198,20 @@ String buildVisualizerPage()
   html += F("<div class='info-panel'>");
   html += F("<div><strong>LED seleccionado:</strong> <span id='infoIndex'>-</span></div>");
   html += F("<div><strong>Color:</strong> <span id='infoColor'>-</span></div>");
+  html += F("<div><strong>Frame:</strong> <span id='infoFrame'>-</span></div>");
   html += F("</div>");
   html += F("<p style='margin-top:1.5rem;font-size:0.9rem;'><a class='link' href='/config'>&larr; Volver al panel de configuración</a></p>");
   html += F("</div>");
   html += F("</section>");
   html += F("<script>");
   html += "const totalLeds=" + String(ledCount) + ";";
-  html += F("const grid=document.getElementById('visualizerGrid');const widthInput=document.getElementById('matrixWidth');const heightInput=document.getElementById('matrixHeight');const serpInput=document.getElementById('serpentine');const scanInput=document.getElementById('scanMode');const cornerInput=document.getElementById('startCorner');const infoIndex=document.getElementById('infoIndex');const infoColor=document.getElementById('infoColor');const cellMap=new Map();let latestData=[];");
+  html += F("const grid=document.getElementById('visualizerGrid');const widthInput=document.getElementById('matrixWidth');const heightInput=document.getElementById('matrixHeight');const serpInput=document.getElementById('serpentine');const scanInput=document.getElementById('scanMode');const cornerInput=document.getElementById('startCorner');const infoIndex=document.getElementById('infoIndex');const infoColor=document.getElementById('infoColor');const infoFrame=document.getElementById('infoFrame');const cellMap=new Map();let latestData=[];let lastFrame=-1;");
   html += F("if(totalLeds===0){[widthInput,heightInput,serpInput,scanInput,cornerInput].forEach(function(el){if(el){el.disabled=true;}});} ");
   html += F("function ensureDimensions(){let width=parseInt(widthInput.value,10);if(!Number.isFinite(width)||width<1){width=1;widthInput.value='1';}let height=parseInt(heightInput.value,10);if(!Number.isFinite(height)||height<1){height=1;heightInput.value='1';}if(totalLeds>0){const minHeight=Math.ceil(totalLeds/width);if(height<minHeight){height=minHeight;heightInput.value=String(height);}}return{width,height};}");
   html += F("function layoutCells(width,height,serp,mode,corner){const cells=[];let led=0;if(totalLeds===0){return cells;}if(mode==='row'){rows:for(let y=0;y<height;y++){let xs=Array.from({length:width},(_,i)=>i);if(serp&&y%2===1){xs.reverse();}for(const x of xs){if(led>=totalLeds){break rows;}cells.push({ledIndex:led,x:x,y:y});led++;}}}else{cols:for(let x=0;x<width;x++){let ys=Array.from({length:height},(_,i)=>i);if(serp&&x%2===1){ys.reverse();}for(const y of ys){if(led>=totalLeds){break cols;}cells.push({ledIndex:led,x:x,y:y});led++;}}}return cells.map(function(cell){let px=cell.x;let py=cell.y;if(corner==='tr'||corner==='br'){px=width-1-px;}if(corner==='bl'||corner==='br'){py=height-1-py;}return{ledIndex:cell.ledIndex,x:px,y:py};});}");
   html += F("function rebuildGrid(){cellMap.clear();grid.innerHTML='';const dims=ensureDimensions();const width=dims.width;const height=dims.height;grid.style.gridTemplateColumns='repeat('+width+', minmax(32px,1fr))';if(totalLeds===0){const msg=document.createElement('p');msg.textContent='No hay LEDs configurados en este dispositivo.';msg.style.color='#cfd8f7';msg.style.fontSize='0.95rem';grid.appendChild(msg);return;}const cells=layoutCells(width,height,serpInput.checked,scanInput.value,cornerInput.value);cells.forEach(function(cell){const el=document.createElement('div');el.className='led-cell';el.style.gridColumn=String(cell.x+1);el.style.gridRow=String(cell.y+1);const idx=document.createElement('div');idx.className='led-index';idx.textContent=cell.ledIndex;el.appendChild(idx);const overlay=document.createElement('div');overlay.className='led-overlay';overlay.textContent='RGB';el.appendChild(overlay);el.dataset.index=cell.ledIndex;el.title='LED '+cell.ledIndex;el.addEventListener('mouseenter',function(){const rgb=el.dataset.rgb||'-, -, -';infoIndex.textContent=cell.ledIndex;infoColor.textContent=rgb;});cellMap.set(cell.ledIndex,el);grid.appendChild(el);});applyColors();}");
   html += F("function applyColors(){if(!Array.isArray(latestData)){return;}latestData.forEach(function(entry){const cell=cellMap.get(entry.index);if(!cell){return;}const color='rgb('+entry.r+','+entry.g+','+entry.b+')';cell.style.backgroundColor=color;const overlay=cell.querySelector('.led-overlay');if(overlay){overlay.textContent=entry.r+','+entry.g+','+entry.b;}cell.dataset.rgb=entry.r+', '+entry.g+', '+entry.b;cell.title='LED '+entry.index+'\nR: '+entry.r+' G: '+entry.g+' B: '+entry.b;const brightness=0.2126*entry.r+0.7152*entry.g+0.0722*entry.b;cell.style.color=brightness>140?'#000':'#fff';if(overlay){overlay.style.backgroundColor=brightness>140?'rgba(0,0,0,0.25)':'rgba(0,0,0,0.55)';}});}");
-  html += F("function poll(){fetch('/api/led_state',{cache:'no-store'}).then(function(res){if(!res.ok){throw new Error('http');}return res.json();}).then(function(data){if(data&&Array.isArray(data.leds)){latestData=data.leds;applyColors();}}).catch(function(err){console.debug('visualizador: error',err);});}");
+  html += F("function poll(){fetch('/api/led_state?since='+lastFrame,{cache:'no-store'}).then(function(res){if(!res.ok){throw new Error('http');}return res.json();}).then(function(data){if(!data){return;}if(typeof data.frame==='number'){lastFrame=data.frame;infoFrame.textContent=data.frame;}if(Array.isArray(data.leds)){latestData=data.leds;applyColors();}}).catch(function(err){console.debug('visualizador: error',err);});}");
   html += F("widthInput.addEventListener('change',rebuildGrid);heightInput.addEventListener('change',rebuildGrid);serpInput.addEventListener('change',rebuildGrid);scanInput.addEventListener('change',rebuildGrid);cornerInput.addEventListener('change',rebuildGrid);rebuildGrid();poll();setInterval(poll,250);");
   html += F("</script></body></html>");
   return html;
@@ -1151,11 +2301,20 @@ void handleConfigPost()
   if (g_server.hasArg("fallbackToStatic")) {
     newConfig.fallbackToStatic = g_server.arg("fallbackToStatic") == "1";
   }
+  if (g_server.hasArg("shortName")) {
+    newConfig.shortName = g_server.arg("shortName");
+  }
+  if (g_server.hasArg("longName")) {
+    newConfig.longName = g_server.arg("longName");
+  }
   if (g_server.hasArg("artnetInput")) {
     long parsed = g_server.arg("artnetInput").toInt();
     if (parsed < 0) parsed = DEFAULT_ARTNET_INPUT;
     newConfig.artnetInput = static_cast<uint8_t>(parsed);
   }
+  if (g_server.hasArg("wifiStandby")) {
+    newConfig.wifiStandby = g_server.arg("wifiStandby").toInt() != 0;
+  }
   if (g_server.hasArg("wifiEnabled")) {
     newConfig.wifiEnabled = g_server.arg("wifiEnabled") == "1";
   }
@@ -1222,6 +2381,47 @@ void handleConfigPost()
     if (su < 0) su = 0;
     newConfig.startUniverse = static_cast<uint16_t>(su);
   }
+  if (g_server.hasArg("outputCount")) {
+    long parsed = g_server.arg("outputCount").toInt();
+    parsed = std::max(1L, std::min<long>(parsed, LedOutputs::MAX_OUTPUTS));
+    newConfig.outputCount = static_cast<uint8_t>(parsed);
+  }
+  for (uint8_t o = 0; o < LedOutputs::MAX_OUTPUTS; ++o) {
+    const String suffix = String(o);
+    if (g_server.hasArg("outputPin" + suffix)) {
+      newConfig.outputPins[o] = static_cast<uint8_t>(g_server.arg("outputPin" + suffix).toInt());
+    }
+    if (g_server.hasArg("outputSource" + suffix)) {
+      long parsed = g_server.arg("outputSource" + suffix).toInt();
+      if (parsed < 0) parsed = static_cast<long>(OutputSource::Any);
+      newConfig.outputSources[o] = static_cast<uint8_t>(parsed);
+    }
+    if (o == 0) continue;
+    ExtraOutputConfig& out = newConfig.extraOutputs[o - 1];
+    if (g_server.hasArg("outputLeds" + suffix)) {
+      long parsed = g_server.arg("outputLeds" + suffix).toInt();
+      parsed = std::max(1L, std::min<long>(parsed, static_cast<long>(MAX_LEDS)));
+      out.ledCount = static_cast<uint16_t>(parsed);
+    }
+    if (g_server.hasArg("outputUniverse" + suffix)) {
+      long parsed = g_server.arg("outputUniverse" + suffix).toInt();
+      out.startUniverse = static_cast<uint16_t>(std::max(0L, std::min(parsed, 32767L)));
+    }
+    if (g_server.hasArg("outputChip" + suffix)) {
+      long parsed = g_server.arg("outputChip" + suffix).toInt();
+      if (parsed < 0) parsed = DEFAULT_CHIP_TYPE;
+      out.chipType = static_cast<uint8_t>(parsed);
+    }
+    if (g_server.hasArg("outputOrder" + suffix)) {
+      long parsed = g_server.arg("outputOrder" + suffix).toInt();
+      if (parsed < 0) parsed = DEFAULT_COLOR_ORDER;
+      out.colorOrder = static_cast<uint8_t>(parsed);
+    }
+    if (g_server.hasArg("outputPower" + suffix)) {
+      long parsed = g_server.arg("outputPower" + suffix).toInt();
+      out.powerLimitMa = static_cast<uint32_t>(std::max(0L, std::min<long>(parsed, MAX_POWER_LIMIT_MA)));
+    }
+  }
   if (g_server.hasArg("pixelsPerUniverse")) {
     long parsed = g_server.arg("pixelsPerUniverse").toInt();
     parsed = std::max(1L, std::min<long>(parsed, static_cast<long>(MAX_LEDS)));
@@ -1242,14 +2442,88 @@ void handleConfigPost()
     if (parsed < 0) parsed = DEFAULT_COLOR_ORDER;
     newConfig.colorOrder = static_cast<uint8_t>(parsed);
   }
+  if (g_server.hasArg("maxFps")) {
+    long parsed = g_server.arg("maxFps").toInt();
+    newConfig.maxFps = static_cast<uint16_t>(std::max(0L, std::min(1000L, parsed)));
+  }
+  if (g_server.hasArg("powerLimit")) {
+    long parsed = g_server.arg("powerLimit").toInt();
+    newConfig.powerLimitMa = static_cast<uint32_t>(std::max(0L, std::min<long>(parsed, MAX_POWER_LIMIT_MA)));
+  }
+  if (g_server.hasArg("keepAlive")) {
+    long parsed = g_server.arg("keepAlive").toInt();
+    newConfig.keepAliveMs = static_cast<uint16_t>(std::max(0L, std::min(60000L, parsed)));
+  }
+  if (g_server.hasArg("jitterLatency")) {
+    long parsed = g_server.arg("jitterLatency").toInt();
+    newConfig.jitterLatencyMs = static_cast<uint16_t>(std::max(0L, std::min<long>(parsed, FrameJitterBuffer::MAX_LATENCY_MS)));
+  }
+  if (g_server.hasArg("interpolate")) {
+    newConfig.interpolate = g_server.arg("interpolate").toInt() != 0;
+  }
+  if (g_server.hasArg("timecodeSync")) {
+    newConfig.timecodeSync = g_server.arg("timecodeSync").toInt() != 0;
+  }
+  if (g_server.hasArg("clockRole")) {
+    long parsed = g_server.arg("clockRole").toInt();
+    if (parsed < 0) parsed = DEFAULT_CLOCK_ROLE;
+    newConfig.clockRole = static_cast<uint8_t>(parsed);
+  }
+  if (g_server.hasArg("clockMaster")) {
+    String value = g_server.arg("clockMaster");
+    value.trim();
+    newConfig.clockMasterIp = value.length() ? parseIp(value, newConfig.clockMasterIp) : 0;
+  }
+  if (g_server.hasArg("presentDelay")) {
+    long parsed = g_server.arg("presentDelay").toInt();
+    newConfig.presentDelayMs = static_cast<uint16_t>(std::max(1L, std::min<long>(parsed, MAX_PRESENT_DELAY_MS)));
+  }
+  if (g_server.hasArg("timecodeStart")) {
+    newConfig.timecodeStartMs = parseTimecode(g_server.arg("timecodeStart"), newConfig.timecodeStartMs);
+  }
+  if (g_server.hasArg("mergeMode")) {
+    long parsed = g_server.arg("mergeMode").toInt();
+    if (parsed < 0) parsed = DEFAULT_MERGE_MODE;
+    newConfig.mergeMode = static_cast<uint8_t>(parsed);
+  }
+  if (g_server.hasArg("sourceLossPolicy")) {
+    long parsed = g_server.arg("sourceLossPolicy").toInt();
+    if (parsed < 0) parsed = DEFAULT_SOURCE_LOSS_POLICY;
+    newConfig.sourceLossPolicy = static_cast<uint8_t>(parsed);
+  }
+  if (g_server.hasArg("sourceLossTimeout")) {
+    long parsed = g_server.arg("sourceLossTimeout").toInt();
+    newConfig.sourceLossTimeoutMs = static_cast<uint32_t>(std::max(100L, std::min(600000L, parsed)));
+  }
+  if (g_server.hasArg("sourceLossFade")) {
+    long parsed = g_server.arg("sourceLossFade").toInt();
+    newConfig.sourceLossFadeMs = static_cast<uint32_t>(std::max(0L, std::min(60000L, parsed)));
+  }
+  if (g_server.hasArg("bootScene")) {
+    long parsed = g_server.arg("bootScene").toInt();
+    if (parsed < 0) parsed = DEFAULT_BOOT_SCENE;
+    newConfig.bootScene = static_cast<uint8_t>(parsed);
+  }
+  if (g_server.hasArg("logLevel")) {
+    long parsed = g_server.arg("logLevel").toInt();
+    if (parsed < 0) parsed = DEFAULT_LOG_LEVEL;
+    newConfig.logLevel = static_cast<uint8_t>(parsed);
+  }
+  if (g_server.hasArg("syslogIp")) {
+    String value = g_server.arg("syslogIp");
+    value.trim();
+    newConfig.syslogIp = value.length() ? parseIp(value, newConfig.syslogIp) : 0;
+  }
+  if (g_server.hasArg("syslogPort")) {
+    long parsed = g_server.arg("syslogPort").toInt();
+    newConfig.syslogPort = static_cast<uint16_t>(std::max(1L, std::min(65535L, parsed)));
+  }
 
   normalizeConfig(newConfig);
 
-  bool requiresRestart = (newConfig.chipType != g_config.chipType) ||
-                         (newConfig.colorOrder != g_config.colorOrder);
-
   g_config = newConfig;
   applyConfig();
+  const bool requiresRestart = g_outputsNeedRestart;
   saveConfig();
   // Wi-Fi bring-up switches the default LwIP interface to the wireless stack.
   // Re-initialise Ethernet afterwards so Art-Net binds to the wired interface.
@@ -1258,7 +2532,8 @@ void handleConfigPost()
   artnet.updateNetworkInfo();
 
   if (requiresRestart) {
-    g_server.send(200, "text/html", buildConfigPage("Configuración actualizada. Reiniciando para aplicar tipo de chip/orden de color."));
+    g_server.send(200, "text/html", buildConfigPage("Configuración actualizada. Reiniciando para aplicar pin, tipo de chip u orden de color."));
+    g_configStore.flush();
     delay(500);
     ESP.restart();
   } else {
@@ -1266,6 +2541,154 @@ void handleConfigPost()
   }
 }
 
+String sceneSaveResultText(SceneStore::SaveResult result)
+{
+  switch (result) {
+    case SceneStore::SaveResult::Saved: return F("Escena guardada.");
+    case SceneStore::SaveResult::Unchanged: return F("La escena guardada ya coincide con la actual.");
+    case SceneStore::SaveResult::Unavailable: return F("No hay partición 'scene' en la flash (requiere grabar por USB la nueva tabla de particiones).");
+    case SceneStore::SaveResult::TooLarge: return F("La escena no entra en un bloque de flash.");
+    case SceneStore::SaveResult::Failed:
+    default: return F("Error al escribir la escena en flash.");
+  }
+}
+
+SceneStore::SaveResult saveBootScene()
+{
+  const uint32_t t0 = millis();
+  const SceneStore::SaveResult result = g_sceneStore.save(g_render.liveFrame(), totalLeds(g_config));
+  g_lastSceneSaveMs = millis();
+  if (result == SceneStore::SaveResult::Saved) {
+    g_log.log(LogLevel::Info, LogTag::Scene, "Escena guardada: %u LEDs en %u bytes (%u ms)", g_sceneStore.storedPixels(),
+              g_sceneStore.storedBytes(), g_lastSceneSaveMs - t0);
+  } else if (result != SceneStore::SaveResult::Unchanged) {
+    g_log.logText(LogLevel::Warn, LogTag::Scene, "%s", sceneSaveResultText(result).c_str());
+  }
+  return result;
+}
+
+// Modo "último frame": guarda cuando la entrada queda quieta o, con show
+// continuo, cada SCENE_LIVE_SAVE_INTERVAL_MS; nunca más de una vez por minuto.
+// El borrado de un sector de flash detiene la CPU ~40 ms, por eso se evita
+// hacerlo mientras llegan frames.
+void serviceBootScene()
+{
+  if (!g_sceneDirty || g_config.bootScene != static_cast<uint8_t>(BootSceneMode::LastFrame) || !g_sceneStore.available()) {
+    return;
+  }
+  const uint32_t now = millis();
+  const uint32_t sinceSave = now - g_lastSceneSaveMs;
+  if (sinceSave < SCENE_MIN_SAVE_INTERVAL_MS) {
+    return;
+  }
+  const bool idle = (now - g_lastFrameMs) >= SCENE_IDLE_MS;
+  if (!idle && sinceSave < SCENE_LIVE_SAVE_INTERVAL_MS) {
+    return;
+  }
+  g_sceneDirty = false;
+  saveBootScene();
+}
+
+uint16_t loadFallbackScene(CRGB* pixels, uint16_t capacity)
+{
+  const uint16_t loaded = g_sceneStore.load(pixels, capacity);
+  if (loaded > 0) {
+    // El fundido cruzado pasa por ambos looks: respetar el más exigente.
+    const uint8_t liveBrightness = g_power.brightness();
+    g_power.measure(pixels, loaded, g_config.brightness);
+    FastLED.setBrightness(std::min(liveBrightness, g_power.brightness()));
+  }
+  return loaded;
+}
+
+void restoreBootScene()
+{
+  if (!g_sceneStore.begin()) {
+    g_log.log(LogLevel::Warn, LogTag::Scene, "Sin partición 'scene'; escena de arranque deshabilitada.");
+    return;
+  }
+  if (g_config.bootScene == static_cast<uint8_t>(BootSceneMode::Off)) {
+    return;
+  }
+
+  const uint32_t t0 = millis();
+  const uint16_t restored = g_sceneStore.load(leds, totalLeds(g_config));
+  if (restored == 0) {
+    g_log.log(LogLevel::Info, LogTag::Scene, "No hay escena guardada.");
+    return;
+  }
+  g_power.measure(leds, restored, g_config.brightness);
+  FastLED.setBrightness(g_power.brightness());
+  g_outputs.show(FastLED.getBrightness());
+  g_render.holdOutput(BOOT_SCENE_CROSSFADE_MS);
+  g_log.log(LogLevel::Info, LogTag::Scene, "Escena restaurada: %u LEDs en %u ms (a %u ms del arranque)", restored,
+            millis() - t0, millis());
+}
+
+String buildShowStatus()
+{
+  if (!g_show.available() && g_show.state() == ShowRecorder::State::Idle) {
+    return F("Sin sistema de archivos (se formatea al grabar por primera vez).");
+  }
+  String status;
+  switch (g_show.state()) {
+    case ShowRecorder::State::Recording: status = F("Grabando: "); break;
+    case ShowRecorder::State::Playing:   status = F("Reproduciendo: "); break;
+    case ShowRecorder::State::Idle:      status = g_show.hasShow() ? F("Guardado: ") : F("Sin show grabado."); break;
+  }
+  if (g_show.hasShow() || g_show.state() != ShowRecorder::State::Idle) {
+    status += String((unsigned long)g_show.showFrames()) + " frames, " +
+              String((unsigned long)(g_show.showDurationMs() / 1000)) + " s, " +
+              String((unsigned long)(g_show.showBytes() / 1024)) + " KB";
+  }
+  if (g_show.state() == ShowRecorder::State::Playing) {
+    status += " (frame " + String((unsigned long)g_show.playedFrames()) + ")";
+  }
+  if (g_tcSync.enabled()) {
+    status += g_tcSync.locked() ? F(" — sincronizado a timecode ") : F(" — esperando timecode desde ");
+    status += timecodeToString(g_tcSync.locked() ? g_tcSync.timecodeMs() : g_config.timecodeStartMs);
+  }
+  if (g_show.lastError()[0]) {
+    status += String(" — ") + g_show.lastError();
+  }
+  return status;
+}
+
+// Los frames reproducidos pasan por la misma copia que Art-Net: la detección
+// de cambios, el limitador de consumo y el visualizador funcionan igual.
+void serviceShowPlayback()
+{
+  // Un salto de timecode ya dejó el frame nuevo decodificado.
+  const bool repositioned = g_tcSync.service(g_show, millis());
+  if (!g_show.servicePlayback() && !repositioned) {
+    return;
+  }
+  g_ingest.loadFrame(g_show.frame(), std::min<uint16_t>(g_show.pixelCount(), totalLeds(g_config)));
+  presentLatchedFrame();
+}
+
+void handleShowPost()
+{
+  const String action = g_server.arg("action");
+  bool ok = true;
+  if (action == "record") {
+    ok = g_show.startRecording(totalLeds(g_config));
+  } else if (action == "play" || action == "loop") {
+    ok = g_show.startPlayback(action == "loop");
+  } else if (action == "stop") {
+    g_show.stop();
+  } else if (action == "delete") {
+    g_show.remove();
+  }
+  String message = ok ? buildShowStatus() : String(F("Error: ")) + g_show.lastError();
+  g_server.send(200, "text/html", buildConfigPage(message));
+}
+
+void handleScenePost()
+{
+  g_server.send(200, "text/html", buildConfigPage(sceneSaveResultText(saveBootScene())));
+}
+
 void handleRoot()
 {
   g_server.sendHeader("Location", "/config", true);
@@ -1281,9 +2704,9 @@ void handleFirmwareUpload()
       g_firmwareUploadHandled = true;
       g_firmwareUpdateShouldRestart = false;
       g_firmwareUpdateMessage = F("Iniciando actualización de firmware...");
-      Serial.printf("[FW] Iniciando carga: %s\n", upload.filename.c_str());
+      g_log.logText(LogLevel::Info, LogTag::Fw, "Iniciando carga: %s", upload.filename.c_str());
       if (!Update.begin(UPDATE_SIZE_UNKNOWN)) {
-        Update.printError(Serial);
+        g_log.logText(LogLevel::Error, LogTag::Fw, "%s", Update.errorString());
         g_firmwareUpdateMessage = F("No se pudo iniciar la actualización de firmware.");
       }
       break;
@@ -1291,7 +2714,7 @@ void handleFirmwareUpload()
       if (Update.isRunning()) {
         size_t written = Update.write(upload.buf, upload.currentSize);
         if (written != upload.currentSize) {
-          Update.printError(Serial);
+          g_log.logText(LogLevel::Error, LogTag::Fw, "%s", Update.errorString());
           g_firmwareUpdateMessage = F("Error al escribir el firmware recibido.");
         }
       }
@@ -1301,9 +2724,9 @@ void handleFirmwareUpload()
         if (Update.end(true)) {
           g_firmwareUpdateMessage = F("Firmware actualizado correctamente. Reiniciando...");
           g_firmwareUpdateShouldRestart = true;
-          Serial.printf("[FW] Actualización completada (%u bytes).\n", upload.totalSize);
+          g_log.log(LogLevel::Info, LogTag::Fw, "Actualización completada (%u bytes).", upload.totalSize);
         } else {
-          Update.printError(Serial);
+          g_log.logText(LogLevel::Error, LogTag::Fw, "%s", Update.errorString());
           g_firmwareUpdateMessage = F("La actualización de firmware falló al finalizar.");
         }
       }
@@ -1311,7 +2734,7 @@ void handleFirmwareUpload()
     case UPLOAD_FILE_ABORTED:
       Update.abort();
       g_firmwareUpdateMessage = F("La carga de firmware fue cancelada.");
-      Serial.println("[FW] Actualización abortada por el cliente.");
+      g_log.log(LogLevel::Warn, LogTag::Fw, "Actualización abortada por el cliente.");
       break;
     default:
       break;
@@ -1338,6 +2761,7 @@ void handleFirmwareUpdatePost()
   g_firmwareUpdateMessage.clear();
 
   if (shouldRestart) {
+    g_configStore.flush();
     delay(500);
     ESP.restart();
   }
@@ -1358,15 +2782,15 @@ void bringUpWiFi(const AppConfig& config)
   wifi_sta_ip = IPAddress((uint32_t)0);
   wifi_ap_ip = IPAddress((uint32_t)0);
   wifi_sta_ssid_current.clear();
+  g_netBringUp.wifiStaPending = false;
 
   if (!config.wifiEnabled) {
-    Serial.println("[WIFI] Deshabilitado.");
+    g_log.log(LogLevel::Info, LogTag::Wifi, "Deshabilitado.");
     return;
   }
 
   if (config.wifiApMode) {
-    Serial.print("[WIFI] Activando punto de acceso: ");
-    Serial.println(config.wifiApSsid);
+    g_log.logText(LogLevel::Info, LogTag::Wifi, "Activando punto de acceso: %s", config.wifiApSsid.c_str());
     WiFi.mode(WIFI_AP);
     bool ok = false;
     if (config.wifiApPassword.length() >= 8) {
@@ -1378,121 +2802,174 @@ void bringUpWiFi(const AppConfig& config)
       WiFi.softAPsetHostname(DEVICE_HOSTNAME);
       wifi_ap_running = true;
       wifi_ap_ip = WiFi.softAPIP();
-      Serial.print("[WIFI] AP IP: ");
-      Serial.println(wifi_ap_ip);
+      logIp(LogTag::Wifi, "AP IP: %u.%u.%u.%u", wifi_ap_ip);
     } else {
-      Serial.println("[WIFI] softAP() falló");
+      g_log.log(LogLevel::Error, LogTag::Wifi, "softAP() falló");
     }
   } else {
     if (config.wifiStaSsid.length() == 0) {
-      Serial.println("[WIFI] SSID no configurado; no se intentará conectar.");
+      g_log.log(LogLevel::Warn, LogTag::Wifi, "SSID no configurado; no se intentará conectar.");
       return;
     }
 
-    Serial.print("[WIFI] Conectando a SSID: ");
-    Serial.println(config.wifiStaSsid);
+    g_log.logText(LogLevel::Info, LogTag::Wifi, "Conectando a SSID: %s", config.wifiStaSsid.c_str());
     WiFi.mode(WIFI_STA);
     WiFi.setHostname(DEVICE_HOSTNAME);
     WiFi.setAutoReconnect(true);
+    // En espera activa el módem no duerme: el primer paquete tras el failover
+    // no espera al próximo beacon.
+    if (config.wifiStandby) WiFi.setSleep(false);
     WiFi.begin(config.wifiStaSsid.c_str(), config.wifiStaPassword.c_str());
 
-    const uint32_t t0 = millis();
-    while (millis() - t0 < config.dhcpTimeoutMs) {
-      if (WiFi.status() == WL_CONNECTED) {
-        break;
-      }
-      if (wifi_sta_has_ip) {
-        break;
-      }
-      Serial.print('.');
-      delay(250);
-    }
-    Serial.println();
-
-    if (WiFi.status() == WL_CONNECTED) {
-      wifi_sta_connected = true;
-      wifi_sta_has_ip = true;
-      wifi_sta_ip = WiFi.localIP();
-      wifi_sta_ssid_current = WiFi.SSID();
-      Serial.print("[WIFI] IP obtenida: ");
-      Serial.println(wifi_sta_ip);
-    } else if (wifi_sta_has_ip) {
-      Serial.print("[WIFI] IP actual: ");
-      Serial.println(wifi_sta_ip);
-    } else {
-      Serial.println("[WIFI] No se obtuvo conexión/IP en el tiempo configurado.");
-    }
+    // La IP llega por onWiFiEvent(); serviceNetworkBringUp() avisa si vence el plazo.
+    g_netBringUp.wifiStaPending = true;
+    g_netBringUp.wifiDeadlineMs = millis() + config.dhcpTimeoutMs;
   }
 }
 
+bool applyEthernetStaticIp(const AppConfig& config)
+{
+  bool ok = ETH.config(IPAddress(config.staticIp), IPAddress(config.staticGateway), IPAddress(config.staticSubnet),
+                       IPAddress(config.staticDns1), IPAddress(config.staticDns2));
+  if (ok) {
+    eth_has_ip = (ETH.localIP() != IPAddress((uint32_t)0));
+    if (eth_has_ip && !g_netBringUp.ethIpMs) g_netBringUp.ethIpMs = millis();
+    logIp(LogTag::Eth, "IP fija configurada: %u.%u.%u.%u", ETH.localIP());
+  }
+  return ok;
+}
+
 void bringUpEthernet(const AppConfig& config)
 {
   eth_link_up = false;
   eth_has_ip  = false;
+  g_netBringUp.ethDhcpPending = false;
   pinMode(ETH_POWER_PIN, OUTPUT);
   digitalWrite(ETH_POWER_PIN, HIGH);
   delay(10);
 
   if (!ETH.begin(ETH_PHY_ADDR, ETH_POWER_PIN, ETH_MDC_PIN, ETH_MDIO_PIN, ETH_PHY_TYPE, ETH_CLK_MODE)) {
-    Serial.println("[ETH] begin() FALLÓ");
+    g_log.log(LogLevel::Error, LogTag::Eth, "begin() FALLÓ");
   }
 
-  IPAddress staticIp(config.staticIp);
-  IPAddress staticGw(config.staticGateway);
-  IPAddress staticMask(config.staticSubnet);
-  IPAddress staticDns1(config.staticDns1);
-  IPAddress staticDns2(config.staticDns2);
-
   if (!config.useDhcp) {
-    bool ok = ETH.config(staticIp, staticGw, staticMask, staticDns1, staticDns2);
-    if (ok) {
-      eth_has_ip = (ETH.localIP() != IPAddress((uint32_t)0));
-      Serial.print("[ETH] IP fija configurada: ");
-      Serial.println(ETH.localIP());
-    } else {
-      Serial.println("[ETH] ETH.config() FALLÓ (no se pudo asignar la IP fija)");
+    if (!applyEthernetStaticIp(config)) {
+      g_log.log(LogLevel::Error, LogTag::Eth, "ETH.config() FALLÓ (no se pudo asignar la IP fija)");
     }
+    return;
   }
 
-  Serial.print(config.useDhcp ? "[ETH] Esperando link + DHCP" : "[ETH] Esperando link");
-  const uint32_t t0 = millis();
-  while (millis() - t0 < config.dhcpTimeoutMs) {
-    Serial.print(".");
-    delay(250);
-    if (config.useDhcp) {
-      if (eth_link_up && eth_has_ip) break;
-    } else if (eth_link_up) {
-      break;
-    }
+  g_log.log(LogLevel::Info, LogTag::Eth, "Esperando link + DHCP (en segundo plano)");
+  g_netBringUp.ethDhcpPending = true;
+  g_netBringUp.ethDeadlineMs = millis() + config.dhcpTimeoutMs;
+}
+
+// Aplica lo que dejó ArtIpProg sobre la interfaz ya levantada: sin ETH.begin()
+// el link no se cae, y con IP fija no hay que esperar a DHCP.
+void serviceIpProgram()
+{
+  if (!g_ipProgramPending) {
+    return;
+  }
+  g_ipProgramPending = false;
+
+  if (g_config.useDhcp) {
+    // ETH.config() sin dirección vuelve a arrancar el cliente DHCP.
+    ETH.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));
+    eth_has_ip = false;
+    g_log.log(LogLevel::Info, LogTag::Eth, "Esperando DHCP (ArtIpProg)");
+    g_netBringUp.ethDhcpPending = true;
+    g_netBringUp.ethDeadlineMs = millis() + g_config.dhcpTimeoutMs;
+  } else if (!applyEthernetStaticIp(g_config)) {
+    g_log.log(LogLevel::Error, LogTag::Eth, "ETH.config() FALLÓ (no se pudo asignar la IP fija)");
   }
-  Serial.println();
-
-  if (config.useDhcp && !eth_has_ip) {
-    Serial.println("[ETH] DHCP no respondió.");
-    if (config.fallbackToStatic) {
-      Serial.println("[ETH] Aplicando configuración IP fija de respaldo…");
-      bool ok = ETH.config(staticIp, staticGw, staticMask, staticDns1, staticDns2);
-      if (ok) {
-        Serial.print("[ETH] IP fija configurada: ");
-        Serial.println(ETH.localIP());
-        eth_has_ip = (ETH.localIP() != IPAddress((uint32_t)0));
-      } else {
-        Serial.println("[ETH] ETH.config() FALLÓ (IP fija no aplicada)");
+  artnet.updateNetworkInfo();
+}
+
+// Aplica a ArtNetNode el estado del enlace Ethernet que informó onWiFiEvent().
+// Con la IP todavía asignada, ArtNetNode seguiría escuchando en Ethernet hasta
+// que venza la concesión; así cambia a Wi-Fi en la misma vuelta de loop().
+void serviceFailover()
+{
+  const bool linkUp = eth_link_up;
+  if (linkUp == g_failover.linkSeen) return;
+  g_failover.linkSeen = linkUp;
+  artnet.setLinkUp(ArtNetNode::Interface::Ethernet, linkUp);
+
+  if (linkUp) {
+    if (g_failover.count) reportDiagnostic(ArtNetNode::DiagPriority::Medium, "Enlace Ethernet de vuelta");
+    g_failover.awaitingData = false;
+    return;
+  }
+  if (!artnet.listening(ArtNetNode::Interface::WiFiStation) &&
+      !artnet.listening(ArtNetNode::Interface::WiFiAccessPoint)) {
+    return;
+  }
+  g_failover.count++;
+  g_failover.lastSwitchUs = micros() - g_failover.linkDownUs;
+  g_failover.awaitingData = g_failover.lastEthernetDmxMs != 0;
+  reportDiagnostic(ArtNetNode::DiagPriority::High, "Ethernet caído: Art-Net sigue por Wi-Fi (%lu us)",
+                   (unsigned long)g_failover.lastSwitchUs);
+}
+
+void serviceNetworkBringUp()
+{
+  const uint32_t now = millis();
+
+  if (g_netBringUp.ethDhcpPending) {
+    if (eth_has_ip) {
+      g_netBringUp.ethDhcpPending = false;
+      artnet.updateNetworkInfo();
+    } else if (static_cast<int32_t>(now - g_netBringUp.ethDeadlineMs) >= 0) {
+      g_netBringUp.ethDhcpPending = false;
+      g_log.log(LogLevel::Warn, LogTag::Eth, "DHCP no respondió.");
+      if (g_config.fallbackToStatic) {
+        g_log.log(LogLevel::Info, LogTag::Eth, "Aplicando configuración IP fija de respaldo…");
+        if (!applyEthernetStaticIp(g_config)) {
+          g_log.log(LogLevel::Error, LogTag::Eth, "ETH.config() FALLÓ (IP fija no aplicada)");
+        }
+      }
+      if (!eth_has_ip) {
+        g_log.log(LogLevel::Warn, LogTag::Eth, "Advertencia: sin IP (no habrá Art-Net hasta que haya red).");
       }
+      artnet.updateNetworkInfo();
     }
   }
 
-  if (!eth_has_ip) {
-    Serial.println("[ETH] Advertencia: sin IP (no habrá Art-Net hasta que haya red).");
+  if (g_netBringUp.wifiStaPending) {
+    if (wifi_sta_has_ip) {
+      g_netBringUp.wifiStaPending = false;
+      artnet.updateNetworkInfo();
+    } else if (static_cast<int32_t>(now - g_netBringUp.wifiDeadlineMs) >= 0) {
+      g_netBringUp.wifiStaPending = false;
+      g_log.log(LogLevel::Warn, LogTag::Wifi, "No se obtuvo conexión/IP en el tiempo configurado (se sigue reintentando).");
+    }
+  }
+
+  if (!g_netBringUp.firstReplyLogged && artnet.firstPollReplyMs() != 0) {
+    g_netBringUp.firstReplyLogged = true;
+    g_log.log(LogLevel::Info, LogTag::ArtNet, "Primer ArtPollReply a %u ms del arranque (IP ETH: %u ms, IP Wi-Fi: %u ms)",
+              artnet.firstPollReplyMs(), g_netBringUp.ethIpMs, g_netBringUp.wifiIpMs);
   }
 }
 
 void handleLedStateJson()
 {
-  const uint16_t ledCount = std::min<uint16_t>(g_config.numLeds, MAX_LEDS);
+  // El contador solo avanza cuando cambia lo que muestra la tira; con ?since=N
+  // igual al actual se responde sin la lista de LEDs.
+  const uint32_t frame = g_render.outputFrame();
+  if (g_server.hasArg("since") && g_server.arg("since").toInt() == static_cast<long>(frame)) {
+    g_server.sendHeader("Cache-Control", "no-store");
+    g_server.send(200, "application/json", "{\"frame\":" + String((unsigned long)frame) + "}");
+    return;
+  }
+
+  const uint16_t ledCount = std::min<uint16_t>(totalLeds(g_config), VISUALIZER_MAX_LEDS);
   String json;
-  json.reserve(static_cast<size_t>(ledCount) * 30 + 32);
-  json += F("{\"leds\":[");
+  json.reserve(static_cast<size_t>(ledCount) * 30 + 48);
+  json += F("{\"frame\":");
+  json += String((unsigned long)frame);
+  json += F(",\"leds\":[");
   for (uint16_t i = 0; i < ledCount; ++i) {
     if (i > 0) json += ',';
     const CRGB& color = leds[i];
@@ -1512,6 +2989,410 @@ void handleLedStateJson()
   g_server.send(200, "application/json", json);
 }
 
+// Los últimos LogRing::HISTORY mensajes ya enviados por Serial, del más viejo
+// al más nuevo.  Con ?since=N sólo los de seq mayor o igual a N.
+void handleLogsJson()
+{
+  const uint32_t since = g_server.hasArg("since") ? static_cast<uint32_t>(g_server.arg("since").toInt()) : 0;
+  String json = F("{\"written\":");
+  json += String((unsigned long)g_log.written());
+  json += F(",\"dropped\":");
+  json += String((unsigned long)g_log.dropped());
+  json += F(",\"level\":\"");
+  json += LogRing::levelName(g_log.level());
+  json += F("\",\"records\":[");
+  char line[LogRing::LINE_SIZE];
+  bool first = true;
+  for (size_t i = 0; i < g_log.historyCount(); ++i) {
+    const LogRing::Record& record = g_log.history(i);
+    if (record.seq < since) continue;
+    LogRing::format(record, line, sizeof(line));
+    if (!first) json += ',';
+    first = false;
+    json += F("{\"seq\":");
+    json += String((unsigned long)record.seq);
+    json += F(",\"ms\":");
+    json += String((unsigned long)record.ms);
+    json += F(",\"level\":\"");
+    json += LogRing::levelName(record.level);
+    json += F("\",\"text\":\"");
+    json += jsonEscape(String(line));
+    json += F("\"}");
+  }
+  json += F("]}");
+  g_server.sendHeader("Cache-Control", "no-store");
+  g_server.send(200, "application/json", json);
+}
+
+void appendHistogramJson(String& json, const LatencyHistogram& histogram)
+{
+  json += F("{\"count\":");
+  json += String((unsigned long)histogram.count());
+  json += F(",\"p50\":");
+  json += String((unsigned long)histogram.percentile(50));
+  json += F(",\"p90\":");
+  json += String((unsigned long)histogram.percentile(90));
+  json += F(",\"p99\":");
+  json += String((unsigned long)histogram.percentile(99));
+  json += F(",\"max\":");
+  json += String((unsigned long)histogram.max());
+  json += F("}");
+}
+
+void handleMetricsJson()
+{
+  if (g_server.hasArg("reset")) {
+    g_ingest.resetStats();
+    g_scheduler.resetStats();
+  }
+
+  const FrameIngest::Stats& ingest = g_ingest.stats();
+  String json;
+  json.reserve(512);
+  json += F("{\"uptimeMs\":");
+  json += String((unsigned long)millis());
+  json += F(",\"dmxPackets\":");
+  json += String((unsigned long)g_dmxFrames);
+  json += F(",\"boot\":{\"ethIpMs\":");
+  json += String((unsigned long)g_netBringUp.ethIpMs);
+  json += F(",\"wifiIpMs\":");
+  json += String((unsigned long)g_netBringUp.wifiIpMs);
+  json += F(",\"firstPollReplyMs\":");
+  json += String((unsigned long)artnet.firstPollReplyMs());
+  json += F("}");
+  json += F(",\"config\":{\"writes\":");
+  json += String((unsigned long)g_configStore.writeCount());
+  json += F(",\"skipped\":");
+  json += String((unsigned long)g_configStore.skippedCount());
+  json += F(",\"pending\":");
+  json += g_configStore.dirty() ? F("true") : F("false");
+  json += F("}");
+  json += F(",\"scene\":{\"available\":");
+  json += g_sceneStore.available() ? F("true") : F("false");
+  json += F(",\"storedLeds\":");
+  json += String(g_sceneStore.hasScene() ? g_sceneStore.storedPixels() : 0);
+  json += F(",\"storedBytes\":");
+  json += String((unsigned long)g_sceneStore.storedBytes());
+  json += F(",\"saves\":");
+  json += String((unsigned long)g_sceneStore.saveCount());
+  json += F("}");
+  json += F(",\"show\":{\"state\":\"");
+  json += g_show.state() == ShowRecorder::State::Recording ? F("recording")
+        : g_show.state() == ShowRecorder::State::Playing   ? F("playing") : F("idle");
+  json += F("\",\"frames\":");
+  json += String((unsigned long)g_show.showFrames());
+  json += F(",\"durationMs\":");
+  json += String((unsigned long)g_show.showDurationMs());
+  json += F(",\"bytes\":");
+  json += String((unsigned long)g_show.showBytes());
+  json += F(",\"played\":");
+  json += String((unsigned long)g_show.playedFrames());
+  json += F(",\"loops\":");
+  json += String((unsigned long)g_show.loops());
+  json += F(",\"positionMs\":");
+  json += String((unsigned long)(g_show.state() == ShowRecorder::State::Playing ? g_show.positionMs() : 0));
+  json += F(",\"rate\":");
+  json += String(g_show.rate());
+  json += F("}");
+  json += F(",\"jitter\":{\"enabled\":");
+  json += g_jitter.enabled() ? F("true") : F("false");
+  json += F(",\"depth\":");
+  json += String(g_jitter.depth());
+  json += F(",\"targetDepth\":");
+  json += String(g_jitter.targetDepth());
+  json += F(",\"capacity\":");
+  json += String(g_jitter.capacity());
+  json += F(",\"intervalUs\":");
+  json += String((unsigned long)g_jitter.intervalUs());
+  json += F(",\"latencyUs\":");
+  json += String((unsigned long)g_jitter.latencyUs());
+  json += F(",\"released\":");
+  json += String((unsigned long)g_jitter.released());
+  json += F(",\"underruns\":");
+  json += String((unsigned long)g_jitter.underruns());
+  json += F(",\"overruns\":");
+  json += String((unsigned long)g_jitter.overruns());
+  json += F(",\"late\":");
+  json += String((unsigned long)g_jitter.lateFrames());
+  json += F("}");
+  json += F(",\"outputs\":{\"frameTimeUs\":");
+  json += String((unsigned long)g_outputs.frameTimeUs());
+  json += F(",\"async\":");
+  json += g_outputs.asynchronous() ? F("true") : F("false");
+  json += F(",\"showCallUs\":");
+  json += String((unsigned long)g_outputs.lastShowCallUs());
+  json += F(",\"pendingRestart\":");
+  json += g_outputsNeedRestart ? F("true") : F("false");
+  json += F(",\"list\":[");
+  for (uint8_t i = 0; i < g_outputs.count(); ++i) {
+    const LedOutputs::Output& out = g_outputs.output(i);
+    const uint16_t startUniverse = i == 0 ? g_config.startUniverse : g_config.extraOutputs[i - 1].startUniverse;
+    if (i) json += F(",");
+    json += F("{\"pin\":");
+    json += String(out.pin);
+    json += F(",\"chip\":\"");
+    json += getChipName(static_cast<uint8_t>(out.chip));
+    json += F("\",\"order\":\"");
+    json += getColorOrderName(static_cast<uint8_t>(out.colorOrder));
+    json += F("\",\"firstLed\":");
+    json += String(out.firstLed);
+    json += F(",\"leds\":");
+    json += String(out.ledCount);
+    json += F(",\"startUniverse\":");
+    json += String(startUniverse);
+    json += F(",\"wireTimeUs\":");
+    json += String((unsigned long)LedOutputs::wireTimeUs(out));
+    json += F("}");
+  }
+  json += F("]}");
+  json += F(",\"memory\":{\"arenaBytes\":");
+  json += String((unsigned long)g_arena.capacity());
+  json += F(",\"usedBytes\":");
+  json += String((unsigned long)g_arena.used());
+  json += F(",\"fits\":");
+  json += g_memoryPlan.fits ? F("true") : F("false");
+  json += F(",\"maxLeds\":");
+  json += String(ledBudget(g_config));
+  json += F(",\"pixelBytes\":");
+  json += String((unsigned long)g_memoryPlan.pixelBytes);
+  json += F(",\"renderBytes\":");
+  json += String((unsigned long)g_memoryPlan.renderBytes);
+  json += F(",\"tableBytes\":");
+  json += String((unsigned long)g_memoryPlan.tableBytes);
+  json += F(",\"mergeBytes\":");
+  json += String((unsigned long)g_memoryPlan.mergeBytes);
+  json += F(",\"mergeSlots\":");
+  json += String(g_memoryPlan.mergeSlots);
+  json += F(",\"freeMergeSlots\":");
+  json += String(g_ingest.freeMergeSlots());
+  json += F(",\"jitterBytes\":");
+  json += String((unsigned long)g_memoryPlan.jitterBytes);
+  json += F(",\"jitterFrames\":");
+  json += String(g_memoryPlan.jitterFrames);
+  json += F(",\"freeHeap\":");
+  json += String((unsigned long)ESP.getFreeHeap());
+  json += F(",\"blocks\":[");
+  for (uint8_t i = 0; i < g_arena.blockCount(); ++i) {
+    const MemoryArena::Block& block = g_arena.block(i);
+    if (i) json += F(",");
+    json += F("{\"name\":\"");
+    json += block.name;
+    json += F("\",\"bytes\":");
+    json += String((unsigned long)block.bytes);
+    json += F("}");
+  }
+  json += F("]}");
+  json += F(",\"clock\":{\"role\":");
+  json += String(g_config.clockRole);
+  json += F(",\"synced\":");
+  json += g_clock.synced(micros()) ? F("true") : F("false");
+  json += F(",\"master\":\"");
+  json += g_clock.masterIp().toString();
+  json += F("\",\"offsetUs\":");
+  json += String((unsigned long)g_clock.offsetUs());
+  json += F(",\"pathDelayUs\":");
+  json += String((unsigned long)g_clock.pathDelayUs());
+  json += F(",\"lastErrorUs\":");
+  json += String((long)g_clock.lastErrorUs());
+  json += F(",\"skewUs\":");
+  json += String((unsigned long)(g_config.clockRole == static_cast<uint8_t>(ClockSync::Role::Master)
+                                     ? g_clock.maxPeerSkewUs() : g_clock.skewUs()));
+  json += F(",\"peers\":");
+  json += String(g_clock.peerCount());
+  json += F(",\"exchanges\":");
+  json += String((unsigned long)g_clock.exchanges());
+  json += F(",\"targeted\":");
+  json += String((unsigned long)g_clock.targetedFrames());
+  json += F(",\"presented\":");
+  json += String((unsigned long)g_clock.presentedFrames());
+  json += F(",\"late\":");
+  json += String((unsigned long)g_clock.lateFrames());
+  json += F("}");
+  json += F(",\"timecode\":{\"enabled\":");
+  json += g_tcSync.enabled() ? F("true") : F("false");
+  json += F(",\"locked\":");
+  json += g_tcSync.locked() ? F("true") : F("false");
+  json += F(",\"freewheel\":");
+  json += g_tcSync.freewheeling() ? F("true") : F("false");
+  json += F(",\"timecodeMs\":");
+  json += String((unsigned long)g_tcSync.timecodeMs());
+  json += F(",\"errorMs\":");
+  json += String((long)g_tcSync.errorMs());
+  json += F(",\"received\":");
+  json += String((unsigned long)g_tcSync.received());
+  json += F(",\"seeks\":");
+  json += String((unsigned long)g_tcSync.seeks());
+  json += F(",\"dropouts\":");
+  json += String((unsigned long)g_tcSync.dropouts());
+  json += F("}");
+  json += F(",\"output\":{\"inputFps\":");
+  json += String(g_pacer.inputFps());
+  json += F(",\"outputFps\":");
+  json += String(g_pacer.outputFps());
+  json += F(",\"showUs\":");
+  json += String((unsigned long)g_pacer.showUs());
+  json += F(",\"intervalUs\":");
+  json += String((unsigned long)g_pacer.intervalUs());
+  json += F(",\"coalesced\":");
+  json += String((unsigned long)g_pacer.coalesced());
+  json += F(",\"frames\":");
+  json += String((unsigned long)g_render.outputFrame());
+  json += F(",\"unchanged\":");
+  json += String((unsigned long)g_render.unchangedFrames());
+  json += F(",\"keepAlives\":");
+  json += String((unsigned long)g_render.keepAliveCount());
+  json += F(",\"interpolate\":");
+  json += g_render.interpolation() ? F("true") : F("false");
+  json += F(",\"frameIntervalUs\":");
+  json += String((unsigned long)g_render.frameIntervalUs());
+  json += F("}");
+  json += F(",\"power\":{\"limitMa\":");
+  json += String((unsigned long)g_config.powerLimitMa);
+  json += F(",\"estimatedMa\":");
+  json += String((unsigned long)g_power.estimatedMa());
+  json += F(",\"limitedMa\":");
+  json += String((unsigned long)g_power.limitedMa());
+  json += F(",\"brightness\":");
+  json += String(g_power.brightness());
+  json += F(",\"limiting\":");
+  json += g_power.limiting() ? F("true") : F("false");
+  json += F(",\"limitedFrames\":");
+  json += String((unsigned long)g_power.limitedFrames());
+  json += F(",\"outputs\":[");
+  for (uint8_t i = 0; i < g_power.outputCount(); ++i) {
+    const PowerLimiter::Output& out = g_power.output(i);
+    if (i) json += ',';
+    json += F("{\"limitMa\":");
+    json += String((unsigned long)out.limitMa);
+    json += F(",\"estimatedMa\":");
+    json += String((unsigned long)out.estimatedMa);
+    json += F(",\"limitedMa\":");
+    json += String((unsigned long)out.limitedMa);
+    json += '}';
+  }
+  json += F("]}");
+  json += F(",\"render\":{\"passthrough\":");
+  json += g_render.passthrough() ? F("true") : F("false");
+  json += F(",\"sourceLost\":");
+  json += g_render.sourceLost() ? F("true") : F("false");
+  json += F(",\"losses\":");
+  json += String((unsigned long)g_render.lossCount());
+  json += F(",\"inputAgeMs\":");
+  json += String((unsigned long)g_render.inputAgeMs());
+  json += F("}");
+  json += F(",\"artnet\":{\"interfaces\":[");
+  for (uint8_t i = 0; i < ArtNetNode::INTERFACE_COUNT; ++i) {
+    const ArtNetNode::Interface iface = static_cast<ArtNetNode::Interface>(i);
+    if (i) json += ',';
+    json += F("{\"name\":\"");
+    json += ARTNET_INTERFACE_NAMES[i];
+    json += F("\",\"listening\":");
+    json += artnet.listening(iface) ? F("true") : F("false");
+    json += F(",\"standingBy\":");
+    json += artnet.standingBy(iface) ? F("true") : F("false");
+    json += F(",\"ip\":\"");
+    json += artnet.interfaceIp(iface).toString();
+    json += F("\",\"packets\":");
+    json += String((unsigned long)artnet.interfacePackets(iface));
+    json += F("}");
+  }
+  json += F("],\"filteredPackets\":");
+  json += String((unsigned long)artnet.filteredPackets());
+  json += F(",\"unownedPackets\":");
+  json += String((unsigned long)artnet.unownedPackets());
+  json += F(",\"announcements\":");
+  json += String((unsigned long)artnet.announcements());
+  const ArtNetNode::PollStats& polls = artnet.pollStats();
+  json += F(",\"polls\":{\"received\":");
+  json += String((unsigned long)polls.polls);
+  json += F(",\"replies\":");
+  json += String((unsigned long)polls.replies);
+  json += F(",\"coalesced\":");
+  json += String((unsigned long)polls.coalesced);
+  json += F(",\"untargeted\":");
+  json += String((unsigned long)polls.untargeted);
+  json += F(",\"changeReplies\":");
+  json += String((unsigned long)polls.changeReplies);
+  json += F(",\"diagnostics\":");
+  json += String((unsigned long)polls.diagnostics);
+  json += F(",\"controllers\":");
+  json += String((unsigned long)artnet.controllerCount());
+  json += F("}");
+  json += F(",\"failover\":{\"standby\":");
+  json += g_config.wifiStandby ? F("true") : F("false");
+  json += F(",\"count\":");
+  json += String((unsigned long)g_failover.count);
+  json += F(",\"lastSwitchUs\":");
+  json += String((unsigned long)g_failover.lastSwitchUs);
+  json += F(",\"lastGapMs\":");
+  json += String((unsigned long)g_failover.lastGapMs);
+  json += F("}}");
+  json += F(",\"logs\":{\"level\":\"");
+  json += LogRing::levelName(g_log.level());
+  json += F("\",\"written\":");
+  json += String((unsigned long)g_log.written());
+  json += F(",\"dropped\":");
+  json += String((unsigned long)g_log.dropped());
+  json += F(",\"syslog\":\"");
+  json += g_config.syslogIp ? ipToString(g_config.syslogIp) + ":" + String(g_config.syslogPort) : String();
+  json += F("\"}");
+  json += F(",\"scheduler\":{\"passes\":");
+  json += String((unsigned long)g_scheduler.passes());
+  json += F(",\"idlePermille\":");
+  json += String(g_scheduler.idlePermille());
+  json += F(",\"tasks\":[");
+  for (uint8_t i = 0; i < g_scheduler.taskCount(); ++i) {
+    const TaskScheduler::Stats& task = g_scheduler.stats(i);
+    if (i) json += ',';
+    json += F("{\"name\":\"");
+    json += g_scheduler.name(i);
+    json += F("\",\"priority\":");
+    json += String(g_scheduler.priority(i));
+    json += F(",\"periodUs\":");
+    json += String((unsigned long)g_scheduler.periodUs(i));
+    json += F(",\"budgetUs\":");
+    json += String((unsigned long)g_scheduler.budgetUs(i));
+    json += F(",\"runs\":");
+    json += String((unsigned long)task.runs);
+    json += F(",\"cpuPermille\":");
+    json += String(task.cpuPermille);
+    json += F(",\"lastRunUs\":");
+    json += String((unsigned long)task.lastRunUs);
+    json += F(",\"maxRunUs\":");
+    json += String((unsigned long)task.maxRunUs);
+    json += F(",\"maxLatencyUs\":");
+    json += String((unsigned long)task.maxLatencyUs);
+    json += F(",\"overruns\":");
+    json += String((unsigned long)task.overruns);
+    json += F("}");
+  }
+  json += F("]}");
+  json += F(",\"ingest\":{\"packets\":");
+  json += String((unsigned long)ingest.packets);
+  json += F(",\"framesLatched\":");
+  json += String((unsigned long)ingest.framesLatched);
+  json += F(",\"syncPackets\":");
+  json += String((unsigned long)ingest.syncPackets);
+  json += F(",\"syncLatched\":");
+  json += String((unsigned long)ingest.syncLatched);
+  json += F(",\"mergedPackets\":");
+  json += String((unsigned long)ingest.mergedPackets);
+  json += F(",\"ignoredSourcePackets\":");
+  json += String((unsigned long)ingest.ignoredSourcePackets);
+  json += F(",\"unbufferedMerges\":");
+  json += String((unsigned long)ingest.unbufferedMerges);
+  json += F(",\"exclusiveSource\":\"");
+  json += ipToString(g_ingest.exclusiveSource());
+  json += F("\",\"syncMode\":");
+  json += g_ingest.syncMode() ? F("true") : F("false");
+  json += F(",\"latchLatencyUs\":");
+  appendHistogramJson(json, ingest.latchLatencyUs);
+  json += F("}}");
+
+  g_server.sendHeader("Cache-Control", "no-store");
+  g_server.send(200, "application/json", json);
+}
+
 void handleWifiScan()
 {
   int16_t n = WiFi.scanNetworks(/*async=*/false, /*show_hidden=*/true);
@@ -1544,8 +3425,63 @@ void handleWifiScan()
   WiFi.scanDelete();
 }
 
+// ===================== PLANIFICADOR =====================
+// La recepción tiene prioridad 0: corre al principio de cada pasada y otra
+// vez antes de cada tarea que toque, así un paquete espera como mucho lo que
+// dura una sola tarea.  /metrics informa el uso de CPU y la peor espera de
+// cada una.
+// Lee lo que haya en los sockets hasta agotar su presupuesto: tras una tarea
+// larga la cola se vacía de una vez y no un paquete por pasada.
+void taskIngest()
+{
+  serviceFailover();
+  const uint32_t startUs = micros();
+  while (artnet.read() && micros() - startUs < TASK_INGEST_BUDGET_US) {
+  }
+  g_clock.service(micros());
+}
+
+void taskRender()
+{
+  serviceJitterBuffer();
+  serviceOutput();
+  serviceShowPlayback();
+}
+
+// Plazos: pérdida de señal, DHCP y lo que dejó ArtIpProg.
+void taskTimers()
+{
+  g_render.serviceSourceLoss();
+  serviceNetworkBringUp();
+  serviceIpProgram();
+}
+
+void taskWeb()
+{
+  g_server.handleClient();
+}
+
+void taskHousekeeping()
+{
+  serviceConfigPersistence();
+  serviceBootScene();
+  serviceLogs();
+}
+
+void addTasks()
+{
+  g_scheduler.add("ingest", taskIngest, 0, 0, TASK_INGEST_BUDGET_US);
+  g_scheduler.add("render", taskRender, 1, 0, TASK_RENDER_BUDGET_US);
+  g_scheduler.add("timers", taskTimers, 2, TASK_TIMERS_PERIOD_US, TASK_TIMERS_BUDGET_US);
+  g_scheduler.add("web", taskWeb, 3, TASK_WEB_PERIOD_US, TASK_WEB_BUDGET_US);
+  g_scheduler.add("housekeeping", taskHousekeeping, 4, TASK_HOUSEKEEPING_PERIOD_US, TASK_HOUSEKEEPING_BUDGET_US);
+}
+
 void setup()
 {
+  // Con buffer de transmisión, serviceLogs() escribe sólo lo que entra y
+  // loop() no espera a que la UART saque los bytes.
+  Serial.setTxBufferSize(SERIAL_TX_BUFFER);
   Serial.begin(115200);
   delay(200);
 
@@ -1553,26 +3489,53 @@ void setup()
     restoreFactoryDefaults();
   }
 
+  // El arena y la tarea de salida van antes de cargar la configuración: de
+  // ellos depende cuántos LEDs entran.
+  size_t arenaBytes = MEMORY_ARENA_BYTES;
+  while (!g_arena.begin(arenaBytes) && arenaBytes > 4096) {
+    arenaBytes /= 2;
+  }
+  g_log.log(LogLevel::Info, LogTag::Mem, "Arena de %u bytes (%u libres en el heap)", g_arena.capacity(), ESP.getFreeHeap());
+  // FastLED.show() corre en su propia tarea: loop() sigue recibiendo Art-Net
+  // mientras la tira se transmite.
+  if (!g_ledBackend.begin(OUTPUT_TASK_CORE)) {
+    g_log.log(LogLevel::Warn, LogTag::Led, "No se pudo crear la tarea de salida; show() bloqueante.");
+  }
+
   loadConfig();
 
-  initializeFastLEDController();
-  FastLED.clear(true);
+  g_outputs.begin(g_ledBackend);
+  g_outputs.setDoneCallback(onOutputDone);
   FastLED.setDither(0);
   FastLED.setBrightness(g_config.brightness);
 
+  g_render.begin(g_ingest);
+  g_render.setFallbackLoader(loadFallbackScene);
   applyConfig();
+  // Antes de levantar la red: la última escena queda visible en milisegundos.
+  restoreBootScene();
+  g_show.setLog(&g_log);
+  g_show.begin();
 
   WiFi.onEvent(onWiFiEvent);
   WiFi.persistent(false);
   // Wi-Fi bring-up switches the default LwIP interface to the wireless stack.
   // Re-initialise Ethernet afterwards so Art-Net binds to the wired interface.
+  // Neither call waits for DHCP; loop() finishes the bring-up in the background.
   bringUpWiFi(g_config);
   bringUpEthernet(g_config);
+  g_failover.linkSeen = eth_link_up;
+  artnet.setLinkUp(ArtNetNode::Interface::Ethernet, eth_link_up);
   artnet.updateNetworkInfo();
 
-  artnet.setNodeNames("PixelEtherLED", "PixelEtherLED Controller");
   artnet.begin();                      // responde a ArtPoll → Jinx "Scan"
   artnet.setArtDmxCallback(onDmxFrame);
+  artnet.setArtSyncCallback(onArtSync);
+  artnet.setArtTimeCodeCallback(onArtTimeCode);
+  artnet.setArtAddressCallback(onArtAddress);
+  artnet.setArtIpProgCallback(onArtIpProg);
+  g_clockReady = true;
+  g_clock.begin(static_cast<ClockSync::Role>(g_config.clockRole), IPAddress(g_config.clockMasterIp));
 
   g_server.on("/", HTTP_GET, handleRoot);
   g_server.on("/config", HTTP_GET, handleConfigGet);
@@ -1581,24 +3544,33 @@ void setup()
   g_server.on("/wifi", HTTP_POST, handleWifiConfigPost);
   g_server.on("/visualizer", HTTP_GET, handleVisualizerGet);
   g_server.on("/api/led_state", HTTP_GET, handleLedStateJson);
+  g_server.on("/metrics", HTTP_GET, handleMetricsJson);
+  g_server.on("/api/logs", HTTP_GET, handleLogsJson);
   g_server.on("/update", HTTP_GET, handleRoot);
   g_server.on("/update", HTTP_POST, handleFirmwareUpdatePost, handleFirmwareUpload);
   g_server.on("/wifi_scan", HTTP_GET, handleWifiScan);
+  g_server.on("/scene", HTTP_POST, handleScenePost);
+  g_server.on("/show", HTTP_POST, handleShowPost);
   g_server.begin();
+  addTasks();
 
-  Serial.println("[ARTNET] Listo");
-  Serial.printf("  Universos: %u (desde %u)\n", g_universeCount, g_config.startUniverse);
-  Serial.printf("  LEDs: %u, pix/universo: %u\n", g_config.numLeds, g_config.pixelsPerUniverse);
-  Serial.print("  IP actual: "); Serial.println(ETH.localIP());
+  g_log.log(LogLevel::Info, LogTag::ArtNet, "Listo: %u universos (desde %u), %u LEDs en %u salida(s), %u pix/universo",
+            g_ingest.universeCount(), g_config.startUniverse, totalLeds(g_config), g_outputs.count(),
+            g_config.pixelsPerUniverse);
+  if (eth_has_ip) {
+    logIp(LogTag::Eth, "IP actual: %u.%u.%u.%u", ETH.localIP());
+  } else {
+    g_log.log(LogLevel::Info, LogTag::Eth, "IP actual: (esperando DHCP)");
+  }
   IPAddress wifiIp = WiFi.localIP();
   if (wifiIp == IPAddress((uint32_t)0)) {
     wifiIp = WiFi.softAPIP();
   }
-  Serial.print("  Wi-Fi IP: "); Serial.println(wifiIp);
+  logIp(LogTag::Wifi, "IP: %u.%u.%u.%u", wifiIp);
+  g_log.log(LogLevel::Info, LogTag::ArtNet, "Setup completo a %u ms del arranque", millis());
 }
 
 void loop()
 {
-  artnet.read();
-  g_server.handleClient();
+  g_scheduler.runPass();
 }
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+// Marker written by artnet_loadgen at the start of every ArtDmx payload so
+// host_node can tie a latched frame back to the moment the generator sent its
+// first packet.  Both tools run on the same host and share CLOCK_MONOTONIC,
+// which is what micros() returns in the host build.
+struct LoadStamp {
+  static constexpr size_t SIZE = 10;
+
+  uint32_t frameId = 0;
+  uint32_t sendUs = 0;
+
+  void write(uint8_t* data) const
+  {
+    data[0] = 'P';
+    data[1] = 'L';
+    memcpy(data + 2, &frameId, sizeof(frameId));
+    memcpy(data + 6, &sendUs, sizeof(sendUs));
+  }
+
+  bool read(const uint8_t* data)
+  {
+    if (data[0] != 'P' || data[1] != 'L') return false;
+    memcpy(&frameId, data + 2, sizeof(frameId));
+    memcpy(&sendUs, data + 6, sizeof(sendUs));
+    return true;
+  }
+};
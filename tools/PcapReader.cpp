@@ -0,0 +1,365 @@
+#include "PcapReader.h"
+
+#include <cstring>
+
+namespace {
+constexpr uint32_t kPcapMagicUs = 0xA1B2C3D4;
+constexpr uint32_t kPcapMagicNs = 0xA1B23C4D;
+constexpr uint32_t kPcapMagicUsSwapped = 0xD4C3B2A1;
+constexpr uint32_t kPcapMagicNsSwapped = 0x4D3CB2A1;
+
+constexpr uint32_t kBlockSectionHeader = 0x0A0D0D0A;
+constexpr uint32_t kBlockInterface = 0x00000001;
+constexpr uint32_t kBlockObsoletePacket = 0x00000002;
+constexpr uint32_t kBlockSimplePacket = 0x00000003;
+constexpr uint32_t kBlockEnhancedPacket = 0x00000006;
+constexpr uint32_t kByteOrderMagic = 0x1A2B3C4D;
+
+constexpr uint16_t kLinkNull = 0;
+constexpr uint16_t kLinkEthernet = 1;
+constexpr uint16_t kLinkRawBsd = 12;
+constexpr uint16_t kLinkRaw = 101;
+constexpr uint16_t kLinkLoop = 108;
+constexpr uint16_t kLinkLinuxSll = 113;
+constexpr uint16_t kLinkIpv4 = 228;
+constexpr uint16_t kLinkLinuxSll2 = 276;
+
+constexpr uint32_t kMaxBlockLength = 16 * 1024 * 1024;
+
+uint16_t be16(const uint8_t* p) { return static_cast<uint16_t>(p[0] << 8 | p[1]); }
+
+uint32_t swap32(uint32_t value)
+{
+  return ((value & 0xFF) << 24) | ((value & 0xFF00) << 8) | ((value >> 8) & 0xFF00) | (value >> 24);
+}
+
+uint16_t swap16(uint16_t value) { return static_cast<uint16_t>((value << 8) | (value >> 8)); }
+
+}  // namespace
+
+PcapReader::~PcapReader()
+{
+  close();
+}
+
+bool PcapReader::open(const std::string& path)
+{
+  close();
+  m_file = std::fopen(path.c_str(), "rb");
+  if (!m_file) {
+    m_error = "cannot open " + path;
+    return false;
+  }
+
+  uint32_t magic = 0;
+  if (!readBytes(&magic, sizeof(magic))) {
+    m_error = "empty capture";
+    return false;
+  }
+
+  switch (magic) {
+    case kPcapMagicUs:
+    case kPcapMagicNs:
+    case kPcapMagicUsSwapped:
+    case kPcapMagicNsSwapped: {
+      m_format = Format::Pcap;
+      m_swapped = (magic == kPcapMagicUsSwapped || magic == kPcapMagicNsSwapped);
+      m_nanoseconds = (magic == kPcapMagicNs || magic == kPcapMagicNsSwapped);
+      uint8_t header[20];
+      if (!readBytes(header, sizeof(header))) {
+        m_error = "truncated pcap header";
+        return false;
+      }
+      uint32_t linkType;
+      memcpy(&linkType, header + 16, sizeof(linkType));
+      m_linkType = static_cast<uint16_t>(fix32(linkType) & 0xFFFF);
+      return true;
+    }
+    case kBlockSectionHeader: {
+      m_format = Format::PcapNg;
+      uint32_t blockLength = 0;
+      if (!readBytes(&blockLength, sizeof(blockLength))) {
+        m_error = "truncated pcapng header";
+        return false;
+      }
+      return parseSectionHeader(blockLength);
+    }
+    default:
+      m_error = "not a pcap/pcapng file";
+      return false;
+  }
+}
+
+void PcapReader::close()
+{
+  if (m_file) {
+    std::fclose(m_file);
+    m_file = nullptr;
+  }
+  m_format = Format::None;
+  m_interfaces.clear();
+}
+
+bool PcapReader::readBytes(void* dest, size_t length)
+{
+  return m_file && std::fread(dest, 1, length, m_file) == length;
+}
+
+uint16_t PcapReader::fix16(uint16_t value) const
+{
+  return m_swapped ? swap16(value) : value;
+}
+
+uint32_t PcapReader::fix32(uint32_t value) const
+{
+  return m_swapped ? swap32(value) : value;
+}
+
+bool PcapReader::next(Datagram& out)
+{
+  switch (m_format) {
+    case Format::Pcap: return nextPcap(out);
+    case Format::PcapNg: return nextPcapNg(out);
+    default: return false;
+  }
+}
+
+bool PcapReader::nextPcap(Datagram& out)
+{
+  for (;;) {
+    uint32_t record[4];
+    if (!readBytes(record, sizeof(record))) {
+      return false;
+    }
+    const uint32_t seconds = fix32(record[0]);
+    const uint32_t fraction = fix32(record[1]);
+    const uint32_t captured = fix32(record[2]);
+    if (captured > kMaxBlockLength) {
+      m_error = "corrupt pcap record";
+      return false;
+    }
+    m_block.resize(captured);
+    if (!readBytes(m_block.data(), captured)) {
+      return false;
+    }
+    ++m_framesRead;
+    out.timestampUs = static_cast<uint64_t>(seconds) * 1000000ULL + (m_nanoseconds ? fraction / 1000 : fraction);
+    if (decodeFrame(m_linkType, m_block.data(), captured, out)) {
+      return true;
+    }
+    ++m_framesSkipped;
+  }
+}
+
+bool PcapReader::parseSectionHeader(uint32_t rawLength)
+{
+  uint32_t byteOrder = 0;
+  if (!readBytes(&byteOrder, sizeof(byteOrder))) {
+    m_error = "truncated section header";
+    return false;
+  }
+  if (byteOrder == kByteOrderMagic) {
+    m_swapped = false;
+  } else if (byteOrder == swap32(kByteOrderMagic)) {
+    m_swapped = true;
+  } else {
+    m_error = "bad pcapng byte-order magic";
+    return false;
+  }
+
+  const uint32_t blockLength = fix32(rawLength);
+  if (blockLength < 28 || blockLength > kMaxBlockLength) {
+    m_error = "bad section header length";
+    return false;
+  }
+  // Remainder: version, section length, options and trailing length.
+  m_block.resize(blockLength - 12);
+  if (!readBytes(m_block.data(), m_block.size())) {
+    m_error = "truncated section header";
+    return false;
+  }
+  m_interfaces.clear();
+  return true;
+}
+
+void PcapReader::parseInterfaceOptions(Interface& iface, const uint8_t* options, size_t length)
+{
+  size_t pos = 0;
+  while (pos + 4 <= length) {
+    uint16_t code;
+    uint16_t optLength;
+    memcpy(&code, options + pos, 2);
+    memcpy(&optLength, options + pos + 2, 2);
+    code = fix16(code);
+    optLength = fix16(optLength);
+    pos += 4;
+    if (code == 0 || pos + optLength > length) {
+      return;
+    }
+    if (code == 9 && optLength >= 1) {  // if_tsresol
+      const uint8_t resolution = options[pos];
+      const uint8_t exponent = resolution & 0x7F;
+      uint64_t ticks = 1;
+      for (uint8_t i = 0; i < exponent && ticks < (1ULL << 60); ++i) {
+        ticks *= (resolution & 0x80) ? 2 : 10;
+      }
+      iface.ticksPerSecond = ticks;
+    }
+    pos += (optLength + 3u) & ~3u;
+  }
+}
+
+bool PcapReader::nextPcapNg(Datagram& out)
+{
+  for (;;) {
+    uint32_t header[2];
+    if (!readBytes(header, sizeof(header))) {
+      return false;
+    }
+
+    if (header[0] == kBlockSectionHeader) {
+      if (!parseSectionHeader(header[1])) {
+        return false;
+      }
+      continue;
+    }
+
+    const uint32_t type = fix32(header[0]);
+    const uint32_t blockLength = fix32(header[1]);
+    if (blockLength < 12 || blockLength > kMaxBlockLength || (blockLength & 3) != 0) {
+      m_error = "corrupt pcapng block";
+      return false;
+    }
+    m_block.resize(blockLength - 8);
+    if (!readBytes(m_block.data(), m_block.size())) {
+      return false;
+    }
+    const uint8_t* body = m_block.data();
+    const size_t bodyLength = m_block.size() - 4;
+
+    auto word = [&](size_t offset) {
+      uint32_t value;
+      memcpy(&value, body + offset, sizeof(value));
+      return fix32(value);
+    };
+
+    if (type == kBlockInterface) {
+      if (bodyLength < 8) continue;
+      Interface iface;
+      uint16_t linkType;
+      memcpy(&linkType, body, sizeof(linkType));
+      iface.linkType = fix16(linkType);
+      parseInterfaceOptions(iface, body + 8, bodyLength - 8);
+      m_interfaces.push_back(iface);
+      continue;
+    }
+
+    uint32_t interfaceId = 0;
+    uint64_t ticks = 0;
+    uint32_t captured = 0;
+    size_t dataOffset = 0;
+
+    if (type == kBlockEnhancedPacket) {
+      if (bodyLength < 20) continue;
+      interfaceId = word(0);
+      ticks = (static_cast<uint64_t>(word(4)) << 32) | word(8);
+      captured = word(12);
+      dataOffset = 20;
+    } else if (type == kBlockObsoletePacket) {
+      if (bodyLength < 20) continue;
+      uint16_t id;
+      memcpy(&id, body, sizeof(id));
+      interfaceId = fix16(id);
+      ticks = (static_cast<uint64_t>(word(4)) << 32) | word(8);
+      captured = word(12);
+      dataOffset = 20;
+    } else if (type == kBlockSimplePacket) {
+      if (bodyLength < 4) continue;
+      captured = static_cast<uint32_t>(bodyLength - 4);
+      dataOffset = 4;
+    } else {
+      continue;
+    }
+
+    if (interfaceId >= m_interfaces.size() || dataOffset + captured > bodyLength) {
+      ++m_framesSkipped;
+      continue;
+    }
+
+    const Interface& iface = m_interfaces[interfaceId];
+    ++m_framesRead;
+    out.timestampUs = iface.ticksPerSecond == 1000000 ? ticks
+                    : static_cast<uint64_t>(static_cast<long double>(ticks) * 1000000.0L / iface.ticksPerSecond);
+    if (decodeFrame(iface.linkType, body + dataOffset, captured, out)) {
+      return true;
+    }
+    ++m_framesSkipped;
+  }
+}
+
+bool PcapReader::decodeFrame(uint16_t linkType, const uint8_t* frame, size_t length, Datagram& out)
+{
+  size_t offset = 0;
+  uint16_t etherType = 0x0800;
+
+  switch (linkType) {
+    case kLinkEthernet:
+      if (length < 14) return false;
+      etherType = be16(frame + 12);
+      offset = 14;
+      while ((etherType == 0x8100 || etherType == 0x88A8) && length >= offset + 4) {
+        etherType = be16(frame + offset + 2);
+        offset += 4;
+      }
+      break;
+    case kLinkNull:
+    case kLinkLoop:
+      if (length < 4) return false;
+      // AF_INET is 2 on every platform; byte order depends on the capture host.
+      if (!(frame[0] == 2 || frame[3] == 2)) return false;
+      offset = 4;
+      break;
+    case kLinkLinuxSll:
+      if (length < 16) return false;
+      etherType = be16(frame + 14);
+      offset = 16;
+      break;
+    case kLinkLinuxSll2:
+      if (length < 20) return false;
+      etherType = be16(frame);
+      offset = 20;
+      break;
+    case kLinkRaw:
+    case kLinkRawBsd:
+    case kLinkIpv4:
+      break;
+    default:
+      return false;
+  }
+
+  if (etherType != 0x0800 || length < offset + 20) return false;
+
+  const uint8_t* ip = frame + offset;
+  if ((ip[0] >> 4) != 4) return false;
+  const size_t ihl = static_cast<size_t>(ip[0] & 0x0F) * 4;
+  const uint16_t totalLength = be16(ip + 2);
+  const uint16_t fragment = be16(ip + 6);
+  if (ip[9] != 17 || ihl < 20) return false;
+  if ((fragment & 0x3FFF) != 0) return false;  // fragmented datagrams are not reassembled
+
+  size_t ipEnd = offset + totalLength;
+  if (ipEnd > length) ipEnd = length;
+  if (offset + ihl + 8 > ipEnd) return false;
+
+  const uint8_t* udp = ip + ihl;
+  size_t udpLength = be16(udp + 4);
+  const size_t available = ipEnd - (offset + ihl);
+  if (udpLength < 8 || udpLength > available) udpLength = available;
+
+  memcpy(&out.srcIp, ip + 12, 4);
+  memcpy(&out.dstIp, ip + 16, 4);
+  out.srcPort = be16(udp);
+  out.dstPort = be16(udp + 2);
+  out.payload.assign(udp + 8, udp + udpLength);
+  return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Streams IPv4/UDP datagrams out of classic pcap and pcapng captures.
+// Supported link layers: Ethernet (with 802.1Q tags), raw IPv4, BSD loopback
+// and Linux cooked captures (SLL and SLL2).
+class PcapReader {
+public:
+  struct Datagram {
+    uint64_t timestampUs = 0;
+    uint32_t srcIp = 0;    // network byte order, as stored in IPAddress
+    uint32_t dstIp = 0;
+    uint16_t srcPort = 0;
+    uint16_t dstPort = 0;
+    std::vector<uint8_t> payload;
+  };
+
+  ~PcapReader();
+
+  bool open(const std::string& path);
+  void close();
+
+  // Returns false at end of file or on a malformed capture.
+  bool next(Datagram& out);
+
+  const std::string& error() const { return m_error; }
+  uint64_t framesRead() const { return m_framesRead; }
+  uint64_t framesSkipped() const { return m_framesSkipped; }
+
+private:
+  enum class Format : uint8_t { None, Pcap, PcapNg };
+
+  struct Interface {
+    uint16_t linkType = 0;
+    uint64_t ticksPerSecond = 1000000;
+  };
+
+  bool readBytes(void* dest, size_t length);
+  uint16_t fix16(uint16_t value) const;
+  uint32_t fix32(uint32_t value) const;
+
+  bool nextPcap(Datagram& out);
+  bool nextPcapNg(Datagram& out);
+  bool parseSectionHeader(uint32_t blockLength);
+  void parseInterfaceOptions(Interface& iface, const uint8_t* options, size_t length);
+  bool decodeFrame(uint16_t linkType, const uint8_t* frame, size_t length, Datagram& out);
+
+  FILE* m_file = nullptr;
+  Format m_format = Format::None;
+  bool m_swapped = false;
+  bool m_nanoseconds = false;
+  uint16_t m_linkType = 0;
+  std::vector<Interface> m_interfaces;
+  std::vector<uint8_t> m_block;
+  std::string m_error;
+  uint64_t m_framesRead = 0;
+  uint64_t m_framesSkipped = 0;
+};
@@ -0,0 +1,343 @@
+// Art-Net load generator for sizing installations.  Sends N ArtDmx universes
+// at a target frame rate (optionally followed by ArtSync, with jitter, loss and
+// reordering) to a node or to host_node on localhost, and sweeps universe
+// counts to produce a throughput/latency curve.  Node-side figures come from
+// the node's /metrics endpoint, which is reset before every step.  host_node
+// also resizes itself to each step's universe count; a real node only latches
+// frames when the step matches its configured universes.
+//
+//   pio run -e artnet_loadgen
+//   .pio/build/artnet_loadgen/program --host 127.0.0.1 --universes 1,4,16,32,64 --fps 40
+//   .pio/build/artnet_loadgen/program --host 192.168.0.50 --metrics 192.168.0.50:80 --sync
+
+#include "LoadStamp.h"
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+  std::string host = "127.0.0.1";
+  uint16_t port = 6454;
+  std::string metrics;  // host:port, defaults to host:8080 for localhost
+  std::vector<uint16_t> universeCounts{1, 2, 4, 8, 16, 32};
+  uint16_t startUniverse = 0;
+  uint16_t channels = 510;
+  double fps = 40.0;
+  double durationS = 5.0;
+  bool sync = false;
+  uint32_t jitterUs = 0;
+  double lossPct = 0.0;
+  double reorderPct = 0.0;
+  uint32_t settleMs = 300;
+  uint32_t seed = 1;
+  bool csv = false;
+};
+
+struct StepResult {
+  uint16_t universes = 0;
+  uint32_t framesSent = 0;
+  uint32_t packetsSent = 0;
+  uint64_t bytesSent = 0;
+  uint32_t lateFrames = 0;
+  double seconds = 0;
+};
+
+uint32_t monotonicMicros()
+{
+  return static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(Clock::now().time_since_epoch()).count());
+}
+
+std::vector<uint16_t> parseList(const std::string& text)
+{
+  std::vector<uint16_t> values;
+  size_t pos = 0;
+  while (pos < text.size()) {
+    const size_t comma = text.find(',', pos);
+    const std::string item = text.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+    const long value = std::atol(item.c_str());
+    if (value > 0) values.push_back(static_cast<uint16_t>(std::min(value, 32768L)));
+    if (comma == std::string::npos) break;
+    pos = comma + 1;
+  }
+  return values;
+}
+
+void buildArtDmx(std::vector<uint8_t>& packet, uint16_t universe, uint8_t sequence, uint16_t channels,
+                 const LoadStamp& stamp, uint32_t frame)
+{
+  packet.assign(18 + channels, 0);
+  memcpy(packet.data(), "Art-Net", 8);
+  packet[8] = 0x00;
+  packet[9] = 0x50;
+  packet[11] = 14;
+  packet[12] = sequence;
+  packet[14] = static_cast<uint8_t>(universe & 0xFF);
+  packet[15] = static_cast<uint8_t>((universe >> 8) & 0x7F);
+  packet[16] = static_cast<uint8_t>(channels >> 8);
+  packet[17] = static_cast<uint8_t>(channels & 0xFF);
+  uint8_t* data = packet.data() + 18;
+  for (uint16_t i = 0; i < channels; ++i) {
+    data[i] = static_cast<uint8_t>(frame + universe + i);
+  }
+  if (channels >= LoadStamp::SIZE) {
+    stamp.write(data);
+  }
+}
+
+std::vector<uint8_t> buildArtSync()
+{
+  std::vector<uint8_t> packet(14, 0);
+  memcpy(packet.data(), "Art-Net", 8);
+  packet[8] = 0x00;
+  packet[9] = 0x52;
+  packet[11] = 14;
+  return packet;
+}
+
+bool resolve(const std::string& host, uint16_t port, sockaddr_in& out)
+{
+  addrinfo hints{};
+  hints.ai_family = AF_INET;
+  addrinfo* result = nullptr;
+  if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || !result) return false;
+  out = *reinterpret_cast<sockaddr_in*>(result->ai_addr);
+  out.sin_port = htons(port);
+  freeaddrinfo(result);
+  return true;
+}
+
+std::string httpGet(const std::string& hostPort, const std::string& path)
+{
+  const size_t colon = hostPort.rfind(':');
+  const std::string host = hostPort.substr(0, colon);
+  const uint16_t port = colon == std::string::npos ? 80 : static_cast<uint16_t>(std::atoi(hostPort.c_str() + colon + 1));
+  sockaddr_in addr{};
+  if (!resolve(host, port, addr)) return std::string();
+
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return std::string();
+  timeval timeout{2, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+  if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+    ::close(fd);
+    return std::string();
+  }
+  const std::string request = "GET " + path + " HTTP/1.0\r\nHost: " + host + "\r\nConnection: close\r\n\r\n";
+  ::send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+
+  std::string response;
+  char buffer[2048];
+  ssize_t n;
+  while ((n = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+    response.append(buffer, static_cast<size_t>(n));
+  }
+  ::close(fd);
+  const size_t body = response.find("\r\n\r\n");
+  return body == std::string::npos ? std::string() : response.substr(body + 4);
+}
+
+// Looks up "key" inside the first object named "section" ("" = anywhere).
+double jsonNumber(const std::string& json, const std::string& section, const std::string& key)
+{
+  size_t from = 0;
+  if (!section.empty()) {
+    from = json.find("\"" + section + "\"");
+    if (from == std::string::npos) return -1;
+  }
+  const size_t at = json.find("\"" + key + "\":", from);
+  if (at == std::string::npos) return -1;
+  return std::strtod(json.c_str() + at + key.size() + 3, nullptr);
+}
+
+StepResult runStep(int fd, const sockaddr_in& target, const Options& opt, uint16_t universes, std::mt19937& rng,
+                   uint32_t& frameId)
+{
+  StepResult result;
+  result.universes = universes;
+
+  std::uniform_real_distribution<double> percent(0.0, 100.0);
+  std::uniform_int_distribution<int32_t> jitter(-static_cast<int32_t>(opt.jitterUs), static_cast<int32_t>(opt.jitterUs));
+  const std::vector<uint8_t> syncPacket = buildArtSync();
+  std::vector<std::vector<uint8_t>> packets(universes);
+  std::vector<size_t> order(universes);
+  std::vector<uint8_t> sequence(universes, 0);
+
+  const auto periodUs = std::chrono::microseconds(static_cast<int64_t>(1e6 / opt.fps));
+  const uint32_t totalFrames = static_cast<uint32_t>(opt.fps * opt.durationS);
+  const auto start = Clock::now();
+
+  for (uint32_t frame = 0; frame < totalFrames; ++frame) {
+    auto due = start + periodUs * frame;
+    if (opt.jitterUs) due += std::chrono::microseconds(jitter(rng));
+    if (Clock::now() > due + periodUs) {
+      ++result.lateFrames;
+    }
+    std::this_thread::sleep_until(due);
+
+    LoadStamp stamp;
+    stamp.frameId = ++frameId;
+    stamp.sendUs = monotonicMicros();
+    for (uint16_t u = 0; u < universes; ++u) {
+      sequence[u] = static_cast<uint8_t>(sequence[u] % 255 + 1);
+      buildArtDmx(packets[u], static_cast<uint16_t>(opt.startUniverse + u), sequence[u], opt.channels, stamp, frame);
+      order[u] = u;
+    }
+    if (opt.reorderPct > 0) {
+      for (size_t i = 0; i + 1 < order.size(); ++i) {
+        if (percent(rng) < opt.reorderPct) std::swap(order[i], order[i + 1]);
+      }
+    }
+    for (size_t index : order) {
+      if (opt.lossPct > 0 && percent(rng) < opt.lossPct) continue;
+      const std::vector<uint8_t>& packet = packets[index];
+      ::sendto(fd, packet.data(), packet.size(), 0, reinterpret_cast<const sockaddr*>(&target), sizeof(target));
+      ++result.packetsSent;
+      result.bytesSent += packet.size();
+    }
+    if (opt.sync) {
+      ::sendto(fd, syncPacket.data(), syncPacket.size(), 0, reinterpret_cast<const sockaddr*>(&target), sizeof(target));
+    }
+    ++result.framesSent;
+  }
+
+  result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  return result;
+}
+
+void usage()
+{
+  std::fprintf(stderr,
+               "usage: artnet_loadgen [options]\n"
+               "  --host H             node address (127.0.0.1); broadcast addresses are allowed\n"
+               "  --port N             Art-Net port (6454)\n"
+               "  --metrics H:P        node metrics endpoint (default H:8080 for localhost, else H:80)\n"
+               "  --universes LIST     comma separated universe counts to sweep (1,2,4,8,16,32)\n"
+               "  --start-universe N   first universe (0)\n"
+               "  --channels N         DMX channels per packet (510)\n"
+               "  --fps F              target frames per second (40)\n"
+               "  --duration S         seconds per step (5)\n"
+               "  --sync               send ArtSync after each frame\n"
+               "  --jitter-us N        uniform +/-N us jitter on frame start\n"
+               "  --loss PCT           drop PCT %% of ArtDmx packets\n"
+               "  --reorder PCT        swap adjacent packets with PCT %% probability\n"
+               "  --settle-ms N        wait before reading metrics (300)\n"
+               "  --seed N             random seed (1)\n"
+               "  --csv                machine readable output\n");
+}
+
+bool parseOptions(int argc, char** argv, Options& opt)
+{
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    auto value = [&]() -> std::string { return (i + 1 < argc) ? argv[++i] : ""; };
+    if (arg == "--host") opt.host = value();
+    else if (arg == "--port") opt.port = static_cast<uint16_t>(std::atoi(value().c_str()));
+    else if (arg == "--metrics") opt.metrics = value();
+    else if (arg == "--universes") opt.universeCounts = parseList(value());
+    else if (arg == "--start-universe") opt.startUniverse = static_cast<uint16_t>(std::atoi(value().c_str()));
+    else if (arg == "--channels") opt.channels = static_cast<uint16_t>(std::max(2, std::min(512, std::atoi(value().c_str()))) & ~1);
+    else if (arg == "--fps") opt.fps = std::max(0.1, std::atof(value().c_str()));
+    else if (arg == "--duration") opt.durationS = std::max(0.1, std::atof(value().c_str()));
+    else if (arg == "--sync") opt.sync = true;
+    else if (arg == "--jitter-us") opt.jitterUs = static_cast<uint32_t>(std::atol(value().c_str()));
+    else if (arg == "--loss") opt.lossPct = std::atof(value().c_str());
+    else if (arg == "--reorder") opt.reorderPct = std::atof(value().c_str());
+    else if (arg == "--settle-ms") opt.settleMs = static_cast<uint32_t>(std::atol(value().c_str()));
+    else if (arg == "--seed") opt.seed = static_cast<uint32_t>(std::atol(value().c_str()));
+    else if (arg == "--csv") opt.csv = true;
+    else return false;
+  }
+  if (opt.metrics.empty()) {
+    const bool local = opt.host == "127.0.0.1" || opt.host == "localhost";
+    opt.metrics = opt.host + (local ? ":8080" : ":80");
+  }
+  return !opt.universeCounts.empty();
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  Options opt;
+  if (!parseOptions(argc, argv, opt)) {
+    usage();
+    return 2;
+  }
+
+  sockaddr_in target{};
+  if (!resolve(opt.host, opt.port, target)) {
+    std::fprintf(stderr, "artnet_loadgen: cannot resolve %s\n", opt.host.c_str());
+    return 1;
+  }
+  int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+  int yes = 1;
+  setsockopt(fd, SOL_SOCKET, SO_BROADCAST, &yes, sizeof(yes));
+  int sndbuf = 4 * 1024 * 1024;
+  setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+
+  std::mt19937 rng(opt.seed);
+  uint32_t frameId = 0;
+
+  if (opt.csv) {
+    std::printf("universes,target_fps,sent_fps,packets_s,mbit_s,late_frames,latched_fps,complete_pct,"
+                "latch_p50_us,latch_p99_us,e2e_p50_us,e2e_p99_us,e2e_max_us\n");
+  } else {
+    std::printf("%-9s %7s %8s %9s %8s %5s | %8s %8s %9s %9s %9s %9s\n", "universes", "target", "sent fps",
+                "pkts/s", "Mbit/s", "late", "latched", "complete", "latch p50", "latch p99", "e2e p50", "e2e p99");
+  }
+
+  for (uint16_t universes : opt.universeCounts) {
+    const bool haveMetrics =
+        !httpGet(opt.metrics, "/metrics?reset=1&universes=" + std::to_string(universes)).empty();
+    const StepResult step = runStep(fd, target, opt, universes, rng, frameId);
+    std::this_thread::sleep_for(std::chrono::milliseconds(opt.settleMs));
+    const std::string metrics = haveMetrics ? httpGet(opt.metrics, "/metrics") : std::string();
+
+    const double sentFps = step.framesSent / step.seconds;
+    const double packetsPerSecond = step.packetsSent / step.seconds;
+    const double mbit = step.bytesSent * 8.0 / step.seconds / 1e6;
+    const double latched = metrics.empty() ? -1 : jsonNumber(metrics, "ingest", "framesLatched");
+    const double latchedFps = latched < 0 ? -1 : latched / step.seconds;
+    const double complete = latched < 0 ? -1 : 100.0 * latched / std::max<uint32_t>(1, step.framesSent);
+    const double latchP50 = jsonNumber(metrics, "latchLatencyUs", "p50");
+    const double latchP99 = jsonNumber(metrics, "latchLatencyUs", "p99");
+    const double e2eP50 = jsonNumber(metrics, "endToEndUs", "p50");
+    const double e2eP99 = jsonNumber(metrics, "endToEndUs", "p99");
+    const double e2eMax = jsonNumber(metrics, "endToEndUs", "max");
+
+    if (opt.csv) {
+      std::printf("%u,%.1f,%.2f,%.0f,%.2f,%u,%.2f,%.2f,%.0f,%.0f,%.0f,%.0f,%.0f\n", universes, opt.fps, sentFps,
+                  packetsPerSecond, mbit, step.lateFrames, latchedFps, complete, latchP50, latchP99, e2eP50, e2eP99,
+                  e2eMax);
+    } else {
+      std::printf("%-9u %7.1f %8.2f %9.0f %8.2f %5u | %8.2f %7.1f%% %9.0f %9.0f %9.0f %9.0f\n", universes, opt.fps,
+                  sentFps, packetsPerSecond, mbit, step.lateFrames, latchedFps, complete, latchP50, latchP99, e2eP50,
+                  e2eP99);
+    }
+    std::fflush(stdout);
+  }
+
+  if (!opt.csv) {
+    std::printf("\nlatencies in us; -1 = not reported by the node (no /metrics or no stamped frames)\n");
+  }
+  ::close(fd);
+  return 0;
+}
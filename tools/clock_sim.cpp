@@ -0,0 +1,236 @@
+// Host simulation of presentation-time sync.  Runs one master and several
+// slave ClockSync instances on loopback (127.0.0.1, 127.0.0.2, ...), each
+// with its own virtual clock (random offset and ppm drift).  Every frame
+// period the master "latches" a frame; each slave latches the same frame
+// after a random receive jitter, as Wi-Fi nodes do after an ArtSync.  Nodes
+// show a frame when ClockSync says it is due, and the tool compares the real
+// instants at which they did so.
+//
+//   pio run -e clock_sim
+//   .pio/build/clock_sim/program --nodes 8 --jitter-us 8000 --delay-ms 20
+//
+// Exit status is 3 when the 99th percentile skew between nodes exceeds
+// --max-skew-us, so the tool doubles as a regression check.
+
+#include <Arduino.h>
+#include <HostNet.h>
+
+#include "ClockSync.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+  uint16_t nodes = 8;
+  uint16_t port = ClockSync::PORT;
+  double fps = 40.0;
+  double durationS = 10.0;
+  double warmupS = 1.5;
+  uint32_t jitterUs = 8000;     // spread of frame arrival between nodes
+  uint32_t delayMs = 20;        // presentation delay
+  uint32_t stallUs = 0;         // random loop stalls per node
+  uint32_t driftPpm = 50;
+  uint32_t maxSkewUs = 1000;
+  uint32_t seed = 1;
+};
+
+struct Node {
+  std::unique_ptr<ClockSync> sync;
+  uint32_t clockOffsetUs = 0;
+  double drift = 0;
+  uint64_t busyUntilUs = 0;
+  // Next frame to latch: index and true arrival time.
+  std::vector<std::pair<uint32_t, uint64_t>> arrivals;
+  long heldFrame = -1;
+};
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t trueMicros(Clock::time_point start)
+{
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count());
+}
+
+uint32_t localMicros(const Node& node, uint64_t trueUs)
+{
+  return node.clockOffsetUs + static_cast<uint32_t>(static_cast<uint64_t>(static_cast<double>(trueUs) * node.drift));
+}
+
+uint64_t percentile(std::vector<uint64_t> values, double fraction)
+{
+  if (values.empty()) return 0;
+  std::sort(values.begin(), values.end());
+  const size_t index = static_cast<size_t>(fraction * static_cast<double>(values.size() - 1) + 0.5);
+  return values[std::min(index, values.size() - 1)];
+}
+
+void usage()
+{
+  std::fprintf(stderr,
+               "usage: clock_sim [options]\n"
+               "  --nodes N          slave nodes besides the master (8)\n"
+               "  --port N           sync UDP port (6460)\n"
+               "  --fps N            frames per second (40)\n"
+               "  --duration S       measured seconds (10)\n"
+               "  --jitter-us N      frame arrival spread between nodes (8000)\n"
+               "  --delay-ms N       presentation delay (20)\n"
+               "  --stall-us N       longest random loop stall per node (0)\n"
+               "  --drift-ppm N      largest clock drift per node (50)\n"
+               "  --max-skew-us N    fail when p99 skew is above this (1000)\n"
+               "  --seed N           random seed (1)\n");
+}
+
+bool parseOptions(int argc, char** argv, Options& opt)
+{
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    auto value = [&]() -> const char* { return (i + 1 < argc) ? argv[++i] : ""; };
+    if (arg == "--nodes") opt.nodes = static_cast<uint16_t>(std::max(1, std::min(200, std::atoi(value()))));
+    else if (arg == "--port") opt.port = static_cast<uint16_t>(std::atoi(value()));
+    else if (arg == "--fps") opt.fps = std::max(1.0, std::atof(value()));
+    else if (arg == "--duration") opt.durationS = std::max(1.0, std::atof(value()));
+    else if (arg == "--jitter-us") opt.jitterUs = static_cast<uint32_t>(std::atol(value()));
+    else if (arg == "--delay-ms") opt.delayMs = static_cast<uint32_t>(std::atol(value()));
+    else if (arg == "--stall-us") opt.stallUs = static_cast<uint32_t>(std::atol(value()));
+    else if (arg == "--drift-ppm") opt.driftPpm = static_cast<uint32_t>(std::atol(value()));
+    else if (arg == "--max-skew-us") opt.maxSkewUs = static_cast<uint32_t>(std::atol(value()));
+    else if (arg == "--seed") opt.seed = static_cast<uint32_t>(std::atol(value()));
+    else if (arg == "-h" || arg == "--help") return false;
+    else {
+      std::fprintf(stderr, "unknown option: %s\n", arg.c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  Options opt;
+  if (!parseOptions(argc, argv, opt)) {
+    usage();
+    return 2;
+  }
+  if (opt.nodes > ClockSync::MAX_PEERS) {
+    std::fprintf(stderr, "clock_sim: the master tracks at most %u slaves\n", ClockSync::MAX_PEERS);
+    return 2;
+  }
+
+  HostNet::setMode(HostNet::Mode::Socket);
+  std::mt19937 rng(opt.seed);
+  std::uniform_int_distribution<uint32_t> anyOffset;
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+  // Node 0 is the master; the rest are slaves that know its address.
+  const IPAddress masterIp(127, 0, 0, 1);
+  std::vector<Node> nodes(opt.nodes + 1u);
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    Node& node = nodes[i];
+    node.sync.reset(new ClockSync());
+    node.clockOffsetUs = i == 0 ? 0 : anyOffset(rng);
+    node.drift = 1.0 + (unit(rng) * 2.0 - 1.0) * opt.driftPpm * 1e-6;
+    node.sync->setPresentDelay(opt.delayMs * 1000);
+    node.sync->begin(i == 0 ? ClockSync::Role::Master : ClockSync::Role::Slave, masterIp, opt.port,
+                     IPAddress(127, 0, 0, static_cast<uint8_t>(1 + i)));
+  }
+
+  const uint64_t periodUs = static_cast<uint64_t>(1e6 / opt.fps);
+  const uint64_t warmupUs = static_cast<uint64_t>(opt.warmupS * 1e6);
+  const uint64_t endUs = warmupUs + static_cast<uint64_t>(opt.durationS * 1e6);
+  // Per frame: when each node received it and when it went out.
+  std::vector<std::vector<uint64_t>> arrived;
+  std::vector<std::vector<uint64_t>> shown;
+
+  const Clock::time_point start = Clock::now();
+  uint64_t nextFrameUs = warmupUs / 2;  // let the slaves sync first
+  uint64_t ticks = 0;
+  for (uint64_t now = trueMicros(start); now < endUs; now = trueMicros(start), ++ticks) {
+    if (now >= nextFrameUs) {
+      const uint32_t frame = static_cast<uint32_t>(arrived.size());
+      arrived.emplace_back(nodes.size(), 0);
+      shown.emplace_back(nodes.size(), 0);
+      for (Node& node : nodes) {
+        const uint64_t at = now + static_cast<uint64_t>(unit(rng) * opt.jitterUs);
+        node.arrivals.emplace_back(frame, &node == &nodes[0] ? now : at);
+      }
+      nextFrameUs += periodUs;
+    }
+
+    for (Node& node : nodes) {
+      if (now < node.busyUntilUs) continue;
+      if (opt.stallUs && unit(rng) < 0.002) {
+        node.busyUntilUs = now + static_cast<uint64_t>(unit(rng) * opt.stallUs);
+        continue;
+      }
+      const uint32_t local = localMicros(node, now);
+      node.sync->service(local);
+      while (!node.arrivals.empty() && node.arrivals.front().second <= now) {
+        // A newer frame replaces one still waiting, as RenderStage does.
+        node.heldFrame = node.arrivals.front().first;
+        arrived[node.heldFrame][&node - &nodes[0]] = now;
+        node.arrivals.erase(node.arrivals.begin());
+        node.sync->frameLatched(local);
+      }
+      if (node.heldFrame >= 0 && node.sync->presentDue(local)) {
+        shown[node.heldFrame][&node - &nodes[0]] = now;
+        node.heldFrame = -1;
+        node.sync->presented(local);
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(20));
+  }
+
+  std::vector<uint64_t> receiveSkew;
+  std::vector<uint64_t> presentSkew;
+  uint32_t incomplete = 0;
+  for (size_t f = 0; f < shown.size(); ++f) {
+    if (arrived[f][0] < warmupUs) continue;
+    const auto rx = std::minmax_element(arrived[f].begin(), arrived[f].end());
+    const auto tx = std::minmax_element(shown[f].begin(), shown[f].end());
+    if (*rx.first == 0 || *tx.first == 0) {
+      incomplete++;
+      continue;
+    }
+    receiveSkew.push_back(*rx.second - *rx.first);
+    presentSkew.push_back(*tx.second - *tx.first);
+  }
+
+  const uint64_t now = trueMicros(start);
+  const Node& master = nodes[0];
+  std::printf("nodes              %zu (1 master + %u slaves), %.0f fps, delay %u ms\n", nodes.size(), opt.nodes,
+              opt.fps, opt.delayMs);
+  std::printf("loop tick          %.0f us avg\n", static_cast<double>(now) / static_cast<double>(ticks));
+  std::printf("frames measured    %zu (%u coalesced or unfinished)\n", presentSkew.size(), incomplete);
+  std::printf("skew on receive    p50 %6" PRIu64 "  p99 %6" PRIu64 "  max %6" PRIu64 " us\n",
+              percentile(receiveSkew, 0.5), percentile(receiveSkew, 0.99), percentile(receiveSkew, 1.0));
+  std::printf("skew on present    p50 %6" PRIu64 "  p99 %6" PRIu64 "  max %6" PRIu64 " us\n",
+              percentile(presentSkew, 0.5), percentile(presentSkew, 0.99), percentile(presentSkew, 1.0));
+  std::printf("master estimate    %u us worst slave skew, %u slaves seen\n", master.sync->maxPeerSkewUs(),
+              master.sync->peerCount());
+  std::printf("\n node  offset err  path delay  est. skew  targeted  presented  late\n");
+  for (size_t i = 1; i < nodes.size(); ++i) {
+    const ClockSync& sync = *nodes[i].sync;
+    // Where this node thinks the master clock is, against where it is.
+    const int32_t offsetError = static_cast<int32_t>(sync.toMaster(localMicros(nodes[i], now)) - localMicros(master, now));
+    std::printf(" %4zu  %7" PRId32 " us  %7u us  %6u us  %8u  %9u  %4u\n", i, offsetError, sync.pathDelayUs(),
+                sync.skewUs(), sync.targetedFrames(), sync.presentedFrames(), sync.lateFrames());
+  }
+
+  const uint64_t p99 = percentile(presentSkew, 0.99);
+  if (presentSkew.empty() || p99 > opt.maxSkewUs) {
+    std::printf("\nFAIL: p99 skew %" PRIu64 " us above %u us\n", p99, opt.maxSkewUs);
+    return 3;
+  }
+  std::printf("\nok\n");
+  return 0;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+// Minimal Arduino surface so the Art-Net receive path (ArtNetNode, FrameIngest)
+// can be compiled and exercised on a development host.  Only what the
+// firmware modules actually use is provided.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using std::max;
+using std::min;
+
+#define F(text) (text)
+#define PROGMEM
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+class String {
+public:
+  String() = default;
+  String(const char* text) : m_value(text ? text : "") {}
+  String(const std::string& text) : m_value(text) {}
+  explicit String(char c) : m_value(1, c) {}
+  explicit String(int value) : m_value(std::to_string(value)) {}
+  explicit String(unsigned int value) : m_value(std::to_string(value)) {}
+  explicit String(long value) : m_value(std::to_string(value)) {}
+  explicit String(unsigned long value) : m_value(std::to_string(value)) {}
+
+  size_t length() const { return m_value.size(); }
+  const char* c_str() const { return m_value.c_str(); }
+  void reserve(size_t size) { m_value.reserve(size); }
+  void clear() { m_value.clear(); }
+  char operator[](size_t index) const { return index < m_value.size() ? m_value[index] : '\0'; }
+
+  String substring(size_t from, size_t to = std::string::npos) const
+  {
+    if (from >= m_value.size()) return String();
+    return String(m_value.substr(from, to == std::string::npos ? std::string::npos : to - from));
+  }
+
+  void trim()
+  {
+    const char* ws = " \t\r\n";
+    const size_t first = m_value.find_first_not_of(ws);
+    if (first == std::string::npos) {
+      m_value.clear();
+      return;
+    }
+    m_value = m_value.substr(first, m_value.find_last_not_of(ws) - first + 1);
+  }
+
+  long toInt() const { return std::strtol(m_value.c_str(), nullptr, 10); }
+
+  String& operator+=(const String& other) { m_value += other.m_value; return *this; }
+  String& operator+=(const char* other) { m_value += other ? other : ""; return *this; }
+  String& operator+=(char c) { m_value += c; return *this; }
+
+  friend String operator+(String lhs, const String& rhs) { lhs += rhs; return lhs; }
+  friend String operator+(String lhs, const char* rhs) { lhs += rhs; return lhs; }
+  friend bool operator==(const String& lhs, const String& rhs) { return lhs.m_value == rhs.m_value; }
+  friend bool operator!=(const String& lhs, const String& rhs) { return lhs.m_value != rhs.m_value; }
+
+private:
+  std::string m_value;
+};
+
+class IPAddress {
+public:
+  IPAddress() : m_address(0) {}
+  IPAddress(uint32_t address) : m_address(address) {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+  {
+    m_bytes[0] = a;
+    m_bytes[1] = b;
+    m_bytes[2] = c;
+    m_bytes[3] = d;
+  }
+
+  operator uint32_t() const { return m_address; }
+  uint8_t operator[](int index) const { return m_bytes[index]; }
+  uint8_t& operator[](int index) { return m_bytes[index]; }
+  bool operator==(const IPAddress& other) const { return m_address == other.m_address; }
+  bool operator!=(const IPAddress& other) const { return m_address != other.m_address; }
+
+  bool fromString(const String& text)
+  {
+    unsigned a, b, c, d;
+    char tail;
+    if (std::sscanf(text.c_str(), "%u.%u.%u.%u%c", &a, &b, &c, &d, &tail) != 4) return false;
+    if (a > 255 || b > 255 || c > 255 || d > 255) return false;
+    *this = IPAddress(a, b, c, d);
+    return true;
+  }
+
+  String toString() const
+  {
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "%u.%u.%u.%u", m_bytes[0], m_bytes[1], m_bytes[2], m_bytes[3]);
+    return String(buf);
+  }
+
+private:
+  union {
+    uint8_t m_bytes[4];
+    uint32_t m_address;
+  };
+};
+
+class HostSerial {
+public:
+  void begin(unsigned long) {}
+  void print(const String& text) { std::fputs(text.c_str(), stdout); }
+  void print(const char* text) { std::fputs(text, stdout); }
+  void print(char c) { std::fputc(c, stdout); }
+  void println() { std::fputc('\n', stdout); }
+  void println(const String& text) { print(text); println(); }
+  void println(const char* text) { print(text); println(); }
+  void println(const IPAddress& ip) { println(ip.toString()); }
+  template <typename... Args>
+  void printf(const char* format, Args... args) { std::printf(format, args...); }
+};
+
+extern HostSerial Serial;
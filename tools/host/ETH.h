@@ -0,0 +1,16 @@
+#pragma once
+
+#include <Arduino.h>
+
+class ETHClass {
+public:
+  IPAddress localIP() const { return m_localIp; }
+  IPAddress subnetMask() const { return m_subnetMask; }
+  void setLocalIp(IPAddress ip, IPAddress mask = IPAddress()) { m_localIp = ip; m_subnetMask = mask; }
+
+private:
+  IPAddress m_localIp;
+  IPAddress m_subnetMask;
+};
+
+extern ETHClass ETH;
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Host stand-in for the FastLED pixel type.  Layout matches FastLED's CRGB
+// (three packed bytes) so frame buffers can be shared with the firmware code.
+struct CRGB {
+  uint8_t r = 0;
+  uint8_t g = 0;
+  uint8_t b = 0;
+
+  CRGB() = default;
+  CRGB(uint8_t red, uint8_t green, uint8_t blue) : r(red), g(green), b(blue) {}
+
+  void setRGB(uint8_t red, uint8_t green, uint8_t blue)
+  {
+    r = red;
+    g = green;
+    b = blue;
+  }
+};
+
+static_assert(sizeof(CRGB) == 3, "CRGB must stay a packed RGB triplet");
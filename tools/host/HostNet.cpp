@@ -0,0 +1,291 @@
+#include "HostNet.h"
+
+#include <ETH.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <esp_system.h>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <random>
+#include <thread>
+
+HostSerial Serial;
+WiFiClass WiFi;
+ETHClass ETH;
+
+namespace {
+
+struct InjectedPacket {
+  std::vector<uint8_t> data;
+  IPAddress remoteIp;
+  uint16_t remotePort;
+  IPAddress localIp;
+};
+
+HostNet::Mode g_mode = HostNet::Mode::Injected;
+std::deque<InjectedPacket> g_injected;
+HostNet::TransmitHook g_transmitHook = nullptr;
+std::vector<int> g_sockets;
+bool g_manualClock = false;
+uint64_t g_clockUs = 0;
+std::minstd_rand g_random(1);
+uint64_t g_bytesRead = 0;
+
+uint64_t monotonicMicros()
+{
+  using namespace std::chrono;
+  if (g_manualClock) return g_clockUs;
+  return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+sockaddr_in toSockaddr(IPAddress ip, uint16_t port)
+{
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = static_cast<uint32_t>(ip);
+  return addr;
+}
+
+}  // namespace
+
+uint32_t millis()
+{
+  return static_cast<uint32_t>(monotonicMicros() / 1000);
+}
+
+uint32_t micros()
+{
+  return static_cast<uint32_t>(monotonicMicros());
+}
+
+void delay(uint32_t ms)
+{
+  if (g_manualClock) {
+    g_clockUs += static_cast<uint64_t>(ms) * 1000;
+    return;
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us)
+{
+  if (g_manualClock) {
+    g_clockUs += us;
+    return;
+  }
+  std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+esp_err_t esp_read_mac(uint8_t* mac, esp_mac_type_t type)
+{
+  static const uint8_t kBase[6] = {0x02, 0x00, 0x5E, 0x10, 0x00, 0x00};
+  memcpy(mac, kBase, sizeof(kBase));
+  mac[5] = static_cast<uint8_t>(type);
+  return ESP_OK;
+}
+
+uint32_t esp_random()
+{
+  return static_cast<uint32_t>(g_random());
+}
+
+namespace HostNet {
+
+void setMode(Mode mode) { g_mode = mode; }
+
+void useManualClock(uint64_t startUs)
+{
+  g_manualClock = true;
+  g_clockUs = startUs;
+}
+
+void advanceClock(uint32_t us) { g_clockUs += us; }
+void seedRandom(uint32_t seed) { g_random.seed(seed); }
+Mode mode() { return g_mode; }
+
+void setEthernetIp(IPAddress ip, IPAddress mask) { ETH.setLocalIp(ip, mask); }
+void setWifiStationIp(IPAddress ip, IPAddress mask)
+{
+  WiFi.setStationIp(ip, mask);
+  WiFi.setMode(static_cast<wifi_mode_t>(WiFi.getMode() | WIFI_STA));
+}
+void setSoftApIp(IPAddress ip)
+{
+  WiFi.setSoftApIp(ip);
+  WiFi.setMode(static_cast<wifi_mode_t>(WiFi.getMode() | WIFI_AP));
+}
+
+void inject(const uint8_t* data, size_t length, IPAddress remoteIp, uint16_t remotePort, IPAddress localIp)
+{
+  g_injected.push_back(InjectedPacket{std::vector<uint8_t>(data, data + length), remoteIp, remotePort, localIp});
+}
+
+size_t pending() { return g_injected.size(); }
+uint64_t bytesRead() { return g_bytesRead; }
+void clear() { g_injected.clear(); }
+
+void setTransmitHook(TransmitHook hook) { g_transmitHook = hook; }
+
+bool waitForPacket(uint32_t timeoutUs)
+{
+  if (g_mode == Mode::Injected) {
+    return !g_injected.empty();
+  }
+  std::vector<pollfd> fds;
+  for (int fd : g_sockets) {
+    fds.push_back(pollfd{fd, POLLIN, 0});
+  }
+  if (fds.empty()) {
+    delayMicroseconds(timeoutUs);
+    return false;
+  }
+  const int timeoutMs = static_cast<int>((timeoutUs + 999) / 1000);
+  return ::poll(fds.data(), fds.size(), timeoutMs) > 0;
+}
+
+}  // namespace HostNet
+
+uint8_t WiFiUDP::begin(uint16_t port)
+{
+  return begin(IPAddress((uint32_t)0), port);
+}
+
+uint8_t WiFiUDP::begin(IPAddress address, uint16_t port)
+{
+  stop();
+  m_port = port;
+  m_bindAddress = address;
+  if (HostNet::mode() != HostNet::Mode::Socket) {
+    return 1;
+  }
+
+  m_fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+  if (m_fd < 0) {
+    return 0;
+  }
+  int yes = 1;
+  setsockopt(m_fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+  setsockopt(m_fd, SOL_SOCKET, SO_BROADCAST, &yes, sizeof(yes));
+  int rcvbuf = 4 * 1024 * 1024;
+  setsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+  fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL, 0) | O_NONBLOCK);
+
+  sockaddr_in addr = toSockaddr(address, port);
+  if (::bind(m_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+    ::close(m_fd);
+    m_fd = -1;
+    return 0;
+  }
+  g_sockets.push_back(m_fd);
+  return 1;
+}
+
+void WiFiUDP::stop()
+{
+  if (m_fd >= 0) {
+    g_sockets.erase(std::remove(g_sockets.begin(), g_sockets.end(), m_fd), g_sockets.end());
+    ::close(m_fd);
+    m_fd = -1;
+  }
+  m_rxLength = 0;
+  m_rxPos = 0;
+}
+
+int WiFiUDP::parsePacket()
+{
+  m_rxLength = 0;
+  m_rxPos = 0;
+
+  if (HostNet::mode() == HostNet::Mode::Injected) {
+    auto packet = std::find_if(g_injected.begin(), g_injected.end(), [&](const InjectedPacket& candidate) {
+      const uint32_t local = static_cast<uint32_t>(candidate.localIp);
+      return local == 0 || static_cast<uint32_t>(m_bindAddress) == 0 || local == static_cast<uint32_t>(m_bindAddress);
+    });
+    if (packet == g_injected.end()) {
+      return 0;
+    }
+    m_rx.swap(packet->data);
+    m_rxLength = m_rx.size();
+    m_remoteIp = packet->remoteIp;
+    m_remotePort = packet->remotePort;
+    g_injected.erase(packet);
+    return static_cast<int>(m_rx.size());
+  }
+
+  if (m_fd < 0) {
+    return 0;
+  }
+  if (m_rx.size() < 65536) {
+    m_rx.resize(65536);
+  }
+  sockaddr_in from{};
+  socklen_t fromLen = sizeof(from);
+  ssize_t received = ::recvfrom(m_fd, m_rx.data(), m_rx.size(), 0, reinterpret_cast<sockaddr*>(&from), &fromLen);
+  if (received <= 0) {
+    return 0;
+  }
+  m_rxLength = static_cast<size_t>(received);
+  m_remoteIp = IPAddress(static_cast<uint32_t>(from.sin_addr.s_addr));
+  m_remotePort = ntohs(from.sin_port);
+  return static_cast<int>(received);
+}
+
+int WiFiUDP::read()
+{
+  if (m_rxPos >= m_rxLength) {
+    return -1;
+  }
+  return m_rx[m_rxPos++];
+}
+
+int WiFiUDP::read(uint8_t* buffer, size_t length)
+{
+  const size_t count = std::min(length, m_rxLength - m_rxPos);
+  memcpy(buffer, m_rx.data() + m_rxPos, count);
+  m_rxPos += count;
+  g_bytesRead += count;
+  return static_cast<int>(count);
+}
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port)
+{
+  m_tx.clear();
+  m_txIp = ip;
+  m_txPort = port;
+  return 1;
+}
+
+size_t WiFiUDP::write(uint8_t value)
+{
+  m_tx.push_back(value);
+  return 1;
+}
+
+size_t WiFiUDP::write(const uint8_t* buffer, size_t size)
+{
+  m_tx.insert(m_tx.end(), buffer, buffer + size);
+  return size;
+}
+
+int WiFiUDP::endPacket()
+{
+  if (HostNet::mode() == HostNet::Mode::Socket && m_fd >= 0) {
+    sockaddr_in addr = toSockaddr(m_txIp, m_txPort);
+    ::sendto(m_fd, m_tx.data(), m_tx.size(), 0, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+  }
+  if (g_transmitHook) {
+    g_transmitHook(m_tx.data(), m_tx.size(), m_txIp, m_txPort);
+  }
+  m_tx.clear();
+  return 1;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Controls the simulated network seen by the host build of the firmware
+// modules: which addresses ETH/WiFi report and where WiFiUDP traffic goes.
+namespace HostNet {
+
+enum class Mode : uint8_t {
+  Injected = 0,  // datagrams come from inject(), replies go to the transmit hook
+  Socket,        // WiFiUDP is backed by a real UDP socket
+};
+
+using TransmitHook = void (*)(const uint8_t* data, size_t length, IPAddress remoteIp, uint16_t remotePort);
+
+void setMode(Mode mode);
+Mode mode();
+
+// A mask of 0.0.0.0 (the default) puts every sender on that interface's network.
+void setEthernetIp(IPAddress ip, IPAddress mask = IPAddress());
+void setWifiStationIp(IPAddress ip, IPAddress mask = IPAddress());
+void setSoftApIp(IPAddress ip);
+
+// localIp picks the socket bound to that address, as if the datagram had come
+// in on its interface; 0.0.0.0 goes to whichever socket reads first.
+void inject(const uint8_t* data, size_t length, IPAddress remoteIp, uint16_t remotePort = 6454,
+            IPAddress localIp = IPAddress());
+size_t pending();
+void clear();
+// Bytes every WiFiUDP has copied out of received datagrams so far.
+uint64_t bytesRead();
+
+// Blocks until a datagram is ready for any open WiFiUDP (or the timeout
+// expires).  Lets host tools idle without spinning on ArtNetNode::read().
+bool waitForPacket(uint32_t timeoutUs);
+
+void setTransmitHook(TransmitHook hook);
+
+// A manual clock holds millis()/micros() (and makes delay() advance them)
+// until advanceClock() moves it, so a simulation runs faster than real time
+// and repeats exactly.
+void useManualClock(uint64_t startUs = 0);
+void advanceClock(uint32_t us);
+// esp_random() is a seeded generator here.
+void seedRandom(uint32_t seed);
+
+}  // namespace HostNet
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <Arduino.h>
+
+typedef enum {
+  WIFI_OFF = 0,
+  WIFI_STA = 1,
+  WIFI_AP = 2,
+  WIFI_AP_STA = 3,
+} wifi_mode_t;
+
+class WiFiClass {
+public:
+  wifi_mode_t getMode() const { return m_mode; }
+  IPAddress localIP() const { return m_stationIp; }
+  IPAddress subnetMask() const { return m_stationMask; }
+  IPAddress softAPIP() const { return m_softApIp; }
+
+  void setMode(wifi_mode_t mode) { m_mode = mode; }
+  void setStationIp(IPAddress ip, IPAddress mask = IPAddress()) { m_stationIp = ip; m_stationMask = mask; }
+  void setSoftApIp(IPAddress ip) { m_softApIp = ip; }
+
+private:
+  wifi_mode_t m_mode = WIFI_OFF;
+  IPAddress m_stationIp;
+  IPAddress m_stationMask;
+  IPAddress m_softApIp;
+};
+
+extern WiFiClass WiFi;
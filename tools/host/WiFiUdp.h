@@ -0,0 +1,44 @@
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+
+// Host implementation of the ESP32 WiFiUDP API.  Depending on HostNet::mode()
+// datagrams come from packets queued with HostNet::inject() or from a real
+// UDP socket, so the same ArtNetNode code can be fed from a capture file or
+// from the loopback interface.
+class WiFiUDP {
+public:
+  ~WiFiUDP() { stop(); }
+
+  uint8_t begin(uint16_t port);
+  uint8_t begin(IPAddress address, uint16_t port);
+  void stop();
+
+  int parsePacket();
+  int available() const { return static_cast<int>(m_rxLength - m_rxPos); }
+  int read();
+  int read(uint8_t* buffer, size_t length);
+  int peek() const { return available() > 0 ? m_rx[m_rxPos] : -1; }
+  void flush() { m_rxPos = m_rxLength; }
+  IPAddress remoteIP() const { return m_remoteIp; }
+  uint16_t remotePort() const { return m_remotePort; }
+
+  int beginPacket(IPAddress ip, uint16_t port);
+  size_t write(uint8_t value);
+  size_t write(const uint8_t* buffer, size_t size);
+  int endPacket();
+
+private:
+  int m_fd = -1;
+  uint16_t m_port = 0;
+  IPAddress m_bindAddress;
+  std::vector<uint8_t> m_rx;
+  size_t m_rxLength = 0;
+  size_t m_rxPos = 0;
+  IPAddress m_remoteIp;
+  uint16_t m_remotePort = 0;
+  std::vector<uint8_t> m_tx;
+  IPAddress m_txIp;
+  uint16_t m_txPort = 0;
+};
@@ -0,0 +1,358 @@
+// Host-native build of the node's receive path: ArtNetNode + FrameIngest on a
+// real UDP socket, with the same /metrics JSON as the firmware served over a
+// minimal HTTP listener.  Frames stamped by artnet_loadgen additionally report
+// generator-to-latch latency and lost frame ids.  "GET /metrics?reset=1&universes=N"
+// clears the counters and remaps the node to N universes.  ArtAddress renames
+// and re-patches it like the firmware (nothing is persisted); ArtIpProg only
+// reports the loopback address.  With --wifi-ip (another loopback address,
+// e.g. 127.0.0.2) the node also listens there as its Wi-Fi interface and
+// --wifi-universes N limits the last N universes to it, as /config does.
+// --standby keeps that address in hot standby behind Ethernet instead;
+// "GET /metrics?ethLink=0" (or 1) drops or restores the Ethernet link, and
+// the failover section reports the gap between the last ArtDmx on Ethernet
+// and the first on Wi-Fi.
+//
+//   pio run -e host_node
+//   .pio/build/host_node/program --leds 5440 --metrics-port 8080
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <HostNet.h>
+
+#include "ArtNetNode.h"
+#include "FrameIngest.h"
+#include "LatencyHistogram.h"
+#include "LoadStamp.h"
+#include "MemoryArena.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <csignal>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+  uint16_t port = 6454;
+  uint16_t metricsPort = 8080;
+  uint16_t numLeds = 170 * 32;
+  uint16_t startUniverse = 0;
+  uint16_t pixelsPerUniverse = 170;
+  IPAddress wifiIp;
+  uint16_t wifiUniverses = 0;
+  bool standby = false;
+};
+
+struct FailoverStats {
+  uint32_t count = 0;
+  uint32_t lastEthernetDmxUs = 0;
+  uint32_t lastGapUs = 0;
+  bool awaitingData = false;
+};
+
+struct StampStats {
+  uint32_t stampedFrames = 0;
+  uint32_t lostFrames = 0;
+  uint32_t lastFrameId = 0;
+  LatencyHistogram endToEndUs;
+};
+
+volatile std::sig_atomic_t g_stop = 0;
+ArtNetNode g_artnet;
+FrameIngest g_ingest;
+MemoryArena g_arena;
+std::vector<CRGB> g_pixels;
+StampStats g_stamps;
+uint32_t g_dmxPackets = 0;
+FailoverStats g_failover;
+
+void onFrameLatched()
+{
+  LoadStamp stamp;
+  if (g_pixels.size() * sizeof(CRGB) < LoadStamp::SIZE || !stamp.read(reinterpret_cast<const uint8_t*>(g_pixels.data()))) {
+    return;
+  }
+  const uint32_t now = micros();
+  if (g_stamps.stampedFrames && stamp.frameId > g_stamps.lastFrameId + 1) {
+    g_stamps.lostFrames += stamp.frameId - g_stamps.lastFrameId - 1;
+  }
+  g_stamps.lastFrameId = stamp.frameId;
+  g_stamps.stampedFrames++;
+  g_stamps.endToEndUs.record(now - stamp.sendUs);
+}
+
+void onDmxFrame(uint16_t universe, uint16_t length, uint8_t, uint8_t* data, IPAddress remoteIP)
+{
+  g_dmxPackets++;
+  if (g_artnet.packetInterface() == ArtNetNode::Interface::Ethernet) {
+    g_failover.lastEthernetDmxUs = micros();
+  } else if (g_failover.awaitingData) {
+    g_failover.awaitingData = false;
+    g_failover.lastGapUs = micros() - g_failover.lastEthernetDmxUs;
+  }
+  if (g_ingest.ingest(universe, length, data, static_cast<uint32_t>(remoteIP))) {
+    onFrameLatched();
+  }
+}
+
+void onArtSync(IPAddress)
+{
+  if (g_ingest.sync()) {
+    onFrameLatched();
+  }
+}
+
+// The arena holds the ingest tables and a merge slot per universe.
+void configureIngest(uint16_t leds, uint16_t startUniverse, uint16_t pixelsPerUniverse)
+{
+  FrameIngest::Range range;
+  range.startUniverse = startUniverse;
+  range.pixelCount = leds;
+  const uint16_t universes = FrameIngest::universesFor(&range, 1, pixelsPerUniverse);
+  g_arena.begin(FrameIngest::tableBytes(universes) + FrameIngest::mergePoolBytes(universes));
+  g_ingest.configure(leds, startUniverse, pixelsPerUniverse, g_arena, universes);
+}
+
+// Lets artnet_loadgen resize the mapping between sweep steps.
+void resizeUniverses(uint16_t universes)
+{
+  const uint32_t leds = std::min<uint32_t>(65535, static_cast<uint32_t>(universes) * g_ingest.pixelsPerUniverse());
+  g_pixels.assign(leds, CRGB());
+  configureIngest(static_cast<uint16_t>(leds), g_ingest.startUniverse(), g_ingest.pixelsPerUniverse());
+  g_ingest.setTarget(g_pixels.data());
+  g_artnet.setUniverseInfo(g_ingest.startUniverse(), g_ingest.universeCount());
+}
+
+void onArtAddress(const ArtNetNode::AddressProgram& program, IPAddress)
+{
+  using Program = ArtNetNode::AddressProgram;
+  g_artnet.setNodeNames(program.shortName, program.longName);
+
+  uint16_t start = g_ingest.startUniverse();
+  auto program15 = [&](int16_t value, uint8_t shift, uint16_t mask) {
+    if (value == Program::UNCHANGED) return;
+    const uint16_t bits = value == Program::RESET ? 0 : static_cast<uint16_t>(value);
+    start = static_cast<uint16_t>((start & ~(mask << shift)) | (bits << shift));
+  };
+  program15(program.net, 8, 0x7F);
+  program15(program.subNet, 4, 0x0F);
+  program15(program.swOut, 0, 0x0F);
+  if (start != g_ingest.startUniverse()) {
+    configureIngest(static_cast<uint16_t>(g_pixels.size()), start, g_ingest.pixelsPerUniverse());
+    g_artnet.setUniverseInfo(start, g_ingest.universeCount());
+  }
+
+  switch (program.command) {
+    case ArtNetNode::AddressCommand::CancelMerge: g_ingest.cancelMerge(); break;
+    case ArtNetNode::AddressCommand::MergeLtp:
+    case ArtNetNode::AddressCommand::MergeHtp: {
+      const bool ltp = program.command == ArtNetNode::AddressCommand::MergeLtp;
+      g_ingest.setMergeMode(ltp ? FrameIngest::MergeMode::Ltp : FrameIngest::MergeMode::Htp);
+      g_artnet.setMergeLtp(ltp);
+      break;
+    }
+    default: break;
+  }
+}
+
+void onArtIpProg(const ArtNetNode::IpProgram&, IPAddress, ArtNetNode::IpSettings& settings)
+{
+  settings.ip = IPAddress(127, 0, 0, 1);
+  settings.mask = IPAddress(255, 0, 0, 0);
+}
+
+void appendHistogram(std::string& json, const LatencyHistogram& histogram)
+{
+  json += "{\"count\":" + std::to_string(histogram.count());
+  json += ",\"p50\":" + std::to_string(histogram.percentile(50));
+  json += ",\"p90\":" + std::to_string(histogram.percentile(90));
+  json += ",\"p99\":" + std::to_string(histogram.percentile(99));
+  json += ",\"max\":" + std::to_string(histogram.max()) + "}";
+}
+
+std::string buildMetricsJson()
+{
+  const FrameIngest::Stats& ingest = g_ingest.stats();
+  std::string json;
+  json += "{\"uptimeMs\":" + std::to_string(millis());
+  json += ",\"dmxPackets\":" + std::to_string(g_dmxPackets);
+  json += ",\"artnet\":{\"ethernetPackets\":" + std::to_string(g_artnet.interfacePackets(ArtNetNode::Interface::Ethernet));
+  json += ",\"wifiPackets\":" + std::to_string(g_artnet.interfacePackets(ArtNetNode::Interface::WiFiStation));
+  json += ",\"filteredPackets\":" + std::to_string(g_artnet.filteredPackets());
+  json += ",\"unownedPackets\":" + std::to_string(g_artnet.unownedPackets());
+  json += ",\"announcements\":" + std::to_string(g_artnet.announcements());
+  json += ",\"polls\":{\"received\":" + std::to_string(g_artnet.pollStats().polls);
+  json += ",\"replies\":" + std::to_string(g_artnet.pollStats().replies);
+  json += ",\"untargeted\":" + std::to_string(g_artnet.pollStats().untargeted);
+  json += ",\"changeReplies\":" + std::to_string(g_artnet.pollStats().changeReplies) + "}";
+  json += ",\"failover\":{\"count\":" + std::to_string(g_failover.count);
+  json += ",\"lastGapUs\":" + std::to_string(g_failover.lastGapUs) + "}}";
+  json += ",\"ingest\":{\"packets\":" + std::to_string(ingest.packets);
+  json += ",\"framesLatched\":" + std::to_string(ingest.framesLatched);
+  json += ",\"syncPackets\":" + std::to_string(ingest.syncPackets);
+  json += ",\"syncLatched\":" + std::to_string(ingest.syncLatched);
+  json += ",\"mergedPackets\":" + std::to_string(ingest.mergedPackets);
+  json += ",\"ignoredSourcePackets\":" + std::to_string(ingest.ignoredSourcePackets);
+  json += ",\"exclusiveSource\":\"" + std::string(IPAddress(g_ingest.exclusiveSource()).toString().c_str()) + "\"";
+  json += std::string(",\"syncMode\":") + (g_ingest.syncMode() ? "true" : "false");
+  json += ",\"latchLatencyUs\":";
+  appendHistogram(json, ingest.latchLatencyUs);
+  json += "},\"loadgen\":{\"stampedFrames\":" + std::to_string(g_stamps.stampedFrames);
+  json += ",\"lostFrames\":" + std::to_string(g_stamps.lostFrames);
+  json += ",\"endToEndUs\":";
+  appendHistogram(json, g_stamps.endToEndUs);
+  json += "}}";
+  return json;
+}
+
+int openMetricsListener(uint16_t port)
+{
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+  int yes = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd, 4) != 0) {
+    ::close(fd);
+    return -1;
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  return fd;
+}
+
+void serviceMetrics(int listenFd)
+{
+  if (listenFd < 0) return;
+  int client = ::accept(listenFd, nullptr, nullptr);
+  if (client < 0) return;
+
+  timeval timeout{0, 200000};
+  setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  char request[1024];
+  const ssize_t length = ::recv(client, request, sizeof(request) - 1, 0);
+  request[length > 0 ? length : 0] = '\0';
+  const std::string line(request, strcspn(request, "\r\n"));
+
+  std::string status = "200 OK";
+  std::string body;
+  if (line.rfind("GET /metrics", 0) == 0) {
+    const size_t universesArg = line.find("universes=");
+    if (universesArg != std::string::npos) {
+      resizeUniverses(static_cast<uint16_t>(std::max(1, std::atoi(line.c_str() + universesArg + 10))));
+    }
+    const size_t linkArg = line.find("ethLink=");
+    if (linkArg != std::string::npos) {
+      const bool up = line[linkArg + 8] != '0';
+      g_artnet.setLinkUp(ArtNetNode::Interface::Ethernet, up);
+      if (!up && g_artnet.listening(ArtNetNode::Interface::WiFiStation)) {
+        g_failover.count++;
+        g_failover.awaitingData = g_failover.lastEthernetDmxUs != 0;
+      }
+    }
+    if (line.find("reset") != std::string::npos) {
+      g_ingest.resetStats();
+      g_stamps = StampStats();
+      g_dmxPackets = 0;
+    }
+    body = buildMetricsJson();
+  } else {
+    status = "404 Not Found";
+    body = "{}";
+  }
+
+  const std::string response = "HTTP/1.0 " + status + "\r\nContent-Type: application/json\r\nCache-Control: no-store\r\n"
+                               "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+  ::send(client, response.data(), response.size(), MSG_NOSIGNAL);
+  ::close(client);
+}
+
+bool parseOptions(int argc, char** argv, Options& opt)
+{
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    auto value = [&]() { return (i + 1 < argc) ? std::atol(argv[++i]) : 0L; };
+    if (arg == "--port") opt.port = static_cast<uint16_t>(value());
+    else if (arg == "--metrics-port") opt.metricsPort = static_cast<uint16_t>(value());
+    else if (arg == "--leds") opt.numLeds = static_cast<uint16_t>(std::max(1L, std::min(value(), 65535L)));
+    else if (arg == "--start-universe") opt.startUniverse = static_cast<uint16_t>(value());
+    else if (arg == "--pixels-per-universe") opt.pixelsPerUniverse = static_cast<uint16_t>(std::max(1L, value()));
+    else if (arg == "--wifi-ip" && i + 1 < argc) { if (!opt.wifiIp.fromString(argv[++i])) return false; }
+    else if (arg == "--wifi-universes") opt.wifiUniverses = static_cast<uint16_t>(value());
+    else if (arg == "--standby") opt.standby = true;
+    else return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  Options opt;
+  if (!parseOptions(argc, argv, opt)) {
+    std::fprintf(stderr,
+                 "usage: host_node [--port 6454] [--metrics-port 8080] [--leds N]\n"
+                 "                 [--start-universe N] [--pixels-per-universe 170]\n"
+                 "                 [--wifi-ip 127.0.0.2 [--wifi-universes N | --standby]]\n");
+    return 2;
+  }
+
+  std::signal(SIGINT, [](int) { g_stop = 1; });
+  std::signal(SIGTERM, [](int) { g_stop = 1; });
+
+  g_pixels.assign(opt.numLeds, CRGB());
+  configureIngest(opt.numLeds, opt.startUniverse, opt.pixelsPerUniverse);
+  g_ingest.setTarget(g_pixels.data());
+
+  HostNet::setMode(HostNet::Mode::Socket);
+  HostNet::setEthernetIp(IPAddress(127, 0, 0, 1));
+
+  ArtNetNode& artnet = g_artnet;
+  artnet.setNodeNames("PixelEtherLED", "PixelEtherLED Host Node");
+  artnet.setUniverseInfo(opt.startUniverse, g_ingest.universeCount());
+  if (opt.wifiIp != IPAddress((uint32_t)0)) {
+    HostNet::setWifiStationIp(opt.wifiIp);
+    artnet.setInterfacePreference(opt.standby ? ArtNetNode::InterfacePreference::Ethernet
+                                              : ArtNetNode::InterfacePreference::Auto);
+    artnet.setStandby(opt.standby);
+    const uint16_t wifiUniverses = std::min(opt.wifiUniverses, g_ingest.universeCount());
+    ArtNetNode::SourceFilter filters[2];
+    filters[0].firstUniverse = opt.startUniverse;
+    filters[0].universeCount = g_ingest.universeCount() - wifiUniverses;
+    filters[0].interfaces = wifiUniverses ? ArtNetNode::ETHERNET_ONLY : ArtNetNode::ANY_INTERFACE;
+    filters[1].firstUniverse = opt.startUniverse + filters[0].universeCount;
+    filters[1].universeCount = wifiUniverses;
+    filters[1].interfaces = ArtNetNode::WIFI_ONLY;
+    artnet.setSourceFilters(filters, 2);
+  }
+  artnet.begin(opt.port);
+  artnet.setUniverseFilter(&g_ingest.portAddressMap());
+  artnet.setArtDmxCallback(onDmxFrame);
+  artnet.setArtSyncCallback(onArtSync);
+  artnet.setArtAddressCallback(onArtAddress);
+  artnet.setArtIpProgCallback(onArtIpProg);
+
+  const int metricsFd = openMetricsListener(opt.metricsPort);
+  std::printf("host_node: Art-Net on UDP %u, %u universes from %u, metrics on http://127.0.0.1:%u/metrics%s\n",
+              opt.port, g_ingest.universeCount(), opt.startUniverse, opt.metricsPort,
+              metricsFd < 0 ? " (listener failed)" : "");
+
+  while (!g_stop) {
+    // Delayed ArtPollReplies go out from read() even when nothing arrives.
+    HostNet::waitForPacket(2000);
+    artnet.read();
+    serviceMetrics(metricsFd);
+  }
+
+  std::printf("%s\n", buildMetricsJson().c_str());
+  if (metricsFd >= 0) ::close(metricsFd);
+  return 0;
+}
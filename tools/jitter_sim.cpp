@@ -0,0 +1,146 @@
+// Host check of the frame jitter buffer.  Feeds FrameJitterBuffer frames at a
+// steady rate with random arrival jitter, polls release() as loop() would,
+// and reports the target depth, the added latency and how evenly frames came
+// out, for a grid of input rates and latency budgets.  The grid includes
+// inputs slower than the whole budget (20 fps against 40 ms), where the
+// buffer must settle on a depth of one frame instead of waiting out the
+// budget on every frame.
+//
+//   pio run -e jitter_sim
+//   .pio/build/jitter_sim/program --jitter-us 5000
+//
+// Exit status is 3 when a case holds a deeper target than the budget allows,
+// adds more latency than the budget, or releases fewer frames than it got.
+
+#include <Arduino.h>
+
+#include "FrameJitterBuffer.h"
+#include "MemoryArena.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+
+namespace {
+
+constexpr uint16_t kLeds = 16;
+constexpr uint32_t kPollUs = 250;      // loop() pass
+const uint16_t kFps[] = {20, 30, 40, 60};
+const uint16_t kBudgetMs[] = {20, 40, 80, 150};
+
+struct Options {
+  uint32_t frames = 2000;
+  uint32_t jitterUs = 5000;
+  uint8_t capacity = FrameJitterBuffer::MAX_CAPACITY;
+  uint32_t seed = 1;
+};
+
+struct Result {
+  uint8_t targetDepth = 0;
+  uint32_t intervalUs = 0;
+  uint32_t latencyUs = 0;
+  uint32_t pushed = 0;
+  uint32_t released = 0;
+  uint32_t underruns = 0;
+  uint32_t overruns = 0;
+  uint32_t late = 0;
+};
+
+Result run(const Options& opt, uint16_t fps, uint16_t budgetMs)
+{
+  MemoryArena arena;
+  arena.begin(FrameJitterBuffer::bytesFor(kLeds, opt.capacity));
+  FrameJitterBuffer buffer;
+  buffer.configure(kLeds, budgetMs, arena, opt.capacity);
+
+  std::mt19937 random(opt.seed);
+  std::uniform_int_distribution<uint32_t> jitter(0, opt.jitterUs);
+  const uint32_t periodUs = 1000000 / fps;
+  Result result;
+  uint32_t nowUs = 0;
+  uint32_t nextArrivalUs = jitter(random);
+  uint8_t sequence = 0;
+  while (result.pushed < opt.frames) {
+    if (static_cast<int32_t>(nowUs - nextArrivalUs) >= 0) {
+      sequence = static_cast<uint8_t>(sequence == 255 ? 1 : sequence + 1);
+      buffer.push(sequence, nowUs);
+      result.pushed++;
+      nextArrivalUs = (result.pushed + 1) * periodUs + jitter(random);
+    }
+    if (buffer.release(nowUs)) result.released++;
+    nowUs += kPollUs;
+  }
+  // Let the queue drain.
+  const uint32_t endUs = nowUs + budgetMs * 1000u + periodUs;
+  for (; static_cast<int32_t>(nowUs - endUs) < 0; nowUs += kPollUs) {
+    if (buffer.release(nowUs)) result.released++;
+  }
+
+  result.targetDepth = buffer.targetDepth();
+  result.intervalUs = buffer.intervalUs();
+  result.latencyUs = buffer.latencyUs();
+  result.underruns = buffer.underruns();
+  result.overruns = buffer.overruns();
+  result.late = buffer.lateFrames();
+  return result;
+}
+
+void usage()
+{
+  std::fprintf(stderr,
+               "usage: jitter_sim [options]\n"
+               "  --frames N      frames per case (2000)\n"
+               "  --jitter-us N   random delay added to each arrival (5000)\n"
+               "  --capacity N    queued frames (16)\n"
+               "  --seed N        random seed (1)\n");
+}
+
+bool parseOptions(int argc, char** argv, Options& opt)
+{
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    auto value = [&]() { return (i + 1 < argc) ? std::atol(argv[++i]) : 0L; };
+    if (arg == "--frames") opt.frames = static_cast<uint32_t>(std::max(10L, value()));
+    else if (arg == "--jitter-us") opt.jitterUs = static_cast<uint32_t>(std::max(0L, std::min(value(), 100000L)));
+    else if (arg == "--capacity") {
+      opt.capacity = static_cast<uint8_t>(std::max<long>(FrameJitterBuffer::MIN_CAPACITY,
+                                                         std::min<long>(value(), FrameJitterBuffer::MAX_CAPACITY)));
+    } else if (arg == "--seed") opt.seed = static_cast<uint32_t>(value());
+    else return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  Options opt;
+  if (!parseOptions(argc, argv, opt)) {
+    usage();
+    return 2;
+  }
+
+  std::printf("jitter_sim: %lu frames per case, arrival jitter up to %lu us, capacity %u\n",
+              static_cast<unsigned long>(opt.frames), static_cast<unsigned long>(opt.jitterUs), opt.capacity);
+  std::printf("%5s %8s %10s %7s %11s %9s %10s %10s %6s\n", "fps", "budget", "interval", "target", "latency us",
+              "released", "underruns", "overruns", "");
+  uint32_t failures = 0;
+  for (uint16_t fps : kFps) {
+    for (uint16_t budgetMs : kBudgetMs) {
+      const Result r = run(opt, fps, budgetMs);
+      const uint32_t budgetUs = budgetMs * 1000u;
+      // Each queued frame waits one interval; one interval stays free.
+      const int32_t room = r.intervalUs ? static_cast<int32_t>(budgetUs / r.intervalUs) - 1 : 1;
+      const uint8_t allowed = static_cast<uint8_t>(std::max<int32_t>(1, room));
+      const bool ok = r.targetDepth <= allowed && r.latencyUs <= budgetUs &&
+                      r.released + r.overruns + r.late >= r.pushed;
+      if (!ok) failures++;
+      std::printf("%5u %6u ms %10lu %7u %11lu %9lu %10lu %10lu %6s\n", fps, budgetMs,
+                  static_cast<unsigned long>(r.intervalUs), r.targetDepth, static_cast<unsigned long>(r.latencyUs),
+                  static_cast<unsigned long>(r.released), static_cast<unsigned long>(r.underruns),
+                  static_cast<unsigned long>(r.overruns), ok ? "ok" : "FAIL");
+    }
+  }
+  return failures ? 3 : 0;
+}
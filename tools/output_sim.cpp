@@ -0,0 +1,370 @@
+// Host check of parallel LED outputs.  Feeds ArtDmx data for several outputs
+// (each with its own universe range) through FrameIngest, shows the frames
+// through LedOutputs into a recording backend, and checks what every output
+// would have put on its wire: pixel bytes in its color order at the given
+// brightness, and the transfer timing of a parallel refresh (all outputs
+// start together, the frame ends with the longest one).
+//
+// With --async the backend behaves like a DMA transfer: show() only starts
+// it and the pixels are read when it completes.  The tool scribbles over the
+// pixel buffer in between, as the next frame's ingest would, so the check
+// proves the frame was double-buffered.
+//
+//   pio run -e output_sim
+//   .pio/build/output_sim/program --leds 300,170,512,42 --universes 0,10,20,40
+//
+// Exit status is 3 when any check fails, so the tool doubles as a regression
+// check for the universe mapping and the output slicing.
+
+#include <Arduino.h>
+
+#include "FrameIngest.h"
+#include "LedOutputs.h"
+#include "MemoryArena.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr uint16_t kMaxLeds = 1024;
+
+// Source channel (0 = R, 1 = G, 2 = B) sent in each wire slot, per LedColorOrder.
+const uint8_t kWireOrder[][3] = {
+  {0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0},
+};
+
+struct Options {
+  std::vector<uint16_t> leds = {300, 170, 512, 42};
+  std::vector<uint16_t> universes = {0, 10, 20, 40};
+  uint16_t pixelsPerUniverse = 170;
+  uint32_t frames = 100;
+  uint8_t brightness = 200;
+  bool async = false;
+};
+
+uint32_t g_doneCalls = 0;
+
+void onDone(uint32_t startUs, uint32_t endUs)
+{
+  (void)startUs;
+  (void)endUs;
+  g_doneCalls++;
+}
+
+// Records what each output sends.  Time is virtual: every show() starts all
+// outputs at the current instant and advances it by the longest transfer.
+// An asynchronous one reads the pixels only in complete().
+class RecordingBackend : public LedOutputs::Backend {
+public:
+  explicit RecordingBackend(bool async) : m_async(async) {}
+
+  struct Channel {
+    LedOutputs::Output wiring;
+    const CRGB* pixels = nullptr;
+    uint16_t count = 0;
+    std::vector<uint8_t> wire;   // last frame as sent, in color order
+    uint64_t startUs = 0;
+    uint64_t endUs = 0;
+    uint32_t frames = 0;
+  };
+
+  bool attach(uint8_t index, const LedOutputs::Output& output, CRGB* pixels) override
+  {
+    if (index != m_channels.size()) return false;
+    Channel channel;
+    channel.wiring = output;
+    channel.pixels = pixels;
+    channel.count = output.ledCount;
+    m_channels.push_back(channel);
+    return true;
+  }
+
+  void resize(uint8_t index, CRGB* pixels, uint16_t count) override
+  {
+    m_channels[index].pixels = pixels;
+    m_channels[index].count = count;
+  }
+
+  void show(uint8_t brightness) override
+  {
+    m_brightness = brightness;
+    m_busy = true;
+    if (!m_async) complete();
+  }
+
+  bool asynchronous() const override { return m_async; }
+  bool busy() const override { return m_busy; }
+  uint32_t doneUs() const override { return m_doneUs; }
+
+  void complete()
+  {
+    if (!m_busy) return;
+    const uint8_t brightness = m_brightness;
+    uint64_t endUs = m_nowUs;
+    for (Channel& channel : m_channels) {
+      encode(channel, brightness);
+      LedOutputs::Output sent = channel.wiring;
+      sent.ledCount = channel.count;
+      channel.startUs = m_nowUs;
+      channel.endUs = m_nowUs + LedOutputs::wireTimeUs(sent);
+      channel.frames++;
+      endUs = std::max(endUs, channel.endUs);
+    }
+    m_lastFrameUs = endUs - m_nowUs;
+    m_nowUs = endUs;
+    m_doneUs = micros();
+    m_busy = false;
+  }
+
+  const std::vector<Channel>& channels() const { return m_channels; }
+  uint64_t lastFrameUs() const { return m_lastFrameUs; }
+
+private:
+  static void encode(Channel& channel, uint8_t brightness)
+  {
+    const uint8_t* order = kWireOrder[static_cast<uint8_t>(channel.wiring.colorOrder)];
+    channel.wire.resize(static_cast<size_t>(channel.count) * 3);
+    for (uint16_t i = 0; i < channel.count; ++i) {
+      const uint8_t rgb[3] = {channel.pixels[i].r, channel.pixels[i].g, channel.pixels[i].b};
+      for (uint8_t c = 0; c < 3; ++c) {
+        // FastLED's scale8.
+        channel.wire[i * 3 + c] = static_cast<uint8_t>((rgb[order[c]] * (1u + brightness)) >> 8);
+      }
+    }
+  }
+
+  std::vector<Channel> m_channels;
+  bool m_async = false;
+  bool m_busy = false;
+  uint8_t m_brightness = 255;
+  uint32_t m_doneUs = 0;
+  uint64_t m_nowUs = 0;
+  uint64_t m_lastFrameUs = 0;
+};
+
+// Deterministic test pattern, distinct per output, pixel and frame.
+CRGB pattern(uint8_t output, uint16_t pixel, uint32_t frame)
+{
+  return CRGB(static_cast<uint8_t>(pixel * 7 + frame),
+              static_cast<uint8_t>(output * 61 + pixel),
+              static_cast<uint8_t>(frame * 3 + output * 17 + (pixel >> 3)));
+}
+
+bool parseList(const char* text, std::vector<uint16_t>& out)
+{
+  out.clear();
+  std::string item;
+  for (const char* p = text;; ++p) {
+    if (*p == ',' || *p == '\0') {
+      if (item.empty()) return false;
+      out.push_back(static_cast<uint16_t>(std::atoi(item.c_str())));
+      item.clear();
+      if (*p == '\0') break;
+    } else {
+      item += *p;
+    }
+  }
+  return !out.empty();
+}
+
+void usage()
+{
+  std::fprintf(stderr,
+               "usage: output_sim [options]\n"
+               "  --leds A,B,...             LEDs per output (300,170,512,42)\n"
+               "  --universes A,B,...        first universe per output (0,10,20,40)\n"
+               "  --pixels-per-universe N    pixels per universe (170)\n"
+               "  --frames N                 frames to send (100)\n"
+               "  --brightness N             output brightness (200)\n"
+               "  --async                    DMA-like backend, transfer overlaps ingest\n");
+}
+
+bool parseOptions(int argc, char** argv, Options& opt)
+{
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    auto value = [&]() -> const char* { return (i + 1 < argc) ? argv[++i] : ""; };
+    if (arg == "--leds") {
+      if (!parseList(value(), opt.leds)) return false;
+    } else if (arg == "--universes") {
+      if (!parseList(value(), opt.universes)) return false;
+    } else if (arg == "--pixels-per-universe") {
+      opt.pixelsPerUniverse = static_cast<uint16_t>(std::max(1, std::min(170, std::atoi(value()))));
+    } else if (arg == "--frames") {
+      opt.frames = static_cast<uint32_t>(std::max(1L, std::atol(value())));
+    } else if (arg == "--brightness") {
+      opt.brightness = static_cast<uint8_t>(std::max(0, std::min(255, std::atoi(value()))));
+    } else if (arg == "--async") {
+      opt.async = true;
+    } else if (arg == "-h" || arg == "--help") {
+      return false;
+    } else {
+      std::fprintf(stderr, "unknown option: %s\n", arg.c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  Options opt;
+  if (!parseOptions(argc, argv, opt)) {
+    usage();
+    return 2;
+  }
+  if (opt.leds.size() > LedOutputs::MAX_OUTPUTS || opt.universes.size() != opt.leds.size()) {
+    std::fprintf(stderr, "output_sim: up to %u outputs, one first universe per output\n", LedOutputs::MAX_OUTPUTS);
+    return 2;
+  }
+
+  const uint8_t outputCount = static_cast<uint8_t>(opt.leds.size());
+  std::vector<CRGB> pixels(kMaxLeds);
+  LedOutputs::Output outputs[LedOutputs::MAX_OUTPUTS];
+  FrameIngest::Range ranges[LedOutputs::MAX_OUTPUTS];
+  uint16_t firstLed = 0;
+  for (uint8_t o = 0; o < outputCount; ++o) {
+    if (firstLed + opt.leds[o] > kMaxLeds) {
+      std::fprintf(stderr, "output_sim: more than %u LEDs in total\n", kMaxLeds);
+      return 2;
+    }
+    outputs[o].pin = LedOutputs::PINS[o];
+    outputs[o].chip = static_cast<LedChipType>(o % static_cast<uint8_t>(LedChipType::CHIP_TYPE_COUNT));
+    outputs[o].colorOrder = static_cast<LedColorOrder>((o * 2 + 2) % static_cast<uint8_t>(LedColorOrder::COLOR_ORDER_COUNT));
+    outputs[o].firstLed = firstLed;
+    outputs[o].ledCount = opt.leds[o];
+    ranges[o].startUniverse = opt.universes[o];
+    ranges[o].firstPixel = firstLed;
+    ranges[o].pixelCount = opt.leds[o];
+    firstLed += opt.leds[o];
+  }
+
+  uint32_t failures = 0;
+  auto check = [&](bool ok, const char* what, uint32_t frame, int output) {
+    if (ok) return;
+    if (failures++ < 10) std::printf("FAIL frame %u output %d: %s\n", frame, output, what);
+  };
+
+  // Sized exactly as the node's plan sizes these blocks.
+  const uint16_t universes = FrameIngest::universesFor(ranges, outputCount, opt.pixelsPerUniverse);
+  MemoryArena arena;
+  arena.begin(FrameIngest::tableBytes(universes, outputCount) + FrameIngest::mergePoolBytes(universes) +
+              LedOutputs::bytesFor(kMaxLeds, opt.async));
+  FrameIngest ingest;
+  check(ingest.configure(ranges, outputCount, opt.pixelsPerUniverse, arena, universes), "ingest tables", 0, -1);
+  ingest.setTarget(pixels.data());
+  RecordingBackend backend(opt.async);
+  LedOutputs leds;
+  leds.begin(backend);
+  check(leds.setBuffers(pixels.data(), kMaxLeds, arena), "transmit buffer", 0, -1);
+  check(arena.available() == 0, "arena carved as planned", 0, -1);
+  leds.setDoneCallback(onDone);
+
+  check(leds.configure(outputs, outputCount), "configure", 0, -1);
+  check(leds.count() == outputCount, "attached outputs", 0, -1);
+
+  uint32_t latched = 0;
+  uint64_t serialUs = 0;
+  uint8_t dmx[512];
+  for (uint32_t frame = 0; frame < opt.frames; ++frame) {
+    bool complete = false;
+    for (uint8_t o = 0; o < outputCount; ++o) {
+      for (uint16_t sent = 0; sent < outputs[o].ledCount; sent += opt.pixelsPerUniverse) {
+        const uint16_t count = std::min<uint16_t>(opt.pixelsPerUniverse, outputs[o].ledCount - sent);
+        for (uint16_t i = 0; i < count; ++i) {
+          const CRGB c = pattern(o, sent + i, frame);
+          dmx[i * 3 + 0] = c.r;
+          dmx[i * 3 + 1] = c.g;
+          dmx[i * 3 + 2] = c.b;
+        }
+        const uint16_t universe = ranges[o].startUniverse + sent / opt.pixelsPerUniverse;
+        complete = ingest.ingest(universe, count * 3, dmx, 0x0A000001u);
+      }
+    }
+    check(complete, "frame did not latch on its last universe", frame, -1);
+    if (!complete) continue;
+    latched++;
+    check(leds.show(opt.brightness), "show refused", frame, -1);
+    if (opt.async) {
+      check(leds.busy(), "asynchronous show finished at once", frame, -1);
+      check(!leds.show(opt.brightness), "second show while busy", frame, -1);
+      // The next frame's ingest overlaps the transfer.
+      std::fill(pixels.begin(), pixels.end(), CRGB(0xA5, 0x5A, 0xC3));
+      backend.complete();
+      leds.service();
+    }
+    check(!leds.busy() && g_doneCalls == latched, "done callback", frame, -1);
+
+    uint64_t longestUs = 0;
+    uint64_t sumUs = 0;
+    for (uint8_t o = 0; o < outputCount; ++o) {
+      const RecordingBackend::Channel& channel = backend.channels()[o];
+      const uint32_t wireUs = LedOutputs::wireTimeUs(outputs[o]);
+      check(channel.frames == latched, "output skipped a show", frame, o);
+      check(channel.startUs == backend.channels()[0].startUs, "outputs did not start together", frame, o);
+      check(channel.endUs - channel.startUs == wireUs, "transfer time", frame, o);
+      longestUs = std::max<uint64_t>(longestUs, wireUs);
+      sumUs += wireUs;
+
+      bool same = channel.wire.size() == static_cast<size_t>(outputs[o].ledCount) * 3;
+      for (uint16_t i = 0; same && i < outputs[o].ledCount; ++i) {
+        const CRGB c = pattern(o, i, frame);
+        const uint8_t rgb[3] = {c.r, c.g, c.b};
+        const uint8_t* order = kWireOrder[static_cast<uint8_t>(outputs[o].colorOrder)];
+        for (uint8_t k = 0; k < 3; ++k) {
+          const uint8_t expected = static_cast<uint8_t>((rgb[order[k]] * (1u + opt.brightness)) >> 8);
+          same = same && channel.wire[i * 3 + k] == expected;
+        }
+      }
+      check(same, "pixel data", frame, o);
+    }
+    check(backend.lastFrameUs() == longestUs, "refresh time is not the longest output", frame, -1);
+    check(leds.frameTimeUs() == longestUs, "LedOutputs::frameTimeUs", frame, -1);
+    serialUs = sumUs;
+  }
+
+  // The universe right after the first range is owned only if a range covers it.
+  const uint16_t gap = ranges[0].startUniverse + (outputs[0].ledCount + opt.pixelsPerUniverse - 1) / opt.pixelsPerUniverse;
+  bool gapCovered = false;
+  for (uint8_t o = 0; o < outputCount; ++o) {
+    const uint16_t universes = (outputs[o].ledCount + opt.pixelsPerUniverse - 1) / opt.pixelsPerUniverse;
+    gapCovered = gapCovered || (gap >= ranges[o].startUniverse && gap < ranges[o].startUniverse + universes);
+  }
+  check(ingest.ownsUniverse(gap) == gapCovered, "universe outside every range", 0, -1);
+
+  // LED counts change in place; rewiring an attached output needs a restart.
+  LedOutputs::Output changed[LedOutputs::MAX_OUTPUTS];
+  std::copy(outputs, outputs + outputCount, changed);
+  changed[0].ledCount = std::max<uint16_t>(1, outputs[0].ledCount / 2);
+  check(leds.configure(changed, outputCount), "resize without restart", 0, 0);
+  check(backend.channels()[0].count == changed[0].ledCount, "resize reached the backend", 0, 0);
+  changed[0].colorOrder = static_cast<LedColorOrder>((static_cast<uint8_t>(changed[0].colorOrder) + 1) %
+                                                     static_cast<uint8_t>(LedColorOrder::COLOR_ORDER_COUNT));
+  check(!leds.configure(changed, outputCount), "color order change asks for a restart", 0, 0);
+
+  std::printf("outputs            %u, %u LEDs, %u universes, %u pixels per universe\n", outputCount, firstLed,
+              ingest.universeCount(), opt.pixelsPerUniverse);
+  std::printf("\n out  pin  leds  universes  first LED  wire time\n");
+  for (uint8_t o = 0; o < outputCount; ++o) {
+    const uint16_t universes = (outputs[o].ledCount + opt.pixelsPerUniverse - 1) / opt.pixelsPerUniverse;
+    std::printf(" %3u  %3u  %4u  %4u-%-4u  %9u  %6u us\n", o + 1, outputs[o].pin, outputs[o].ledCount,
+                ranges[o].startUniverse, ranges[o].startUniverse + universes - 1, outputs[o].firstLed,
+                LedOutputs::wireTimeUs(outputs[o]));
+  }
+  std::printf("\nframes latched     %u of %u (%s output)\n", latched, opt.frames,
+              opt.async ? "asynchronous" : "blocking");
+  std::printf("refresh parallel   %" PRIu64 " us (one after another: %" PRIu64 " us)\n", backend.lastFrameUs(), serialUs);
+  std::printf("universe %-5u     %s\n", gap, ingest.ownsUniverse(gap) ? "mapped" : "unmapped");
+
+  if (failures) {
+    std::printf("\nFAIL: %u checks failed\n", failures);
+    return 3;
+  }
+  std::printf("\nok\n");
+  return 0;
+}
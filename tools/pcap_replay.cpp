@@ -0,0 +1,268 @@
+// Replays the Art-Net traffic of a Wireshark capture through ArtNetNode::read()
+// and the FrameIngest path used by onDmxFrame(), and reports throughput, frame
+// latching, per-universe completeness and ingest-time percentiles.
+//
+//   pio run -e pcap_replay
+//   .pio/build/pcap_replay/program show.pcapng --realtime
+//
+// Exit status is non-zero when one of the --max-p99-ns / --min-frames gates
+// fails, so the tool can guard changes to the receive path.
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <HostNet.h>
+
+#include "ArtNetNode.h"
+#include "FrameIngest.h"
+#include "MemoryArena.h"
+#include "PcapReader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <map>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+  std::string path;
+  uint16_t port = 6454;
+  long numLeds = -1;
+  long startUniverse = -1;
+  uint16_t pixelsPerUniverse = 170;
+  bool realtime = false;
+  double speed = 1.0;
+  unsigned loops = 1;
+  uint64_t maxP99Ns = 0;
+  uint64_t minFrames = 0;
+};
+
+struct UniverseStats {
+  uint64_t packets = 0;
+  uint64_t sequenceGaps = 0;
+  uint8_t lastSequence = 0;
+};
+
+FrameIngest g_ingest;
+MemoryArena g_arena;
+std::vector<CRGB> g_pixels;
+std::map<uint16_t, UniverseStats> g_universes;
+uint64_t g_dmxPackets = 0;
+uint64_t g_framesLatched = 0;
+
+void onDmxFrame(uint16_t universe, uint16_t length, uint8_t sequence, uint8_t* data, IPAddress remoteIP)
+{
+  ++g_dmxPackets;
+  UniverseStats& stats = g_universes[universe];
+  if (stats.packets && sequence && stats.lastSequence && sequence != static_cast<uint8_t>(stats.lastSequence + 1)) {
+    ++stats.sequenceGaps;
+  }
+  stats.lastSequence = sequence;
+  ++stats.packets;
+
+  if (g_ingest.ingest(universe, length, data, static_cast<uint32_t>(remoteIP))) {
+    ++g_framesLatched;
+  }
+}
+
+void usage()
+{
+  std::fprintf(stderr,
+               "usage: pcap_replay <capture.pcap|pcapng> [options]\n"
+               "  --port N                 Art-Net UDP port to extract (6454)\n"
+               "  --leds N                 active LEDs (default: cover every universe seen)\n"
+               "  --start-universe N       first universe (default: lowest universe seen)\n"
+               "  --pixels-per-universe N  pixels mapped per universe (170)\n"
+               "  --realtime               honour capture timing instead of replaying flat out\n"
+               "  --speed X                realtime speed factor (1.0)\n"
+               "  --loops N                replay the capture N times (1)\n"
+               "  --max-p99-ns N           fail if p99 ingest time exceeds N ns\n"
+               "  --min-frames N           fail if fewer than N frames latch\n");
+}
+
+bool parseOptions(int argc, char** argv, Options& opt)
+{
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    auto value = [&]() -> const char* { return (i + 1 < argc) ? argv[++i] : ""; };
+    if (arg == "--port") opt.port = static_cast<uint16_t>(std::atoi(value()));
+    else if (arg == "--leds") opt.numLeds = std::atol(value());
+    else if (arg == "--start-universe") opt.startUniverse = std::atol(value());
+    else if (arg == "--pixels-per-universe") opt.pixelsPerUniverse = static_cast<uint16_t>(std::max(1, std::atoi(value())));
+    else if (arg == "--realtime") opt.realtime = true;
+    else if (arg == "--speed") opt.speed = std::max(0.01, std::atof(value()));
+    else if (arg == "--loops") opt.loops = static_cast<unsigned>(std::max(1, std::atoi(value())));
+    else if (arg == "--max-p99-ns") opt.maxP99Ns = std::strtoull(value(), nullptr, 10);
+    else if (arg == "--min-frames") opt.minFrames = std::strtoull(value(), nullptr, 10);
+    else if (arg == "-h" || arg == "--help") return false;
+    else if (opt.path.empty() && arg[0] != '-') opt.path = arg;
+    else {
+      std::fprintf(stderr, "unknown option: %s\n", arg.c_str());
+      return false;
+    }
+  }
+  return !opt.path.empty();
+}
+
+bool readDmxUniverse(const std::vector<uint8_t>& payload, uint16_t& universe)
+{
+  if (payload.size() < 18 || memcmp(payload.data(), "Art-Net", 8) != 0) return false;
+  if (payload[8] != 0x00 || payload[9] != 0x50) return false;
+  universe = static_cast<uint16_t>(payload[14] | (payload[15] << 8));
+  return true;
+}
+
+uint64_t percentile(const std::vector<uint64_t>& sorted, double fraction)
+{
+  if (sorted.empty()) return 0;
+  size_t index = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  Options opt;
+  if (!parseOptions(argc, argv, opt)) {
+    usage();
+    return 2;
+  }
+
+  PcapReader reader;
+  if (!reader.open(opt.path)) {
+    std::fprintf(stderr, "pcap_replay: %s\n", reader.error().c_str());
+    return 1;
+  }
+
+  std::vector<PcapReader::Datagram> packets;
+  uint16_t minUniverse = 0xFFFF;
+  uint16_t maxUniverse = 0;
+  PcapReader::Datagram datagram;
+  while (reader.next(datagram)) {
+    if (datagram.dstPort != opt.port) continue;
+    uint16_t universe;
+    if (readDmxUniverse(datagram.payload, universe)) {
+      minUniverse = std::min(minUniverse, universe);
+      maxUniverse = std::max(maxUniverse, universe);
+    }
+    packets.push_back(std::move(datagram));
+  }
+  if (!reader.error().empty()) {
+    std::fprintf(stderr, "pcap_replay: warning: %s\n", reader.error().c_str());
+  }
+  if (packets.empty()) {
+    std::fprintf(stderr, "pcap_replay: no UDP datagrams to port %u in %s\n", opt.port, opt.path.c_str());
+    return 1;
+  }
+  if (minUniverse > maxUniverse) {
+    minUniverse = maxUniverse = 0;
+  }
+
+  const uint16_t startUniverse = opt.startUniverse >= 0 ? static_cast<uint16_t>(opt.startUniverse) : minUniverse;
+  long numLeds = opt.numLeds;
+  if (numLeds <= 0) {
+    const long universes = std::max<long>(1, static_cast<long>(maxUniverse) - startUniverse + 1);
+    numLeds = universes * opt.pixelsPerUniverse;
+  }
+  numLeds = std::min<long>(numLeds, 0xFFFF);
+
+  g_pixels.assign(static_cast<size_t>(numLeds), CRGB());
+  // The arena holds the ingest tables and a merge slot per universe.
+  FrameIngest::Range range;
+  range.startUniverse = startUniverse;
+  range.pixelCount = static_cast<uint16_t>(numLeds);
+  const uint16_t universes = FrameIngest::universesFor(&range, 1, opt.pixelsPerUniverse);
+  g_arena.begin(FrameIngest::tableBytes(universes) + FrameIngest::mergePoolBytes(universes));
+  g_ingest.configure(static_cast<uint16_t>(numLeds), startUniverse, opt.pixelsPerUniverse, g_arena, universes);
+  g_ingest.setTarget(g_pixels.data());
+
+  HostNet::setMode(HostNet::Mode::Injected);
+  HostNet::setEthernetIp(IPAddress(10, 0, 0, 50));
+
+  ArtNetNode artnet;
+  artnet.setUniverseInfo(startUniverse, g_ingest.universeCount());
+  artnet.begin();
+  artnet.setArtDmxCallback(onDmxFrame);
+
+  std::vector<uint64_t> ingestNs;
+  ingestNs.reserve(packets.size() * opt.loops);
+
+  using Clock = std::chrono::steady_clock;
+  const uint64_t firstTs = packets.front().timestampUs;
+  const uint64_t captureSpanUs = packets.back().timestampUs - firstTs;
+  const auto wallStart = Clock::now();
+
+  for (unsigned loop = 0; loop < opt.loops; ++loop) {
+    const auto loopStart = Clock::now();
+    for (const PcapReader::Datagram& packet : packets) {
+      if (opt.realtime) {
+        const auto due = loopStart + std::chrono::microseconds(
+                             static_cast<uint64_t>((packet.timestampUs - firstTs) / opt.speed));
+        std::this_thread::sleep_until(due);
+      }
+      HostNet::inject(packet.payload.data(), packet.payload.size(), IPAddress(packet.srcIp), packet.srcPort);
+      const auto t0 = Clock::now();
+      artnet.read();
+      const auto t1 = Clock::now();
+      ingestNs.push_back(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()));
+    }
+  }
+
+  const double wallSeconds = std::chrono::duration<double>(Clock::now() - wallStart).count();
+  const uint64_t replayed = ingestNs.size();
+  std::sort(ingestNs.begin(), ingestNs.end());
+
+  std::printf("capture            %s\n", opt.path.c_str());
+  std::printf("frames read        %" PRIu64 " (%" PRIu64 " skipped)\n", reader.framesRead(), reader.framesSkipped());
+  std::printf("datagrams          %zu to port %u, %.3f s of capture\n", packets.size(), opt.port, captureSpanUs / 1e6);
+  std::printf("mapping            %ld LEDs, universes %u..%u, %u px/universe\n", numLeds, startUniverse,
+              startUniverse + g_ingest.universeCount() - 1, opt.pixelsPerUniverse);
+  std::printf("mode               %s, %u loop(s)\n", opt.realtime ? "realtime" : "flat out", opt.loops);
+  std::printf("replayed           %" PRIu64 " packets in %.3f s = %.0f packets/s\n", replayed, wallSeconds,
+              wallSeconds > 0 ? replayed / wallSeconds : 0.0);
+  std::printf("ArtDmx             %" PRIu64 " packets\n", g_dmxPackets);
+  std::printf("frames latched     %" PRIu64 "", g_framesLatched);
+  if (captureSpanUs > 0) {
+    std::printf(" (%.1f fps at capture timing)", g_framesLatched / (captureSpanUs / 1e6) / opt.loops);
+  }
+  std::printf("\n");
+
+  std::printf("ingest ns          p50 %" PRIu64 "  p90 %" PRIu64 "  p99 %" PRIu64 "  p99.9 %" PRIu64 "  max %" PRIu64 "\n",
+              percentile(ingestNs, 0.50), percentile(ingestNs, 0.90), percentile(ingestNs, 0.99),
+              percentile(ingestNs, 0.999), ingestNs.empty() ? 0 : ingestNs.back());
+
+  uint64_t mostPackets = 0;
+  for (uint16_t i = 0; i < g_ingest.universeCount(); ++i) {
+    auto it = g_universes.find(static_cast<uint16_t>(startUniverse + i));
+    if (it != g_universes.end()) mostPackets = std::max(mostPackets, it->second.packets);
+  }
+  std::printf("\nuniverse   packets  complete  seq-gaps\n");
+  for (uint16_t i = 0; i < g_ingest.universeCount(); ++i) {
+    const uint16_t universe = static_cast<uint16_t>(startUniverse + i);
+    const auto it = g_universes.find(universe);
+    const UniverseStats stats = it != g_universes.end() ? it->second : UniverseStats{};
+    const double complete = mostPackets ? 100.0 * stats.packets / mostPackets : 0.0;
+    std::printf("%8u  %8" PRIu64 "  %7.2f%%  %8" PRIu64 "\n", universe, stats.packets, complete, stats.sequenceGaps);
+  }
+  uint64_t foreign = 0;
+  for (const auto& entry : g_universes) {
+    if (!g_ingest.ownsUniverse(entry.first)) foreign += entry.second.packets;
+  }
+  if (foreign) {
+    std::printf("(+%" PRIu64 " packets for universes outside the mapping)\n", foreign);
+  }
+
+  int status = 0;
+  if (opt.maxP99Ns && percentile(ingestNs, 0.99) > opt.maxP99Ns) {
+    std::printf("\nFAIL: p99 ingest %" PRIu64 " ns > %" PRIu64 " ns\n", percentile(ingestNs, 0.99), opt.maxP99Ns);
+    status = 3;
+  }
+  if (opt.minFrames && g_framesLatched < opt.minFrames) {
+    std::printf("\nFAIL: %" PRIu64 " frames latched < %" PRIu64 "\n", g_framesLatched, opt.minFrames);
+    status = 3;
+  }
+  return status;
+}
@@ -0,0 +1,248 @@
+// Host simulation of discovery on a large Art-Net network.  Runs --nodes
+// ArtNetNode instances (each with its own run of universes) against a few
+// controllers that broadcast ArtPoll every --poll-ms, on a manual clock, and
+// counts the ArtPollReplies the network carries.  The same run is made twice:
+//
+//   legacy    Art-Net 3 polls, every node answers at once (reply window 0);
+//             a node's state change is seen at the next poll.
+//   art-net 4 the first controller polls the whole network, the others target
+//             --target-nodes nodes each; every controller asks for changes;
+//             nodes answer within --window-ms.
+//
+// Now and then a node's merge state flips; the tool measures how long until a
+// controller receives a reply that shows it.
+//
+//   pio run -e poll_sim
+//   .pio/build/poll_sim/program --nodes 200 --controllers 3
+
+#include <Arduino.h>
+#include <HostNet.h>
+
+#include "ArtNetNode.h"
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+  uint16_t nodes = 200;
+  uint8_t controllers = 3;
+  uint16_t universesPerNode = 4;
+  uint16_t targetNodes = 16;
+  uint32_t pollMs = 2500;
+  uint16_t windowMs = ArtNetNode::DEFAULT_POLL_REPLY_WINDOW_MS;
+  uint32_t durationS = 30;
+  uint16_t changes = 20;
+  uint32_t seed = 1;
+};
+
+struct Change {
+  uint32_t atMs;
+  uint16_t node;
+};
+
+struct Result {
+  uint64_t pollsReceived = 0;
+  uint64_t replies = 0;
+  uint64_t ignored = 0;
+  uint32_t peakPer10Ms = 0;
+  uint32_t changesSeen = 0;
+  uint64_t changeLatencyMs = 0;
+  uint32_t worstChangeMs = 0;
+};
+
+constexpr uint16_t kOpPoll = 0x2000;
+constexpr uint16_t kOpPollReply = 0x2100;
+
+// Reply bookkeeping for the transmit hook: which node is running and when
+// its last unseen change happened.
+int g_currentNode = -1;
+std::vector<uint32_t> g_changeSinceMs;   // 0 = nothing unseen
+std::vector<uint32_t> g_bucketReplies;
+Result* g_result = nullptr;
+
+void onTransmit(const uint8_t* data, size_t length, IPAddress, uint16_t)
+{
+  if (length < 10 || g_currentNode < 0) return;
+  const uint16_t opCode = static_cast<uint16_t>(data[8] | (data[9] << 8));
+  if (opCode != kOpPollReply) return;
+
+  g_result->replies++;
+  const uint32_t bucket = millis() / 10;
+  if (bucket >= g_bucketReplies.size()) g_bucketReplies.resize(bucket + 1, 0);
+  g_result->peakPer10Ms = std::max(g_result->peakPer10Ms, ++g_bucketReplies[bucket]);
+
+  uint32_t& since = g_changeSinceMs[g_currentNode];
+  if (since) {
+    const uint32_t latency = millis() - since;
+    g_result->changesSeen++;
+    g_result->changeLatencyMs += latency;
+    g_result->worstChangeMs = std::max(g_result->worstChangeMs, latency);
+    since = 0;
+  }
+}
+
+std::vector<uint8_t> buildPoll(bool artNet4, bool targeted, uint16_t bottom, uint16_t top)
+{
+  std::vector<uint8_t> packet = {'A', 'r', 't', '-', 'N', 'e', 't', 0, kOpPoll & 0xFF, kOpPoll >> 8, 0, 14};
+  if (!artNet4) {
+    packet.push_back(0);   // Flags
+    packet.push_back(0);   // DiagPriority
+    return packet;
+  }
+  packet.push_back(static_cast<uint8_t>(0x02 | (targeted ? 0x20 : 0)));
+  packet.push_back(0x10);
+  packet.push_back(static_cast<uint8_t>(top >> 8));
+  packet.push_back(static_cast<uint8_t>(top & 0xFF));
+  packet.push_back(static_cast<uint8_t>(bottom >> 8));
+  packet.push_back(static_cast<uint8_t>(bottom & 0xFF));
+  packet.resize(22, 0);   // EstaMan, Oem
+  return packet;
+}
+
+Result run(const Options& opt, bool artNet4)
+{
+  Result result;
+  g_result = &result;
+  g_bucketReplies.clear();
+  g_changeSinceMs.assign(opt.nodes, 0);
+  HostNet::useManualClock(1000000);
+  HostNet::seedRandom(opt.seed);
+  HostNet::clear();
+
+  std::vector<std::unique_ptr<ArtNetNode>> nodes;
+  for (uint16_t i = 0; i < opt.nodes; ++i) {
+    g_currentNode = -1;   // boot announcements are not part of the count
+    nodes.emplace_back(new ArtNetNode());
+    nodes.back()->setUniverseInfo(static_cast<uint16_t>(i * opt.universesPerNode), opt.universesPerNode);
+    nodes.back()->setPollReplyWindow(artNet4 ? opt.windowMs : 0);
+    nodes.back()->begin();
+    nodes.back()->read();
+  }
+
+  std::mt19937 random(opt.seed);
+  std::vector<Change> changes;
+  const uint32_t durationMs = opt.durationS * 1000;
+  for (uint16_t i = 0; i < opt.changes; ++i) {
+    changes.push_back({static_cast<uint32_t>(1000 + random() % (durationMs - 1000)),
+                       static_cast<uint16_t>(random() % opt.nodes)});
+  }
+
+  std::vector<std::vector<uint8_t>> polls;
+  for (uint8_t c = 0; c < opt.controllers; ++c) {
+    // Controller 0 sees the whole network; the others patch a few nodes each.
+    const uint16_t firstNode = c ? static_cast<uint16_t>((c - 1) * opt.targetNodes % opt.nodes) : 0;
+    const uint16_t bottom = static_cast<uint16_t>(firstNode * opt.universesPerNode);
+    const uint16_t top = static_cast<uint16_t>(bottom + opt.targetNodes * opt.universesPerNode - 1);
+    polls.push_back(buildPoll(artNet4, c > 0, bottom, top));
+  }
+
+  std::vector<bool> merging(opt.nodes, false);
+  for (uint32_t t = 0; t < durationMs; ++t) {
+    for (uint8_t c = 0; c < opt.controllers; ++c) {
+      // Controllers poll out of phase with each other.
+      if ((t + c * opt.pollMs / opt.controllers) % opt.pollMs != 0) continue;
+      const IPAddress controllerIp(10, 0, 0, static_cast<uint8_t>(201 + c));
+      for (uint16_t i = 0; i < opt.nodes; ++i) {
+        g_currentNode = i;
+        HostNet::inject(polls[c].data(), polls[c].size(), controllerIp);
+        nodes[i]->read();
+      }
+    }
+    for (const Change& change : changes) {
+      if (change.atMs != t) continue;
+      if (!g_changeSinceMs[change.node]) g_changeSinceMs[change.node] = millis();
+      merging[change.node] = !merging[change.node];
+      nodes[change.node]->setPortMerging(0, merging[change.node]);
+    }
+    for (uint16_t i = 0; i < opt.nodes; ++i) {
+      g_currentNode = i;
+      nodes[i]->read();
+    }
+    HostNet::advanceClock(1000);
+  }
+
+  for (const auto& node : nodes) {
+    result.pollsReceived += node->pollStats().polls;
+    result.ignored += node->pollStats().untargeted;
+  }
+  g_currentNode = -1;
+  return result;
+}
+
+void usage()
+{
+  std::fprintf(stderr,
+               "usage: poll_sim [options]\n"
+               "  --nodes N           nodes on the network (200)\n"
+               "  --controllers N     controllers polling (3)\n"
+               "  --universes N       universes per node (4)\n"
+               "  --target-nodes N    nodes each targeting controller patches (16)\n"
+               "  --poll-ms N         poll interval per controller (2500)\n"
+               "  --window-ms N       reply window with Art-Net 4 handling (1000)\n"
+               "  --duration S        simulated seconds (30)\n"
+               "  --changes N         node state changes during the run (20)\n"
+               "  --seed N            random seed (1)\n");
+}
+
+bool parseOptions(int argc, char** argv, Options& opt)
+{
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    auto value = [&]() { return (i + 1 < argc) ? std::atol(argv[++i]) : 0L; };
+    if (arg == "--nodes") opt.nodes = static_cast<uint16_t>(std::max(1L, std::min(value(), 4096L)));
+    else if (arg == "--controllers") opt.controllers = static_cast<uint8_t>(std::max(1L, std::min(value(), 8L)));
+    else if (arg == "--universes") opt.universesPerNode = static_cast<uint16_t>(std::max(1L, std::min(value(), 16L)));
+    else if (arg == "--target-nodes") opt.targetNodes = static_cast<uint16_t>(std::max(1L, value()));
+    else if (arg == "--poll-ms") opt.pollMs = static_cast<uint32_t>(std::max(100L, value()));
+    else if (arg == "--window-ms") opt.windowMs = static_cast<uint16_t>(std::max(0L, std::min(value(), 1000L)));
+    else if (arg == "--duration") opt.durationS = static_cast<uint32_t>(std::max(2L, value()));
+    else if (arg == "--changes") opt.changes = static_cast<uint16_t>(std::max(0L, value()));
+    else if (arg == "--seed") opt.seed = static_cast<uint32_t>(value());
+    else return false;
+  }
+  opt.targetNodes = std::min(opt.targetNodes, opt.nodes);
+  // Port-Addresses are 15 bits.
+  return static_cast<uint32_t>(opt.nodes) * opt.universesPerNode <= 32768;
+}
+
+void printRow(const char* label, uint64_t legacy, uint64_t artNet4)
+{
+  std::printf("%-28s %12llu %12llu\n", label, static_cast<unsigned long long>(legacy),
+              static_cast<unsigned long long>(artNet4));
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  Options opt;
+  if (!parseOptions(argc, argv, opt)) {
+    usage();
+    return 2;
+  }
+
+  HostNet::setMode(HostNet::Mode::Injected);
+  HostNet::setEthernetIp(IPAddress(10, 0, 0, 1), IPAddress(255, 255, 255, 0));
+  HostNet::setTransmitHook(onTransmit);
+
+  const Result legacy = run(opt, false);
+  const Result artNet4 = run(opt, true);
+
+  std::printf("poll_sim: %u nodes x %u universes, %u controllers every %lu ms, %lu s\n", opt.nodes,
+              opt.universesPerNode, opt.controllers, static_cast<unsigned long>(opt.pollMs),
+              static_cast<unsigned long>(opt.durationS));
+  std::printf("%-28s %12s %12s\n", "", "legacy", "art-net 4");
+  printRow("polls received", legacy.pollsReceived, artNet4.pollsReceived);
+  printRow("ArtPollReply sent", legacy.replies, artNet4.replies);
+  printRow("targeted polls ignored", legacy.ignored, artNet4.ignored);
+  printRow("peak replies per 10 ms", legacy.peakPer10Ms, artNet4.peakPer10Ms);
+  printRow("changes seen", legacy.changesSeen, artNet4.changesSeen);
+  printRow("mean change latency (ms)", legacy.changesSeen ? legacy.changeLatencyMs / legacy.changesSeen : 0,
+           artNet4.changesSeen ? artNet4.changeLatencyMs / artNet4.changesSeen : 0);
+  printRow("worst change latency (ms)", legacy.worstChangeMs, artNet4.worstChangeMs);
+  return 0;
+}
@@ -0,0 +1,318 @@
+// Host simulation of the main loop's scheduling, on a manual clock.  The
+// tasks are stand-ins that spend simulated time the way the firmware's do:
+//
+//   ingest        ArtDmx at --packet-us each from a receive queue that holds
+//                 --queue packets; a controller sends --universes packets
+//                 back to back every frame at --fps.  The old loop read one
+//                 per pass, the ingest task drains the queue within its budget
+//   render        --render-us once a frame is complete
+//   timers        a few microseconds
+//   web           --web-us for a page every --web-ms
+//   housekeeping  --flash-us for a flash write every --flash-ms, else a log
+//                 line
+//
+// The same traffic is run twice: through the old loop(), which called every
+// service once per pass, and through TaskScheduler with the firmware's task
+// table.  The tool reports how long packets waited in the queue, how many
+// overflowed it and the scheduler's per-task statistics.
+//
+//   pio run -e sched_sim
+//   .pio/build/sched_sim/program --universes 32 --web-us 25000
+//
+// Exit status is 3 when a packet waited longer than the longest task plus
+// --slack-us under the scheduler, so the tool doubles as a regression check.
+
+#include <Arduino.h>
+#include <HostNet.h>
+
+#include "LatencyHistogram.h"
+#include "TaskScheduler.h"
+
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <string>
+
+namespace {
+
+struct Options {
+  uint32_t durationS = 10;
+  uint16_t universes = 16;
+  uint16_t fps = 40;
+  uint32_t wireUs = 45;        // spacing of packets within a frame burst
+  uint32_t packetUs = 20;
+  uint16_t queue = 16;
+  uint32_t renderUs = 1500;
+  uint32_t webMs = 500;
+  uint32_t webUs = 20000;
+  uint32_t flashMs = 5000;
+  uint32_t flashUs = 40000;
+  uint32_t slackUs = 2000;
+  uint32_t seed = 1;
+};
+
+// The firmware's task table (src/main.cpp).
+constexpr uint32_t kIngestBudgetUs = 500;
+constexpr uint32_t kRenderBudgetUs = 2000;
+constexpr uint32_t kTimersPeriodUs = 10000;
+constexpr uint32_t kTimersBudgetUs = 500;
+constexpr uint32_t kWebPeriodUs = 2000;
+constexpr uint32_t kWebBudgetUs = 20000;
+constexpr uint32_t kHousekeepingPeriodUs = 10000;
+constexpr uint32_t kHousekeepingBudgetUs = 5000;
+constexpr uint32_t kPassUs = 2;      // loop() overhead; keeps an idle loop moving
+constexpr uint32_t kIdleUs = 3;      // a service with nothing to do
+constexpr uint32_t kTimersUs = 15;
+constexpr uint32_t kLogLineUs = 60;
+
+struct Result {
+  LatencyHistogram wait;
+  uint32_t received = 0;
+  uint32_t overflowed = 0;
+  uint32_t frames = 0;
+};
+
+const Options* g_opt = nullptr;
+Result* g_result = nullptr;
+std::deque<uint32_t> g_arrivals;     // every packet's arrival time, in order
+std::deque<uint32_t> g_queue;        // arrived, not read yet
+uint16_t g_frameProgress = 0;
+bool g_framePending = false;
+uint32_t g_nextWebMs = 0;
+uint32_t g_nextFlashMs = 0;
+
+void spend(uint32_t us)
+{
+  delayMicroseconds(us);
+}
+
+// Moves what has arrived by now into the receive queue; packets that find it
+// full are lost, as with the lwIP mailbox.
+void deliver()
+{
+  const uint32_t now = micros();
+  while (!g_arrivals.empty() && static_cast<int32_t>(now - g_arrivals.front()) >= 0) {
+    if (g_queue.size() >= g_opt->queue) {
+      g_result->overflowed++;
+    } else {
+      g_queue.push_back(g_arrivals.front());
+    }
+    g_arrivals.pop_front();
+  }
+}
+
+// One packet, as ArtNetNode::read() takes; false when the queue was empty.
+bool readPacket()
+{
+  deliver();
+  if (g_queue.empty()) {
+    spend(kIdleUs);
+    return false;
+  }
+  g_result->wait.record(micros() - g_queue.front());
+  g_result->received++;
+  g_queue.pop_front();
+  spend(g_opt->packetUs);
+  if (++g_frameProgress == g_opt->universes) {
+    g_frameProgress = 0;
+    g_framePending = true;
+  }
+  return true;
+}
+
+// The old loop() read one packet per pass.
+void legacyIngest()
+{
+  readPacket();
+}
+
+// The firmware's ingest task drains the queue within its budget.
+void taskIngest()
+{
+  const uint32_t startUs = micros();
+  while (readPacket() && micros() - startUs < kIngestBudgetUs) {
+  }
+}
+
+void taskRender()
+{
+  if (!g_framePending) {
+    spend(kIdleUs);
+    return;
+  }
+  g_framePending = false;
+  g_result->frames++;
+  spend(g_opt->renderUs);
+}
+
+void taskTimers()
+{
+  spend(kTimersUs);
+}
+
+void taskWeb()
+{
+  if (static_cast<int32_t>(millis() - g_nextWebMs) < 0) {
+    spend(kIdleUs);
+    return;
+  }
+  g_nextWebMs += g_opt->webMs;
+  spend(g_opt->webUs);
+}
+
+void taskHousekeeping()
+{
+  if (static_cast<int32_t>(millis() - g_nextFlashMs) >= 0) {
+    g_nextFlashMs += g_opt->flashMs;
+    spend(g_opt->flashUs);
+    return;
+  }
+  spend(kLogLineUs);
+}
+
+void schedule(const Options& opt, std::mt19937& random)
+{
+  g_arrivals.clear();
+  g_queue.clear();
+  std::uniform_int_distribution<uint32_t> jitter(0, 2000);
+  const uint32_t frameUs = 1000000 / opt.fps;
+  for (uint32_t start = 1000; start < opt.durationS * 1000000; start += frameUs) {
+    const uint32_t first = start + jitter(random);
+    for (uint16_t u = 0; u < opt.universes; ++u) {
+      g_arrivals.push_back(first + u * opt.wireUs);
+    }
+  }
+  g_frameProgress = 0;
+  g_framePending = false;
+  g_nextWebMs = opt.webMs;
+  g_nextFlashMs = opt.flashMs;
+}
+
+Result runLegacy(const Options& opt)
+{
+  Result result;
+  g_result = &result;
+  std::mt19937 random(opt.seed);
+  HostNet::useManualClock(0);
+  schedule(opt, random);
+  const uint32_t endUs = opt.durationS * 1000000;
+  while (micros() < endUs) {
+    legacyIngest();
+    taskRender();
+    taskWeb();
+    taskTimers();
+    taskHousekeeping();
+    spend(kPassUs);
+  }
+  return result;
+}
+
+Result runScheduled(const Options& opt, TaskScheduler& scheduler)
+{
+  Result result;
+  g_result = &result;
+  std::mt19937 random(opt.seed);
+  HostNet::useManualClock(0);
+  schedule(opt, random);
+  scheduler.add("ingest", taskIngest, 0, 0, kIngestBudgetUs);
+  scheduler.add("render", taskRender, 1, 0, kRenderBudgetUs);
+  scheduler.add("timers", taskTimers, 2, kTimersPeriodUs, kTimersBudgetUs);
+  scheduler.add("web", taskWeb, 3, kWebPeriodUs, kWebBudgetUs);
+  scheduler.add("housekeeping", taskHousekeeping, 4, kHousekeepingPeriodUs, kHousekeepingBudgetUs);
+  const uint32_t endUs = opt.durationS * 1000000;
+  while (micros() < endUs) {
+    scheduler.runPass();
+    spend(kPassUs);
+  }
+  return result;
+}
+
+void usage()
+{
+  std::fprintf(stderr,
+               "usage: sched_sim [options]\n"
+               "  --duration S     simulated seconds (10)\n"
+               "  --universes N    ArtDmx per frame (16)\n"
+               "  --fps N          frames per second (40)\n"
+               "  --packet-us N    time to ingest one packet (20)\n"
+               "  --queue N        receive queue, in packets (16)\n"
+               "  --render-us N    time to present a frame (1500)\n"
+               "  --web-ms N       interval between web requests (500)\n"
+               "  --web-us N       time to serve one (20000)\n"
+               "  --flash-ms N     interval between flash writes (5000)\n"
+               "  --flash-us N     time for one (40000)\n"
+               "  --slack-us N     allowed wait beyond the longest task (2000)\n"
+               "  --seed N         random seed (1)\n");
+}
+
+bool parseOptions(int argc, char** argv, Options& opt)
+{
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    auto value = [&]() { return (i + 1 < argc) ? std::atol(argv[++i]) : 0L; };
+    if (arg == "--duration") opt.durationS = static_cast<uint32_t>(std::max(1L, std::min(value(), 3600L)));
+    else if (arg == "--universes") opt.universes = static_cast<uint16_t>(std::max(1L, std::min(value(), 512L)));
+    else if (arg == "--fps") opt.fps = static_cast<uint16_t>(std::max(1L, std::min(value(), 1000L)));
+    else if (arg == "--packet-us") opt.packetUs = static_cast<uint32_t>(std::max(1L, value()));
+    else if (arg == "--queue") opt.queue = static_cast<uint16_t>(std::max(1L, std::min(value(), 1024L)));
+    else if (arg == "--render-us") opt.renderUs = static_cast<uint32_t>(std::max(0L, value()));
+    else if (arg == "--web-ms") opt.webMs = static_cast<uint32_t>(std::max(1L, value()));
+    else if (arg == "--web-us") opt.webUs = static_cast<uint32_t>(std::max(0L, value()));
+    else if (arg == "--flash-ms") opt.flashMs = static_cast<uint32_t>(std::max(1L, value()));
+    else if (arg == "--flash-us") opt.flashUs = static_cast<uint32_t>(std::max(0L, value()));
+    else if (arg == "--slack-us") opt.slackUs = static_cast<uint32_t>(std::max(0L, value()));
+    else if (arg == "--seed") opt.seed = static_cast<uint32_t>(value());
+    else return false;
+  }
+  return true;
+}
+
+void printRow(const char* label, uint32_t legacy, uint32_t scheduled)
+{
+  std::printf("%-26s %12lu %12lu\n", label, static_cast<unsigned long>(legacy),
+              static_cast<unsigned long>(scheduled));
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  Options opt;
+  if (!parseOptions(argc, argv, opt)) {
+    usage();
+    return 2;
+  }
+  g_opt = &opt;
+
+  const Result legacy = runLegacy(opt);
+  TaskScheduler scheduler;
+  const Result scheduled = runScheduled(opt, scheduler);
+
+  std::printf("sched_sim: %u universes at %u fps, web %lu us every %lu ms, flash %lu us every %lu ms, %lu s\n",
+              opt.universes, opt.fps, static_cast<unsigned long>(opt.webUs), static_cast<unsigned long>(opt.webMs),
+              static_cast<unsigned long>(opt.flashUs), static_cast<unsigned long>(opt.flashMs),
+              static_cast<unsigned long>(opt.durationS));
+  std::printf("%-26s %12s %12s\n", "", "loop", "scheduler");
+  printRow("packets read", legacy.received, scheduled.received);
+  printRow("packets lost (queue full)", legacy.overflowed, scheduled.overflowed);
+  printRow("frames rendered", legacy.frames, scheduled.frames);
+  printRow("packet wait p50 (us)", legacy.wait.percentile(50), scheduled.wait.percentile(50));
+  printRow("packet wait p99 (us)", legacy.wait.percentile(99), scheduled.wait.percentile(99));
+  printRow("packet wait max (us)", legacy.wait.max(), scheduled.wait.max());
+
+  std::printf("\n%-14s %4s %9s %8s %8s %10s %12s %9s\n", "task", "prio", "period", "runs", "cpu %",
+              "max run", "max latency", "overruns");
+  uint32_t longestUs = 0;
+  for (uint8_t i = 0; i < scheduler.taskCount(); ++i) {
+    const TaskScheduler::Stats& stats = scheduler.stats(i);
+    std::printf("%-14s %4u %9lu %8lu %8.1f %10lu %12lu %9lu\n", scheduler.name(i), scheduler.priority(i),
+                static_cast<unsigned long>(scheduler.periodUs(i)), static_cast<unsigned long>(stats.runs),
+                stats.cpuPermille / 10.0, static_cast<unsigned long>(stats.maxRunUs),
+                static_cast<unsigned long>(stats.maxLatencyUs), static_cast<unsigned long>(stats.overruns));
+    if (scheduler.priority(i) > 0) longestUs = std::max(longestUs, stats.maxRunUs);
+  }
+  std::printf("%-14s %4s %9s %8lu %8.1f\n", "(idle)", "", "", static_cast<unsigned long>(scheduler.passes()),
+              scheduler.idlePermille() / 10.0);
+
+  return scheduled.wait.max() > longestUs + opt.slackUs ? 3 : 0;
+}
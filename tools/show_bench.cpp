@@ -0,0 +1,310 @@
+// Runs Wireshark captures through the receive path (ArtNetNode + FrameIngest)
+// and records every changed latched frame with ShowCodec, exactly as the
+// firmware's show recorder does.  Reports compression and encode/decode
+// throughput, then decodes the stream again and checks every frame against a
+// CRC of the original.
+//
+//   pio run -e show_bench
+//   .pio/build/show_bench/program show_jinx.pcapng show_resolume.pcap
+//
+// Exit status is 3 when a decoded frame differs from the recorded one, so the
+// tool doubles as a regression check for the codec.
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <HostNet.h>
+
+#include "ArtNetNode.h"
+#include "Crc32.h"
+#include "FrameIngest.h"
+#include "MemoryArena.h"
+#include "PcapReader.h"
+#include "ShowCodec.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Size of the firmware's LittleFS ("spiffs") partition in partitions.csv.
+constexpr double kFlashBytes = 0x150000;
+
+struct Options {
+  std::vector<std::string> paths;
+  uint16_t port = 6454;
+  long numLeds = -1;
+  long startUniverse = -1;
+  uint16_t pixelsPerUniverse = 170;
+  uint16_t keyInterval = 100;
+  std::string output;
+};
+
+struct Recording {
+  std::vector<uint8_t> stream;       // FileHeader + records, as on flash
+  std::vector<uint32_t> frameCrcs;
+  std::vector<uint64_t> encodeNs;
+  uint64_t latched = 0;
+  uint64_t lastTimestampUs = 0;
+  uint64_t durationUs = 0;
+};
+
+FrameIngest g_ingest;
+MemoryArena g_arena;
+std::vector<CRGB> g_pixels;
+ShowCodec::Encoder g_encoder;
+std::vector<uint8_t> g_record;
+Recording g_rec;
+uint64_t g_packetTimestampUs = 0;
+
+using Clock = std::chrono::steady_clock;
+
+void recordFrame()
+{
+  g_rec.latched++;
+  if (!g_ingest.takeFrameChanged() && !g_rec.frameCrcs.empty()) return;
+
+  const uint64_t dtUs = g_rec.frameCrcs.empty() ? 0 : g_packetTimestampUs - g_rec.lastTimestampUs;
+  const uint16_t dtMs = static_cast<uint16_t>(std::min<uint64_t>(dtUs / 1000, 0xFFFF));
+  const auto t0 = Clock::now();
+  const size_t length = g_encoder.encode(g_pixels.data(), dtMs, g_record.data(), g_record.size());
+  const auto t1 = Clock::now();
+  if (length == 0) {
+    std::fprintf(stderr, "show_bench: encode failed at frame %zu\n", g_rec.frameCrcs.size());
+    return;
+  }
+  g_rec.encodeNs.push_back(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()));
+  g_rec.stream.insert(g_rec.stream.end(), g_record.begin(), g_record.begin() + length);
+  g_rec.frameCrcs.push_back(crc32(g_pixels.data(), g_pixels.size() * sizeof(CRGB)));
+  g_rec.durationUs += dtUs;
+  g_rec.lastTimestampUs = g_packetTimestampUs;
+}
+
+void onDmxFrame(uint16_t universe, uint16_t length, uint8_t, uint8_t* data, IPAddress remoteIP)
+{
+  if (g_ingest.ingest(universe, length, data, static_cast<uint32_t>(remoteIP))) {
+    recordFrame();
+  }
+}
+
+void onArtSync(IPAddress)
+{
+  if (g_ingest.sync()) {
+    recordFrame();
+  }
+}
+
+void usage()
+{
+  std::fprintf(stderr,
+               "usage: show_bench <capture.pcap|pcapng>... [options]\n"
+               "  --port N                 Art-Net UDP port to extract (6454)\n"
+               "  --leds N                 active LEDs (default: cover every universe seen)\n"
+               "  --start-universe N       first universe (default: lowest universe seen)\n"
+               "  --pixels-per-universe N  pixels mapped per universe (170)\n"
+               "  --key-interval N         frames between key frames (100, as the firmware)\n"
+               "  --output FILE            write the recording of the last capture (.pxr)\n");
+}
+
+bool parseOptions(int argc, char** argv, Options& opt)
+{
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    auto value = [&]() -> const char* { return (i + 1 < argc) ? argv[++i] : ""; };
+    if (arg == "--port") opt.port = static_cast<uint16_t>(std::atoi(value()));
+    else if (arg == "--leds") opt.numLeds = std::atol(value());
+    else if (arg == "--start-universe") opt.startUniverse = std::atol(value());
+    else if (arg == "--pixels-per-universe") opt.pixelsPerUniverse = static_cast<uint16_t>(std::max(1, std::atoi(value())));
+    else if (arg == "--key-interval") opt.keyInterval = static_cast<uint16_t>(std::max(1, std::atoi(value())));
+    else if (arg == "--output") opt.output = value();
+    else if (arg == "-h" || arg == "--help") return false;
+    else if (arg[0] != '-') opt.paths.push_back(arg);
+    else {
+      std::fprintf(stderr, "unknown option: %s\n", arg.c_str());
+      return false;
+    }
+  }
+  return !opt.paths.empty();
+}
+
+bool readDmxUniverse(const std::vector<uint8_t>& payload, uint16_t& universe)
+{
+  if (payload.size() < 18 || memcmp(payload.data(), "Art-Net", 8) != 0) return false;
+  if (payload[8] != 0x00 || payload[9] != 0x50) return false;
+  universe = static_cast<uint16_t>(payload[14] | (payload[15] << 8));
+  return true;
+}
+
+uint64_t percentile(std::vector<uint64_t> values, double fraction)
+{
+  if (values.empty()) return 0;
+  std::sort(values.begin(), values.end());
+  const size_t index = static_cast<size_t>(fraction * static_cast<double>(values.size() - 1) + 0.5);
+  return values[std::min(index, values.size() - 1)];
+}
+
+// Decodes the whole stream with the player's fixed buffers; returns the index
+// of the first mismatching frame, or -1 when all match.
+long verify(const Recording& rec, size_t frameBytes, double& decodeSeconds)
+{
+  ShowCodec::FileHeader header;
+  memcpy(&header, rec.stream.data(), sizeof(header));
+  ShowCodec::Decoder decoder;
+  if (!decoder.begin(header)) return 0;
+  std::vector<CRGB> frame(header.pixelCount);
+
+  size_t pos = sizeof(header);
+  size_t index = 0;
+  long mismatch = -1;
+  Clock::duration decodeTime{};
+  while (pos + sizeof(ShowCodec::RecordHeader) <= rec.stream.size()) {
+    ShowCodec::RecordHeader record;
+    memcpy(&record, rec.stream.data() + pos, sizeof(record));
+    pos += sizeof(record);
+    if (pos + record.length > rec.stream.size()) break;
+    const auto t0 = Clock::now();
+    const bool applied = decoder.apply(record, rec.stream.data() + pos, frame.data());
+    decodeTime += Clock::now() - t0;
+    if (!applied || index >= rec.frameCrcs.size() || crc32(frame.data(), frameBytes) != rec.frameCrcs[index]) {
+      mismatch = static_cast<long>(index);
+      break;
+    }
+    pos += record.length;
+    ++index;
+  }
+  decodeSeconds = std::chrono::duration<double>(decodeTime).count();
+  if (mismatch < 0 && index != rec.frameCrcs.size()) mismatch = static_cast<long>(index);
+  return mismatch;
+}
+
+int benchCapture(const std::string& path, const Options& opt)
+{
+  PcapReader reader;
+  if (!reader.open(path)) {
+    std::fprintf(stderr, "show_bench: %s\n", reader.error().c_str());
+    return 1;
+  }
+  std::vector<PcapReader::Datagram> packets;
+  uint16_t minUniverse = 0xFFFF;
+  uint16_t maxUniverse = 0;
+  PcapReader::Datagram datagram;
+  while (reader.next(datagram)) {
+    if (datagram.dstPort != opt.port) continue;
+    uint16_t universe;
+    if (readDmxUniverse(datagram.payload, universe)) {
+      minUniverse = std::min(minUniverse, universe);
+      maxUniverse = std::max(maxUniverse, universe);
+    }
+    packets.push_back(std::move(datagram));
+  }
+  if (packets.empty()) {
+    std::fprintf(stderr, "show_bench: no UDP datagrams to port %u in %s\n", opt.port, path.c_str());
+    return 1;
+  }
+  if (minUniverse > maxUniverse) minUniverse = maxUniverse = 0;
+
+  const uint16_t startUniverse = opt.startUniverse >= 0 ? static_cast<uint16_t>(opt.startUniverse) : minUniverse;
+  long numLeds = opt.numLeds;
+  if (numLeds <= 0) {
+    numLeds = std::max<long>(1, static_cast<long>(maxUniverse) - startUniverse + 1) * opt.pixelsPerUniverse;
+  }
+  numLeds = std::min<long>(numLeds, ShowCodec::MAX_PIXELS);
+
+  g_pixels.assign(static_cast<size_t>(numLeds), CRGB());
+  // The arena holds the ingest tables and a merge slot per universe.
+  FrameIngest::Range range;
+  range.startUniverse = startUniverse;
+  range.pixelCount = static_cast<uint16_t>(numLeds);
+  const uint16_t universes = FrameIngest::universesFor(&range, 1, opt.pixelsPerUniverse);
+  g_arena.begin(FrameIngest::tableBytes(universes) + FrameIngest::mergePoolBytes(universes));
+  g_ingest.configure(static_cast<uint16_t>(numLeds), startUniverse, opt.pixelsPerUniverse, g_arena, universes);
+  g_ingest.setTarget(g_pixels.data());
+  g_encoder.begin(static_cast<uint16_t>(numLeds), opt.keyInterval);
+  g_record.assign(ShowCodec::maxRecordSize(static_cast<size_t>(numLeds)), 0);
+  g_rec = Recording();
+  const ShowCodec::FileHeader placeholder = g_encoder.header(0, 0);
+  g_rec.stream.assign(reinterpret_cast<const uint8_t*>(&placeholder),
+                      reinterpret_cast<const uint8_t*>(&placeholder) + sizeof(placeholder));
+
+  ArtNetNode artnet;
+  artnet.setUniverseInfo(startUniverse, g_ingest.universeCount());
+  artnet.begin();
+  artnet.setArtDmxCallback(onDmxFrame);
+  artnet.setArtSyncCallback(onArtSync);
+  for (const PcapReader::Datagram& packet : packets) {
+    g_packetTimestampUs = packet.timestampUs;
+    HostNet::inject(packet.payload.data(), packet.payload.size(), IPAddress(packet.srcIp), packet.srcPort);
+    artnet.read();
+  }
+
+  const size_t recorded = g_rec.frameCrcs.size();
+  const ShowCodec::FileHeader header = g_encoder.header(static_cast<uint32_t>(recorded),
+                                                        static_cast<uint32_t>(g_rec.durationUs / 1000));
+  memcpy(g_rec.stream.data(), &header, sizeof(header));
+
+  const size_t frameBytes = g_pixels.size() * sizeof(CRGB);
+  const double rawBytes = static_cast<double>(recorded) * frameBytes;
+  const double encodedBytes = static_cast<double>(g_rec.stream.size());
+  uint64_t encodeTotalNs = 0;
+  for (uint64_t ns : g_rec.encodeNs) encodeTotalNs += ns;
+  double decodeSeconds = 0;
+  const long mismatch = recorded ? verify(g_rec, frameBytes, decodeSeconds) : -1;
+  const double showSeconds = g_rec.durationUs / 1e6;
+
+  std::printf("capture            %s\n", path.c_str());
+  std::printf("mapping            %ld LEDs, universes %u..%u, %u px/universe\n", numLeds, startUniverse,
+              startUniverse + g_ingest.universeCount() - 1, opt.pixelsPerUniverse);
+  std::printf("frames             %" PRIu64 " latched, %zu recorded (%" PRIu64 " unchanged), %u key / %u delta\n",
+              g_rec.latched, recorded, g_rec.latched - recorded, g_encoder.keyFrames(), g_encoder.deltaFrames());
+  std::printf("size               %.1f KB raw -> %.1f KB (%.2f%%, %.1fx), %.0f bytes/frame\n", rawBytes / 1024,
+              encodedBytes / 1024, rawBytes > 0 ? 100.0 * encodedBytes / rawBytes : 0.0,
+              encodedBytes > 0 ? rawBytes / encodedBytes : 0.0, recorded ? encodedBytes / recorded : 0.0);
+  if (showSeconds > 0) {
+    const double bytesPerSecond = encodedBytes / showSeconds;
+    std::printf("show               %.1f s, %.1f KB/s -> %.1f min fit in the %.0f KB partition\n", showSeconds,
+                bytesPerSecond / 1024, kFlashBytes / bytesPerSecond / 60, kFlashBytes / 1024);
+  }
+  std::printf("encode ns/frame    p50 %" PRIu64 "  p99 %" PRIu64 "  max %" PRIu64 "  (%.1f MB/s)\n",
+              percentile(g_rec.encodeNs, 0.50), percentile(g_rec.encodeNs, 0.99), percentile(g_rec.encodeNs, 1.0),
+              encodeTotalNs ? rawBytes / (encodeTotalNs / 1e9) / 1e6 : 0.0);
+  std::printf("decode ns/frame    avg %.0f  (%.1f MB/s)\n", recorded ? decodeSeconds * 1e9 / recorded : 0.0,
+              decodeSeconds > 0 ? rawBytes / decodeSeconds / 1e6 : 0.0);
+
+  if (!opt.output.empty()) {
+    FILE* file = std::fopen(opt.output.c_str(), "wb");
+    if (file) {
+      std::fwrite(g_rec.stream.data(), 1, g_rec.stream.size(), file);
+      std::fclose(file);
+      std::printf("written            %s\n", opt.output.c_str());
+    }
+  }
+
+  if (mismatch >= 0) {
+    std::printf("verify             FAIL at frame %ld\n\n", mismatch);
+    return 3;
+  }
+  std::printf("verify             ok\n\n");
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  Options opt;
+  if (!parseOptions(argc, argv, opt)) {
+    usage();
+    return 2;
+  }
+
+  HostNet::setMode(HostNet::Mode::Injected);
+  HostNet::setEthernetIp(IPAddress(10, 0, 0, 50));
+
+  int status = 0;
+  for (const std::string& path : opt.paths) {
+    status = std::max(status, benchCapture(path, opt));
+  }
+  return status;
+}